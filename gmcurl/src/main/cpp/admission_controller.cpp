@@ -0,0 +1,120 @@
+#include "admission_controller.h"
+#include <algorithm>
+
+/**
+ * @file admission_controller.cpp
+ * @brief 请求准入控制实现
+ */
+
+bool ParseOverflowPolicy(const std::string &name, OverflowPolicy &policy) {
+    if (name == "reject") {
+        policy = OverflowPolicy::REJECT_NEW;
+    } else if (name == "dropOldest") {
+        policy = OverflowPolicy::DROP_OLDEST_LOW_PRIORITY;
+    } else if (name == "wait") {
+        policy = OverflowPolicy::WAIT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+AdmissionController::Result AdmissionController::Submit(void *request, int priority, Clock::time_point deadline,
+                                                        void *&dropped, std::vector<void *> &expired) {
+    dropped = nullptr;
+    // 已到期的请求不占用队列位置
+    Expire(expired);
+    if (queue.empty() && inFlight < config.maxInFlight) {
+        inFlight++;
+        stats.admitted++;
+        return Result::START;
+    }
+    if (static_cast<int>(queue.size()) >= config.maxQueued) {
+        if (config.policy == OverflowPolicy::REJECT_NEW || queue.empty()) {
+            stats.rejected++;
+            return Result::REJECTED;
+        }
+        auto victim = queue.begin();
+        bool rejectNew;
+        if (config.policy == OverflowPolicy::WAIT) {
+            // 截止时间最早的请求中最早入队的一个
+            for (auto it = queue.begin(); it != queue.end(); ++it) {
+                if (it->deadline < victim->deadline) {
+                    victim = it;
+                }
+            }
+            rejectNew = victim->deadline == Clock::time_point::max() || deadline < victim->deadline;
+        } else {
+            // 优先级最低的请求中最早入队的一个
+            for (auto it = queue.begin(); it != queue.end(); ++it) {
+                if (it->priority < victim->priority) {
+                    victim = it;
+                }
+            }
+            rejectNew = victim->priority > priority;
+        }
+        if (rejectNew) {
+            stats.rejected++;
+            return Result::REJECTED;
+        }
+        dropped = victim->request;
+        queue.erase(victim);
+        stats.dropped++;
+    }
+    queue.push_back({request, priority, deadline});
+    stats.queued++;
+    return Result::QUEUED;
+}
+
+void AdmissionController::Finish() {
+    if (inFlight > 0) {
+        inFlight--;
+    }
+}
+
+void *AdmissionController::Next(std::vector<void *> &expired) {
+    Expire(expired);
+    if (queue.empty() || inFlight >= config.maxInFlight) {
+        return nullptr;
+    }
+    // 优先级最高的请求中最早入队的一个
+    auto next = queue.begin();
+    for (auto it = queue.begin(); it != queue.end(); ++it) {
+        if (it->priority > next->priority) {
+            next = it;
+        }
+    }
+    void *request = next->request;
+    queue.erase(next);
+    inFlight++;
+    stats.admitted++;
+    return request;
+}
+
+void AdmissionController::Expire(std::vector<void *> &expired) {
+    Clock::time_point now = Clock::now();
+    for (auto it = queue.begin(); it != queue.end();) {
+        if (it->deadline <= now) {
+            expired.push_back(it->request);
+            stats.expired++;
+            it = queue.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void AdmissionController::Drain(std::vector<void *> &drained) {
+    for (const Ticket &ticket : queue) {
+        drained.push_back(ticket.request);
+    }
+    queue.clear();
+}
+
+AdmissionController::Clock::time_point AdmissionController::NextDeadline() const {
+    Clock::time_point deadline = Clock::time_point::max();
+    for (const Ticket &ticket : queue) {
+        deadline = std::min(deadline, ticket.deadline);
+    }
+    return deadline;
+}
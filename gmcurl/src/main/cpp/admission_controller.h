@@ -0,0 +1,161 @@
+#ifndef GMCURL_ADMISSION_CONTROLLER_H
+#define GMCURL_ADMISSION_CONTROLLER_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * @file admission_controller.h
+ * @brief 请求准入控制
+ *
+ * 限制同一env中同时执行的请求数量，超出的请求进入有界等待队列，队列满时按溢出策略处理：
+ * - reject：拒绝新请求
+ * - dropOldest：挤出队列中优先级最低（同优先级中最早）的请求，其优先级高于新请求时拒绝新请求
+ * - wait：不按优先级挤出，依靠截止时间淘汰：挤出截止时间最早的请求，队列中都没有截止时间或新请求更早到期时拒绝新请求
+ * 请求出队时按优先级从高到低、同优先级先进先出。提交与出队时先淘汰已超过截止时间的请求，
+ * 调用方按NextDeadline定时调用Expire，执行槽位一直占满时排队请求也能按时淘汰。
+ * 仅在JS线程中访问，不加锁。
+ */
+
+/**
+ * @brief 队列溢出策略
+ */
+enum class OverflowPolicy {
+    REJECT_NEW,               ///< 拒绝新请求
+    DROP_OLDEST_LOW_PRIORITY, ///< 挤出最早的低优先级请求
+    WAIT                      ///< 始终排队等待
+};
+
+/**
+ * @brief 准入控制配置
+ */
+typedef struct AdmissionConfig {
+    int maxInFlight = 32;                         ///< 最大同时执行请求数
+    int maxQueued = 256;                          ///< 最大排队请求数
+    OverflowPolicy policy = OverflowPolicy::WAIT; ///< 溢出策略
+    int64_t queueTimeout = 0;                     ///< 默认排队截止时间（毫秒），0表示不限
+} AdmissionConfig;
+
+/**
+ * @brief 准入控制统计
+ */
+typedef struct AdmissionStats {
+    int64_t admitted = 0; ///< 已启动请求数
+    int64_t queued = 0;   ///< 曾进入队列的请求数
+    int64_t rejected = 0; ///< 队列满被拒绝的新请求数
+    int64_t dropped = 0;  ///< 被挤出队列的请求数
+    int64_t expired = 0;  ///< 超过截止时间被丢弃的请求数
+} AdmissionStats;
+
+/**
+ * @brief 解析溢出策略名称
+ * @param name 'reject' | 'dropOldest' | 'wait'
+ * @param policy 输出策略
+ * @return 是否支持
+ */
+bool ParseOverflowPolicy(const std::string &name, OverflowPolicy &policy);
+
+/**
+ * @brief 请求准入控制器
+ */
+class AdmissionController {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * @brief 提交结果
+     */
+    enum class Result {
+        START,   ///< 立即执行
+        QUEUED,  ///< 已排队
+        REJECTED ///< 已拒绝
+    };
+
+    /**
+     * @brief 更新配置，放宽限制后需调用Next启动排队请求
+     */
+    void Configure(const AdmissionConfig &config) { this->config = config; }
+
+    /**
+     * @brief 当前配置
+     */
+    const AdmissionConfig &Config() const { return config; }
+
+    /**
+     * @brief 提交请求
+     * @param request 请求
+     * @param priority 优先级，越大越优先
+     * @param deadline 排队截止时间，Clock::time_point::max()表示不限
+     * @param dropped 被挤出队列的请求（无则为nullptr）
+     * @param expired 追加已超过截止时间的请求
+     * @return 提交结果
+     */
+    Result Submit(void *request, int priority, Clock::time_point deadline, void *&dropped,
+                  std::vector<void *> &expired);
+
+    /**
+     * @brief 登记一个已启动的请求结束
+     */
+    void Finish();
+
+    /**
+     * @brief 取出下一个可启动的排队请求
+     * @param expired 追加已超过截止时间的请求
+     * @return 可启动的请求，无执行槽位或队列为空时返回nullptr
+     */
+    void *Next(std::vector<void *> &expired);
+
+    /**
+     * @brief 淘汰已超过截止时间的排队请求
+     * @param expired 追加被淘汰的请求
+     */
+    void Expire(std::vector<void *> &expired);
+
+    /**
+     * @brief 取出全部排队请求（env销毁时）
+     * @param drained 追加取出的请求
+     */
+    void Drain(std::vector<void *> &drained);
+
+    /**
+     * @brief 排队请求中最早的截止时间，队列为空或都不限时返回Clock::time_point::max()
+     */
+    Clock::time_point NextDeadline() const;
+
+    /**
+     * @brief 记录一个在启动前因超时被丢弃的请求（已出队但尚未执行）
+     */
+    void RecordExpired() { stats.expired++; }
+
+    /**
+     * @brief 排队中的请求数
+     */
+    size_t QueueDepth() const { return queue.size(); }
+
+    /**
+     * @brief 执行中的请求数
+     */
+    int InFlight() const { return inFlight; }
+
+    /**
+     * @brief 统计数据
+     */
+    const AdmissionStats &Stats() const { return stats; }
+
+private:
+    typedef struct Ticket {
+        void *request;              ///< 请求
+        int priority;               ///< 优先级
+        Clock::time_point deadline; ///< 截止时间
+    } Ticket;
+
+    AdmissionConfig config;   ///< 配置
+    std::deque<Ticket> queue; ///< 等待队列（按提交顺序）
+    int inFlight = 0;         ///< 执行中的请求数
+    AdmissionStats stats;     ///< 统计数据
+};
+
+#endif // GMCURL_ADMISSION_CONTROLLER_H
@@ -0,0 +1,89 @@
+#include "body_reader.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @file body_reader.cpp
+ * @brief 流式请求体实现
+ */
+
+size_t BodyReader::CurlRead(char *buffer, size_t size, size_t nmemb, void *userp) {
+    auto *reader = static_cast<BodyReader *>(userp);
+    size_t got = reader->Read(buffer, size * nmemb);
+    if (reader->Failed()) {
+        return CURL_READFUNC_ABORT;
+    }
+    return got;
+}
+
+int BodyReader::CurlSeek(void *userp, curl_off_t offset, int origin) {
+    auto *reader = static_cast<BodyReader *>(userp);
+    if (origin != SEEK_SET || offset != 0) {
+        return CURL_SEEKFUNC_CANTSEEK;
+    }
+    return reader->Rewind() ? CURL_SEEKFUNC_OK : CURL_SEEKFUNC_FAIL;
+}
+
+size_t MemoryBodyReader::Read(char *buffer, size_t length) {
+    size_t chunk = std::min(length, size - offset);
+    if (chunk > 0) {
+        memcpy(buffer, data + offset, chunk);
+        offset += chunk;
+    }
+    return chunk;
+}
+
+bool MemoryBodyReader::Rewind() {
+    offset = 0;
+    return true;
+}
+
+FileBodyReader::FileBodyReader(const std::string &filePath, int64_t offset, int64_t length) {
+    fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0) {
+        int64_t fileSize = static_cast<int64_t>(st.st_size);
+        offset = std::min(std::max<int64_t>(offset, 0), fileSize);
+        size = length < 0 ? fileSize - offset : std::min(length, fileSize - offset);
+        reader.Open(fd, offset + size, offset);
+    } else {
+        failed = true;
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+}
+
+FileBodyReader::~FileBodyReader() {
+    // 等待进行中的预读后再关闭文件
+    reader.Close();
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+size_t FileBodyReader::Read(char *buffer, size_t length) {
+    if (fd < 0) {
+        failed = true;
+        return 0;
+    }
+    size_t got = reader.Read(buffer, length);
+    if (reader.Failed()) {
+        failed = true;
+    }
+    return got;
+}
+
+bool FileBodyReader::Rewind() {
+    if (fd < 0) {
+        return false;
+    }
+    reader.Rewind();
+    failed = false;
+    return true;
+}
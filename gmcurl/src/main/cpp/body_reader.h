@@ -0,0 +1,109 @@
+#ifndef GMCURL_BODY_READER_H
+#define GMCURL_BODY_READER_H
+
+#include "curl.h"
+#include "file_io.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * @file body_reader.h
+ * @brief 可重复读取的流式请求体
+ *
+ * 请求体处理阶段（multipart编码、签名摘要、载荷加密）之间通过 BodyReader 串联，
+ * 每个阶段只持有固定大小的缓冲区，文件内容由I/O引擎分块异步预读。
+ */
+
+/**
+ * @brief 流式请求体接口
+ */
+class BodyReader {
+public:
+    virtual ~BodyReader() = default;
+
+    /**
+     * @brief 读取下一段数据
+     * @param buffer 输出缓冲区
+     * @param length 缓冲区大小
+     * @return 实际读取字节数，0表示结束，读取失败时Failed()为true
+     */
+    virtual size_t Read(char *buffer, size_t length) = 0;
+
+    /**
+     * @brief 回到请求体起始位置
+     */
+    virtual bool Rewind() = 0;
+
+    /**
+     * @brief 请求体总长度
+     */
+    virtual int64_t TotalSize() const = 0;
+
+    /**
+     * @brief 是否发生读取错误
+     */
+    virtual bool Failed() const = 0;
+
+    /**
+     * @brief cURL读取回调（CURLOPT_READFUNCTION）
+     */
+    static size_t CurlRead(char *buffer, size_t size, size_t nmemb, void *userp);
+
+    /**
+     * @brief cURL定位回调（CURLOPT_SEEKFUNCTION），仅支持回到起始位置
+     */
+    static int CurlSeek(void *userp, curl_off_t offset, int origin);
+};
+
+/**
+ * @brief 内存请求体（不持有数据）
+ */
+class MemoryBodyReader : public BodyReader {
+public:
+    MemoryBodyReader(const void *data, size_t size) : data(static_cast<const char *>(data)), size(size) {}
+
+    size_t Read(char *buffer, size_t length) override;
+    bool Rewind() override;
+    int64_t TotalSize() const override { return static_cast<int64_t>(size); }
+    bool Failed() const override { return false; }
+
+private:
+    const char *data;  ///< 数据指针
+    size_t size;       ///< 数据大小
+    size_t offset = 0; ///< 当前偏移
+};
+
+/**
+ * @brief 文件请求体（异步预读）
+ */
+class FileBodyReader : public BodyReader {
+public:
+    /**
+     * @param filePath 文件路径
+     * @param offset 起始位置
+     * @param length 读取长度，小于0时读到文件末尾
+     */
+    explicit FileBodyReader(const std::string &filePath, int64_t offset = 0, int64_t length = -1);
+    ~FileBodyReader();
+
+    FileBodyReader(const FileBodyReader &) = delete;
+    FileBodyReader &operator=(const FileBodyReader &) = delete;
+
+    /**
+     * @brief 文件是否可读
+     */
+    bool IsOpen() const { return fd >= 0; }
+
+    size_t Read(char *buffer, size_t length) override;
+    bool Rewind() override;
+    int64_t TotalSize() const override { return size; }
+    bool Failed() const override { return failed; }
+
+private:
+    int fd = -1;          ///< 文件描述符
+    int64_t size = 0;     ///< 文件大小
+    FileReadAhead reader; ///< 预读器
+    bool failed = false;  ///< 读取错误标识
+};
+
+#endif // GMCURL_BODY_READER_H
@@ -0,0 +1,335 @@
+#include "charset_decoder.h"
+#include "gb18030_index.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <strings.h>
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @file charset_decoder.cpp
+ * @brief 文本响应体的字符集解码实现
+ */
+
+namespace {
+
+const char16_t kReplacement = 0xFFFD;
+
+/**
+ * @brief 四字节补充平面码位的起始线性序号（0x90308130）
+ */
+const uint32_t kSupplementaryIndex = 189000;
+
+/**
+ * @brief 字符集名称与字符集
+ */
+typedef struct CharsetName {
+    const char *name;    ///< 字符集名称
+    TextCharset charset; ///< 字符集
+} CharsetName;
+
+const CharsetName kCharsetNames[] = {
+    {"utf-8", TextCharset::UTF8},          {"utf8", TextCharset::UTF8},
+    {"gb18030", TextCharset::GB18030},     {"gbk", TextCharset::GB18030},
+    {"gb2312", TextCharset::GB18030},      {"x-gbk", TextCharset::GB18030},
+    {"cp936", TextCharset::GB18030},       {"windows-936", TextCharset::GB18030},
+    {"iso-8859-1", TextCharset::LATIN1},   {"iso8859-1", TextCharset::LATIN1},
+    {"latin1", TextCharset::LATIN1},       {"us-ascii", TextCharset::LATIN1},
+    {"utf-16le", TextCharset::UTF16LE},    {"utf-16be", TextCharset::UTF16BE},
+    {"utf-16", TextCharset::UTF16LE},
+};
+
+/**
+ * @brief 从data起连续ASCII字节的长度（aarch64使用NEON、x86使用SSE2，每次检查16字节）
+ */
+size_t AsciiPrefix(const uint8_t *data, size_t size) {
+    size_t i = 0;
+#if defined(__aarch64__)
+    for (; i + 64 <= size; i += 64) {
+        uint8x16_t any = vorrq_u8(vorrq_u8(vld1q_u8(data + i), vld1q_u8(data + i + 16)),
+                                  vorrq_u8(vld1q_u8(data + i + 32), vld1q_u8(data + i + 48)));
+        if (vmaxvq_u8(any) >= 0x80) {
+            break;
+        }
+    }
+    for (; i + 16 <= size; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(data + i)) >= 0x80) {
+            break;
+        }
+    }
+#elif defined(__SSE2__)
+    for (; i + 16 <= size; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+#else
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        if (word & 0x8080808080808080ULL) {
+            break;
+        }
+    }
+#endif
+    while (i < size && data[i] < 0x80) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief 把ASCII字节扩展为UTF-16（编译器自动向量化）
+ */
+void WidenAscii(const uint8_t *data, size_t count, char16_t *out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = data[i];
+    }
+}
+
+/**
+ * @brief 按WHATWG规则解码UTF-8，每个最长无效前缀替换为一个U+FFFD
+ * @param out 输出缓冲区，至少size个单元（UTF-16单元数不超过UTF-8字节数）
+ * @param maxCodePoint 出现的最大码位
+ * @return 写入的UTF-16单元数
+ */
+size_t DecodeUtf8(const uint8_t *bytes, size_t size, char16_t *out, uint32_t &maxCodePoint) {
+    size_t i = 0;
+    size_t n = 0;
+    uint32_t maxSeen = 0;
+    while (i < size) {
+        uint8_t lead = bytes[i];
+        if (lead < 0x80) {
+            size_t run = AsciiPrefix(bytes + i, size - i);
+            WidenAscii(bytes + i, run, out + n);
+            i += run;
+            n += run;
+            continue;
+        }
+        size_t need;
+        uint32_t codePoint;
+        uint8_t lower = 0x80;
+        uint8_t upper = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            need = 1;
+            codePoint = lead & 0x1F;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            // 排除超长编码与代理区
+            need = 2;
+            codePoint = lead & 0x0F;
+            lower = lead == 0xE0 ? 0xA0 : 0x80;
+            upper = lead == 0xED ? 0x9F : 0xBF;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            // 排除超长编码与超过U+10FFFF的码位
+            need = 3;
+            codePoint = lead & 0x07;
+            lower = lead == 0xF0 ? 0x90 : 0x80;
+            upper = lead == 0xF4 ? 0x8F : 0xBF;
+        } else {
+            out[n++] = kReplacement;
+            maxSeen = std::max<uint32_t>(maxSeen, kReplacement);
+            i++;
+            continue;
+        }
+        size_t seen = 1;
+        while (seen <= need && i + seen < size && bytes[i + seen] >= lower && bytes[i + seen] <= upper) {
+            codePoint = (codePoint << 6) | (bytes[i + seen] & 0x3F);
+            lower = 0x80;
+            upper = 0xBF;
+            seen++;
+        }
+        if (seen <= need) {
+            // 替换已读取的无效前缀，当前字节重新解析
+            out[n++] = kReplacement;
+            maxSeen = std::max<uint32_t>(maxSeen, kReplacement);
+            i += seen;
+            continue;
+        }
+        i += seen;
+        maxSeen = std::max(maxSeen, codePoint);
+        if (codePoint < 0x10000) {
+            out[n++] = static_cast<char16_t>(codePoint);
+        } else {
+            codePoint -= 0x10000;
+            out[n++] = static_cast<char16_t>(0xD800 + (codePoint >> 10));
+            out[n++] = static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF));
+        }
+    }
+    maxCodePoint = maxSeen;
+    return n;
+}
+
+void AppendCodePoint(std::u16string &out, uint32_t codePoint) {
+    if (codePoint < 0x10000) {
+        out.push_back(static_cast<char16_t>(codePoint));
+    } else {
+        codePoint -= 0x10000;
+        out.push_back(static_cast<char16_t>(0xD800 + (codePoint >> 10)));
+        out.push_back(static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF)));
+    }
+}
+
+/**
+ * @brief 四字节线性序号对应的码位，无效序号返回0
+ */
+uint32_t FourByteCodePoint(uint32_t index) {
+    if (index >= kSupplementaryIndex) {
+        uint32_t codePoint = 0x10000 + (index - kSupplementaryIndex);
+        return codePoint <= 0x10FFFF ? codePoint : 0;
+    }
+    const Gb18030Range *end = kGb18030Ranges + kGb18030RangeCount;
+    const Gb18030Range *range = std::upper_bound(
+        kGb18030Ranges, end, index, [](uint32_t value, const Gb18030Range &entry) { return value < entry.index; });
+    uint32_t codePoint = (range - 1)->codePoint + (index - (range - 1)->index);
+    // 最后一个区间止于U+FFFF
+    return codePoint <= 0xFFFF ? codePoint : 0;
+}
+
+std::u16string DecodeGb18030(const std::string &data) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    size_t size = data.size();
+    std::u16string out;
+    out.reserve(size);
+    size_t i = 0;
+    while (i < size) {
+        uint8_t lead = bytes[i];
+        if (lead < 0x80) {
+            size_t run = AsciiPrefix(bytes + i, size - i);
+            size_t offset = out.size();
+            out.resize(offset + run);
+            WidenAscii(bytes + i, run, &out[offset]);
+            i += run;
+            continue;
+        }
+        if (lead == 0x80 || lead == 0xFF) {
+            // 0x80为CP936中的欧元符号
+            out.push_back(lead == 0x80 ? 0x20AC : kReplacement);
+            i++;
+            continue;
+        }
+        if (i + 1 >= size) {
+            out.push_back(kReplacement);
+            break;
+        }
+        uint8_t second = bytes[i + 1];
+        if (second >= 0x30 && second <= 0x39) {
+            uint8_t third = i + 2 < size ? bytes[i + 2] : 0;
+            uint8_t fourth = i + 3 < size ? bytes[i + 3] : 0;
+            uint32_t codePoint = 0;
+            if (third >= 0x81 && third <= 0xFE && fourth >= 0x30 && fourth <= 0x39) {
+                uint32_t index = ((lead - 0x81) * 10 + (second - 0x30)) * 1260 + (third - 0x81) * 10 + (fourth - 0x30);
+                codePoint = FourByteCodePoint(index);
+            }
+            if (codePoint == 0) {
+                // 无效的四字节序列只替换首字节，其余字节重新解析
+                out.push_back(kReplacement);
+                i++;
+            } else {
+                AppendCodePoint(out, codePoint);
+                i += 4;
+            }
+        } else if (second >= 0x40 && second <= 0xFE && second != 0x7F) {
+            out.push_back(kGb18030TwoByte[(lead - 0x81) * 190 + (second - 0x40) - (second > 0x7F ? 1 : 0)]);
+            i += 2;
+        } else {
+            // 尾字节无效时只替换首字节，ASCII尾字节按原样输出
+            out.push_back(kReplacement);
+            i++;
+        }
+    }
+    return out;
+}
+
+std::u16string DecodeUtf16(const std::string &data, bool bigEndian) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    size_t size = data.size();
+    size_t i = 0;
+    // 字节序标记优先于字符集名称
+    if (size >= 2 && ((bytes[0] == 0xFF && bytes[1] == 0xFE) || (bytes[0] == 0xFE && bytes[1] == 0xFF))) {
+        bigEndian = bytes[0] == 0xFE;
+        i = 2;
+    }
+    std::u16string out;
+    out.reserve(size / 2 + 1);
+    for (; i + 1 < size; i += 2) {
+        uint16_t unit = bigEndian ? (bytes[i] << 8) | bytes[i + 1] : bytes[i] | (bytes[i + 1] << 8);
+        out.push_back(static_cast<char16_t>(unit));
+    }
+    if (i < size) {
+        out.push_back(kReplacement);
+    }
+    return out;
+}
+
+} // namespace
+
+bool ParseCharset(const std::string &name, TextCharset &out) {
+    for (const CharsetName &entry : kCharsetNames) {
+        if (strcasecmp(entry.name, name.c_str()) == 0) {
+            out = entry.charset;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string CharsetOfContentType(const std::string &contentType) {
+    size_t pos = 0;
+    while ((pos = contentType.find(';', pos)) != std::string::npos) {
+        pos = contentType.find_first_not_of(" \t", pos + 1);
+        if (pos == std::string::npos) {
+            break;
+        }
+        if (strncasecmp(contentType.c_str() + pos, "charset=", 8) == 0) {
+            std::string value = contentType.substr(pos + 8);
+            value = value.substr(0, value.find(';'));
+            value.erase(value.find_last_not_of(" \t") + 1);
+            if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+                value = value.substr(1, value.size() - 2);
+            }
+            return value;
+        }
+    }
+    return std::string();
+}
+
+TextForm PrepareText(TextCharset charset, std::string &data, std::u16string &decoded) {
+    switch (charset) {
+        case TextCharset::LATIN1:
+            return TextForm::LATIN1;
+        case TextCharset::GB18030:
+            decoded = DecodeGb18030(data);
+            break;
+        case TextCharset::UTF16LE:
+        case TextCharset::UTF16BE:
+            decoded = DecodeUtf16(data, charset == TextCharset::UTF16BE);
+            break;
+        default: {
+            const auto *bytes = reinterpret_cast<const uint8_t *>(data.data());
+            // 纯ASCII不需要转换
+            if (AsciiPrefix(bytes, data.size()) == data.size()) {
+                return TextForm::LATIN1;
+            }
+            decoded.resize(data.size());
+            uint32_t maxCodePoint = 0;
+            decoded.resize(DecodeUtf8(bytes, data.size(), &decoded[0], maxCodePoint));
+            if (maxCodePoint <= 0xFF) {
+                // 只含Latin-1字符时转为单字节，JS字符串占用一半内存
+                data.resize(decoded.size());
+                for (size_t i = 0; i < decoded.size(); i++) {
+                    data[i] = static_cast<char>(decoded[i]);
+                }
+                std::u16string().swap(decoded);
+                return TextForm::LATIN1;
+            }
+            break;
+        }
+    }
+    data.clear();
+    return TextForm::UTF16;
+}
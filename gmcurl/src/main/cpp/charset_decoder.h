@@ -0,0 +1,59 @@
+#ifndef GMCURL_CHARSET_DECODER_H
+#define GMCURL_CHARSET_DECODER_H
+
+#include <string>
+
+/**
+ * @file charset_decoder.h
+ * @brief 文本响应体的字符集解码
+ *
+ * 响应体在传输线程中转换为可直接创建JS字符串的形式，JS线程不再校验与转码：
+ * - UTF-8响应先以SIMD检测纯ASCII，纯ASCII或只含U+0000~U+00FF的响应转为Latin-1，以napi_create_string_latin1创建
+ * - 其他UTF-8响应校验后转为UTF-16，无效序列按WHATWG规则（每个最长无效前缀）替换为U+FFFD
+ * - GBK/GB2312/GB18030响应查表解码为UTF-16，以napi_create_string_utf16创建；ISO-8859-1响应原样保留
+ */
+
+/**
+ * @brief 文本响应体的字符集
+ */
+enum class TextCharset {
+    UTF8,    ///< UTF-8（默认）
+    LATIN1,  ///< ISO-8859-1
+    UTF16LE, ///< UTF-16LE
+    UTF16BE, ///< UTF-16BE
+    GB18030  ///< GB18030（兼容GBK、GB2312）
+};
+
+/**
+ * @brief 响应体转换后的存放形式
+ */
+enum class TextForm {
+    UTF8,   ///< 未转换，以napi_create_string_utf8创建
+    LATIN1, ///< Latin-1字节，以napi_create_string_latin1创建
+    UTF16   ///< UTF-16，以napi_create_string_utf16创建
+};
+
+/**
+ * @brief 按字符集名称识别（不区分大小写）
+ * @param name 字符集名称，如"gbk"、"GB2312"、"utf-8"
+ * @param out 识别的字符集
+ * @return 是否支持该字符集
+ */
+bool ParseCharset(const std::string &name, TextCharset &out);
+
+/**
+ * @brief 取Content-Type中的charset参数
+ * @return charset参数值（已去除引号），没有时返回空字符串
+ */
+std::string CharsetOfContentType(const std::string &contentType);
+
+/**
+ * @brief 把响应体转换为可直接创建JS字符串的形式，无效或不完整的字节序列替换为U+FFFD
+ * @param charset 字符集
+ * @param data 响应体，转为Latin-1时原地改写，转为UTF-16时清空
+ * @param decoded 转为UTF-16时的结果
+ * @return 转换后的存放形式
+ */
+TextForm PrepareText(TextCharset charset, std::string &data, std::u16string &decoded);
+
+#endif // GMCURL_CHARSET_DECODER_H
@@ -0,0 +1,285 @@
+#include "connection_pool.h"
+#include <algorithm>
+#include <thread>
+
+/**
+ * @file connection_pool.cpp
+ * @brief 进程级连接池实现
+ */
+
+ConnectionPool &ConnectionPool::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static ConnectionPool *pool = new ConnectionPool();
+    return *pool;
+}
+
+std::string ConnectionPool::KeyOf(const std::string &url) {
+    std::string key;
+    CURLU *handle = curl_url();
+    if (!handle) {
+        return key;
+    }
+    char *scheme = nullptr;
+    char *host = nullptr;
+    char *port = nullptr;
+    if (curl_url_set(handle, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK &&
+        curl_url_get(handle, CURLUPART_SCHEME, &scheme, 0) == CURLUE_OK &&
+        curl_url_get(handle, CURLUPART_HOST, &host, 0) == CURLUE_OK &&
+        curl_url_get(handle, CURLUPART_PORT, &port, CURLU_DEFAULT_PORT) == CURLUE_OK) {
+        key = std::string(scheme) + "://" + host + ":" + port;
+    }
+    curl_free(scheme);
+    curl_free(host);
+    curl_free(port);
+    curl_url_cleanup(handle);
+    return key;
+}
+
+void ConnectionPool::Configure(const ConnectionPoolConfig &newConfig) {
+    std::vector<CURL *> closing;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        config = newConfig;
+        CollectExcess(closing);
+    }
+    wakeup.notify_all();
+    for (CURL *curl : closing) {
+        curl_easy_cleanup(curl);
+    }
+}
+
+ConnectionPoolConfig ConnectionPool::Config() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return config;
+}
+
+CURL *ConnectionPool::Acquire(const std::string &key) {
+    if (key.empty()) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    Host &host = hosts[key];
+    host.busy++;
+    if (host.idle.empty()) {
+        return nullptr;
+    }
+    // 优先使用最近归还的连接，最不可能已被服务端关闭
+    IdleHandle handle = host.idle.front();
+    host.idle.pop_front();
+    births[handle.curl] = handle.born;
+    return handle.curl;
+}
+
+void ConnectionPool::Prepare(CURL *curl) {
+    ConnectionPoolConfig current = Config();
+    curl_easy_setopt(curl, CURLOPT_MAXCONNECTS, 1L);
+    curl_easy_setopt(curl, CURLOPT_MAXAGE_CONN, static_cast<long>(current.maxIdleTime));
+    curl_easy_setopt(curl, CURLOPT_MAXLIFETIME_CONN, static_cast<long>(current.maxConnectionAge));
+    if (current.tcpKeepAlive > 0) {
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, static_cast<long>(current.tcpKeepAlive));
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, static_cast<long>(current.tcpKeepAlive));
+    }
+}
+
+void ConnectionPool::Release(const std::string &key, CURL *curl, bool reusable) {
+    if (key.empty()) {
+        if (curl) {
+            curl_easy_cleanup(curl);
+        }
+        return;
+    }
+    if (curl && reusable) {
+        // 清除请求级选项（包括指向请求上下文的回调数据），保留连接、会话与DNS缓存
+        curl_easy_reset(curl);
+    }
+    bool pooled = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Host &host = hosts[key];
+        host.busy = std::max(host.busy - 1, 0);
+        Clock::time_point born = Clock::now();
+        auto birth = curl ? births.find(curl) : births.end();
+        if (birth != births.end()) {
+            born = birth->second;
+            births.erase(birth);
+        }
+        int open = 0;
+        for (const auto &item : hosts) {
+            open += static_cast<int>(item.second.idle.size()) + item.second.busy + item.second.pinging;
+        }
+        bool expired = config.maxConnectionAge > 0 &&
+                       Clock::now() - born >= std::chrono::seconds(config.maxConnectionAge);
+        bool withinLimit =
+            static_cast<int>(host.idle.size()) + host.busy + host.pinging < config.maxConnectionsPerHost &&
+            open < config.maxConnections;
+        if (curl && reusable && !expired && withinLimit) {
+            host.idle.push_front({curl, Clock::now(), born});
+            pooled = true;
+            StartReaper();
+        } else if (host.idle.empty() && host.busy == 0 && host.pinging == 0) {
+            hosts.erase(key);
+        }
+    }
+    if (pooled) {
+        wakeup.notify_all();
+    } else if (curl) {
+        curl_easy_cleanup(curl);
+    }
+}
+
+int ConnectionPool::CloseIdle() {
+    std::vector<CURL *> closing;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // 保活检测中的句柄由后台线程检测完后关闭
+        closeGeneration++;
+        for (auto it = hosts.begin(); it != hosts.end();) {
+            for (const IdleHandle &handle : it->second.idle) {
+                closing.push_back(handle.curl);
+            }
+            it->second.idle.clear();
+            it = it->second.busy == 0 && it->second.pinging == 0 ? hosts.erase(it) : std::next(it);
+        }
+    }
+    for (CURL *curl : closing) {
+        curl_easy_cleanup(curl);
+    }
+    return static_cast<int>(closing.size());
+}
+
+std::vector<HostConnectionStats> ConnectionPool::Stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<HostConnectionStats> result;
+    for (const auto &item : hosts) {
+        HostConnectionStats stats;
+        stats.host = item.first;
+        stats.idle = static_cast<int>(item.second.idle.size()) + item.second.pinging;
+        stats.busy = item.second.busy;
+        result.push_back(stats);
+    }
+    return result;
+}
+
+size_t ConnectionPool::IdleCount() const {
+    size_t count = 0;
+    for (const auto &item : hosts) {
+        count += item.second.idle.size();
+    }
+    return count;
+}
+
+void ConnectionPool::CollectExcess(std::vector<CURL *> &closing) {
+    // 需持有互斥锁：关闭超出主机上限的空闲连接（最久未用的优先）
+    int open = 0;
+    for (auto &item : hosts) {
+        Host &host = item.second;
+        while (!host.idle.empty() &&
+               static_cast<int>(host.idle.size()) + host.busy + host.pinging > config.maxConnectionsPerHost) {
+            closing.push_back(host.idle.back().curl);
+            host.idle.pop_back();
+        }
+        open += static_cast<int>(host.idle.size()) + host.busy + host.pinging;
+    }
+    // 关闭超出总上限的空闲连接
+    for (auto &item : hosts) {
+        Host &host = item.second;
+        while (open > config.maxConnections && !host.idle.empty()) {
+            closing.push_back(host.idle.back().curl);
+            host.idle.pop_back();
+            open--;
+        }
+    }
+}
+
+void ConnectionPool::StartReaper() {
+    // 需持有互斥锁
+    if (reaperStarted) {
+        return;
+    }
+    reaperStarted = true;
+    std::thread([this] { Reap(); }).detach();
+}
+
+void ConnectionPool::Reap() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        // 没有空闲连接时休眠，避免后台空转
+        wakeup.wait(lock, [this] { return IdleCount() > 0; });
+        std::vector<CURL *> closing;
+        std::vector<std::pair<std::string, IdleHandle>> pinging;
+        Clock::time_point now = Clock::now();
+        for (auto it = hosts.begin(); it != hosts.end();) {
+            Host &host = it->second;
+            for (auto handle = host.idle.begin(); handle != host.idle.end();) {
+                bool idleTimeout = now - handle->since >= std::chrono::seconds(config.maxIdleTime);
+                bool tooOld = config.maxConnectionAge > 0 &&
+                              now - handle->born >= std::chrono::seconds(config.maxConnectionAge);
+                if (idleTimeout || tooOld) {
+                    closing.push_back(handle->curl);
+                    handle = host.idle.erase(handle);
+                    continue;
+                }
+                if (config.pingInterval > 0 && now - handle->since >= std::chrono::seconds(config.pingInterval)) {
+                    // 移出空闲列表后在锁外检测，检测期间不会被取用
+                    pinging.emplace_back(it->first, *handle);
+                    host.pinging++;
+                    handle = host.idle.erase(handle);
+                    continue;
+                }
+                ++handle;
+            }
+            it = host.idle.empty() && host.busy == 0 && host.pinging == 0 ? hosts.erase(it) : std::next(it);
+        }
+        if (!closing.empty() || !pinging.empty()) {
+            long upkeepInterval = static_cast<long>(config.pingInterval * 1000);
+            uint64_t generation = closeGeneration;
+            lock.unlock();
+            for (CURL *curl : closing) {
+                curl_easy_cleanup(curl);
+            }
+            closing.clear();
+            std::vector<bool> alive;
+            for (const auto &item : pinging) {
+                // 按CURLOPT_UPKEEP_INTERVAL_MS对HTTP/2连接发送PING，检测失效连接
+                curl_easy_setopt(item.second.curl, CURLOPT_UPKEEP_INTERVAL_MS, upkeepInterval);
+                alive.push_back(curl_easy_upkeep(item.second.curl) == CURLE_OK);
+            }
+            lock.lock();
+            // 检测通过的句柄按空闲时间放回原位置，失效或检测期间已要求关闭全部空闲连接的句柄关闭
+            for (size_t i = 0; i < pinging.size(); i++) {
+                Host &host = hosts[pinging[i].first];
+                host.pinging--;
+                const IdleHandle &handle = pinging[i].second;
+                if (!alive[i] || generation != closeGeneration) {
+                    closing.push_back(handle.curl);
+                    continue;
+                }
+                auto position = host.idle.begin();
+                while (position != host.idle.end() && position->since >= handle.since) {
+                    ++position;
+                }
+                host.idle.insert(position, handle);
+            }
+            // 检测期间配置可能已调低上限
+            CollectExcess(closing);
+            for (auto it = hosts.begin(); it != hosts.end();) {
+                const Host &host = it->second;
+                it = host.idle.empty() && host.busy == 0 && host.pinging == 0 ? hosts.erase(it) : std::next(it);
+            }
+            if (!closing.empty()) {
+                lock.unlock();
+                for (CURL *curl : closing) {
+                    curl_easy_cleanup(curl);
+                }
+                lock.lock();
+            }
+        }
+        // 检查周期取空闲超时与PING间隔中较小者
+        int64_t period = config.maxIdleTime;
+        if (config.pingInterval > 0) {
+            period = std::min(period, config.pingInterval);
+        }
+        wakeup.wait_for(lock, std::chrono::seconds(std::max<int64_t>(period, 1)));
+    }
+}
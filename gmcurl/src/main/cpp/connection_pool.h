@@ -0,0 +1,147 @@
+#ifndef GMCURL_CONNECTION_POOL_H
+#define GMCURL_CONNECTION_POOL_H
+
+#include "curl.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @file connection_pool.h
+ * @brief 进程级连接池
+ *
+ * libcurl的连接缓存属于cURL句柄，句柄释放时连接随之关闭。连接池在请求结束后不释放句柄，
+ * 而是curl_easy_reset后按"协议://主机:端口"放入空闲列表，下一个发往同一主机的请求直接取用，复用其中的连接：
+ * - 每个句柄最多保留一个连接（CURLOPT_MAXCONNECTS=1），空闲句柄数即空闲连接数
+ * - 请求结束后主机/总连接数超过上限时直接关闭，并发数量由准入控制限制
+ * - 后台线程关闭空闲超时或超过最大存活时间的连接，并对空闲连接调用curl_easy_upkeep发送HTTP/2 PING
+ *   （保活检测期间句柄移出空闲列表，不持有互斥锁，不阻塞取用与归还）
+ * - 启用TCP keepalive，由内核探测失效连接
+ * 失败、取消的请求不归还连接。
+ */
+
+/**
+ * @brief 连接池配置
+ */
+typedef struct ConnectionPoolConfig {
+    int maxConnections = 32;       ///< 最大连接数（所有主机）
+    int maxConnectionsPerHost = 6; ///< 单个主机最大连接数
+    int64_t maxIdleTime = 60;      ///< 最长空闲时间（秒）
+    int64_t maxConnectionAge = 0;  ///< 最长存活时间（秒），0表示不限
+    int64_t tcpKeepAlive = 30;     ///< TCP keepalive空闲探测间隔（秒），0表示关闭
+    int64_t pingInterval = 30;     ///< HTTP/2 PING间隔（秒），0表示关闭
+} ConnectionPoolConfig;
+
+/**
+ * @brief 单个主机的连接状态
+ */
+typedef struct HostConnectionStats {
+    std::string host; ///< 协议://主机:端口
+    int idle = 0;     ///< 空闲连接数
+    int busy = 0;     ///< 使用中的连接数
+} HostConnectionStats;
+
+/**
+ * @brief 进程级连接池
+ */
+class ConnectionPool {
+public:
+    /**
+     * @brief 获取进程级实例（首次调用时创建，进程退出前不释放）
+     */
+    static ConnectionPool &Instance();
+
+    ConnectionPool(const ConnectionPool &) = delete;
+    ConnectionPool &operator=(const ConnectionPool &) = delete;
+
+    /**
+     * @brief 计算URL对应的连接池键
+     * @param url 请求URL
+     * @return 协议://主机:端口，URL无法解析时返回空字符串
+     */
+    static std::string KeyOf(const std::string &url);
+
+    /**
+     * @brief 更新配置，超出新上限的空闲连接立即关闭
+     */
+    void Configure(const ConnectionPoolConfig &config);
+
+    /**
+     * @brief 当前配置
+     */
+    ConnectionPoolConfig Config();
+
+    /**
+     * @brief 取出主机的空闲句柄并登记使用中
+     * @param key 连接池键
+     * @return 空闲句柄，没有时返回nullptr（调用方自行创建句柄）
+     */
+    CURL *Acquire(const std::string &key);
+
+    /**
+     * @brief 为句柄设置连接池相关选项（空闲/存活时间、keepalive、PING间隔）
+     */
+    void Prepare(CURL *curl);
+
+    /**
+     * @brief 请求结束，归还或关闭句柄，并注销使用中
+     * @param key 连接池键
+     * @param curl cURL句柄（允许nullptr）
+     * @param reusable 连接是否可复用
+     */
+    void Release(const std::string &key, CURL *curl, bool reusable);
+
+    /**
+     * @brief 关闭全部空闲连接（例如应用从后台恢复时）
+     * @return 关闭的连接数
+     */
+    int CloseIdle();
+
+    /**
+     * @brief 各主机连接状态
+     */
+    std::vector<HostConnectionStats> Stats();
+
+private:
+    ConnectionPool() = default;
+
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * @brief 空闲句柄
+     */
+    typedef struct IdleHandle {
+        CURL *curl;              ///< cURL句柄
+        Clock::time_point since; ///< 进入空闲的时间
+        Clock::time_point born;  ///< 创建时间
+    } IdleHandle;
+
+    /**
+     * @brief 单个主机的句柄
+     */
+    typedef struct Host {
+        std::list<IdleHandle> idle; ///< 空闲句柄（最近归还的在前）
+        int busy = 0;               ///< 使用中的句柄数
+        int pinging = 0;            ///< 保活检测中的空闲句柄数（不可取用）
+    } Host;
+
+    void Reap();
+    void StartReaper();
+    size_t IdleCount() const;
+    void CollectExcess(std::vector<CURL *> &closing);
+
+    std::mutex mutex;                               ///< 互斥锁
+    std::condition_variable wakeup;                 ///< 唤醒后台线程
+    ConnectionPoolConfig config;                    ///< 配置
+    std::map<std::string, Host> hosts;              ///< 各主机句柄
+    std::map<CURL *, Clock::time_point> births;     ///< 使用中句柄的创建时间
+    bool reaperStarted = false;                     ///< 后台线程是否已启动
+    uint64_t closeGeneration = 0;                   ///< CloseIdle调用次数，保活检测期间变化时检测完直接关闭
+};
+
+#endif // GMCURL_CONNECTION_POOL_H
@@ -0,0 +1,661 @@
+#include "download_manager.h"
+#include "connection_pool.h"
+#include "journal_file.h"
+#include "receive_tuner.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <strings.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+/**
+ * @file download_manager.cpp
+ * @brief 进程级持久化下载管理器实现
+ */
+
+namespace {
+
+/**
+ * @brief 任务日志文件名
+ */
+const char *const kJournalFileName = "downloads.journal";
+
+/**
+ * @brief 下载线程的轮询周期与进度汇总周期（毫秒）
+ */
+const int kTickMs = 500;
+
+/**
+ * @brief 下载中定期写入进度的间隔（秒）
+ */
+const int kSaveInterval = 5;
+
+/**
+ * @brief 暂停后保留连接的时间（秒），超过后释放连接，恢复时续传
+ */
+const int kPauseHoldSeconds = 30;
+
+/**
+ * @brief 网络中断后自动续传的次数
+ */
+const int kMaxRetries = 3;
+
+int64_t FileSize(const std::string &path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? static_cast<int64_t>(st.st_size) : 0;
+}
+
+bool ParseState(const std::string &name, DownloadState &state) {
+    for (DownloadState candidate : {DownloadState::QUEUED, DownloadState::RUNNING, DownloadState::PAUSED,
+                                    DownloadState::COMPLETED, DownloadState::FAILED}) {
+        if (name == DownloadStateName(candidate)) {
+            state = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 网络中断类错误，已有数据可续传
+ */
+bool IsRetriable(CURLcode result) {
+    return result == CURLE_RECV_ERROR || result == CURLE_SEND_ERROR || result == CURLE_PARTIAL_FILE ||
+           result == CURLE_GOT_NOTHING || result == CURLE_OPERATION_TIMEDOUT || result == CURLE_HTTP2_STREAM;
+}
+
+/**
+ * @brief 提取响应头的值（去除首尾空白）
+ */
+bool HeaderValue(const char *data, size_t len, const char *name, std::string &out) {
+    size_t nameLen = strlen(name);
+    if (len <= nameLen || strncasecmp(data, name, nameLen) != 0) {
+        return false;
+    }
+    std::string value(data + nameLen, len - nameLen);
+    size_t begin = value.find_first_not_of(" \t");
+    size_t end = value.find_last_not_of(" \t\r\n");
+    out = begin == std::string::npos ? "" : value.substr(begin, end - begin + 1);
+    return true;
+}
+
+} // namespace
+
+const char *DownloadStateName(DownloadState state) {
+    switch (state) {
+        case DownloadState::QUEUED:
+            return "queued";
+        case DownloadState::RUNNING:
+            return "running";
+        case DownloadState::PAUSED:
+            return "paused";
+        case DownloadState::COMPLETED:
+            return "completed";
+        case DownloadState::FAILED:
+            return "failed";
+    }
+    return "failed";
+}
+
+DownloadManager &DownloadManager::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static DownloadManager *manager = new DownloadManager();
+    return *manager;
+}
+
+void DownloadManager::Start(const std::string &newDirectory, DownloadConfigurator newConfigurator) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!configurator) {
+        configurator = newConfigurator;
+    }
+    if (!newDirectory.empty()) {
+        LoadJournal(newDirectory + "/" + kJournalFileName);
+    }
+    directory = newDirectory;
+    journalDirty = true;
+    if (!started) {
+        multi = curl_multi_init();
+        if (!multi) {
+            return;
+        }
+        started = true;
+        std::thread([this] { Loop(); }).detach();
+    }
+    wakeup.notify_all();
+    curl_multi_wakeup(multi);
+}
+
+std::string DownloadManager::Add(const DownloadOptions &options, const std::string &id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string jobId = id;
+    if (jobId.empty()) {
+        int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+        jobId = "dl-" + std::to_string(now) + "-" + std::to_string(nextSequence);
+    }
+    if (jobs.count(jobId)) {
+        return jobId;
+    }
+    std::unique_ptr<Job> job(new Job());
+    job->id = jobId;
+    job->options = options;
+    job->host = ConnectionPool::KeyOf(options.url);
+    job->sequence = nextSequence++;
+    job->changed = true;
+    jobs[jobId] = std::move(job);
+    journalDirty = true;
+    if (multi) {
+        wakeup.notify_all();
+        curl_multi_wakeup(multi);
+    }
+    return jobId;
+}
+
+bool DownloadManager::Pause(const std::string &id) { return Post(Command::PAUSE, id); }
+
+bool DownloadManager::Resume(const std::string &id) { return Post(Command::RESUME, id); }
+
+bool DownloadManager::Remove(const std::string &id) { return Post(Command::REMOVE, id); }
+
+bool DownloadManager::Post(Command::Type type, const std::string &id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!jobs.count(id)) {
+        return false;
+    }
+    commands.push_back({type, id});
+    if (multi) {
+        wakeup.notify_all();
+        curl_multi_wakeup(multi);
+    }
+    return true;
+}
+
+std::vector<DownloadInfo> DownloadManager::List() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<DownloadInfo> result;
+    for (const auto &item : jobs) {
+        result.push_back(Info(*item.second));
+    }
+    return result;
+}
+
+DownloadInfo DownloadManager::Info(const Job &job) {
+    // 需持有互斥锁
+    DownloadInfo info;
+    info.id = job.id;
+    info.url = job.options.url;
+    info.filePath = job.options.filePath;
+    info.priority = job.options.priority;
+    info.state = job.state;
+    info.downloaded = job.downloaded.load();
+    info.total = job.total.load();
+    info.error = job.error;
+    return info;
+}
+
+void DownloadManager::Configure(int newMaxConcurrent, int newMaxPerHost) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (newMaxConcurrent > 0) {
+        maxConcurrent = newMaxConcurrent;
+    }
+    if (newMaxPerHost > 0) {
+        maxPerHost = newMaxPerHost;
+    }
+    if (multi) {
+        wakeup.notify_all();
+        curl_multi_wakeup(multi);
+    }
+}
+
+int DownloadManager::AddListener(DownloadListener listener) {
+    std::lock_guard<std::mutex> lock(listenerMutex);
+    int token = nextListener++;
+    listeners[token] = listener;
+    return token;
+}
+
+void DownloadManager::RemoveListener(int token) {
+    std::lock_guard<std::mutex> lock(listenerMutex);
+    listeners.erase(token);
+}
+
+void DownloadManager::Loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    lastNotify = Clock::now();
+    lastSave = lastNotify;
+    while (true) {
+        ApplyCommands();
+        Schedule();
+        ReleaseHeldPauses();
+        bool active = std::any_of(jobs.begin(), jobs.end(), [](const auto &item) { return item.second->curl; });
+        Clock::time_point now = Clock::now();
+        std::vector<DownloadInfo> batch;
+        if (!active || now - lastNotify >= std::chrono::milliseconds(kTickMs)) {
+            batch = CollectChanges();
+            lastNotify = now;
+        }
+        std::string journal;
+        std::string journalDirectory;
+        if (journalDirty || (active && now - lastSave >= std::chrono::seconds(kSaveInterval))) {
+            journal = SerializeJournal();
+            journalDirectory = directory;
+            journalDirty = false;
+            lastSave = now;
+        }
+        lock.unlock();
+        if (!batch.empty()) {
+            std::lock_guard<std::mutex> listenerLock(listenerMutex);
+            for (const auto &item : listeners) {
+                item.second(batch);
+            }
+        }
+        if (!journalDirectory.empty()) {
+            WriteJournal(journalDirectory, journal);
+        }
+        if (!active) {
+            // 没有进行中的传输时休眠，直到有新任务或命令
+            lock.lock();
+            wakeup.wait(lock, [this] { return !commands.empty() || journalDirty || HasQueued(); });
+            continue;
+        }
+        int running = 0;
+        curl_multi_perform(multi, &running);
+        curl_multi_poll(multi, nullptr, 0, kTickMs, nullptr);
+        curl_multi_perform(multi, &running);
+        lock.lock();
+        CURLMsg *message = nullptr;
+        int remaining = 0;
+        while ((message = curl_multi_info_read(multi, &remaining)) != nullptr) {
+            if (message->msg != CURLMSG_DONE) {
+                continue;
+            }
+            Job *job = nullptr;
+            curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &job);
+            if (job) {
+                FinishJob(*job, message->data.result);
+            }
+        }
+    }
+}
+
+bool DownloadManager::HasQueued() {
+    // 需持有互斥锁
+    return std::any_of(jobs.begin(), jobs.end(),
+                       [](const auto &item) { return item.second->state == DownloadState::QUEUED; });
+}
+
+void DownloadManager::ApplyCommands() {
+    // 需持有互斥锁
+    std::vector<Command> pending;
+    pending.swap(commands);
+    for (const Command &command : pending) {
+        auto it = jobs.find(command.id);
+        if (it == jobs.end()) {
+            continue;
+        }
+        Job &job = *it->second;
+        if (command.type == Command::PAUSE) {
+            if (job.state == DownloadState::RUNNING && job.curl) {
+                // 暂停接收，保留连接
+                curl_easy_pause(job.curl, CURLPAUSE_RECV);
+                job.pausedAt = Clock::now();
+            } else if (job.state != DownloadState::QUEUED) {
+                continue;
+            }
+            job.state = DownloadState::PAUSED;
+        } else if (command.type == Command::RESUME) {
+            if (job.state == DownloadState::PAUSED && job.curl) {
+                curl_easy_pause(job.curl, CURLPAUSE_CONT);
+                job.state = DownloadState::RUNNING;
+            } else if (job.state == DownloadState::PAUSED || job.state == DownloadState::FAILED) {
+                job.state = DownloadState::QUEUED;
+                job.retries = 0;
+                job.error.clear();
+            } else {
+                continue;
+            }
+        } else {
+            DetachJob(job);
+            if (job.state != DownloadState::COMPLETED) {
+                std::remove(job.options.filePath.c_str());
+            }
+            jobs.erase(it);
+            journalDirty = true;
+            continue;
+        }
+        job.changed = true;
+        journalDirty = true;
+    }
+}
+
+void DownloadManager::Schedule() {
+    // 需持有互斥锁
+    int active = 0;
+    std::map<std::string, int> perHost;
+    std::vector<Job *> queued;
+    for (const auto &item : jobs) {
+        Job *job = item.second.get();
+        if (job->curl) {
+            active++;
+            perHost[job->host]++;
+        } else if (job->state == DownloadState::QUEUED) {
+            queued.push_back(job);
+        }
+    }
+    // 高优先级先启动，同优先级先进先出
+    std::sort(queued.begin(), queued.end(), [](const Job *a, const Job *b) {
+        return a->options.priority != b->options.priority ? a->options.priority > b->options.priority
+                                                          : a->sequence < b->sequence;
+    });
+    for (Job *job : queued) {
+        if (active >= maxConcurrent) {
+            break;
+        }
+        if (perHost[job->host] >= maxPerHost) {
+            continue;
+        }
+        StartJob(*job);
+        if (job->curl) {
+            active++;
+            perHost[job->host]++;
+        }
+    }
+}
+
+void DownloadManager::StartJob(Job &job) {
+    // 需持有互斥锁
+    job.changed = true;
+    journalDirty = true;
+    // 只有能校验资源未变化时才续传
+    int64_t size = FileSize(job.options.filePath);
+    bool validated = !job.etag.empty() || !job.lastModified.empty();
+    job.offset = size > 0 && validated ? size : 0;
+    // 由批量写入器按偏移异步写入
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (job.offset > 0 ? 0 : O_TRUNC);
+    job.fd = open(job.options.filePath.c_str(), flags, 0644);
+    job.curl = job.fd >= 0 ? curl_easy_init() : nullptr;
+    if (!job.curl) {
+        job.error = job.fd >= 0 ? "Curl initialization failed" : "Failed to open file: " + job.options.filePath;
+        if (job.fd >= 0) {
+            close(job.fd);
+            job.fd = -1;
+        }
+        job.state = DownloadState::FAILED;
+        return;
+    }
+    long bufferSize = ReceiveTuner::Instance().BufferSize(job.host, true);
+    job.batcher.Open(job.fd, job.offset, ReceiveTuner::BatchSize(bufferSize));
+    job.downloaded = job.offset;
+    job.progressed = true;
+    job.responseChecked = false;
+    job.writeFailed = false;
+
+    if (configurator) {
+        configurator(job.curl, job.options);
+    }
+    // 按字节续传，不协商压缩编码
+    curl_easy_setopt(job.curl, CURLOPT_ACCEPT_ENCODING, nullptr);
+    curl_easy_setopt(job.curl, CURLOPT_URL, job.options.url.c_str());
+    curl_easy_setopt(job.curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(job.curl, CURLOPT_MAXREDIRS, 10L);
+    curl_easy_setopt(job.curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(job.curl, CURLOPT_CONNECTTIMEOUT, static_cast<long>(job.options.connectTimeout));
+    curl_easy_setopt(job.curl, CURLOPT_BUFFERSIZE, bufferSize);
+    curl_easy_setopt(job.curl, CURLOPT_WRITEFUNCTION, WriteBody);
+    curl_easy_setopt(job.curl, CURLOPT_WRITEDATA, &job);
+    curl_easy_setopt(job.curl, CURLOPT_HEADERFUNCTION, ReadHeader);
+    curl_easy_setopt(job.curl, CURLOPT_HEADERDATA, &job);
+    curl_easy_setopt(job.curl, CURLOPT_PRIVATE, &job);
+    for (const std::string &header : job.options.headers) {
+        job.headerList = curl_slist_append(job.headerList, header.c_str());
+    }
+    if (job.offset > 0) {
+        std::string validator = job.etag.empty() ? job.lastModified : job.etag;
+        job.headerList = curl_slist_append(job.headerList, ("If-Range: " + validator).c_str());
+        curl_easy_setopt(job.curl, CURLOPT_RANGE, (std::to_string(job.offset) + "-").c_str());
+    }
+    curl_easy_setopt(job.curl, CURLOPT_HTTPHEADER, job.headerList);
+    curl_multi_add_handle(multi, job.curl);
+    job.state = DownloadState::RUNNING;
+    job.error.clear();
+}
+
+void DownloadManager::FinishJob(Job &job, CURLcode result) {
+    // 需持有互斥锁
+    long code = 0;
+    curl_easy_getinfo(job.curl, CURLINFO_RESPONSE_CODE, &code);
+    int64_t received = job.downloaded.load() - job.offset;
+    bool completeBefore = result == CURLE_HTTP_RETURNED_ERROR && code == 416 && job.offset > 0;
+    // 等待全部写入完成
+    bool writeFailed = !job.batcher.Close() || job.writeFailed;
+    if (result == CURLE_OK && !writeFailed) {
+        ReceiveTuner::Instance().Record(job.host, job.curl);
+    }
+    DetachJob(job);
+    job.changed = true;
+    journalDirty = true;
+    if ((result == CURLE_OK && !writeFailed) || (completeBefore && job.total.load() == job.offset)) {
+        // 续传范围无效且已知文件已完整时同样视为完成
+        job.state = DownloadState::COMPLETED;
+        job.total = job.downloaded.load();
+        job.retries = 0;
+        return;
+    }
+    if (completeBefore) {
+        // 本地文件与服务端资源不一致，从头下载
+        std::remove(job.options.filePath.c_str());
+        job.etag.clear();
+        job.lastModified.clear();
+        job.state = DownloadState::QUEUED;
+        return;
+    }
+    if (!writeFailed && IsRetriable(result) && job.retries < kMaxRetries) {
+        // 网络中断，自动续传；本次收到过数据时不计入重试次数
+        job.retries = received > 0 ? 0 : job.retries + 1;
+        job.state = DownloadState::QUEUED;
+        return;
+    }
+    job.state = DownloadState::FAILED;
+    if (writeFailed) {
+        job.error = "Failed to write file: " + job.options.filePath;
+    } else if (result == CURLE_HTTP_RETURNED_ERROR) {
+        job.error = "HTTP " + std::to_string(code);
+    } else {
+        job.error = curl_easy_strerror(result);
+    }
+}
+
+void DownloadManager::DetachJob(Job &job) {
+    // 需持有互斥锁
+    if (job.curl) {
+        curl_multi_remove_handle(multi, job.curl);
+        curl_easy_cleanup(job.curl);
+        job.curl = nullptr;
+    }
+    curl_slist_free_all(job.headerList);
+    job.headerList = nullptr;
+    if (job.fd >= 0) {
+        // 写入剩余数据，长时间暂停后按文件大小续传
+        job.batcher.Close();
+        close(job.fd);
+        job.fd = -1;
+    }
+}
+
+void DownloadManager::ReleaseHeldPauses() {
+    // 需持有互斥锁
+    Clock::time_point now = Clock::now();
+    for (const auto &item : jobs) {
+        Job &job = *item.second;
+        if (job.state == DownloadState::PAUSED && job.curl &&
+            now - job.pausedAt >= std::chrono::seconds(kPauseHoldSeconds)) {
+            // 长时间暂停，释放连接与并发名额，恢复时续传
+            DetachJob(job);
+            journalDirty = true;
+        }
+    }
+}
+
+std::vector<DownloadInfo> DownloadManager::CollectChanges() {
+    // 需持有互斥锁
+    std::vector<DownloadInfo> batch;
+    for (const auto &item : jobs) {
+        Job &job = *item.second;
+        bool progressed = job.progressed.exchange(false);
+        if (job.changed || progressed) {
+            job.changed = false;
+            batch.push_back(Info(job));
+        }
+    }
+    return batch;
+}
+
+size_t DownloadManager::WriteBody(char *data, size_t size, size_t nmemb, void *userp) {
+    Job *job = static_cast<Job *>(userp);
+    size_t len = size * nmemb;
+    if (!job->responseChecked) {
+        job->responseChecked = true;
+        long code = 0;
+        curl_easy_getinfo(job->curl, CURLINFO_RESPONSE_CODE, &code);
+        if (job->offset > 0 && code != 206) {
+            // 资源已变化（If-Range不匹配）或服务端不支持Range，从头写入
+            job->batcher.Rewind(0);
+            if (ftruncate(job->fd, 0) != 0) {
+                job->writeFailed = true;
+                return 0;
+            }
+            job->offset = 0;
+            job->downloaded = 0;
+        }
+        curl_off_t length = -1;
+        curl_easy_getinfo(job->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+        job->total = length >= 0 ? job->offset + length : -1;
+    }
+    if (!job->batcher.Write(data, len)) {
+        job->writeFailed = true;
+        return 0;
+    }
+    job->downloaded += static_cast<int64_t>(len);
+    job->progressed = true;
+    return len;
+}
+
+size_t DownloadManager::ReadHeader(char *data, size_t size, size_t nmemb, void *userp) {
+    Job *job = static_cast<Job *>(userp);
+    size_t len = size * nmemb;
+    std::string value;
+    if (len > 5 && strncmp(data, "HTTP/", 5) == 0) {
+        // 新的响应（含重定向），以最终响应的校验信息为准
+        job->etag.clear();
+        job->lastModified.clear();
+    } else if (HeaderValue(data, len, "ETag:", value)) {
+        // 弱校验ETag不能用于If-Range
+        if (value.compare(0, 2, "W/") != 0) {
+            job->etag = value;
+        }
+    } else if (HeaderValue(data, len, "Last-Modified:", value)) {
+        job->lastModified = value;
+    }
+    return len;
+}
+
+void DownloadManager::LoadJournal(const std::string &path) {
+    // 需持有互斥锁
+    std::ifstream file(path);
+    std::string line;
+    std::unique_ptr<Job> job;
+    while (std::getline(file, line)) {
+        size_t space = line.find(' ');
+        std::string key = line.substr(0, space);
+        std::string value = space == std::string::npos ? "" : JournalUnescape(line.substr(space + 1));
+        if (key == "job") {
+            job.reset(new Job());
+            job->id = value;
+        } else if (!job) {
+            continue;
+        } else if (key == "url") {
+            job->options.url = value;
+        } else if (key == "path") {
+            job->options.filePath = value;
+        } else if (key == "header") {
+            job->options.headers.push_back(value);
+        } else if (key == "priority") {
+            job->options.priority = atoi(value.c_str());
+        } else if (key == "ca") {
+            job->options.caPath = value;
+        } else if (key == "cert") {
+            job->options.clientCertPath = value;
+        } else if (key == "tlcp") {
+            job->options.isTLCP = value == "1";
+        } else if (key == "verify") {
+            job->options.verifyServer = value == "1";
+        } else if (key == "timeout") {
+            job->options.connectTimeout = atoi(value.c_str());
+        } else if (key == "state") {
+            ParseState(value, job->state);
+        } else if (key == "total") {
+            job->total = atoll(value.c_str());
+        } else if (key == "etag") {
+            job->etag = value;
+        } else if (key == "modified") {
+            job->lastModified = value;
+        } else if (key == "error") {
+            job->error = value;
+        } else if (key == "end") {
+            if (!job->id.empty() && !job->options.url.empty() && !jobs.count(job->id)) {
+                // 上次进程退出时未完成的任务重新排队，已下载量以文件实际大小为准
+                if (job->state == DownloadState::RUNNING) {
+                    job->state = DownloadState::QUEUED;
+                }
+                job->downloaded = FileSize(job->options.filePath);
+                job->host = ConnectionPool::KeyOf(job->options.url);
+                job->sequence = nextSequence++;
+                job->changed = true;
+                jobs[job->id] = std::move(job);
+            }
+            job.reset();
+        }
+    }
+}
+
+std::string DownloadManager::SerializeJournal() {
+    // 需持有互斥锁
+    std::ostringstream out;
+    std::vector<const Job *> ordered;
+    for (const auto &item : jobs) {
+        ordered.push_back(item.second.get());
+    }
+    std::sort(ordered.begin(), ordered.end(), [](const Job *a, const Job *b) { return a->sequence < b->sequence; });
+    for (const Job *job : ordered) {
+        const DownloadOptions &options = job->options;
+        out << "job " << JournalEscape(job->id) << "\n";
+        out << "url " << JournalEscape(options.url) << "\n";
+        out << "path " << JournalEscape(options.filePath) << "\n";
+        for (const std::string &header : options.headers) {
+            out << "header " << JournalEscape(header) << "\n";
+        }
+        out << "priority " << options.priority << "\n";
+        out << "ca " << JournalEscape(options.caPath) << "\n";
+        out << "cert " << JournalEscape(options.clientCertPath) << "\n";
+        out << "tlcp " << (options.isTLCP ? 1 : 0) << "\n";
+        out << "verify " << (options.verifyServer ? 1 : 0) << "\n";
+        out << "timeout " << options.connectTimeout << "\n";
+        out << "state " << DownloadStateName(job->state) << "\n";
+        out << "total " << job->total.load() << "\n";
+        out << "etag " << JournalEscape(job->etag) << "\n";
+        out << "modified " << JournalEscape(job->lastModified) << "\n";
+        out << "error " << JournalEscape(job->error) << "\n";
+        out << "end\n";
+    }
+    return out.str();
+}
+
+void DownloadManager::WriteJournal(const std::string &journalDirectory, const std::string &content) {
+    WriteJournalFile(journalDirectory, kJournalFileName, content);
+}
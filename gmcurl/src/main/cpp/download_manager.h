@@ -0,0 +1,233 @@
+#ifndef GMCURL_DOWNLOAD_MANAGER_H
+#define GMCURL_DOWNLOAD_MANAGER_H
+
+#include "curl.h"
+#include "file_io.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @file download_manager.h
+ * @brief 进程级持久化下载管理器
+ *
+ * 下载任务由专用线程通过curl multi接口驱动：
+ * - 任务列表保存在缓存目录下的downloads.journal中，状态变化时立即写入，进度定期写入；
+ *   文件包含任务的请求头（可能含Authorization、Cookie、签名），仅应用自身可读写（0600）
+ * - 按优先级（高优先级先启动，同优先级先进先出）调度，受总并发数与单主机并发数限制
+ * - 暂停通过curl_easy_pause实现，暂停期间保留连接，超过保持时间后释放连接，恢复时按Range续传
+ * - 进程重启后自动恢复未完成的任务；续传请求携带If-Range（ETag或Last-Modified），
+ *   服务端返回200（资源已变化）时从头下载，没有校验信息的任务也从头下载
+ * - 进度按周期汇总，所有发生变化的任务在一次回调中通知
+ */
+
+/**
+ * @brief 下载任务状态
+ */
+enum class DownloadState {
+    QUEUED,    ///< 排队中
+    RUNNING,   ///< 下载中
+    PAUSED,    ///< 已暂停
+    COMPLETED, ///< 已完成
+    FAILED     ///< 失败（可通过恢复重试）
+};
+
+/**
+ * @brief 下载状态名称
+ */
+const char *DownloadStateName(DownloadState state);
+
+/**
+ * @brief 下载任务配置
+ */
+typedef struct DownloadOptions {
+    std::string url;                  ///< 下载URL
+    std::string filePath;             ///< 保存路径
+    std::vector<std::string> headers; ///< 请求头（"Name: value"，明文保存在任务日志中）
+    int priority = 0;                 ///< 优先级
+    std::string caPath;               ///< CA证书路径
+    std::string clientCertPath;       ///< 客户端证书目录
+    bool isTLCP = false;              ///< 是否使用TLCP
+    bool verifyServer = true;         ///< 是否校验服务端证书
+    int connectTimeout = 15;          ///< 连接超时（秒）
+} DownloadOptions;
+
+/**
+ * @brief 下载任务信息
+ */
+typedef struct DownloadInfo {
+    std::string id;                            ///< 任务ID
+    std::string url;                           ///< 下载URL
+    std::string filePath;                      ///< 保存路径
+    int priority = 0;                          ///< 优先级
+    DownloadState state = DownloadState::QUEUED; ///< 状态
+    int64_t downloaded = 0;                    ///< 已下载字节数
+    int64_t total = -1;                        ///< 总字节数，未知时为-1
+    std::string error;                         ///< 失败原因
+} DownloadInfo;
+
+/**
+ * @brief 句柄配置回调（传输层配置与共享缓存）
+ */
+typedef std::function<void(CURL *, const DownloadOptions &)> DownloadConfigurator;
+
+/**
+ * @brief 汇总进度回调（在下载线程中调用）
+ */
+typedef std::function<void(const std::vector<DownloadInfo> &)> DownloadListener;
+
+/**
+ * @brief 进程级持久化下载管理器
+ */
+class DownloadManager {
+public:
+    /**
+     * @brief 获取进程级实例（首次调用时创建，进程退出前不释放）
+     */
+    static DownloadManager &Instance();
+
+    DownloadManager(const DownloadManager &) = delete;
+    DownloadManager &operator=(const DownloadManager &) = delete;
+
+    /**
+     * @brief 加载任务日志并启动下载线程，未完成的任务自动恢复
+     * @param directory 任务日志目录（再次调用时合并新目录中的任务并改为写入新目录）
+     * @param configurator 句柄配置回调
+     */
+    void Start(const std::string &directory, DownloadConfigurator configurator);
+
+    /**
+     * @brief 添加下载任务
+     * @param options 任务配置
+     * @param id 任务ID，为空时自动生成；已存在的ID直接返回
+     * @return 任务ID
+     */
+    std::string Add(const DownloadOptions &options, const std::string &id);
+
+    /**
+     * @brief 暂停任务
+     * @return 任务是否存在
+     */
+    bool Pause(const std::string &id);
+
+    /**
+     * @brief 恢复暂停或失败的任务
+     * @return 任务是否存在
+     */
+    bool Resume(const std::string &id);
+
+    /**
+     * @brief 删除任务，未完成任务的临时文件一并删除
+     * @return 任务是否存在
+     */
+    bool Remove(const std::string &id);
+
+    /**
+     * @brief 全部任务信息
+     */
+    std::vector<DownloadInfo> List();
+
+    /**
+     * @brief 设置并发限制
+     * @param maxConcurrent 最大同时下载数（不大于0时保持不变）
+     * @param maxPerHost 单个主机最大同时下载数（不大于0时保持不变）
+     */
+    void Configure(int maxConcurrent, int maxPerHost);
+
+    /**
+     * @brief 注册汇总进度回调
+     * @return 回调标识
+     */
+    int AddListener(DownloadListener listener);
+
+    /**
+     * @brief 注销汇总进度回调，返回后不会再被调用
+     */
+    void RemoveListener(int token);
+
+private:
+    DownloadManager() = default;
+
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * @brief 下载任务
+     */
+    typedef struct Job {
+        std::string id;                             ///< 任务ID
+        DownloadOptions options;                    ///< 任务配置
+        std::string host;                           ///< 协议://主机:端口
+        int64_t sequence = 0;                       ///< 添加顺序
+        DownloadState state = DownloadState::QUEUED; ///< 状态
+        std::string error;                          ///< 失败原因
+        std::atomic<int64_t> downloaded{0};         ///< 已下载字节数
+        std::atomic<int64_t> total{-1};             ///< 总字节数
+        std::atomic<bool> progressed{false};        ///< 上次通知后进度是否变化
+        bool changed = false;                       ///< 上次通知后状态是否变化
+        std::string etag;                           ///< 资源ETag
+        std::string lastModified;                   ///< 资源Last-Modified
+        // 以下仅在下载线程中访问
+        CURL *curl = nullptr;                       ///< 进行中的传输
+        curl_slist *headerList = nullptr;           ///< 请求头
+        int fd = -1;                                ///< 文件描述符
+        WriteBatcher batcher;                       ///< 文件批量写入
+        int64_t offset = 0;                         ///< 本次传输的续传起始位置
+        bool responseChecked = false;               ///< 是否已检查响应状态
+        bool writeFailed = false;                   ///< 写文件失败
+        int retries = 0;                            ///< 连续未收到数据的自动续传次数
+        Clock::time_point pausedAt;                 ///< 暂停时间
+    } Job;
+
+    /**
+     * @brief 待下载线程执行的命令
+     */
+    typedef struct Command {
+        enum Type { PAUSE, RESUME, REMOVE } type; ///< 命令类型
+        std::string id;                          ///< 任务ID
+    } Command;
+
+    void Loop();
+    bool HasQueued();
+    void ApplyCommands();
+    void Schedule();
+    void StartJob(Job &job);
+    void FinishJob(Job &job, CURLcode result);
+    void DetachJob(Job &job);
+    void ReleaseHeldPauses();
+    std::vector<DownloadInfo> CollectChanges();
+    void LoadJournal(const std::string &path);
+    std::string SerializeJournal();
+    bool Post(Command::Type type, const std::string &id);
+
+    static DownloadInfo Info(const Job &job);
+    static void WriteJournal(const std::string &journalDirectory, const std::string &content);
+    static size_t WriteBody(char *data, size_t size, size_t nmemb, void *userp);
+    static size_t ReadHeader(char *data, size_t size, size_t nmemb, void *userp);
+
+    std::mutex mutex;                                 ///< 互斥锁（任务列表、命令、配置）
+    std::condition_variable wakeup;                   ///< 空闲时唤醒下载线程
+    std::map<std::string, std::unique_ptr<Job>> jobs; ///< 任务ID -> 任务
+    std::vector<Command> commands;                    ///< 待执行的命令
+    std::string directory;                            ///< 任务日志目录
+    DownloadConfigurator configurator;                ///< 句柄配置回调
+    CURLM *multi = nullptr;                           ///< multi句柄
+    bool started = false;                             ///< 下载线程是否已启动
+    int maxConcurrent = 4;                            ///< 最大同时下载数
+    int maxPerHost = 2;                               ///< 单个主机最大同时下载数
+    int64_t nextSequence = 0;                         ///< 下一个添加顺序
+    bool journalDirty = false;                        ///< 任务状态变化待写入
+    Clock::time_point lastNotify;                     ///< 上次汇总通知时间
+    Clock::time_point lastSave;                       ///< 上次写入任务日志时间
+
+    std::mutex listenerMutex;                 ///< 回调互斥锁
+    std::map<int, DownloadListener> listeners; ///< 汇总进度回调
+    int nextListener = 1;                     ///< 下一个回调标识
+};
+
+#endif // GMCURL_DOWNLOAD_MANAGER_H
@@ -0,0 +1,461 @@
+#include "fault_injection.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <strings.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+/**
+ * @file fault_injection.cpp
+ * @brief 网络故障注入代理实现
+ */
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief 每次转发读取的最大字节数，也是停顿概率的计算单位
+ */
+const size_t kRelayChunk = 16384;
+
+/**
+ * @brief 不限速时每个方向最多排队等待发送的字节数
+ * 限速时最多排队约1秒的数据；超过后读取线程停止读取，由TCP窗口向发送方施加背压
+ */
+const int64_t kMaxQueuedBytes = 1048576;
+
+/**
+ * @brief CONNECT请求头的最大长度
+ */
+const size_t kMaxConnectHead = 8192;
+
+bool SendAll(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * @brief 稳定的字符串哈希（FNV-1a），使故障序列不依赖标准库实现
+ */
+uint32_t HashOf(const std::string &value) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char ch : value) {
+        hash = (hash ^ ch) * 16777619u;
+    }
+    return hash;
+}
+
+bool MatchHost(const std::string &pattern, const std::string &host) {
+    if (pattern.empty() || pattern == "*") {
+        return true;
+    }
+    if (pattern.compare(0, 2, "*.") == 0) {
+        size_t suffix = pattern.size() - 1;
+        return host.size() > suffix && strcasecmp(host.c_str() + host.size() - suffix, pattern.c_str() + 1) == 0;
+    }
+    return strcasecmp(pattern.c_str(), host.c_str()) == 0;
+}
+
+int ConnectTo(const std::string &host, const std::string &port) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *list = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &list) != 0) {
+        return -1;
+    }
+    int fd = -1;
+    for (addrinfo *address = list; address; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(list);
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+/**
+ * @brief 一条隧道的两个套接字，最后一个转发线程结束时关闭
+ */
+typedef struct Tunnel {
+    int client = -1;                           ///< 客户端套接字
+    int server = -1;                           ///< 目标主机套接字
+    std::function<void(int)> forget;           ///< 从代理的活动套接字中移除
+    std::function<void(int64_t, bool)> report; ///< 累加停顿次数与重置
+
+    ~Tunnel() {
+        for (int fd : {client, server}) {
+            if (fd >= 0) {
+                forget(fd);
+                close(fd);
+            }
+        }
+    }
+} Tunnel;
+
+/**
+ * @brief 隧道的一个方向：读取线程按故障规则计算每个数据块的发送时间，发送线程按时间与带宽写出
+ */
+typedef struct Link {
+    std::shared_ptr<Tunnel> tunnel;                                ///< 所属隧道
+    int from = -1;                                                 ///< 读取的套接字
+    int to = -1;                                                   ///< 写入的套接字
+    bool downstream = false;                                       ///< 是否为目标主机到客户端的方向
+    FaultRule rule;                                                ///< 故障规则
+    std::mt19937 random;                                           ///< 本方向的随机数
+    int64_t resetAt = -1;                                          ///< 写出多少字节后重置连接，-1表示不重置
+    std::mutex mutex;                                              ///< 互斥锁
+    std::condition_variable ready;                                 ///< 有数据块或读取结束
+    std::condition_variable space;                                 ///< 排队数据低于上限或发送结束
+    std::deque<std::pair<Clock::time_point, std::string>> packets; ///< 等待发送的数据块及其发送时间
+    int64_t queued = 0;                                            ///< 等待发送的字节数
+    bool closed = false;                                           ///< 读取是否已结束
+    bool stopped = false;                                          ///< 发送是否已结束
+} Link;
+
+/**
+ * @brief 重置连接：客户端套接字关闭时发送RST而不是FIN
+ */
+void Reset(Tunnel &tunnel) {
+    linger option = {1, 0};
+    setsockopt(tunnel.client, SOL_SOCKET, SO_LINGER, &option, sizeof(option));
+    shutdown(tunnel.client, SHUT_RD);
+    shutdown(tunnel.server, SHUT_RDWR);
+}
+
+void Receive(std::shared_ptr<Link> link) {
+    const FaultRule &rule = link->rule;
+    std::uniform_int_distribution<int64_t> jitter(0, std::max<int64_t>(rule.jitter, 0));
+    // 停顿按数据量而不是读取次数抽样，使故障序列不受分段方式影响
+    double stallRate = std::min(rule.stallRate, 1.0);
+    std::geometric_distribution<int64_t> stallGap(stallRate > 0 ? stallRate : 1.0);
+    int64_t nextStall = stallRate > 0 ? stallGap(link->random) * kRelayChunk : -1;
+    int64_t received = 0;
+    int64_t limit = rule.bandwidth > 0 ? std::max<int64_t>(rule.bandwidth, kRelayChunk) : kMaxQueuedBytes;
+    Clock::time_point last = Clock::now();
+    char buffer[kRelayChunk];
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(link->mutex);
+            link->space.wait(lock, [&link, limit] { return link->queued < limit || link->stopped; });
+            if (link->stopped) {
+                break;
+            }
+        }
+        ssize_t n = recv(link->from, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            break;
+        }
+        int64_t delay = rule.latency + jitter(link->random);
+        if (link->downstream && received == 0) {
+            delay += rule.handshakeDelay;
+        }
+        received += n;
+        int64_t stalls = 0;
+        while (nextStall >= 0 && nextStall < received) {
+            stalls++;
+            nextStall += (stallGap(link->random) + 1) * static_cast<int64_t>(kRelayChunk);
+        }
+        if (stalls > 0) {
+            delay += rule.stallDuration * stalls;
+            link->tunnel->report(stalls, false);
+        }
+        // 抖动不改变数据顺序
+        last = std::max(last, Clock::now() + std::chrono::milliseconds(delay));
+        std::lock_guard<std::mutex> lock(link->mutex);
+        link->packets.emplace_back(last, std::string(buffer, static_cast<size_t>(n)));
+        link->queued += n;
+        link->ready.notify_one();
+    }
+    std::lock_guard<std::mutex> lock(link->mutex);
+    link->closed = true;
+    link->ready.notify_one();
+}
+
+/**
+ * @brief 登记发送结束，唤醒等待排队空间的读取线程
+ */
+void StopLink(Link &link) {
+    std::lock_guard<std::mutex> lock(link.mutex);
+    link.stopped = true;
+    link.space.notify_one();
+}
+
+void Transmit(std::shared_ptr<Link> link) {
+    const FaultRule &rule = link->rule;
+    // 限速时每次最多写出约20毫秒的数据
+    size_t slice = rule.bandwidth > 0 ? static_cast<size_t>(std::max<int64_t>(rule.bandwidth / 50, 1024)) : 0;
+    Clock::time_point idle = Clock::now();
+    int64_t written = 0;
+    std::unique_lock<std::mutex> lock(link->mutex);
+    while (true) {
+        link->ready.wait(lock, [&link] { return !link->packets.empty() || link->closed; });
+        if (link->packets.empty()) {
+            break;
+        }
+        std::pair<Clock::time_point, std::string> packet = std::move(link->packets.front());
+        link->packets.pop_front();
+        link->queued -= static_cast<int64_t>(packet.second.size());
+        link->space.notify_one();
+        lock.unlock();
+        std::this_thread::sleep_until(packet.first);
+        const std::string &data = packet.second;
+        size_t offset = 0;
+        while (offset < data.size()) {
+            size_t length = data.size() - offset;
+            if (slice > 0) {
+                length = std::min(length, slice);
+            }
+            bool reset = link->resetAt >= 0 && written + static_cast<int64_t>(length) >= link->resetAt;
+            if (reset) {
+                length = static_cast<size_t>(link->resetAt - written);
+            }
+            if (length > 0 && !SendAll(link->to, data.data() + offset, length)) {
+                shutdown(link->tunnel->client, SHUT_RDWR);
+                shutdown(link->tunnel->server, SHUT_RDWR);
+                StopLink(*link);
+                return;
+            }
+            if (reset) {
+                Reset(*link->tunnel);
+                link->tunnel->report(0, true);
+                StopLink(*link);
+                return;
+            }
+            written += static_cast<int64_t>(length);
+            offset += length;
+            if (slice > 0) {
+                idle = std::max(idle, Clock::now()) +
+                       std::chrono::microseconds(static_cast<int64_t>(length) * 1000000 / rule.bandwidth);
+                std::this_thread::sleep_until(idle);
+            }
+        }
+        lock.lock();
+    }
+    shutdown(link->to, SHUT_WR);
+}
+
+} // namespace
+
+FaultInjector &FaultInjector::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static FaultInjector *injector = new FaultInjector();
+    return *injector;
+}
+
+int FaultInjector::Start(const FaultConfig &config) {
+    Stop();
+    auto newSession = std::make_shared<Session>();
+    newSession->config = config;
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return 0;
+    }
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, 128) != 0 ||
+        getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length) != 0) {
+        close(fd);
+        return 0;
+    }
+    newSession->listenFd = fd;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        session = newSession;
+        port = ntohs(address.sin_port);
+    }
+    std::thread(Accept, newSession).detach();
+    return ntohs(address.sin_port);
+}
+
+void FaultInjector::Stop() {
+    std::shared_ptr<Session> current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current.swap(session);
+        port = 0;
+    }
+    if (!current) {
+        return;
+    }
+    current->stopping = true;
+    // 唤醒阻塞在accept/recv中的线程，套接字由各线程自行关闭
+    shutdown(current->listenFd, SHUT_RDWR);
+    std::lock_guard<std::mutex> lock(current->mutex);
+    for (int fd : current->sockets) {
+        shutdown(fd, SHUT_RDWR);
+    }
+}
+
+FaultStats FaultInjector::Stats() {
+    std::shared_ptr<Session> current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = session;
+    }
+    if (!current) {
+        return FaultStats();
+    }
+    std::lock_guard<std::mutex> lock(current->mutex);
+    return current->stats;
+}
+
+void FaultInjector::Accept(std::shared_ptr<Session> session) {
+    while (!session->stopping) {
+        int fd = accept4(session->listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            if (session->stopping) {
+                close(fd);
+                break;
+            }
+            session->sockets.insert(fd);
+        }
+        std::thread(Serve, session, fd).detach();
+    }
+    close(session->listenFd);
+}
+
+void FaultInjector::Serve(std::shared_ptr<Session> session, int fd) {
+    auto tunnel = std::make_shared<Tunnel>();
+    tunnel->client = fd;
+    tunnel->forget = [session](int socket) {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->sockets.erase(socket);
+    };
+    tunnel->report = [session](int64_t stalls, bool reset) {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->stats.stalls += stalls;
+        session->stats.resets += reset ? 1 : 0;
+    };
+
+    // 读取CONNECT请求，客户端在收到响应前不会发送隧道数据
+    std::string head;
+    char buffer[2048];
+    while (head.find("\r\n\r\n") == std::string::npos) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0 || head.size() > kMaxConnectHead) {
+            return;
+        }
+        head.append(buffer, static_cast<size_t>(n));
+    }
+    std::string requestLine = head.substr(0, head.find("\r\n"));
+    size_t first = requestLine.find(' ');
+    size_t second = requestLine.find(' ', first == std::string::npos ? first : first + 1);
+    std::string target = first == std::string::npos || second == std::string::npos
+                             ? std::string()
+                             : requestLine.substr(first + 1, second - first - 1);
+    size_t colon = target.rfind(':');
+    if (requestLine.compare(0, first, "CONNECT") != 0 || colon == std::string::npos) {
+        const char *response = "HTTP/1.1 405 Method Not Allowed\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        SendAll(fd, response, strlen(response));
+        return;
+    }
+    std::string host = target.substr(0, colon);
+    std::string port = target.substr(colon + 1);
+    if (host.size() > 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+
+    // 匹配规则并按种子、主机与连接序号生成本连接的随机数
+    const FaultConfig &config = session->config;
+    auto matched = std::find_if(config.rules.begin(), config.rules.end(),
+                                [&host](const FaultRule &rule) { return MatchHost(rule.host, host); });
+    FaultRule rule = matched != config.rules.end() ? *matched : FaultRule();
+    uint32_t serial;
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        serial = session->serial[host]++;
+        session->stats.connections++;
+    }
+    std::seed_seq seed{config.seed, HashOf(host), serial};
+    std::mt19937 random(seed);
+    int64_t resetAt = -1;
+    if (rule.resetRate > 0 && std::uniform_real_distribution<double>(0, 1)(random) < rule.resetRate) {
+        resetAt = std::uniform_int_distribution<int64_t>(0, std::max<int64_t>(rule.resetWithinBytes, 0))(random);
+    }
+
+    // 建立隧道时等待一个往返
+    if (rule.latency > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(rule.latency * 2));
+    }
+    int server = ConnectTo(host, port);
+    bool stopped;
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        stopped = session->stopping;
+        if (server < 0) {
+            session->stats.failures++;
+        } else {
+            session->sockets.insert(server);
+        }
+    }
+    tunnel->server = server;
+    if (server < 0 || stopped) {
+        const char *response = "HTTP/1.1 502 Bad Gateway\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        SendAll(fd, response, strlen(response));
+        return;
+    }
+    const char *established = "HTTP/1.1 200 Connection established\r\n\r\n";
+    if (!SendAll(fd, established, strlen(established))) {
+        return;
+    }
+
+    auto upstream = std::make_shared<Link>();
+    upstream->tunnel = tunnel;
+    upstream->from = fd;
+    upstream->to = server;
+    upstream->rule = rule;
+    upstream->random.seed(random());
+    auto downstream = std::make_shared<Link>();
+    downstream->tunnel = tunnel;
+    downstream->from = server;
+    downstream->to = fd;
+    downstream->downstream = true;
+    downstream->rule = rule;
+    downstream->random.seed(random());
+    downstream->resetAt = resetAt;
+    tunnel.reset();
+    std::thread(Receive, upstream).detach();
+    std::thread(Transmit, upstream).detach();
+    std::thread(Receive, downstream).detach();
+    Transmit(downstream);
+}
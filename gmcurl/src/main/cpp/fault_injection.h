@@ -0,0 +1,116 @@
+#ifndef GMCURL_FAULT_INJECTION_H
+#define GMCURL_FAULT_INJECTION_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @file fault_injection.h
+ * @brief 网络故障注入（测试用）
+ *
+ * 启用后所有请求经127.0.0.1上的本地隧道代理（HTTP CONNECT）转发，代理按目标主机匹配规则，在转发的数据上注入
+ * 延迟、抖动、带宽限制、类似丢包重传的停顿、连接重置与慢握手，用于离线、可重现地测量重试、对冲、超时与连接池
+ * 在尾部延迟下的表现。代理每个方向最多缓存约1秒带宽的待发送数据（不限速时1MB），超过后停止读取，
+ * 由TCP流控向发送方施加背压，与真实瓶颈链路的表现一致。
+ *
+ * 随机数按种子、目标主机与该主机的连接序号生成，相同的种子与请求顺序得到相同的故障序列。
+ */
+
+/**
+ * @brief 故障规则
+ */
+typedef struct FaultRule {
+    std::string host;                 ///< 目标主机，"*.example.com"匹配子域名，为空或"*"匹配所有主机
+    int64_t latency = 0;              ///< 单向延迟（毫秒），建立隧道时等待一个往返
+    int64_t jitter = 0;               ///< 每个数据块附加的随机延迟上限（毫秒），不改变数据顺序
+    int64_t bandwidth = 0;            ///< 每个方向的带宽（字节/秒），0表示不限速
+    double stallRate = 0;             ///< 每16KB数据发生停顿的概率（0~1），模拟丢包后的重传等待
+    int64_t stallDuration = 1000;     ///< 停顿时长（毫秒）
+    double resetRate = 0;             ///< 每个连接被重置的概率（0~1）
+    int64_t resetWithinBytes = 65536; ///< 重置发生在客户端收到的前多少字节内（随机位置）
+    int64_t handshakeDelay = 0;       ///< 服务端首个数据块（TLS为ServerHello）的附加延迟（毫秒），模拟慢握手
+} FaultRule;
+
+/**
+ * @brief 故障注入配置
+ */
+typedef struct FaultConfig {
+    std::vector<FaultRule> rules; ///< 规则，按顺序匹配第一条，没有匹配的规则时直接转发
+    uint32_t seed = 1;            ///< 随机数种子
+} FaultConfig;
+
+/**
+ * @brief 故障注入统计
+ */
+typedef struct FaultStats {
+    int64_t connections = 0; ///< 代理的连接数
+    int64_t stalls = 0;      ///< 注入的停顿次数
+    int64_t resets = 0;      ///< 重置的连接数
+    int64_t failures = 0;    ///< 目标主机无法连接的次数（返回502）
+} FaultStats;
+
+/**
+ * @brief 进程级故障注入代理
+ */
+class FaultInjector {
+public:
+    /**
+     * @brief 获取进程级实例
+     */
+    static FaultInjector &Instance();
+
+    FaultInjector(const FaultInjector &) = delete;
+    FaultInjector &operator=(const FaultInjector &) = delete;
+
+    /**
+     * @brief 按配置启动代理（正在运行时先停止，统计与连接序号重新开始）
+     * @return 代理端口，监听失败时返回0
+     */
+    int Start(const FaultConfig &config);
+
+    /**
+     * @brief 停止代理并断开所有连接
+     */
+    void Stop();
+
+    /**
+     * @brief 代理端口，未启动时为0（无锁，供配置请求句柄时快速判断）
+     */
+    int Port() const { return port.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 当前代理的统计信息
+     */
+    FaultStats Stats();
+
+private:
+    FaultInjector() = default;
+
+    /**
+     * @brief 一次启动的代理状态（由监听线程与转发线程共享）
+     */
+    typedef struct Session {
+        FaultConfig config;                     ///< 配置
+        int listenFd = -1;                      ///< 监听套接字
+        std::set<int> sockets;                  ///< 活动套接字（客户端与目标主机）
+        std::map<std::string, uint32_t> serial; ///< 目标主机 -> 已建立的连接数
+        std::atomic<bool> stopping{false};      ///< 是否已停止
+        std::mutex mutex;                       ///< 互斥锁（套接字、连接序号、统计）
+        FaultStats stats;                       ///< 统计
+    } Session;
+
+    static void Accept(std::shared_ptr<Session> session);
+    static void Serve(std::shared_ptr<Session> session, int fd);
+
+    std::mutex mutex;                 ///< 互斥锁
+    std::shared_ptr<Session> session; ///< 当前代理，未启动时为空
+    std::atomic<int> port{0};         ///< 代理端口
+};
+
+#endif // GMCURL_FAULT_INJECTION_H
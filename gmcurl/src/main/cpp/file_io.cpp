@@ -0,0 +1,650 @@
+#include "file_io.h"
+#include "hilog/log.h"
+#include "request_pool.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define GMCURL_HAS_IO_URING 1
+#endif
+#endif
+#endif
+
+/**
+ * @file file_io.cpp
+ * @brief 下载/上传文件的异步I/O后端实现
+ */
+
+namespace {
+
+/**
+ * @brief 线程池后端的工作线程数
+ */
+const int kPoolThreads = 2;
+
+/**
+ * @brief io_uring提交队列深度
+ */
+const unsigned kRingEntries = 64;
+
+/**
+ * @brief io_uring注册块数量（需要RLIMIT_MEMLOCK允许锁定8MB）
+ */
+const int kRegisteredBlocks = 8;
+
+static_assert(FileIoEngine::kBlockSize == BufferPool::kBufferSize, "file I/O blocks come from BufferPool");
+
+} // namespace
+
+/**
+ * @brief 后端接口
+ */
+class FileIoEngine::Impl {
+public:
+    virtual ~Impl() = default;
+
+    /**
+     * @brief 提交操作剩余的部分
+     * @return 是否已提交（提交队列已满或提交失败时返回false，由调用方改用线程池）
+     */
+    virtual bool Submit(FileIoOp *op) = 0;
+
+    /**
+     * @brief 获取注册块，没有可用注册块时返回nullptr
+     */
+    virtual char *AcquireRegistered(int &index) { return nullptr; }
+
+    /**
+     * @brief 归还注册块
+     */
+    virtual void ReleaseRegistered(int index) {}
+};
+
+namespace {
+
+/**
+ * @brief 线程池pwrite/pread后端
+ */
+class ThreadPoolImpl : public FileIoEngine::Impl {
+public:
+    explicit ThreadPoolImpl(FileIoEngine *engine) : engine(engine) {
+        for (int i = 0; i < kPoolThreads; i++) {
+            std::thread([this] { Run(); }).detach();
+        }
+    }
+
+    bool Submit(FileIoOp *op) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(op);
+        }
+        ready.notify_one();
+        return true;
+    }
+
+private:
+    void Run() {
+        while (true) {
+            FileIoOp *op;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return !queue.empty(); });
+                op = queue.front();
+                queue.pop_front();
+            }
+            char *data = op->buffer + op->done;
+            size_t length = op->length - op->done;
+            off_t offset = static_cast<off_t>(op->offset + static_cast<int64_t>(op->done));
+            ssize_t result = op->write ? pwrite(op->fd, data, length, offset) : pread(op->fd, data, length, offset);
+            engine->Finished(op, result < 0 ? -errno : result);
+        }
+    }
+
+    FileIoEngine *engine;          ///< 所属引擎
+    std::mutex mutex;              ///< 互斥锁
+    std::condition_variable ready; ///< 有待执行的操作
+    std::deque<FileIoOp *> queue;  ///< 待执行的操作
+};
+
+#ifdef GMCURL_HAS_IO_URING
+/**
+ * @brief io_uring后端（直接使用系统调用，不依赖liburing）
+ */
+class UringImpl : public FileIoEngine::Impl {
+public:
+    explicit UringImpl(FileIoEngine *engine) : engine(engine) {}
+
+    ~UringImpl() override {
+        if (ringFd >= 0) {
+            close(ringFd);
+        }
+    }
+
+    /**
+     * @brief 创建ring并注册数据块
+     * @return io_uring是否可用
+     */
+    bool Init() {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, kRingEntries, &params));
+        if (ringFd < 0) {
+            return false;
+        }
+        size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap) {
+            sqSize = cqSize = std::max(sqSize, cqSize);
+        }
+        char *sq = static_cast<char *>(
+            mmap(nullptr, sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING));
+        if (sq == MAP_FAILED) {
+            return false;
+        }
+        char *cq = sq;
+        if (!singleMmap) {
+            cq = static_cast<char *>(mmap(nullptr, cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                          ringFd, IORING_OFF_CQ_RING));
+            if (cq == MAP_FAILED) {
+                return false;
+            }
+        }
+        void *entries = mmap(nullptr, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (entries == MAP_FAILED) {
+            return false;
+        }
+        sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        sqEntries = params.sq_entries;
+        sqes = static_cast<struct io_uring_sqe *>(entries);
+        cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+        RegisterBlocks();
+        std::thread([this] { Reap(); }).detach();
+        return true;
+    }
+
+    bool Submit(FileIoOp *op) override {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        unsigned tail = *sqTail;
+        if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+            return false;
+        }
+        unsigned index = tail & sqMask;
+        struct io_uring_sqe *sqe = &sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->fd = op->fd;
+        sqe->off = static_cast<uint64_t>(op->offset + static_cast<int64_t>(op->done));
+        sqe->user_data = reinterpret_cast<uint64_t>(op);
+        if (op->bufferIndex >= 0) {
+            sqe->opcode = op->write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+            sqe->addr = reinterpret_cast<uint64_t>(op->buffer + op->done);
+            sqe->len = static_cast<uint32_t>(op->length - op->done);
+            sqe->buf_index = static_cast<uint16_t>(op->bufferIndex);
+        } else {
+            op->iov.iov_base = op->buffer + op->done;
+            op->iov.iov_len = op->length - op->done;
+            sqe->opcode = op->write ? IORING_OP_WRITEV : IORING_OP_READV;
+            sqe->addr = reinterpret_cast<uint64_t>(&op->iov);
+            sqe->len = 1;
+        }
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        while (syscall(__NR_io_uring_enter, ringFd, 1, 0, 0, nullptr, 0) < 0 && errno == EINTR) {
+        }
+        // 内核没有取走提交项（EAGAIN/EBUSY/ENOMEM等）时撤回，不留下等待之后提交的项，否则等待该操作的传输会一直阻塞
+        if (__atomic_load_n(sqHead, __ATOMIC_ACQUIRE) != tail + 1) {
+            __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+            return false;
+        }
+        return true;
+    }
+
+    char *AcquireRegistered(int &index) override {
+        std::lock_guard<std::mutex> lock(blockMutex);
+        if (freeBlocks.empty()) {
+            return nullptr;
+        }
+        index = freeBlocks.back();
+        freeBlocks.pop_back();
+        return blocks[index];
+    }
+
+    void ReleaseRegistered(int index) override {
+        std::lock_guard<std::mutex> lock(blockMutex);
+        freeBlocks.push_back(index);
+    }
+
+private:
+    /**
+     * @brief 注册固定数据块，失败时（如RLIMIT_MEMLOCK不足）只使用未注册块
+     */
+    void RegisterBlocks() {
+        std::vector<struct iovec> iovecs;
+        for (int i = 0; i < kRegisteredBlocks; i++) {
+            void *block = nullptr;
+            if (posix_memalign(&block, WriteBatcher::kAlignment, FileIoEngine::kBlockSize) != 0) {
+                break;
+            }
+            blocks.push_back(static_cast<char *>(block));
+            iovecs.push_back({block, FileIoEngine::kBlockSize});
+        }
+        if (iovecs.empty() || syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_BUFFERS, iovecs.data(),
+                                      static_cast<unsigned>(iovecs.size())) < 0) {
+            for (char *block : blocks) {
+                free(block);
+            }
+            blocks.clear();
+            return;
+        }
+        for (int i = static_cast<int>(blocks.size()) - 1; i >= 0; i--) {
+            freeBlocks.push_back(i);
+        }
+    }
+
+    /**
+     * @brief 完成线程：等待并分发完成事件
+     */
+    void Reap() {
+        while (true) {
+            int result = static_cast<int>(
+                syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (result < 0 && errno != EINTR) {
+                OH_LOG_Print(LOG_APP, LOG_ERROR, 0xFF00, "GMCURL", "io_uring wait failed: %{public}d", errno);
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            unsigned head = *cqHead;
+            unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            std::vector<std::pair<FileIoOp *, ssize_t>> finished;
+            while (head != tail) {
+                struct io_uring_cqe *cqe = &cqes[head & cqMask];
+                finished.emplace_back(reinterpret_cast<FileIoOp *>(cqe->user_data), cqe->res);
+                head++;
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+            // 释放完成队列后再分发，重新提交的部分不会占用完成队列
+            for (const auto &item : finished) {
+                engine->Finished(item.first, item.second);
+            }
+        }
+    }
+
+    FileIoEngine *engine;                ///< 所属引擎
+    int ringFd = -1;                     ///< ring文件描述符
+    std::mutex submitMutex;              ///< 提交互斥锁
+    unsigned *sqHead = nullptr;          ///< 提交队列头
+    unsigned *sqTail = nullptr;          ///< 提交队列尾
+    unsigned sqMask = 0;                 ///< 提交队列掩码
+    unsigned *sqArray = nullptr;         ///< 提交队列下标数组
+    unsigned sqEntries = 0;              ///< 提交队列深度
+    struct io_uring_sqe *sqes = nullptr; ///< 提交项
+    unsigned *cqHead = nullptr;          ///< 完成队列头
+    unsigned *cqTail = nullptr;          ///< 完成队列尾
+    unsigned cqMask = 0;                 ///< 完成队列掩码
+    struct io_uring_cqe *cqes = nullptr; ///< 完成项
+    std::mutex blockMutex;               ///< 注册块互斥锁
+    std::vector<char *> blocks;          ///< 注册块
+    std::vector<int> freeBlocks;         ///< 空闲注册块下标
+};
+#endif
+
+} // namespace
+
+const char *FileIoBackendName(FileIoBackend backend) {
+    return backend == FileIoBackend::IO_URING ? "io_uring" : "threadPool";
+}
+
+FileIoEngine &FileIoEngine::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static FileIoEngine *engine = new FileIoEngine();
+    return *engine;
+}
+
+FileIoEngine::FileIoEngine() {
+#ifdef GMCURL_HAS_IO_URING
+    std::unique_ptr<UringImpl> ring(new UringImpl(this));
+    if (ring->Init()) {
+        uring = std::move(ring);
+    } else {
+        OH_LOG_Print(LOG_APP, LOG_INFO, 0xFF00, "GMCURL", "io_uring unavailable (%{public}d), using thread pool",
+                     errno);
+    }
+#endif
+    // 线程池后端始终可用：io_uring提交队列已满时也由其执行
+    pool.reset(new ThreadPoolImpl(this));
+}
+
+FileIoBackend FileIoEngine::Backend() const {
+    return uring ? FileIoBackend::IO_URING : FileIoBackend::THREAD_POOL;
+}
+
+char *FileIoEngine::AcquireBlock(size_t size, int &index) {
+    index = -1;
+    // 注册块数量有限且为整块大小，只用于整块读写，较小的读写不占用
+    char *block = uring && size >= kBlockSize ? uring->AcquireRegistered(index) : nullptr;
+    return block ? block : BufferPool::Instance().Acquire(size);
+}
+
+void FileIoEngine::ReleaseBlock(char *block, int index, size_t size) {
+    if (index >= 0) {
+        uring->ReleaseRegistered(index);
+    } else {
+        BufferPool::Instance().Release(block, size);
+    }
+}
+
+void FileIoEngine::Submit(FileIoOp *op) {
+    if (!uring || !uring->Submit(op)) {
+        pool->Submit(op);
+    }
+}
+
+void FileIoEngine::Finished(FileIoOp *op, ssize_t result) {
+    if (result == -EINTR || result == -EAGAIN) {
+        Submit(op);
+        return;
+    }
+    if (result < 0) {
+        op->error = static_cast<int>(-result);
+    } else if (result == 0 && op->write) {
+        op->error = EIO;
+    } else if (result > 0) {
+        op->done += static_cast<size_t>(result);
+        if (op->done < op->length) {
+            // 部分完成，继续读写剩余部分（读操作遇到文件末尾时下一次返回0）
+            Submit(op);
+            return;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (op->write) {
+            stats.writes++;
+            stats.bytesWritten += static_cast<int64_t>(op->done);
+        } else {
+            stats.reads++;
+            stats.bytesRead += static_cast<int64_t>(op->done);
+        }
+    }
+    op->owner->Complete(op);
+}
+
+FileIoStats FileIoEngine::Stats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+void FileIoEngine::RecordStall() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.stalls++;
+}
+
+void FileIoQueue::Submit(FileIoOp *op) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending++;
+    }
+    op->owner = this;
+    op->done = 0;
+    op->error = 0;
+    op->complete = false;
+    FileIoEngine::Instance().Submit(op);
+}
+
+FileIoOp *FileIoQueue::Wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (pending == 0) {
+        return nullptr;
+    }
+    if (completed.empty()) {
+        FileIoEngine::Instance().RecordStall();
+        done.wait(lock, [this] { return !completed.empty(); });
+    }
+    FileIoOp *op = completed.front();
+    completed.pop_front();
+    pending--;
+    op->complete = true;
+    return op;
+}
+
+void FileIoQueue::Drain() {
+    while (Wait() != nullptr) {
+    }
+}
+
+void FileIoQueue::Complete(FileIoOp *op) {
+    std::lock_guard<std::mutex> lock(mutex);
+    completed.push_back(op);
+    // 在锁内通知：等待方取回全部操作后可能立即销毁队列
+    done.notify_all();
+}
+
+WriteBatcher::~WriteBatcher() {
+    Close();
+}
+
+void WriteBatcher::Open(int newFd, int64_t fileOffset, size_t newBatchSize) {
+    Close();
+    fd = newFd;
+    size_t minSize = kAlignment;
+    size_t maxSize = FileIoEngine::kBlockSize;
+    batchSize = std::min(std::max(newBatchSize, minSize), maxSize) / kAlignment * kAlignment;
+    failed = false;
+    idle.clear();
+    for (FileIoOp &op : ops) {
+        idle.push_back(&op);
+    }
+    current = nullptr;
+    position = fileOffset;
+    NextLimit();
+}
+
+void WriteBatcher::Rewind(int64_t fileOffset) {
+    queue.Drain();
+    idle.clear();
+    for (FileIoOp &op : ops) {
+        if (&op != current) {
+            idle.push_back(&op);
+        }
+    }
+    if (current) {
+        current->length = 0;
+    }
+    failed = false;
+    position = fileOffset;
+    NextLimit();
+}
+
+void WriteBatcher::NextLimit() {
+    // 写入阈值补齐到对齐边界，之后的整块写入都从对齐的文件偏移开始
+    limit = batchSize - static_cast<size_t>(position % kAlignment);
+}
+
+bool WriteBatcher::Reap(FileIoOp *op) {
+    if (op->error != 0) {
+        failed = true;
+    }
+    idle.push_back(op);
+    return !failed;
+}
+
+bool WriteBatcher::NextOp() {
+    if (idle.empty()) {
+        // 进行中的写入已达上限，等待最早完成的一个
+        FileIoOp *op = queue.Wait();
+        if (!op || !Reap(op)) {
+            failed = true;
+            return false;
+        }
+    }
+    current = idle.front();
+    idle.pop_front();
+    if (!current->buffer) {
+        // 数据块按写入块大小获取，不固定占用整块
+        current->capacity = batchSize;
+        current->buffer = FileIoEngine::Instance().AcquireBlock(batchSize, current->bufferIndex);
+    }
+    current->fd = fd;
+    current->write = true;
+    current->length = 0;
+    return true;
+}
+
+bool WriteBatcher::Write(const char *data, size_t len) {
+    if (failed || fd < 0) {
+        return false;
+    }
+    while (len > 0) {
+        if (!current && !NextOp()) {
+            return false;
+        }
+        size_t count = std::min(len, limit - current->length);
+        memcpy(current->buffer + current->length, data, count);
+        current->length += count;
+        data += count;
+        len -= count;
+        if (current->length == limit && !Flush()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WriteBatcher::Flush() {
+    if (failed || fd < 0) {
+        return !failed;
+    }
+    if (current && current->length > 0) {
+        current->offset = position;
+        position += static_cast<int64_t>(current->length);
+        queue.Submit(current);
+        current = nullptr;
+        NextLimit();
+    }
+    return !failed;
+}
+
+bool WriteBatcher::Close() {
+    if (fd < 0) {
+        return !failed;
+    }
+    Flush();
+    FileIoOp *op;
+    while ((op = queue.Wait()) != nullptr) {
+        Reap(op);
+    }
+    for (FileIoOp &item : ops) {
+        if (item.buffer) {
+            FileIoEngine::Instance().ReleaseBlock(item.buffer, item.bufferIndex, item.capacity);
+            item.buffer = nullptr;
+            item.bufferIndex = -1;
+        }
+    }
+    idle.clear();
+    current = nullptr;
+    fd = -1;
+    return !failed;
+}
+
+FileReadAhead::~FileReadAhead() {
+    Close();
+}
+
+void FileReadAhead::Open(int newFd, int64_t newEnd, int64_t newStart) {
+    Close();
+    fd = newFd;
+    start = newStart;
+    end = newEnd;
+    Rewind();
+}
+
+void FileReadAhead::Prefetch(FileIoOp *op) {
+    if (!op->buffer) {
+        op->capacity = kReadSize;
+        op->buffer = FileIoEngine::Instance().AcquireBlock(kReadSize, op->bufferIndex);
+    }
+    op->fd = fd;
+    op->write = false;
+    op->offset = nextOffset;
+    op->length = static_cast<size_t>(std::min(static_cast<int64_t>(kReadSize), end - nextOffset));
+    nextOffset += static_cast<int64_t>(op->length);
+    inOrder.push_back(op);
+    queue.Submit(op);
+}
+
+void FileReadAhead::Rewind() {
+    queue.Drain();
+    inOrder.clear();
+    nextOffset = start;
+    consumed = 0;
+    failed = false;
+    if (fd < 0) {
+        return;
+    }
+    for (FileIoOp &op : ops) {
+        if (nextOffset >= end) {
+            break;
+        }
+        Prefetch(&op);
+    }
+}
+
+size_t FileReadAhead::Read(char *buffer, size_t length) {
+    size_t written = 0;
+    while (written < length && !failed && !inOrder.empty()) {
+        FileIoOp *front = inOrder.front();
+        // 按文件顺序消费，等待首个预读块完成
+        while (!front->complete) {
+            if (!queue.Wait()) {
+                failed = true;
+                return written;
+            }
+        }
+        if (front->error != 0 || front->done < front->length) {
+            // 读取失败或文件在读取过程中被截断
+            failed = true;
+            return written;
+        }
+        size_t count = std::min(length - written, front->done - consumed);
+        memcpy(buffer + written, front->buffer + consumed, count);
+        written += count;
+        consumed += count;
+        if (consumed == front->done) {
+            inOrder.pop_front();
+            consumed = 0;
+            if (nextOffset < end) {
+                Prefetch(front);
+            }
+        }
+    }
+    return written;
+}
+
+void FileReadAhead::Close() {
+    queue.Drain();
+    inOrder.clear();
+    for (FileIoOp &op : ops) {
+        if (op.buffer) {
+            FileIoEngine::Instance().ReleaseBlock(op.buffer, op.bufferIndex, op.capacity);
+            op.buffer = nullptr;
+            op.bufferIndex = -1;
+        }
+    }
+    fd = -1;
+}
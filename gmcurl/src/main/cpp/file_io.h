@@ -0,0 +1,313 @@
+#ifndef GMCURL_FILE_IO_H
+#define GMCURL_FILE_IO_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+/**
+ * @file file_io.h
+ * @brief 下载/上传文件的异步I/O后端
+ *
+ * 传输线程只负责拼接/消费内存块，文件读写提交给进程级I/O引擎异步执行，磁盘延迟不再阻塞网络收发：
+ * - io_uring后端（Linux，运行时探测）：进程共用一个ring，注册固定写入块（IORING_REGISTER_BUFFERS），
+ *   使用WRITE_FIXED/READ_FIXED，注册块用完或注册失败时使用WRITEV/READV；由完成线程分发完成事件
+ * - 线程池后端：io_uring不可用（内核不支持、被seccomp禁止）时由少量工作线程执行pwrite/pread；
+ *   io_uring提交队列已满或io_uring_enter提交失败的操作也改由线程池执行
+ * 每个传输最多kMaxInFlight个进行中的读写，超过时传输线程等待最早完成的一个（计入stalls）。
+ * 数据块按读写大小从BufferPool分级获取（预读kReadSize，写入块随接收缓冲区变化），只有整块读写使用注册块。
+ */
+
+/**
+ * @brief I/O后端类型
+ */
+enum class FileIoBackend {
+    IO_URING,   ///< io_uring
+    THREAD_POOL ///< 线程池pwrite/pread
+};
+
+/**
+ * @brief I/O后端名称（"io_uring" | "threadPool"）
+ */
+const char *FileIoBackendName(FileIoBackend backend);
+
+/**
+ * @brief 文件I/O统计
+ */
+typedef struct FileIoStats {
+    int64_t writes = 0;       ///< 完成的写操作数
+    int64_t reads = 0;        ///< 完成的读操作数
+    int64_t bytesWritten = 0; ///< 写入字节数
+    int64_t bytesRead = 0;    ///< 读取字节数
+    int64_t stalls = 0;       ///< 传输线程等待磁盘的次数
+} FileIoStats;
+
+class FileIoQueue;
+
+/**
+ * @brief 单个异步读写操作
+ */
+typedef struct FileIoOp {
+    FileIoQueue *owner = nullptr; ///< 所属完成队列
+    int fd = -1;                  ///< 文件描述符
+    bool write = false;           ///< 写操作/读操作
+    char *buffer = nullptr;       ///< 数据块（来自I/O引擎）
+    size_t capacity = 0;          ///< 数据块大小
+    int bufferIndex = -1;         ///< 注册块下标，-1表示未注册
+    size_t length = 0;            ///< 读写长度
+    size_t done = 0;              ///< 已完成长度（读操作遇到文件末尾时小于length）
+    int64_t offset = 0;           ///< 文件偏移
+    int error = 0;                ///< 失败时的errno
+    bool complete = false;        ///< 是否已取回完成结果
+    struct iovec iov;             ///< 未注册块使用的向量
+} FileIoOp;
+
+/**
+ * @brief 单个传输的完成队列（线程安全）
+ */
+class FileIoQueue {
+public:
+    /**
+     * @brief 提交操作
+     */
+    void Submit(FileIoOp *op);
+
+    /**
+     * @brief 等待任意一个已提交操作完成
+     * @return 完成的操作，没有进行中的操作时返回nullptr
+     */
+    FileIoOp *Wait();
+
+    /**
+     * @brief 等待全部进行中的操作完成
+     */
+    void Drain();
+
+    /**
+     * @brief I/O引擎回调：操作完成
+     */
+    void Complete(FileIoOp *op);
+
+private:
+    std::mutex mutex;                 ///< 互斥锁
+    std::condition_variable done;     ///< 有操作完成
+    std::deque<FileIoOp *> completed; ///< 已完成未取回的操作
+    size_t pending = 0;               ///< 已提交未取回的操作数
+};
+
+/**
+ * @brief 进程级文件I/O引擎
+ */
+class FileIoEngine {
+public:
+    /**
+     * @brief 最大数据块大小（与BufferPool一致，1MB），也是注册块的大小
+     */
+    static const size_t kBlockSize = 1048576;
+
+    /**
+     * @brief 获取进程级实例（首次调用时探测io_uring，进程退出前不释放）
+     */
+    static FileIoEngine &Instance();
+
+    FileIoEngine(const FileIoEngine &) = delete;
+    FileIoEngine &operator=(const FileIoEngine &) = delete;
+
+    /**
+     * @brief 当前使用的后端
+     */
+    FileIoBackend Backend() const;
+
+    /**
+     * @brief 获取4KB对齐的数据块：整块大小时优先使用注册块，否则从BufferPool按大小获取
+     * @param size 需要的字节数（不超过kBlockSize）
+     * @param index 输出注册块下标，-1表示未注册
+     */
+    char *AcquireBlock(size_t size, int &index);
+
+    /**
+     * @brief 归还数据块
+     * @param size 获取时传入的字节数
+     */
+    void ReleaseBlock(char *block, int index, size_t size);
+
+    /**
+     * @brief 提交操作（完成后回调op->owner->Complete）
+     */
+    void Submit(FileIoOp *op);
+
+    /**
+     * @brief 统计数据
+     */
+    FileIoStats Stats();
+
+    /**
+     * @brief 记录一次传输线程等待
+     */
+    void RecordStall();
+
+    /**
+     * @brief 后端回调：一次系统调用完成，未完成的部分重新提交，全部完成后通知所属完成队列
+     * @param op 操作
+     * @param result 系统调用结果（字节数或负的errno）
+     */
+    void Finished(FileIoOp *op, ssize_t result);
+
+    /**
+     * @brief 后端实现
+     */
+    class Impl;
+
+private:
+    FileIoEngine();
+
+    std::unique_ptr<Impl> uring; ///< io_uring后端，不可用时为空
+    std::unique_ptr<Impl> pool;  ///< 线程池后端
+    std::mutex statsMutex;       ///< 统计互斥锁
+    FileIoStats stats;           ///< 统计数据
+};
+
+/**
+ * @brief 异步批量写入器（下载文件写入，单个传输内使用）
+ * 数据拼接到4KB对齐的数据块，按与文件偏移对齐的整块异步写入
+ */
+class WriteBatcher {
+public:
+    /**
+     * @brief 写入块与文件偏移的对齐单位
+     */
+    static const size_t kAlignment = 4096;
+
+    /**
+     * @brief 每个传输最多进行中的写操作数
+     */
+    static const size_t kMaxInFlight = 4;
+
+    WriteBatcher() = default;
+    ~WriteBatcher();
+
+    WriteBatcher(const WriteBatcher &) = delete;
+    WriteBatcher &operator=(const WriteBatcher &) = delete;
+
+    /**
+     * @brief 开始写入文件
+     * @param fd 文件描述符（由调用方在Close之后关闭）
+     * @param fileOffset 起始写入位置，首个写入块补齐到对齐边界
+     * @param batchSize 写入块大小
+     */
+    void Open(int fd, int64_t fileOffset, size_t batchSize);
+
+    /**
+     * @brief 等待进行中的写入，丢弃未写入的数据并从新的文件位置开始（文件被截断重写时调用）
+     */
+    void Rewind(int64_t fileOffset);
+
+    /**
+     * @brief 写入数据，写入块满时提交写入
+     * @return 是否成功（包含之前提交的写入结果）
+     */
+    bool Write(const char *data, size_t len);
+
+    /**
+     * @brief 提交写入块中的数据（不等待完成）
+     */
+    bool Flush();
+
+    /**
+     * @brief 提交剩余数据，等待全部写入完成并归还数据块
+     * @return 是否全部写入成功
+     */
+    bool Close();
+
+    /**
+     * @brief 是否已打开
+     */
+    bool IsOpen() const { return fd >= 0; }
+
+private:
+    void NextLimit();
+    bool NextOp();
+    bool Reap(FileIoOp *op);
+
+    FileIoQueue queue;              ///< 完成队列
+    FileIoOp ops[kMaxInFlight + 1]; ///< 操作（各自持有一个数据块）
+    std::deque<FileIoOp *> idle;    ///< 空闲操作
+    FileIoOp *current = nullptr;    ///< 正在填充的操作
+    int fd = -1;                    ///< 文件描述符
+    size_t batchSize = 0;           ///< 写入块大小
+    size_t limit = 0;               ///< 当前写入块的写入阈值（补齐到对齐边界）
+    int64_t position = 0;           ///< 下一次写入的文件位置
+    bool failed = false;            ///< 写文件失败
+};
+
+/**
+ * @brief 异步预读器（上传文件读取，单个传输内使用）
+ * 按顺序保持最多kMaxInFlight个预读块，传输线程从已完成的块中复制数据
+ */
+class FileReadAhead {
+public:
+    /**
+     * @brief 每次预读的大小
+     */
+    static const size_t kReadSize = 262144;
+
+    /**
+     * @brief 最多进行中的预读数
+     */
+    static const size_t kMaxInFlight = 4;
+
+    FileReadAhead() = default;
+    ~FileReadAhead();
+
+    FileReadAhead(const FileReadAhead &) = delete;
+    FileReadAhead &operator=(const FileReadAhead &) = delete;
+
+    /**
+     * @brief 开始预读[start, end)区间
+     * @param fd 文件描述符（由调用方在Close之后关闭）
+     * @param end 结束位置（整个文件时为文件大小）
+     * @param start 起始位置
+     */
+    void Open(int fd, int64_t end, int64_t start = 0);
+
+    /**
+     * @brief 读取下一段数据
+     * @return 实际读取字节数，0表示结束或失败
+     */
+    size_t Read(char *buffer, size_t length);
+
+    /**
+     * @brief 等待进行中的预读并回到区间起始位置
+     */
+    void Rewind();
+
+    /**
+     * @brief 等待进行中的预读并归还数据块
+     */
+    void Close();
+
+    /**
+     * @brief 是否发生读取错误（包括文件在读取过程中被截断）
+     */
+    bool Failed() const { return failed; }
+
+private:
+    void Prefetch(FileIoOp *op);
+
+    FileIoQueue queue;              ///< 完成队列
+    FileIoOp ops[kMaxInFlight];     ///< 操作（各自持有一个数据块）
+    std::deque<FileIoOp *> inOrder; ///< 按文件偏移排列的进行中/已完成预读
+    int fd = -1;                    ///< 文件描述符
+    int64_t start = 0;              ///< 区间起始位置
+    int64_t end = 0;                ///< 区间结束位置
+    int64_t nextOffset = 0;         ///< 下一次预读的文件偏移
+    size_t consumed = 0;            ///< 首个预读块已消费的长度
+    bool failed = false;            ///< 读取错误标识
+};
+
+#endif // GMCURL_FILE_IO_H
@@ -0,0 +1,40 @@
+#ifndef GMCURL_GB18030_INDEX_H
+#define GMCURL_GB18030_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file gb18030_index.h
+ * @brief GB18030码表
+ */
+
+/**
+ * @brief 双字节码位数（首字节0x81~0xFE，尾字节0x40~0x7E、0x80~0xFE）
+ */
+const size_t kGb18030TwoByteCount = 126 * 190;
+
+/**
+ * @brief 四字节BMP码位的线性区间数
+ */
+const size_t kGb18030RangeCount = 206;
+
+/**
+ * @brief 四字节BMP码位的线性区间：区间内码位 = codePoint + (index - index起点)
+ */
+typedef struct Gb18030Range {
+    uint32_t index;     ///< 区间起点的四字节线性序号
+    uint16_t codePoint; ///< 区间起点的Unicode码位
+} Gb18030Range;
+
+/**
+ * @brief 双字节码表，按(首字节 - 0x81) * 190 + 尾字节序号排列
+ */
+extern const uint16_t kGb18030TwoByte[kGb18030TwoByteCount];
+
+/**
+ * @brief 四字节BMP码位区间，按index升序排列
+ */
+extern const Gb18030Range kGb18030Ranges[kGb18030RangeCount];
+
+#endif // GMCURL_GB18030_INDEX_H
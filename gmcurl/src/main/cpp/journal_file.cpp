@@ -0,0 +1,60 @@
+#include "journal_file.h"
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::string JournalEscape(const std::string &value) {
+    std::string result;
+    result.reserve(value.size());
+    for (char ch : value) {
+        if (ch == '\\') {
+            result += "\\\\";
+        } else if (ch == '\n') {
+            result += "\\n";
+        } else if (ch == '\r') {
+            result += "\\r";
+        } else {
+            result += ch;
+        }
+    }
+    return result;
+}
+
+std::string JournalUnescape(const std::string &value) {
+    std::string result;
+    result.reserve(value.size());
+    for (size_t i = 0; i < value.size(); i++) {
+        if (value[i] == '\\' && i + 1 < value.size()) {
+            char next = value[++i];
+            result += next == 'n' ? '\n' : (next == 'r' ? '\r' : next);
+        } else {
+            result += value[i];
+        }
+    }
+    return result;
+}
+
+bool WriteJournalFile(const std::string &directory, const std::string &fileName, const std::string &content) {
+    mkdir(directory.c_str(), 0700);
+    std::string path = directory + "/" + fileName;
+    std::string temp = path + ".tmp";
+    // 重命名后保留临时文件的权限
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = fchmod(fd, 0600) == 0;
+    for (size_t written = 0; ok && written < content.size();) {
+        ssize_t n = write(fd, content.data() + written, content.size() - written);
+        ok = n > 0 || (n < 0 && errno == EINTR);
+        written += n > 0 ? static_cast<size_t>(n) : 0;
+    }
+    ok = close(fd) == 0 && ok;
+    if (ok && std::rename(temp.c_str(), path.c_str()) == 0) {
+        return true;
+    }
+    std::remove(temp.c_str());
+    return false;
+}
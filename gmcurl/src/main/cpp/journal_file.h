@@ -0,0 +1,35 @@
+#ifndef GMCURL_JOURNAL_FILE_H
+#define GMCURL_JOURNAL_FILE_H
+
+#include <string>
+
+/**
+ * @file journal_file.h
+ * @brief 行式持久化文件的公共工具
+ *
+ * 下载任务日志、可续传上传记录、离线请求队列、源站缓存与流量录制均使用"键 值"的行式文本格式：
+ * - 值中的反斜杠、换行与回车经转义后写入，保证每个字段占一行
+ * - 整体重写时先写入临时文件再重命名，进程中途退出不会留下截断的文件；
+ *   文件可能包含请求头等凭证，仅应用自身可读写（0600）
+ */
+
+/**
+ * @brief 转义值中的反斜杠、换行与回车
+ */
+std::string JournalEscape(const std::string &value);
+
+/**
+ * @brief 还原JournalEscape转义的值
+ */
+std::string JournalUnescape(const std::string &value);
+
+/**
+ * @brief 以临时文件加重命名的方式原子地重写文件（目录不存在时创建）
+ * @param directory 所在目录
+ * @param fileName 文件名
+ * @param content 文件内容
+ * @return 是否写入成功
+ */
+bool WriteJournalFile(const std::string &directory, const std::string &fileName, const std::string &content);
+
+#endif // GMCURL_JOURNAL_FILE_H
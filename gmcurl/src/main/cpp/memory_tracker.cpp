@@ -0,0 +1,174 @@
+#include "memory_tracker.h"
+#include "curl.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <openssl/crypto.h>
+
+/**
+ * @file memory_tracker.cpp
+ * @brief 网络栈内存统计实现
+ */
+
+namespace {
+
+/**
+ * @brief 分配块头部大小，保存用户区大小并保持malloc的对齐
+ */
+const size_t kHeaderSize = alignof(std::max_align_t) > sizeof(size_t) ? alignof(std::max_align_t) : sizeof(size_t);
+
+/**
+ * @brief 单个来源的统计计数
+ */
+typedef struct Counters {
+    std::atomic<bool> tracked{false};     ///< 是否已接入统计分配器
+    std::atomic<int64_t> liveBytes{0};   ///< 当前占用字节数
+    std::atomic<int64_t> peakBytes{0};   ///< 峰值占用字节数
+    std::atomic<int64_t> allocations{0}; ///< 分配次数
+    std::atomic<int64_t> frees{0};       ///< 释放次数
+} Counters;
+
+/**
+ * @brief 各来源计数与合计计数（下标MemorySource::COUNT）
+ */
+Counters g_counters[static_cast<int>(MemorySource::COUNT) + 1];
+
+void UpdatePeak(std::atomic<int64_t> &peak, int64_t live) {
+    int64_t current = peak.load(std::memory_order_relaxed);
+    while (live > current && !peak.compare_exchange_weak(current, live, std::memory_order_relaxed)) {
+    }
+}
+
+void AddLive(Counters &counters, int64_t delta) {
+    int64_t live = counters.liveBytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+    if (delta > 0) {
+        UpdatePeak(counters.peakBytes, live);
+    }
+}
+
+void Record(MemorySource source, int64_t delta, bool allocated, bool freed) {
+    Counters *targets[] = {&g_counters[static_cast<int>(source)], &g_counters[static_cast<int>(MemorySource::COUNT)]};
+    for (Counters *counters : targets) {
+        AddLive(*counters, delta);
+        if (allocated) {
+            counters->allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (freed) {
+            counters->frees.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void *TrackedMalloc(MemorySource source, size_t size) {
+    char *block = static_cast<char *>(malloc(kHeaderSize + size));
+    if (block == nullptr) {
+        return nullptr;
+    }
+    *reinterpret_cast<size_t *>(block) = size;
+    Record(source, static_cast<int64_t>(size), true, false);
+    return block + kHeaderSize;
+}
+
+void TrackedFree(MemorySource source, void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    char *block = static_cast<char *>(ptr) - kHeaderSize;
+    Record(source, -static_cast<int64_t>(*reinterpret_cast<size_t *>(block)), false, true);
+    free(block);
+}
+
+void *TrackedRealloc(MemorySource source, void *ptr, size_t size) {
+    if (ptr == nullptr) {
+        return TrackedMalloc(source, size);
+    }
+    if (size == 0) {
+        TrackedFree(source, ptr);
+        return nullptr;
+    }
+    char *block = static_cast<char *>(ptr) - kHeaderSize;
+    size_t oldSize = *reinterpret_cast<size_t *>(block);
+    char *newBlock = static_cast<char *>(realloc(block, kHeaderSize + size));
+    if (newBlock == nullptr) {
+        return nullptr;
+    }
+    *reinterpret_cast<size_t *>(newBlock) = size;
+    Record(source, static_cast<int64_t>(size) - static_cast<int64_t>(oldSize), false, false);
+    return newBlock + kHeaderSize;
+}
+
+// libcurl分配回调
+void *CurlMalloc(size_t size) { return TrackedMalloc(MemorySource::CURL, size); }
+
+void CurlFree(void *ptr) { TrackedFree(MemorySource::CURL, ptr); }
+
+void *CurlRealloc(void *ptr, size_t size) { return TrackedRealloc(MemorySource::CURL, ptr, size); }
+
+char *CurlStrdup(const char *str) {
+    size_t len = strlen(str) + 1;
+    char *copy = static_cast<char *>(CurlMalloc(len));
+    if (copy) {
+        memcpy(copy, str, len);
+    }
+    return copy;
+}
+
+void *CurlCalloc(size_t nmemb, size_t size) {
+    if (size != 0 && nmemb > SIZE_MAX / size) {
+        return nullptr;
+    }
+    void *ptr = CurlMalloc(nmemb * size);
+    if (ptr) {
+        memset(ptr, 0, nmemb * size);
+    }
+    return ptr;
+}
+
+// libcrypto分配回调
+void *CryptoMalloc(size_t size, const char *file, int line) { return TrackedMalloc(MemorySource::TLS, size); }
+
+void *CryptoRealloc(void *ptr, size_t size, const char *file, int line) {
+    return TrackedRealloc(MemorySource::TLS, ptr, size);
+}
+
+void CryptoFree(void *ptr, const char *file, int line) { TrackedFree(MemorySource::TLS, ptr); }
+
+MemoryStats Snapshot(const Counters &counters) {
+    MemoryStats stats;
+    stats.tracked = counters.tracked.load();
+    stats.liveBytes = counters.liveBytes.load();
+    stats.peakBytes = counters.peakBytes.load();
+    stats.allocations = counters.allocations.load();
+    stats.frees = counters.frees.load();
+    return stats;
+}
+
+} // namespace
+
+bool InitNetworkMemoryTracking() {
+    static std::once_flag once;
+    static bool initialized = false;
+    std::call_once(once, [] {
+        // 必须先于libcurl初始化：libcurl初始化TLS后端时libcrypto即开始分配内存
+        if (CRYPTO_set_mem_functions(CryptoMalloc, CryptoRealloc, CryptoFree) == 1) {
+            g_counters[static_cast<int>(MemorySource::TLS)].tracked = true;
+        }
+        if (curl_global_init_mem(CURL_GLOBAL_DEFAULT, CurlMalloc, CurlFree, CurlRealloc, CurlStrdup, CurlCalloc) ==
+            CURLE_OK) {
+            g_counters[static_cast<int>(MemorySource::CURL)].tracked = true;
+            initialized = true;
+        } else {
+            // 统计分配器不可用时仍显式初始化，避免在工作线程中惰性初始化
+            initialized = curl_global_init(CURL_GLOBAL_DEFAULT) == CURLE_OK;
+        }
+        g_counters[static_cast<int>(MemorySource::COUNT)].tracked =
+            g_counters[static_cast<int>(MemorySource::CURL)].tracked.load();
+    });
+    return initialized;
+}
+
+MemoryStats GetMemoryStats(MemorySource source) { return Snapshot(g_counters[static_cast<int>(source)]); }
+
+MemoryStats GetTotalMemoryStats() { return Snapshot(g_counters[static_cast<int>(MemorySource::COUNT)]); }
@@ -0,0 +1,53 @@
+#ifndef GMCURL_MEMORY_TRACKER_H
+#define GMCURL_MEMORY_TRACKER_H
+
+#include <cstdint>
+
+/**
+ * @file memory_tracker.h
+ * @brief 网络栈内存统计
+ *
+ * 模块注册时通过curl_global_init_mem显式初始化libcurl，并把libcurl与libcrypto（TLS/TLCP）的内存分配
+ * 接入带统计的分配器，统计当前占用、峰值与分配次数：
+ * - libcurl：curl_global_init_mem注册的malloc/free/realloc/strdup/calloc回调
+ * - libcrypto：CRYPTO_set_mem_functions注册的回调，仅在libcrypto尚未分配过内存时生效
+ * nghttp2使用自身的默认分配器，不在统计范围内。
+ */
+
+/**
+ * @brief 内存来源
+ */
+enum class MemorySource {
+    CURL,  ///< libcurl
+    TLS,   ///< libcrypto
+    COUNT  ///< 来源数量
+};
+
+/**
+ * @brief 内存统计
+ */
+typedef struct MemoryStats {
+    bool tracked = false;    ///< 是否已接入统计分配器
+    int64_t liveBytes = 0;   ///< 当前占用字节数
+    int64_t peakBytes = 0;   ///< 峰值占用字节数
+    int64_t allocations = 0; ///< 分配次数（含realloc新分配）
+    int64_t frees = 0;       ///< 释放次数
+} MemoryStats;
+
+/**
+ * @brief 初始化libcurl全局环境并接入统计分配器（进程内只执行一次，需在任何cURL调用之前）
+ * @return libcurl全局初始化是否成功
+ */
+bool InitNetworkMemoryTracking();
+
+/**
+ * @brief 获取指定来源的内存统计
+ */
+MemoryStats GetMemoryStats(MemorySource source);
+
+/**
+ * @brief 获取全部来源合计的内存统计（峰值为合计占用的峰值）
+ */
+MemoryStats GetTotalMemoryStats();
+
+#endif // GMCURL_MEMORY_TRACKER_H
@@ -0,0 +1,130 @@
+#include "multipart_encoder.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+/**
+ * @file multipart_encoder.cpp
+ * @brief multipart/form-data 流式编码器实现
+ */
+
+MultipartEncoder::MultipartEncoder() {
+    // 生成与libcurl格式一致的随机boundary
+    static const char hex[] = "0123456789abcdef";
+    std::random_device rd;
+    boundary = "------------------------";
+    for (int i = 0; i < 22; i++) {
+        boundary.push_back(hex[rd() % 16]);
+    }
+}
+
+MultipartEncoder::~MultipartEncoder() {
+    file.reset();
+}
+
+void MultipartEncoder::AddText(const std::string &text) {
+    Segment segment;
+    segment.text = text;
+    segment.size = text.size();
+    totalSize += static_cast<int64_t>(segment.size);
+    segments.push_back(std::move(segment));
+}
+
+std::string MultipartEncoder::PartHeader(const std::string &name, const std::string &remoteFileName,
+                                         const std::string &contentType) const {
+    std::string header = "--" + boundary + "\r\nContent-Disposition: form-data; name=\"" + name + "\"";
+    if (!remoteFileName.empty()) {
+        header += "; filename=\"" + remoteFileName + "\"";
+    }
+    header += "\r\n";
+    if (!contentType.empty()) {
+        header += "Content-Type: " + contentType + "\r\n";
+    }
+    header += "\r\n";
+    return header;
+}
+
+void MultipartEncoder::AddData(const std::string &name, const std::string &remoteFileName,
+                               const std::string &contentType, const void *data, size_t size) {
+    AddText(PartHeader(name, remoteFileName, contentType));
+    if (size > 0) {
+        Segment segment;
+        segment.data = static_cast<const char *>(data);
+        segment.size = size;
+        totalSize += static_cast<int64_t>(size);
+        segments.push_back(std::move(segment));
+    }
+    AddText("\r\n");
+}
+
+bool MultipartEncoder::AddFile(const std::string &name, const std::string &remoteFileName,
+                               const std::string &contentType, const std::string &filePath) {
+    std::ifstream in(filePath, std::ifstream::ate | std::ifstream::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::streamoff fileSize = in.tellg();
+    if (fileSize < 0) {
+        return false;
+    }
+    AddText(PartHeader(name, remoteFileName, contentType));
+    Segment segment;
+    segment.filePath = filePath;
+    segment.size = static_cast<size_t>(fileSize);
+    segment.isFile = true;
+    totalSize += fileSize;
+    segments.push_back(std::move(segment));
+    AddText("\r\n");
+    return true;
+}
+
+void MultipartEncoder::Finish() { AddText("--" + boundary + "--\r\n"); }
+
+std::string MultipartEncoder::ContentType() const { return "multipart/form-data; boundary=" + boundary; }
+
+bool MultipartEncoder::Rewind() {
+    file.reset();
+    segmentIndex = 0;
+    segmentOffset = 0;
+    failed = false;
+    return true;
+}
+
+size_t MultipartEncoder::Read(char *buffer, size_t length) {
+    size_t written = 0;
+    while (written < length && segmentIndex < segments.size()) {
+        Segment &segment = segments[segmentIndex];
+        size_t remain = segment.size - segmentOffset;
+        if (remain == 0) {
+            file.reset();
+            segmentIndex++;
+            segmentOffset = 0;
+            continue;
+        }
+        size_t chunk = std::min(remain, length - written);
+        if (segment.isFile) {
+            if (!file) {
+                file.reset(new FileBodyReader(segment.filePath));
+                if (!file->IsOpen()) {
+                    failed = true;
+                    return 0;
+                }
+            }
+            size_t got = file->Read(buffer + written, chunk);
+            if (got == 0 || file->Failed()) {
+                // 文件在编码过程中被截断
+                failed = true;
+                return 0;
+            }
+            chunk = got;
+        } else if (segment.data != nullptr) {
+            memcpy(buffer + written, segment.data + segmentOffset, chunk);
+        } else {
+            memcpy(buffer + written, segment.text.data() + segmentOffset, chunk);
+        }
+        segmentOffset += chunk;
+        written += chunk;
+    }
+    return written;
+}
@@ -0,0 +1,111 @@
+#ifndef GMCURL_MULTIPART_ENCODER_H
+#define GMCURL_MULTIPART_ENCODER_H
+
+#include "body_reader.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file multipart_encoder.h
+ * @brief multipart/form-data 流式编码器
+ *
+ * 与 curl_formadd 不同，本编码器使用固定的 boundary，可以对同一请求体重复编码（Rewind 后重新读取），
+ * 从而在发送前对完整请求体做流式摘要（签名/加密），且文件内容始终分块读取，不会整体加载到内存。
+ */
+
+/**
+ * @brief multipart 编码器
+ * 通过 Read 按顺序输出各表单项的头部、数据与结束分隔符
+ */
+class MultipartEncoder : public BodyReader {
+public:
+    MultipartEncoder();
+    ~MultipartEncoder();
+
+    MultipartEncoder(const MultipartEncoder &) = delete;
+    MultipartEncoder &operator=(const MultipartEncoder &) = delete;
+
+    /**
+     * @brief 添加内存数据表单项（数据指针需在编码器生命周期内有效）
+     * @param name 字段名
+     * @param remoteFileName 远程文件名，为空时不输出filename
+     * @param contentType 数据类型
+     * @param data 数据指针
+     * @param size 数据大小
+     */
+    void AddData(const std::string &name, const std::string &remoteFileName, const std::string &contentType,
+                 const void *data, size_t size);
+
+    /**
+     * @brief 添加文件表单项
+     * @param name 字段名
+     * @param remoteFileName 远程文件名
+     * @param contentType 文件类型
+     * @param filePath 文件路径
+     * @return 文件是否可读
+     */
+    bool AddFile(const std::string &name, const std::string &remoteFileName, const std::string &contentType,
+                 const std::string &filePath);
+
+    /**
+     * @brief 结束添加表单项，生成结束分隔符
+     */
+    void Finish();
+
+    /**
+     * @brief 请求头中使用的Content-Type（包含boundary）
+     */
+    std::string ContentType() const;
+
+    /**
+     * @brief 编码后的请求体总长度
+     */
+    int64_t TotalSize() const override { return totalSize; }
+
+    /**
+     * @brief 回到请求体起始位置
+     * @return 是否成功
+     */
+    bool Rewind() override;
+
+    /**
+     * @brief 读取下一段编码数据
+     * @param buffer 输出缓冲区
+     * @param length 缓冲区大小
+     * @return 实际读取字节数，0表示结束，读取失败时Failed()为true
+     */
+    size_t Read(char *buffer, size_t length) override;
+
+    /**
+     * @brief 是否发生读取错误（文件被删除/截断等）
+     */
+    bool Failed() const override { return failed; }
+
+private:
+    /**
+     * @brief 编码片段：内存数据或文件
+     */
+    typedef struct Segment {
+        std::string text;           ///< 片段自有文本（头部/分隔符）
+        const char *data = nullptr; ///< 外部内存数据指针
+        size_t size = 0;            ///< 片段大小
+        std::string filePath;       ///< 文件路径（文件片段）
+        bool isFile = false;        ///< 是否为文件片段
+    } Segment;
+
+    void AddText(const std::string &text);
+    std::string PartHeader(const std::string &name, const std::string &remoteFileName,
+                           const std::string &contentType) const;
+
+    std::string boundary;                 ///< 分隔符
+    std::vector<Segment> segments;        ///< 编码片段列表
+    int64_t totalSize = 0;                ///< 总长度
+    size_t segmentIndex = 0;              ///< 当前片段下标
+    size_t segmentOffset = 0;             ///< 当前片段内偏移
+    std::unique_ptr<FileBodyReader> file; ///< 当前打开的文件片段
+    bool failed = false;                  ///< 读取错误标识
+};
+
+#endif // GMCURL_MULTIPART_ENCODER_H
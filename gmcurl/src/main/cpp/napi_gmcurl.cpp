@@ -1,10 +1,41 @@
+#include "admission_controller.h"
+#include "charset_decoder.h"
+#include "connection_pool.h"
 #include "curl.h"
+#include "download_manager.h"
+#include "fault_injection.h"
+#include "file_io.h"
 #include "hilog/log.h"
+#include "memory_tracker.h"
 #include "napi/native_api.h"
+#include "origin_cache.h"
+#include "outbox.h"
+#include "multipart_encoder.h"
+#include "parallel_upload.h"
+#include "payload_cipher.h"
+#include "prefetch_queue.h"
+#include "range_fetch.h"
+#include "receive_tuner.h"
+#include "redirect_cache.h"
+#include "request_pool.h"
+#include "request_signer.h"
+#include "response_cache.h"
+#include "resumable_upload.h"
+#include "traffic_replay.h"
+#include "transfer_engine.h"
+#include "upstream_balancer.h"
+#include <atomic>
+#include <condition_variable>
+#include <fcntl.h>
 #include <fstream>
 #include <map>
+#include <memory>
+#include <set>
 #include <sstream>
 #include <string>
+#include <strings.h>
+#include <unistd.h>
+#include <uv.h>
 
 /**
  * @file napi_gmcurl.cpp
@@ -24,8 +55,30 @@
  * - 集成系统日志输出，便于调试和追踪请求过程
  * - 支持multipart/form-data表单提交，包含文件上传和二进制数据传输
  * - 完善的线程安全机制，通过napi_call_threadsafe_function保证回调安全
+ * - 请求状态按env（主线程/ArkTS Worker）隔离，Worker终止时中断并等待其进行中的传输，DNS/TLS会话缓存进程级共享
  * - 支持性能指标监控，便于分析请求耗时和网络状态
  * - 支持压缩，支持gzip、deflate算法
+ * - 支持请求签名（HMAC-SHA256/HMAC-SM3/SM2），在异步线程中流式计算请求体摘要
+ * - 支持SM4-GCM/CBC应用层载荷加解密，请求体在读取路径中加密，响应体在写入回调中解密
+ * - 支持可复用客户端，公共请求头预构建为curl_slist，传输层配置预设到模板句柄并通过curl_easy_duphandle复制
+ * - 进程级连接池：按主机复用空闲句柄及其连接，空闲/存活时间回收，TCP keepalive与HTTP/2 PING探测失效连接
+ * - 所有请求按重定向策略跟随重定向（最大跳转次数、同源限制、POST方法保持），301/308跳转缓存后直接请求最终URL
+ * - 持久化HSTS与Alt-Svc缓存：http://请求直接升级为https://，已知h2备用服务直连
+ * - 接收缓冲区按主机实测吞吐与RTT自适应，下载数据拼接为4KB对齐的整块后写入文件
+ * - 下载写入与上传读取由进程级I/O引擎异步执行（io_uring，不可用时线程池pwrite/pread），磁盘延迟不阻塞传输
+ * - 断点续传上传（tus或Content-Range分块），已确认位置持久化，失败或重启后查询服务端位置继续
+ * - 并行分块上传（S3 Multipart Upload），多个连接同时上传分块，单个分块失败按指数退避重试，AWS SigV4签名
+ * - 多范围读取：一次多范围请求（multipart/byteranges）取得多个字节范围，服务端不支持时并行发送单范围请求
+ * - 空闲预取：无前台请求时按带宽上限预取GET响应到进程级内存缓存，之后同一URL的请求直接从缓存返回
+ * - 离线发件箱：写请求追加到磁盘日志后立即返回，由独立线程重试发送，未指定URL的记录合并为gzip压缩的批量请求
+ * - 持久化下载管理器：下载任务跨进程重启保留，支持暂停/恢复/优先级/并发限制，进度按周期汇总通知
+ * - 流量录制与本地回放：录制请求与响应及耗时，回放服务器按原始或缩放后的延迟与带宽返回，用于离线性能回归测试
+ * - 文本响应按responseCharset选项或Content-Type的charset在传输线程中查表解码（GBK/GB18030、UTF-16、ISO-8859-1）
+ * - UTF-8响应在传输线程中以SIMD检测纯ASCII并校验，JS线程以Latin-1/UTF-16直接创建字符串，不再校验与转码
+ * - 紧凑响应格式：状态码、响应头、性能指标与响应体在传输线程中打包为一块内存，JS线程只创建一个外部ArrayBuffer
+ * - 客户端负载均衡：upstream://组名/路径按延迟EWMA与进行中请求数二选一选择端点，摘除失败端点并预建连接
+ * - 网络故障注入（测试用）：请求经本地隧道代理转发，按主机与随机种子注入延迟、抖动、限速、停顿、重置与慢握手
+ * - 模块加载时通过curl_global_init_mem显式初始化libcurl，统计libcurl/libcrypto内存占用
  *
  * 模块结构概览：
  * - HttpRequestParams：请求参数存储结构体，包含 URL、方法、头信息、证书路径、超时设置等
@@ -35,6 +88,7 @@
  * - convertRequestHeader / convertRequestData：辅助函数，用于从 JS 对象中提取请求头和请求体
  * - progress_callback：进度回调函数，支持实时检查是否取消请求
  * - cancelRequest：N-API 接口函数，用于取消指定 ID 的请求
+ * - createClient / ClientRequest：可复用客户端及其请求入口，请求参数只解析与客户端配置的差异部分
  *
  * 依赖库：
  * - libcurl：底层网络请求引擎
@@ -63,7 +117,7 @@
  * 注意事项：
  * - 所有请求均在异步线程中执行，避免阻塞主线程
  * - 进度回调采用节流机制（1秒间隔或完成时触发），防止高频回调
- * - 使用 std::map<std::int32_t, bool> 存储请求标识符，支持动态取消机制
+ * - 每个env使用独立的 std::map<std::int32_t, bool> 存储请求标识符，支持动态取消机制，请求ID只在本env内有效
  * - 资源管理自动完成，包括文件流缓冲区和内存缓冲区的自动释放
  * - 支持两种数据格式自动转换：JSON字符串和ArrayBuffer二进制数据
  *
@@ -118,63 +172,193 @@ typedef struct PerformanceTiming {
         napi_create_int32(env, data, &val);                                                                            \
         napi_set_named_property(env, performanceObj, #name, val);                                                      \
     }
+struct GmCurlClient;
+
 /**
  * @brief HTTP请求参数结构体
  * 存储完整的请求配置和上下文信息
  */
 typedef struct HttpRequestParams {
     std::string url;                                ///< 请求目标URL
-    std::string method;                             ///< HTTP方法(GET/POST/PUT/DELETE)
+    std::string method = "GET";                     ///< HTTP方法(GET/POST/PUT/DELETE)
     std::string extraDataStr;                       ///< 文本类型请求体数据
     std::string downloadFilePath;                   ///< 下载文件路径
     std::string uploadFilePath;                     ///< 上传文件路径
-    std::ofstream *downloadFile;                    ///< 下载文件流
-    std::ifstream *uploadFile;                      ///< 上传文件流
+    int downloadFd = -1;                            ///< 下载文件描述符
     int64_t resumeFromOffset = 0;                   ///< 续传起始位置
-    char *buffer;                                   ///< 缓冲区指针
     void *extraDataBuffer = nullptr;                ///< 二进制请求体数据指针
     size_t extraDataBufferSize = 0;                 ///< 二进制数据大小
     bool isExtraDataArrayBuffer = false;            ///< 数据类型标识
     std::map<std::string, std::string> headers;     ///< 请求头集合
-    int readTimeout;                                ///< 读取超时时间(秒)
-    int connectTimeout;                             ///< 连接超时时间(秒)
+    int readTimeout = 15;                           ///< 读取超时时间(秒)
+    int connectTimeout = 15;                        ///< 连接超时时间(秒)
     std::string caPath;                             ///< CA证书路径
     std::string clientCertPath;                     ///< 客户端证书路径
     std::string response;                           ///< 响应正文
-    int responseCode;                               ///< HTTP状态码
+    std::string responseCharset;                    ///< 文本响应体的字符集（为空时按Content-Type的charset）
+    TextForm bodyForm = TextForm::UTF8;             ///< 文本响应正文的存放形式（UTF8表示未在传输线程中转换）
+    std::u16string decodedResponse;                 ///< 转换为UTF-16的响应正文（bodyForm为UTF16时有效）
+    bool isPackedResponse = false;                  ///< 以单个ArrayBuffer返回响应（responseFormat为'packed'）
+    std::string packedResponse;                     ///< 打包的响应（在传输线程中生成）
+    int responseCode = 0;                           ///< HTTP状态码
     std::string responseHeaders;                    ///< 响应头原始数据
     std::string errorMsg;                           ///< 错误信息
-    bool isDebug;                                   ///< 调试模式开关
-    bool isTLCP;                                    ///< 国密协议开关
-    bool verifyServer;                              ///< 服务器验证开关
-    std::int32_t requestId;                         ///< 请求ID
+    bool isDebug = false;                           ///< 调试模式开关
+    bool isTLCP = false;                            ///< 国密协议开关
+    bool verifyServer = true;                       ///< 服务器验证开关
+    std::int32_t requestId = 0;                     ///< 请求ID
     std::vector<FormData> formData;                 ///< 表单数据集合
     int64_t lastProgress = 0;                       ///< 上次进度
     std::chrono::steady_clock::time_point lastTime; ///< 上次进度时间
     bool isPerformanceTiming = false;               ///< 性能指标开关
     PerformanceTiming performanceTiming;            ///< 性能指标数据
+    bool isSignature = false;                       ///< 请求签名开关
+    SignatureConfig signature;                      ///< 请求签名配置
+    bool isPayloadCipher = false;                   ///< 载荷加密开关
+    PayloadCipherConfig payloadCipher;              ///< 载荷加密配置
+    int priority = 0;                               ///< 排队优先级，越大越优先
+    int64_t deadline = 0;                           ///< 排队截止时间（毫秒），0表示使用准入控制默认值
+    std::chrono::steady_clock::time_point deadlineTime = std::chrono::steady_clock::time_point::max(); ///< 截止时刻
+    bool expired = false;                           ///< 启动前已超过截止时间
+    std::shared_ptr<GmCurlClient> client;           ///< 所属客户端（为空表示独立请求）
+    bool transportOverridden = false;               ///< 是否覆盖了客户端的传输层配置
+    RedirectPolicy redirect;                        ///< 重定向策略
+    ResumableUploadConfig resumable;                ///< 断点续传上传配置
+    ParallelUploadConfig parallel;                  ///< 并行分块上传配置
+    std::vector<ByteRange> ranges;                  ///< 读取的字节范围（fetchRange）
+    int rangeParallel = 4;                          ///< 单范围请求的最大并发数（fetchRange）
+    std::vector<std::string> slices;                ///< 各字节范围的数据（fetchRange）
+    bool foreground = false;                        ///< 是否已登记为前台请求（预取让行）
 } HttpRequestParams;
 
+struct RequestCallbackData;
+struct QueueTimer;
+
+/**
+ * @brief 每个env最多缓存的请求上下文数量
+ */
+static const size_t kMaxCachedContexts = 64;
+
+/**
+ * @brief env级请求状态
+ * 每个env（主线程/ArkTS Worker）独立持有，请求ID只在本env内有效，不同Worker之间不竞争同一把锁。
+ * 由env级数据和该env的请求共同持有，env销毁后仍在执行的请求可安全访问
+ */
+typedef struct EnvState {
+    std::map<std::int32_t, bool> cancelRequests; ///< 取消请求的标识符
+    std::mutex mutex;                            ///< 互斥锁
+    std::condition_variable drained;             ///< 进行中的传输全部结束
+    int inFlight = 0;                            ///< 进行中的传输数量
+    std::set<CURL *> transfers;                  ///< 进行中传输的句柄（env销毁时中断其连接）
+    std::atomic<bool> closing{false};            ///< env正在销毁，中断并拒绝传输
+    AdmissionController admission;               ///< 准入控制（仅在JS线程访问）
+    QueueTimer *queueTimer = nullptr;            ///< 排队截止时间定时器（仅在JS线程访问）
+    ObjectPool<RequestCallbackData> contextPool{kMaxCachedContexts}; ///< 请求上下文复用池（仅在JS线程访问）
+    int downloadListener = 0;                    ///< 下载进度回调标识（仅在JS线程访问）
+    napi_threadsafe_function downloadProgress = nullptr; ///< 下载进度线程安全函数（仅在JS线程访问）
+
+    /**
+     * @brief 登记开始传输
+     * @return env正在销毁时返回false
+     */
+    bool Enter() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closing) {
+            return false;
+        }
+        inFlight++;
+        return true;
+    }
+
+    /**
+     * @brief 登记传输结束
+     */
+    void Leave() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--inFlight == 0) {
+            drained.notify_all();
+        }
+    }
+
+    /**
+     * @brief 标记env正在销毁，中断进行中传输的连接，阻塞在收发上的传输立即返回
+     */
+    void Close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+        for (CURL *curl : transfers) {
+            TransferEngine::Instance().Interrupt(curl);
+        }
+    }
+} EnvState;
+
+/**
+ * @brief env销毁时等待进行中传输结束的最长时间（毫秒），传输已被中断，只等待其收尾
+ */
+static const int kEnvDrainTimeout = 500;
+
+/**
+ * @brief 传输句柄登记守卫，执行期间env销毁时可中断其连接
+ * 多范围读取与分块上传的句柄不登记，由进度回调与分块间的取消检查中断
+ */
+typedef struct TransferWatch {
+    TransferWatch(EnvState *state, CURL *curl) : state(state), curl(curl) {
+        if (state) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->transfers.insert(curl);
+        }
+    }
+    ~TransferWatch() {
+        if (state) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->transfers.erase(curl);
+        }
+    }
+    EnvState *state; ///< 所属env的请求状态
+    CURL *curl;      ///< 请求句柄
+} TransferWatch;
+
 /**
  * @brief 异步请求回调数据结构
  * 用于在异步操作中传递上下文信息
  */
-typedef struct {
-    napi_async_work asyncWork;     ///< NAPI异步工作对象
-    napi_deferred deferred;        ///< Promise延迟对象
-    HttpRequestParams params;      ///< 请求参数
-    napi_threadsafe_function tsfn; ///< 线程安全函数对象
+typedef struct RequestCallbackData {
+    napi_async_work asyncWork = nullptr;     ///< NAPI异步工作对象
+    napi_deferred deferred = nullptr;        ///< Promise延迟对象
+    HttpRequestParams params;                ///< 请求参数
+    napi_threadsafe_function tsfn = nullptr; ///< 线程安全函数对象
+    std::shared_ptr<EnvState> envState;      ///< 所属env的请求状态
 } RequestCallbackData;
 
 /**
- * @brief 存储取消请求的标识符
+ * @brief 可复用的请求客户端
+ * 冻结createClient时的共享配置：公共请求头预构建为只读的curl_slist，TLS/证书/压缩等传输层配置预设到模板句柄，
+ * 每个请求通过curl_easy_duphandle复制模板句柄，只需设置URL、请求体等差异部分
  */
-static std::map<std::int32_t, bool> mCancelRequestMap;
+typedef struct GmCurlClient {
+    std::string baseUrl;                         ///< 基础URL
+    HttpRequestParams base;                      ///< 共享请求配置（不含公共请求头）
+    std::map<std::string, std::string> headers;  ///< 公共请求头
+    struct curl_slist *defaultHeaders = nullptr; ///< 预构建的公共请求头链表，所有请求只读共享
+    CURL *templateHandle = nullptr;              ///< 模板句柄
+    std::mutex templateMutex;                    ///< 模板句柄互斥锁
 
-/**
- * @brief 互斥锁，用于控制取消请求操作
- */
-static std::mutex mCancel_mtx;
+    ~GmCurlClient() {
+        curl_slist_free_all(defaultHeaders);
+        if (templateHandle) {
+            curl_easy_cleanup(templateHandle);
+        }
+    }
+
+    /**
+     * @brief 复制模板句柄
+     * @return 新的cURL句柄，失败返回nullptr
+     */
+    CURL *DupHandle() {
+        std::lock_guard<std::mutex> lock(templateMutex);
+        return templateHandle ? curl_easy_duphandle(templateHandle) : nullptr;
+    }
+} GmCurlClient;
 
 /**
  * @brief 获取文件大小
@@ -254,23 +438,93 @@ std::map<std::string, std::string> ParseHeaders(const std::string &headerStr) {
 }
 
 /**
- * @brief 文件上传的读取回调函数
- * @param ptr 缓冲区指针
- * @param size 单个数据块大小
- * @param nmemb 数据块数量
- * @param userp 用户数据指针（HttpRequestParams）
- * @return 实际读取的字节数
+ * @brief 响应体写入上下文
+ * 响应体写入内存或下载文件，开启载荷解密时先流式解密再写入
+ */
+typedef struct ResponseWriter {
+    std::string *body = nullptr;                       ///< 响应体缓冲区
+    WriteBatcher *file = nullptr;                      ///< 下载文件批量写入
+    CURL *curl = nullptr;                              ///< cURL句柄（用于获取响应码）
+    const std::string *responseHeaders = nullptr;      ///< 已接收的响应头
+    const PayloadCipherConfig *cipherConfig = nullptr; ///< 载荷解密配置
+    std::string requestIv;                             ///< 请求使用的IV
+    std::unique_ptr<PayloadCipher> decryptor;          ///< 解密器（首个数据块到达时创建）
+    bool decryptChecked = false;                       ///< 是否已判断是否需要解密
+    std::string plain;                                 ///< 解密输出缓冲区（复用）
+    bool failed = false;                               ///< 解密失败标识
+} ResponseWriter;
+
+/**
+ * @brief 解密响应数据块
+ * 首个数据块到达时根据响应码判断是否需要解密（仅解密2xx响应），并优先使用响应头中的IV
+ * @param writer 写入上下文
+ * @param data 输入/输出数据指针
+ * @param len 输入/输出数据长度
+ * @return 是否成功
  */
-size_t read_callback(void *ptr, size_t size, size_t nmemb, void *userp) {
-    auto *params = static_cast<HttpRequestParams *>(userp);
-    if (!params->uploadFile || !params->uploadFile->is_open()) {
-        return 0; // 文件未打开，返回0表示EOF
+static bool DecryptResponseChunk(ResponseWriter *writer, const char *&data, size_t &len) {
+    if (!writer->cipherConfig) {
+        return true;
+    }
+    if (!writer->decryptChecked) {
+        writer->decryptChecked = true;
+        long responseCode = 0;
+        curl_easy_getinfo(writer->curl, CURLINFO_RESPONSE_CODE, &responseCode);
+        if (responseCode < 200 || responseCode >= 300) {
+            return true;
+        }
+        std::string iv = writer->requestIv;
+        if (!writer->cipherConfig->ivHeaderName.empty() && writer->responseHeaders) {
+            for (const auto &header : ParseHeaders(*writer->responseHeaders)) {
+                if (strcasecmp(header.first.c_str(), writer->cipherConfig->ivHeaderName.c_str()) == 0) {
+                    PayloadHexDecode(header.second, iv);
+                }
+            }
+        }
+        writer->decryptor.reset(new PayloadCipher(*writer->cipherConfig, false));
+        if (!writer->decryptor->Init(iv)) {
+            writer->failed = true;
+            return false;
+        }
     }
+    if (!writer->decryptor) {
+        return true;
+    }
+    writer->plain.clear();
+    if (!writer->decryptor->Update(data, len, writer->plain)) {
+        writer->failed = true;
+        return false;
+    }
+    data = writer->plain.data();
+    len = writer->plain.size();
+    return true;
+}
 
-    size_t bufferSize = size * nmemb;
-    params->uploadFile->read(static_cast<char *>(ptr), bufferSize);
-    size_t bytesRead = params->uploadFile->gcount();
-    return bytesRead;
+/**
+ * @brief 结束响应体解密，输出剩余明文并校验认证标签
+ * @param writer 写入上下文
+ * @return 是否成功
+ */
+static bool FinishResponseWriter(ResponseWriter *writer) {
+    if (writer->failed) {
+        return false;
+    }
+    if (!writer->decryptor) {
+        return true;
+    }
+    writer->plain.clear();
+    if (!writer->decryptor->Final(writer->plain)) {
+        writer->failed = true;
+        return false;
+    }
+    if (writer->file) {
+        if (!writer->file->Write(writer->plain.data(), writer->plain.size())) {
+            return false;
+        }
+    } else if (writer->body) {
+        writer->body->append(writer->plain);
+    }
+    return true;
 }
 
 /**
@@ -278,14 +532,19 @@ size_t read_callback(void *ptr, size_t size, size_t nmemb, void *userp) {
  * @param contents 数据指针
  * @param size 单个数据块大小
  * @param nmemb 数据块数量
- * @param userp 用户数据指针
+ * @param userp 用户数据指针（ResponseWriter）
  * @return 写入的字节数
  */
 size_t WriteDownloadCallback(void *contents, size_t size, size_t nmemb, void *userp) {
     size_t totalSize = size * nmemb;
-    std::ofstream *file = static_cast<std::ofstream *>(userp);
-    if (file && file->is_open()) {
-        file->write(static_cast<char *>(contents), totalSize);
+    auto *writer = static_cast<ResponseWriter *>(userp);
+    const char *data = static_cast<char *>(contents);
+    size_t len = totalSize;
+    if (!DecryptResponseChunk(writer, data, len)) {
+        return 0; // 返回0中断传输
+    }
+    if (writer->file && !writer->file->Write(data, len)) {
+        return 0; // 写文件失败，中断传输
     }
     return totalSize;
 }
@@ -295,16 +554,36 @@ size_t WriteDownloadCallback(void *contents, size_t size, size_t nmemb, void *us
  * @param contents 数据指针
  * @param size 单个数据块大小
  * @param nmemb 数据块数量
- * @param userp 用户数据指针
+ * @param userp 用户数据指针（ResponseWriter）
  * @return 写入的字节数
  */
 size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp) {
-    ((std::string *)userp)->append((char *)contents, size * nmemb);
-    return size * nmemb;
+    size_t totalSize = size * nmemb;
+    auto *writer = static_cast<ResponseWriter *>(userp);
+    const char *data = static_cast<char *>(contents);
+    size_t len = totalSize;
+    if (!DecryptResponseChunk(writer, data, len)) {
+        return 0; // 返回0中断传输
+    }
+    writer->body->append(data, len);
+    return totalSize;
 }
 
+/**
+ * @brief 响应头回调上下文
+ */
+typedef struct HeaderContext {
+    CURL *curl = nullptr;                                         ///< cURL句柄
+    std::string *headers = nullptr;                               ///< 响应头接收缓冲区
+    const RedirectPolicy *redirect = nullptr;                     ///< 重定向策略
+    long status = 0;                                              ///< 当前响应的状态码
+    std::vector<std::pair<std::string, std::string>> permanent;   ///< 本次请求经过的301/308跳转
+    bool blocked = false;                                         ///< 跳转被同源策略阻止
+} HeaderContext;
+
 /**
  * @brief cURL响应头处理回调函数
+ * 每个响应（重定向的每一跳、1xx中间响应）开始时清空已接收的响应头，只保留最终响应的响应头
  * @param contents 头部数据指针
  * @param size 单个数据块大小
  * @param nmemb 数据块数量
@@ -312,8 +591,35 @@ size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp) {
  * @return 写入的字节数
  */
 size_t HeaderCallback(void *contents, size_t size, size_t nmemb, void *userp) {
-    ((std::string *)userp)->append((char *)contents, size * nmemb);
-    return size * nmemb;
+    HeaderContext *context = static_cast<HeaderContext *>(userp);
+    const char *data = static_cast<const char *>(contents);
+    size_t len = size * nmemb;
+    if (len > 5 && strncmp(data, "HTTP/", 5) == 0) {
+        context->headers->clear();
+        const char *code = static_cast<const char *>(memchr(data, ' ', len));
+        context->status = code ? strtol(code + 1, nullptr, 10) : 0;
+    } else if (context->redirect->follow && context->status >= 300 && context->status < 400 && len > 9 &&
+               strncasecmp(data, "Location:", 9) == 0) {
+        std::string location(data + 9, len - 9);
+        size_t begin = location.find_first_not_of(" \t");
+        size_t end = location.find_last_not_of(" \t\r\n");
+        char *current = nullptr;
+        std::string target;
+        if (begin != std::string::npos && curl_easy_getinfo(context->curl, CURLINFO_EFFECTIVE_URL, &current) ==
+                                              CURLE_OK && current &&
+            ResolveRedirectLocation(current, location.substr(begin, end - begin + 1), target)) {
+            if (context->redirect->sameOrigin && !IsSameOrigin(current, target)) {
+                // 中止传输
+                context->blocked = true;
+                return 0;
+            }
+            if (context->status == 301 || context->status == 308) {
+                context->permanent.emplace_back(current, target);
+            }
+        }
+    }
+    context->headers->append(data, len);
+    return len;
 }
 
 /**
@@ -370,6 +676,30 @@ static int debug_callback(CURL *handle, curl_infotype type, char *data, size_t s
     return 0;
 }
 
+/**
+ * @brief 检查请求是否被取消或所属env正在销毁（Worker终止），是则记录错误信息
+ * @param callback 回调数据
+ * @return 是否需要中断传输
+ */
+static bool IsRequestCanceled(RequestCallbackData *callback) {
+    if (callback->envState && callback->envState->closing) {
+        callback->params.errorMsg = "Request canceled: environment closing";
+        return true;
+    }
+    if (callback->envState && callback->params.requestId != 0) {
+        std::lock_guard<std::mutex> lock(callback->envState->mutex);
+        auto &cancelRequests = callback->envState->cancelRequests;
+        auto it = cancelRequests.find(callback->params.requestId);
+        if (it != cancelRequests.end() && it->second) {
+            // 删除map中的key
+            callback->params.errorMsg = "Request canceled by user";
+            cancelRequests.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  * @brief 进度回调函数
  * @param clientp 用户自定义数据指针
@@ -441,19 +771,500 @@ static int progress_callback(void *clientp, curl_off_t dltotal, curl_off_t dlnow
         callback->params.lastProgress = dlnow;
     }
 
-    // 检查是否被取消
-    if (callback && callback->params.requestId != 0) {
-        std::lock_guard<std::mutex> lock(mCancel_mtx);
-        auto it = mCancelRequestMap.find(callback->params.requestId);
-        if (it != mCancelRequestMap.end() && it->second) {
-            // 删除map中的key
-            callback->params.errorMsg = "Request canceled by user";
-            mCancelRequestMap.erase(it);
-            return 1; // 返回非零值中断传输
+    // 被取消时返回非零值中断传输
+    return callback && IsRequestCanceled(callback) ? 1 : 0;
+}
+
+/**
+ * @brief 查找请求头，先查本次请求的请求头，再查所属客户端的公共请求头
+ * @param params 请求参数
+ * @param name 请求头名称
+ * @return 请求头值，不存在返回nullptr
+ */
+static const std::string *FindRequestHeader(const HttpRequestParams &params, const std::string &name) {
+    auto it = params.headers.find(name);
+    if (it != params.headers.end()) {
+        return &it->second;
+    }
+    if (params.client) {
+        it = params.client->headers.find(name);
+        if (it != params.client->headers.end()) {
+            return &it->second;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 合并客户端公共请求头
+ * 公共请求头未被本次请求覆盖时直接复用预构建链表（只读），否则复制未被覆盖的部分到本次请求的链表
+ * @param params 请求参数
+ * @param headers 本次请求的请求头链表
+ * @param skipContentType 是否忽略公共请求头中的Content-Type
+ * @return 可直接复用的公共请求头链表，需要复制时返回nullptr
+ */
+static struct curl_slist *MergeClientHeaders(const HttpRequestParams &params, struct curl_slist *&headers,
+                                             bool skipContentType) {
+    if (!params.client || !params.client->defaultHeaders) {
+        return nullptr;
+    }
+    auto overridden = [&params, skipContentType](const std::string &name) {
+        if (skipContentType && strcasecmp(name.c_str(), "Content-Type") == 0) {
+            return true;
+        }
+        for (const auto &pair : params.headers) {
+            if (strcasecmp(pair.first.c_str(), name.c_str()) == 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+    bool anyOverridden = false;
+    for (const auto &pair : params.client->headers) {
+        anyOverridden = anyOverridden || overridden(pair.first);
+    }
+    if (!anyOverridden) {
+        return params.client->defaultHeaders;
+    }
+    for (const auto &pair : params.client->headers) {
+        if (!overridden(pair.first)) {
+            std::string header = pair.first + ": " + pair.second;
+            headers = curl_slist_append(headers, header.c_str());
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 故障注入启用时经本地代理的隧道转发（包括http://请求），未启用时清除句柄上残留的代理设置
+ * @param curl 请求句柄
+ */
+static void ApplyFaultProxy(CURL *curl) {
+    int faultPort = FaultInjector::Instance().Port();
+    if (faultPort > 0) {
+        std::string proxy = "http://127.0.0.1:" + std::to_string(faultPort);
+        curl_easy_setopt(curl, CURLOPT_PROXY, proxy.c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPPROXYTUNNEL, 1L);
+        curl_easy_setopt(curl, CURLOPT_NOPROXY, "");
+    } else {
+        curl_easy_setopt(curl, CURLOPT_PROXY, nullptr);
+        curl_easy_setopt(curl, CURLOPT_HTTPPROXYTUNNEL, 0L);
+        curl_easy_setopt(curl, CURLOPT_NOPROXY, nullptr);
+    }
+}
+
+/**
+ * @brief 设置传输层配置（压缩、CA证书、服务器验证、TLCP、客户端证书、故障注入代理、调试）
+ * @param curl cURL句柄
+ * @param params 请求参数
+ */
+static void ApplyTransportOptions(CURL *curl, const HttpRequestParams &params) {
+    // 设置压缩格式
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "gzip, deflate");
+
+    // 设置SSL证书路径
+    if (!params.caPath.empty()) {
+        curl_easy_setopt(curl, CURLOPT_CAINFO, params.caPath.c_str());
+    }
+
+    // 设置SSL验证
+    if (params.verifyServer) {
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
+    } else {
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
+    }
+
+    // 设置SSL版本和证书路径
+    if (params.isTLCP) {
+        curl_easy_setopt(curl, CURLOPT_SSLVERSION, CURL_SSLVERSION_NTLSv1_1);
+        if (!params.clientCertPath.empty()) {
+            auto encCert = params.clientCertPath + "client_enc.crt";
+            auto encKey = params.clientCertPath + "client_enc.key";
+            auto signCert = params.clientCertPath + "client_sign.crt";
+            auto signKey = params.clientCertPath + "client_sign.key";
+            // 设置客户端双证书
+            curl_easy_setopt(curl, CURLOPT_SSLENCCERT, encCert.c_str());
+            curl_easy_setopt(curl, CURLOPT_SSLENCKEY, encKey.c_str());
+            curl_easy_setopt(curl, CURLOPT_SSLSIGNCERT, signCert.c_str());
+            curl_easy_setopt(curl, CURLOPT_SSLSIGNKEY, signKey.c_str());
+        }
+    } else { // 非tlcp
+        if (!params.clientCertPath.empty()) {
+            // 设置客户端证书
+            auto cert = params.clientCertPath + "client.crt";
+            auto key = params.clientCertPath + "client.key";
+            curl_easy_setopt(curl, CURLOPT_SSLCERT, cert.c_str());
+            curl_easy_setopt(curl, CURLOPT_SSLKEY, key.c_str());
+        }
+    }
+    ApplyFaultProxy(curl);
+    // 设置调试模式
+    if (params.isDebug) {
+        // 开启调试模式
+        curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
+        // 设置调试回调函数
+        curl_easy_setopt(curl, CURLOPT_DEBUGFUNCTION, debug_callback);
+    }
+}
+
+/**
+ * @brief 传输登记守卫，ExecuteRequest任意路径返回时登记传输结束
+ */
+typedef struct TransferGuard {
+    explicit TransferGuard(EnvState *state) : state(state) {}
+    ~TransferGuard() {
+        if (state) {
+            state->Leave();
+        }
+    }
+    EnvState *state; ///< 所属env的请求状态
+} TransferGuard;
+
+/**
+ * @brief 断点续传上传的进度上下文
+ */
+typedef struct ResumableProgress {
+    RequestCallbackData *callbackData = nullptr; ///< 回调数据
+    int64_t offset = 0;                          ///< 本次请求开始前服务端已确认的位置
+    int64_t total = 0;                           ///< 文件大小
+} ResumableProgress;
+
+/**
+ * @brief 断点续传上传的进度回调，把分块请求的进度换算为整个文件的进度
+ */
+static int resumable_progress_callback(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal,
+                                       curl_off_t ulnow) {
+    auto *progress = static_cast<ResumableProgress *>(clientp);
+    return progress_callback(progress->callbackData, 0, 0, progress->total, progress->offset + ulnow);
+}
+
+/**
+ * @brief 多请求传输（分块上传、多范围读取）的附加请求头，本次请求的请求头优先于客户端公共请求头
+ * @param params 请求参数
+ */
+static std::vector<std::string> CollectHeaderLines(const HttpRequestParams &params) {
+    std::vector<std::string> headers;
+    for (const auto &pair : params.headers) {
+        headers.push_back(pair.first + ": " + pair.second);
+    }
+    if (params.client) {
+        for (const auto &pair : params.client->headers) {
+            if (params.headers.find(pair.first) == params.headers.end()) {
+                headers.push_back(pair.first + ": " + pair.second);
+            }
+        }
+    }
+    return headers;
+}
+
+/**
+ * @brief 设置分块上传请求的传输层配置与超时
+ * @param curl 请求句柄
+ * @param params 请求参数
+ */
+static void ConfigureUploadHandle(CURL *curl, const HttpRequestParams &params) {
+    ApplyTransportOptions(curl, params);
+    TransferEngine::Instance().Attach(curl);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, params.connectTimeout);
+    // 分块耗时随网络变化，以持续无数据传输的时间代替总超时
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, static_cast<long>(params.readTimeout));
+    curl_easy_setopt(curl, CURLOPT_UPLOAD_BUFFERSIZE, 131072L);
+}
+
+/**
+ * @brief 把分块上传结果写入请求参数
+ * @param params 请求参数
+ * @param result 上传结果
+ * @param protocolErrorCode 服务端响应不符合协议时的错误码
+ */
+static void ApplyUploadResult(HttpRequestParams &params, UploadResult &result, int protocolErrorCode) {
+    if (result.result == CURLE_OK && result.error.empty()) {
+        params.responseCode = result.status;
+        params.responseHeaders = std::move(result.headers);
+        params.response = std::move(result.body);
+    } else if (result.result == CURLE_READ_ERROR) {
+        params.errorMsg = result.error.empty() ? "Failed to read file for upload" : result.error;
+        params.responseCode = 101;
+    } else if (!result.error.empty()) {
+        params.errorMsg = result.error;
+        params.responseCode = protocolErrorCode;
+    } else {
+        params.responseCode = result.result;
+        if (params.errorMsg.empty()) {
+            params.errorMsg = std::string(curl_easy_strerror(result.result));
+        }
+    }
+}
+
+/**
+ * @brief 登记上游端点的请求结果：传输错误或5xx计为失败，取消或读取本地文件失败的请求不影响端点健康状态
+ * @param ticket 选中的端点（未选中时忽略）
+ * @param result 传输结果
+ * @param status HTTP状态码
+ * @param latency 首字节时间（毫秒），小于0表示没有样本
+ */
+static void FinishUpstream(UpstreamTicket &ticket, CURLcode result, long status, double latency) {
+    if (result == CURLE_ABORTED_BY_CALLBACK || result == CURLE_READ_ERROR) {
+        ticket.Abandon();
+        return;
+    }
+    bool success = (result == CURLE_OK || result == CURLE_HTTP_RETURNED_ERROR) && status < 500;
+    ticket.Finish(success, success ? latency : -1);
+}
+
+/**
+ * @brief 执行断点续传上传
+ * 按分块上传文件，网络中断后查询服务端位置继续，结果为最后一个请求的响应
+ * @param callbackData 回调数据
+ * @param ticket 选中的上游端点，结束时登记结果
+ */
+static void ExecuteResumableUpload(RequestCallbackData *callbackData, UpstreamTicket &ticket) {
+    HttpRequestParams &params = callbackData->params;
+    if (params.isSignature || params.isPayloadCipher) {
+        params.errorMsg = "Resumable upload does not support signature or payloadCipher";
+        params.responseCode = 118;
+        ticket.Abandon();
+        return;
+    }
+    ResumableProgress progress;
+    progress.callbackData = callbackData;
+    progress.total = static_cast<int64_t>(getFileSize(params.uploadFilePath));
+    UploadConfigurator configurator = [&params, &progress](CURL *curl, int64_t offset) {
+        ConfigureUploadHandle(curl, params);
+        progress.offset = offset;
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, resumable_progress_callback);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &progress);
+    };
+    ResumableUpload upload(params.url, params.uploadFilePath, params.resumable, CollectHeaderLines(params));
+    UploadResult result = upload.Run(configurator, [callbackData]() { return IsRequestCanceled(callbackData); });
+    // 由多个请求完成，没有单个首字节时间样本
+    FinishUpstream(ticket, result.result, result.status, -1);
+    ApplyUploadResult(params, result, 118);
+}
+
+/**
+ * @brief 执行并行分块上传
+ * 多个线程各自取用连接并行上传分块，调用线程汇总进度，结果为完成请求的响应
+ * @param callbackData 回调数据
+ * @param ticket 选中的上游端点，结束时登记结果
+ */
+static void ExecuteParallelUpload(RequestCallbackData *callbackData, UpstreamTicket &ticket) {
+    HttpRequestParams &params = callbackData->params;
+    if (params.isSignature || params.isPayloadCipher || params.resumable.enabled) {
+        params.errorMsg = "Parallel upload does not support signature, payloadCipher or resumableUpload";
+        params.responseCode = 119;
+        ticket.Abandon();
+        return;
+    }
+    // 配置回调在各分块线程中调用，只读取请求参数
+    UploadConfigurator configurator = [&params](CURL *curl, int64_t) { ConfigureUploadHandle(curl, params); };
+    UploadProgress progress = [callbackData](int64_t uploaded, int64_t total) {
+        return progress_callback(callbackData, 0, 0, total, uploaded) != 0;
+    };
+    ParallelUpload upload(params.url, params.uploadFilePath, params.parallel, CollectHeaderLines(params));
+    UploadResult result = upload.Run(configurator, progress);
+    FinishUpstream(ticket, result.result, result.status, -1);
+    ApplyUploadResult(params, result, 119);
+}
+
+/**
+ * @brief 执行多范围读取
+ * 先以一个多范围请求读取，服务端不支持时并行发送单范围请求，结果为与请求范围一一对应的数据
+ * @param callbackData 回调数据
+ * @param ticket 选中的上游端点，结束时登记结果
+ */
+static void ExecuteRangeFetch(RequestCallbackData *callbackData, UpstreamTicket &ticket) {
+    HttpRequestParams &params = callbackData->params;
+    RangeConfigurator configurator = [&params](CURL *curl) {
+        ApplyTransportOptions(curl, params);
+        // 范围响应按原始字节切分与校验长度，不协商压缩编码
+        curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, nullptr);
+        TransferEngine::Instance().Attach(curl);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, params.readTimeout);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, params.connectTimeout);
+        // 各范围请求不检查每一跳的来源，要求同源时不跟随重定向
+        bool follow = params.redirect.follow && !params.redirect.sameOrigin;
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, follow ? 1L : 0L);
+        if (follow) {
+            curl_easy_setopt(curl, CURLOPT_MAXREDIRS, static_cast<long>(params.redirect.maxRedirects));
+            curl_easy_setopt(curl, CURLOPT_REDIR_PROTOCOLS_STR, "http,https");
+        }
+    };
+    // 取消检查会写入错误信息，多个范围请求线程串行检查
+    std::mutex cancelMutex;
+    auto canceled = [callbackData, &cancelMutex]() {
+        std::lock_guard<std::mutex> lock(cancelMutex);
+        return IsRequestCanceled(callbackData);
+    };
+    RangeFetch fetch(params.url, params.ranges, CollectHeaderLines(params), params.rangeParallel);
+    RangeFetchResult result = fetch.Run(configurator, canceled);
+    FinishUpstream(ticket, result.result, result.status, -1);
+    if (result.result != CURLE_OK) {
+        params.responseCode = result.result;
+        if (params.errorMsg.empty()) {
+            params.errorMsg = std::string(curl_easy_strerror(result.result));
+        }
+    } else if (!result.error.empty()) {
+        params.errorMsg = result.error;
+        params.responseCode = 120;
+    } else if (result.status != 200 && result.status != 206) {
+        params.errorMsg = "Range request failed with HTTP status " + std::to_string(result.status);
+        params.responseCode = result.status;
+    } else {
+        params.responseCode = result.status;
+        params.responseHeaders = std::move(result.headers);
+        params.slices = std::move(result.slices);
+    }
+}
+
+/**
+ * @brief 响应体是否以ArrayBuffer返回
+ * @param contentType 响应的Content-Type
+ */
+static bool IsBinaryContentType(const std::string &contentType) {
+    return contentType.find("application/octet-stream") != std::string::npos ||
+           contentType.find("image/") != std::string::npos;
+}
+
+/**
+ * @brief 按responseCharset选项或Content-Type的charset解码文本响应体（在传输线程或缓存命中时调用）
+ * 无法识别的字符集按UTF-8处理；UTF-8响应在此校验，纯ASCII/Latin-1响应转为单字节，JS线程不再转码
+ * @param params 请求参数
+ */
+static void DecodeResponseText(HttpRequestParams &params) {
+    std::string contentType;
+    FindResponseHeader(params.responseHeaders, "Content-Type", contentType);
+    if (IsBinaryContentType(contentType)) {
+        return;
+    }
+    std::string name = params.responseCharset.empty() ? CharsetOfContentType(contentType) : params.responseCharset;
+    TextCharset charset = TextCharset::UTF8;
+    if (!name.empty()) {
+        ParseCharset(name, charset);
+    }
+    params.bodyForm = PrepareText(charset, params.response, params.decodedResponse);
+}
+
+/**
+ * @brief 紧凑响应格式（responseFormat为'packed'）的布局，所有整数为小端序
+ * - 0：uint32 魔数0x4B504D47（"GMPK"）
+ * - 4：uint16 版本号（1）
+ * - 6：uint16 标志位，bit0表示包含性能指标
+ * - 8：int32 响应码
+ * - 12：uint32 响应头数量
+ * - 16：uint32 响应头区长度（字节）
+ * - 20：uint32 响应体长度（字节）
+ * - 24：8个int32性能指标（毫秒，不存在时为-1），依次为dns、tcp、tls、firstSend、firstReceive、totalFinish、
+ *   redirect、total
+ * - 56：响应头区，每项为uint16名称长度、uint32值长度、名称（UTF-8）、值（UTF-8）
+ * - 响应头区之后：响应体原始字节（不做字符集转换）
+ */
+static constexpr uint32_t kPackedMagic = 0x4B504D47;
+static constexpr uint16_t kPackedVersion = 1;
+static constexpr uint16_t kPackedFlagTiming = 1;
+static constexpr size_t kPackedHeaderSize = 56;
+static constexpr size_t kPackedTotalTimingOffset = 52;
+
+/**
+ * @brief 按小端序写入整数
+ */
+static void PutLittleEndian(std::string &out, size_t offset, uint32_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out[offset + i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+    }
+}
+
+/**
+ * @brief 在传输线程中把响应打包为紧凑格式（总耗时在JS线程中补写）
+ * @param params 请求参数，打包后释放响应正文与响应头
+ */
+static void PackResponse(HttpRequestParams &params) {
+    std::map<std::string, std::string> headers = ParseHeaders(params.responseHeaders);
+    size_t headersLength = 0;
+    for (const auto &header : headers) {
+        headersLength += 6 + header.first.size() + header.second.size();
+    }
+    std::string &out = params.packedResponse;
+    out.assign(kPackedHeaderSize, '\0');
+    out.reserve(kPackedHeaderSize + headersLength + params.response.size());
+    const PerformanceTiming &timing = params.performanceTiming;
+    bool hasTiming = params.isPerformanceTiming && timing.totalFinishTiming >= 0;
+    PutLittleEndian(out, 0, kPackedMagic, 4);
+    PutLittleEndian(out, 4, kPackedVersion, 2);
+    PutLittleEndian(out, 6, hasTiming ? kPackedFlagTiming : 0, 2);
+    PutLittleEndian(out, 8, static_cast<uint32_t>(params.responseCode), 4);
+    PutLittleEndian(out, 12, static_cast<uint32_t>(headers.size()), 4);
+    PutLittleEndian(out, 16, static_cast<uint32_t>(headersLength), 4);
+    PutLittleEndian(out, 20, static_cast<uint32_t>(params.response.size()), 4);
+    const double timings[] = {timing.dnsTiming,          timing.tcpTiming,          timing.tlsTiming,
+                              timing.firstSendTiming,    timing.firstReceiveTiming, timing.totalFinishTiming,
+                              timing.redirectTiming};
+    for (size_t i = 0; i < 8; i++) {
+        int32_t value = -1;
+        if (hasTiming && i < 7 && timings[i] >= 0) {
+            value = static_cast<int32_t>(timings[i] * 1000);
         }
+        PutLittleEndian(out, 24 + i * 4, static_cast<uint32_t>(value), 4);
     }
+    for (const auto &header : headers) {
+        size_t offset = out.size();
+        out.resize(offset + 6);
+        PutLittleEndian(out, offset, static_cast<uint32_t>(header.first.size()), 2);
+        PutLittleEndian(out, offset + 2, static_cast<uint32_t>(header.second.size()), 4);
+        out.append(header.first).append(header.second);
+    }
+    out.append(params.response);
+    std::string().swap(params.response);
+    std::string().swap(params.responseHeaders);
+}
+
+/**
+ * @brief 准备响应数据（在传输线程或缓存命中时调用）：紧凑格式时打包，否则解码文本响应体
+ * @param params 请求参数
+ */
+static void PrepareResponse(HttpRequestParams &params) {
+    if (params.isPackedResponse) {
+        PackResponse(params);
+    } else {
+        DecodeResponseText(params);
+    }
+}
+
+/**
+ * @brief 释放外部ArrayBuffer持有的打包响应
+ */
+static void FinalizePackedResponse(napi_env env, void *data, void *hint) {
+    delete static_cast<std::string *>(hint);
+}
 
-    return 0; // 继续传输
+/**
+ * @brief 录制请求与响应（录制模式下，普通请求成功后调用）
+ */
+static void RecordExchange(CURL *curl, const HttpRequestParams &params) {
+    curl_off_t ttfb = 0;
+    curl_off_t total = 0;
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &ttfb);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    RecordedExchange exchange;
+    exchange.method = params.method;
+    exchange.url = params.url;
+    // 只有字符串与ArrayBuffer请求体按原样发送，可以在回放时按摘要匹配
+    bool hasBody = params.method != "GET" && params.method != "DELETE" && params.formData.empty() &&
+                   params.uploadFilePath.empty() && !params.isPayloadCipher;
+    if (hasBody && params.isExtraDataArrayBuffer) {
+        exchange.requestHash = RequestBodyHash(params.extraDataBuffer, params.extraDataBufferSize);
+    } else if (hasBody) {
+        exchange.requestHash = RequestBodyHash(params.extraDataStr.data(), params.extraDataStr.size());
+    }
+    exchange.status = params.responseCode;
+    exchange.ttfb = static_cast<int64_t>(ttfb / 1000);
+    exchange.total = static_cast<int64_t>(total / 1000);
+    exchange.body = params.response;
+    TrafficRecorder::Instance().Record(std::move(exchange), params.responseHeaders);
 }
 
 /**
@@ -463,9 +1274,73 @@ static int progress_callback(void *clientp, curl_off_t dltotal, curl_off_t dlnow
  */
 void ExecuteRequest(napi_env env, void *data) {
     RequestCallbackData *callbackData = reinterpret_cast<RequestCallbackData *>(data);
-    CURL *curl = curl_easy_init();
+    // 参数解析阶段已发现错误，直接返回
+    if (!callbackData->params.errorMsg.empty()) {
+        return;
+    }
+    // 在线程池中等待超过截止时间的请求不再启动
+    if (std::chrono::steady_clock::now() > callbackData->params.deadlineTime) {
+        callbackData->params.errorMsg = "Request expired before start";
+        callbackData->params.responseCode = 116;
+        callbackData->params.expired = true;
+        return;
+    }
+    // 所属env正在销毁时不再启动传输
+    EnvState *envState = callbackData->envState.get();
+    if (envState && !envState->Enter()) {
+        callbackData->params.errorMsg = "Request canceled: environment closing";
+        callbackData->params.responseCode = 103;
+        return;
+    }
+    TransferGuard transferGuard(envState);
+    // upstream://地址按延迟与进行中请求数选择端点，改写为端点地址
+    UpstreamTicket upstreamTicket;
+    if (UpstreamBalancer::IsUpstreamUrl(callbackData->params.url) &&
+        !UpstreamBalancer::Instance().Resolve(callbackData->params.url, upstreamTicket)) {
+        callbackData->params.errorMsg = "Unknown upstream group";
+        callbackData->params.responseCode = 121;
+        return;
+    }
+    // HSTS主机的http://请求直接改写为https://，省去重定向往返
+    OriginCache &originCache = OriginCache::Instance();
+    originCache.UpgradeUrl(callbackData->params.url);
+    // 多范围读取、并行分块上传与断点续传上传由多个请求完成
+    if (!callbackData->params.ranges.empty()) {
+        ExecuteRangeFetch(callbackData, upstreamTicket);
+        return;
+    }
+    if (callbackData->params.parallel.enabled && !callbackData->params.uploadFilePath.empty()) {
+        ExecuteParallelUpload(callbackData, upstreamTicket);
+        return;
+    }
+    if (callbackData->params.resumable.enabled && !callbackData->params.uploadFilePath.empty()) {
+        ExecuteResumableUpload(callbackData, upstreamTicket);
+        return;
+    }
+    // GET请求沿永久重定向缓存直接请求最终URL
+    std::string requestedUrl;
+    bool cachedRedirect = false;
+    if (callbackData->params.method == "GET") {
+        requestedUrl = callbackData->params.url;
+        cachedRedirect = RedirectCache::Instance().Resolve(callbackData->params.url, callbackData->params.redirect);
+    }
+    // 优先取用连接池中同一主机的空闲句柄（已重置，需重新设置传输层配置）
+    ConnectionPool &connectionPool = ConnectionPool::Instance();
+    std::string poolKey = ConnectionPool::KeyOf(callbackData->params.url);
+    CURL *curl = connectionPool.Acquire(poolKey);
+    bool pooled = curl != nullptr;
+    // 客户端请求复制模板句柄，覆盖了传输层配置时重新创建
+    bool useTemplate = callbackData->params.client && !callbackData->params.transportOverridden;
+    if (!curl) {
+        curl = useTemplate ? callbackData->params.client->DupHandle() : curl_easy_init();
+    }
+
+    // 备用服务连接条目，句柄归还/释放后再释放
+    std::unique_ptr<curl_slist, void (*)(curl_slist *)> connectToList(nullptr, curl_slist_free_all);
 
     if (!curl) {
+        connectionPool.Release(poolKey, nullptr, false);
+        upstreamTicket.Abandon();
         callbackData->params.errorMsg = "Curl initialization failed";
         callbackData->params.responseCode = 102;
         return;
@@ -475,70 +1350,47 @@ void ExecuteRequest(napi_env env, void *data) {
         // 设置请求URL
         curl_easy_setopt(curl, CURLOPT_URL, callbackData->params.url.c_str());
 
-        // 设置压缩格式
-        curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "gzip, deflate");
-
-        // 设置SSL证书路径
-        if (!callbackData->params.caPath.empty()) {
-            curl_easy_setopt(curl, CURLOPT_CAINFO, callbackData->params.caPath.c_str());
-        }
-
-        // 设置SSL验证
-        if (callbackData->params.verifyServer) {
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1);
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
+        // 设置传输层配置（模板句柄已包含）
+        if (!useTemplate || pooled) {
+            ApplyTransportOptions(curl, callbackData->params);
         } else {
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
-        }
-
-        // 设置SSL版本和证书路径
-        if (callbackData->params.isTLCP) {
-            curl_easy_setopt(curl, CURLOPT_SSLVERSION, CURL_SSLVERSION_NTLSv1_1);
-            if (!callbackData->params.clientCertPath.empty()) {
-                auto encCert = callbackData->params.clientCertPath + "client_enc.crt";
-                auto encKey = callbackData->params.clientCertPath + "client_enc.key";
-                auto signCert = callbackData->params.clientCertPath + "client_sign.crt";
-                auto signKey = callbackData->params.clientCertPath + "client_sign.key";
-                // 设置客户端双证书
-                curl_easy_setopt(curl, CURLOPT_SSLENCCERT, encCert.c_str());
-                curl_easy_setopt(curl, CURLOPT_SSLENCKEY, encKey.c_str());
-                curl_easy_setopt(curl, CURLOPT_SSLSIGNCERT, signCert.c_str());
-                curl_easy_setopt(curl, CURLOPT_SSLSIGNKEY, signKey.c_str());
-            }
-        } else { // 非tlcp
-            if (!callbackData->params.clientCertPath.empty()) {
-                // 设置客户端证书
-                auto cert = callbackData->params.clientCertPath + "client.crt";
-                auto key = callbackData->params.clientCertPath + "client.key";
-                curl_easy_setopt(curl, CURLOPT_SSLCERT, cert.c_str());
-                curl_easy_setopt(curl, CURLOPT_SSLKEY, key.c_str());
-            }
+            // 模板句柄创建后可能启用或停止了故障注入
+            ApplyFaultProxy(curl);
         }
-        // 设置调试模式
-        if (callbackData->params.isDebug) {
-            // 开启调试模式
-            curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
-            // 设置调试回调函数
-            curl_easy_setopt(curl, CURLOPT_DEBUGFUNCTION, debug_callback);
-        }
-        // 设置进度监听
-        if (callbackData->params.requestId != 0 || !callbackData->params.downloadFilePath.empty() ||
-            !callbackData->params.uploadFilePath.empty() || !callbackData->params.formData.empty()) {
-            curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L); // 必须设为 0 来启用进度功能
-            curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progress_callback);
-            curl_easy_setopt(curl, CURLOPT_XFERINFODATA, callbackData); // 传递参数
-            // 下载文件配置
-            if (!callbackData->params.downloadFilePath.empty()) {
-                curl_easy_setopt(curl, CURLOPT_BUFFERSIZE, 131072);
-                curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-            }
-            // 上传文件配置
-            if (!callbackData->params.uploadFilePath.empty()) {
-                curl_easy_setopt(curl, CURLOPT_BUFFERSIZE, 131072);
-                curl_easy_setopt(curl, CURLOPT_UPLOAD_BUFFERSIZE, 131072);
-                curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-            }
+        // 设置连接空闲/存活时间与keepalive
+        connectionPool.Prepare(curl);
+        // 已知h2备用服务时直连备用地址（TLCP连接不协商HTTP/2，不使用备用服务）
+        std::string connectTo;
+        bool useAltService =
+            !callbackData->params.isTLCP && originCache.FindAltService(callbackData->params.url, connectTo);
+        if (useAltService) {
+            connectToList.reset(curl_slist_append(nullptr, connectTo.c_str()));
+            curl_easy_setopt(curl, CURLOPT_CONNECT_TO, connectToList.get());
+            curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        }
+        // 接入进程级共享的DNS/TLS会话缓存
+        TransferEngine::Instance().Attach(curl);
+        // 设置进度监听（同时用于请求取消和env销毁时中断传输）
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L); // 必须设为 0 来启用进度功能
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progress_callback);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, callbackData); // 传递参数
+        // 接收缓冲区按该主机最近测得的带宽时延积设置（下载至少128KB，普通请求最大256KB）
+        long receiveBufferSize =
+            ReceiveTuner::Instance().BufferSize(poolKey, !callbackData->params.downloadFilePath.empty());
+        if (receiveBufferSize > 0) {
+            curl_easy_setopt(curl, CURLOPT_BUFFERSIZE, receiveBufferSize);
+        }
+        // 上传文件配置
+        if (!callbackData->params.uploadFilePath.empty()) {
+            curl_easy_setopt(curl, CURLOPT_UPLOAD_BUFFERSIZE, 131072);
+        }
+        // 重定向策略（所有请求类型）
+        const RedirectPolicy &redirect = callbackData->params.redirect;
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, redirect.follow ? 1L : 0L);
+        if (redirect.follow) {
+            curl_easy_setopt(curl, CURLOPT_MAXREDIRS, static_cast<long>(redirect.maxRedirects));
+            curl_easy_setopt(curl, CURLOPT_POSTREDIR, redirect.keepPost);
+            curl_easy_setopt(curl, CURLOPT_REDIR_PROTOCOLS_STR, "http,https");
         }
         // 设置请求方法
         if (callbackData->params.method == "POST") {
@@ -555,37 +1407,131 @@ void ExecuteRequest(napi_env env, void *data) {
         curl_easy_setopt(curl, CURLOPT_TIMEOUT, callbackData->params.readTimeout);
         curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, callbackData->params.connectTimeout);
 
-        // 设置请求头
-        struct curl_slist *headers = NULL;
-        // 上传文件
-        if (!callbackData->params.uploadFilePath.empty()) {
-            // 打开文件流
-            callbackData->params.uploadFile = new std::ifstream(callbackData->params.uploadFilePath, std::ios::binary);
-            if (!callbackData->params.uploadFile->is_open()) {
-                callbackData->params.errorMsg = "Failed to open file for upload";
-                callbackData->params.responseCode = 101;
-                return;
+        //  判断是否为 multipart/form-data 请求
+        bool isMultipart = false;
+        if (callbackData->params.method == "POST") {
+            const std::string *contentType = FindRequestHeader(callbackData->params, "Content-Type");
+            if (contentType && contentType->find("multipart/form-data") != std::string::npos) {
+                isMultipart = true;
             }
-            curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
-            // 设置读取回调
-            curl_easy_setopt(curl, CURLOPT_READFUNCTION, read_callback);
-            curl_easy_setopt(curl, CURLOPT_READDATA, &callbackData->params);
-            // 获取文件大小
-            std::ifstream::pos_type fileSize = getFileSize(callbackData->params.uploadFilePath);
-            if (fileSize > 0) {
-                curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(fileSize));
+        }
+
+        // 签名或加密时使用固定boundary的编码器，保证摘要与实际发送的请求体一致
+        bool encryptRequest = callbackData->params.isPayloadCipher && callbackData->params.payloadCipher.encryptRequest;
+        std::unique_ptr<MultipartEncoder> encoder;
+        if (isMultipart && (callbackData->params.isSignature || encryptRequest)) {
+            encoder.reset(new MultipartEncoder());
+            for (const auto &form : callbackData->params.formData) {
+                if (!form.filePath.empty()) {
+                    if (!encoder->AddFile(form.name, form.remoteFileName, form.contentType, form.filePath)) {
+                        callbackData->params.errorMsg = "Failed to open form file: " + form.filePath;
+                        callbackData->params.responseCode = 101;
+                        connectionPool.Release(poolKey, curl, false);
+                        upstreamTicket.Abandon();
+                        return;
+                    }
+                } else if (!form.isDataArrayBuffer) {
+                    encoder->AddData(form.name, form.remoteFileName, form.contentType, form.dataStr.data(),
+                                     form.dataStr.size());
+                } else {
+                    encoder->AddData(form.name, "", form.contentType, form.dataBuffer, form.dataBufferSize);
+                }
+            }
+            encoder->Finish();
+        }
+
+        // 需要流式处理的明文请求体：multipart编码器/上传文件/内存数据
+        std::unique_ptr<BodyReader> plainBodyHolder;
+        BodyReader *plainBody = encoder.get();
+        bool hasInlineBody =
+            callbackData->params.method != "GET" && callbackData->params.method != "DELETE" &&
+            ((callbackData->params.isExtraDataArrayBuffer && callbackData->params.extraDataBufferSize > 0) ||
+             !callbackData->params.extraDataStr.empty());
+        FileBodyReader *fileBody = nullptr;
+        if (!plainBody && !callbackData->params.uploadFilePath.empty()) {
+            // 上传文件由I/O引擎异步预读
+            fileBody = new FileBodyReader(callbackData->params.uploadFilePath);
+            plainBodyHolder.reset(fileBody);
+            if (!fileBody->IsOpen()) {
+                callbackData->params.errorMsg = "Failed to open file for upload";
+                callbackData->params.responseCode = 101;
+                connectionPool.Release(poolKey, curl, false);
+                upstreamTicket.Abandon();
+                return;
+            }
+            plainBody = fileBody;
+        } else if (!plainBody && (callbackData->params.isSignature || encryptRequest)) {
+            if (hasInlineBody && callbackData->params.isExtraDataArrayBuffer) {
+                plainBodyHolder.reset(new MemoryBodyReader(callbackData->params.extraDataBuffer,
+                                                           callbackData->params.extraDataBufferSize));
+            } else if (hasInlineBody) {
+                plainBodyHolder.reset(new MemoryBodyReader(callbackData->params.extraDataStr.data(),
+                                                           callbackData->params.extraDataStr.size()));
+            }
+            plainBody = plainBodyHolder.get();
+        }
+
+        // 载荷加密：请求体在读取路径中流式加密
+        std::string requestIv = callbackData->params.payloadCipher.iv;
+        if (callbackData->params.isPayloadCipher && requestIv.empty() &&
+            !GeneratePayloadIv(callbackData->params.payloadCipher.mode, requestIv)) {
+            callbackData->params.errorMsg = "Payload cipher failed: iv generation failed";
+            callbackData->params.responseCode = 113;
+            connectionPool.Release(poolKey, curl, false);
+            upstreamTicket.Abandon();
+            return;
+        }
+        std::unique_ptr<EncryptingBodyReader> encryptedBody;
+        if (encryptRequest && plainBody) {
+            encryptedBody.reset(new EncryptingBodyReader(callbackData->params.payloadCipher, requestIv, plainBody));
+            if (encryptedBody->Failed()) {
+                callbackData->params.errorMsg = "Payload cipher failed: invalid key or iv";
+                callbackData->params.responseCode = 113;
+                connectionPool.Release(poolKey, curl, false);
+                upstreamTicket.Abandon();
+                return;
             }
+        }
+        // 实际发送的流式请求体
+        BodyReader *streamBody = encryptedBody ? static_cast<BodyReader *>(encryptedBody.get()) : encoder.get();
+        if (!streamBody) {
+            streamBody = fileBody;
+        }
+
+        // 设置请求头
+        struct curl_slist *headers = NULL;
+        // 上传文件
+        if (!callbackData->params.uploadFilePath.empty()) {
+            curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+            // 由流式请求体读取（文件预读，或加密后的文件内容）
+            curl_easy_setopt(curl, CURLOPT_READFUNCTION, BodyReader::CurlRead);
+            curl_easy_setopt(curl, CURLOPT_READDATA, streamBody);
+            curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, BodyReader::CurlSeek);
+            curl_easy_setopt(curl, CURLOPT_SEEKDATA, streamBody);
+            curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(streamBody->TotalSize()));
             headers = curl_slist_append(headers, "Content-Type: application/octet-stream");
         }
         if (!callbackData->params.headers.empty()) {
             for (const auto &pair : callbackData->params.headers) {
+                if (encoder && pair.first == "Content-Type") {
+                    continue;
+                }
                 std::string header = pair.first + ": " + pair.second;
                 headers = curl_slist_append(headers, header.c_str());
             }
         }
 
+        // 客户端公共请求头
+        struct curl_slist *sharedHeaders = MergeClientHeaders(callbackData->params, headers, encoder != nullptr);
+
+        if (encoder) {
+            std::string contentType = "Content-Type: " + encoder->ContentType();
+            headers = curl_slist_append(headers, contentType.c_str());
+        }
+
         // 设置默认Content-Type
-        if (callbackData->params.headers.empty()) {
+        if (callbackData->params.headers.empty() &&
+            (!callbackData->params.client || callbackData->params.client->headers.empty())) {
             if (callbackData->params.method == "POST" || callbackData->params.method == "PUT" ||
                 callbackData->params.method == "DELETE") {
                 headers = curl_slist_append(headers, "Content-Type: application/json");
@@ -593,23 +1539,64 @@ void ExecuteRequest(napi_env env, void *data) {
                 headers = curl_slist_append(headers, "Content-Type: application/x-www-form-urlencoded");
             }
         }
-        //  设置请求头
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
-        //  判断是否为 multipart/form-data 请求
-        bool isMultipart = false;
-        if (callbackData->params.method == "POST" && !callbackData->params.headers.empty()) {
-            auto it = callbackData->params.headers.find("Content-Type");
-            if (it != callbackData->params.headers.end() &&
-                it->second.find("multipart/form-data") != std::string::npos) {
-                isMultipart = true;
+        // 传递载荷加密IV
+        if (callbackData->params.isPayloadCipher && !callbackData->params.payloadCipher.ivHeaderName.empty()) {
+            std::string ivHeader =
+                callbackData->params.payloadCipher.ivHeaderName + ": " + PayloadHexEncode(requestIv);
+            headers = curl_slist_append(headers, ivHeader.c_str());
+        }
+
+        // 请求签名（在异步线程中流式计算实际发送请求体的摘要）
+        if (callbackData->params.isSignature) {
+            SignInput input;
+            input.method = callbackData->params.method;
+            input.url = callbackData->params.url;
+            input.headers = headers;
+            input.sharedHeaders = sharedHeaders;
+            input.body = streamBody ? streamBody : plainBody;
+            std::vector<std::string> signHeaders;
+            std::string signError;
+            if (!SignRequest(callbackData->params.signature, input, signHeaders, signError)) {
+                callbackData->params.errorMsg = "Request signing failed: " + signError;
+                callbackData->params.responseCode = 112;
+                curl_slist_free_all(headers);
+                connectionPool.Release(poolKey, curl, false);
+                upstreamTicket.Abandon();
+                return;
+            }
+            for (const auto &header : signHeaders) {
+                headers = curl_slist_append(headers, header.c_str());
+            }
+        }
+
+        // 本次请求的请求头之后链接共享的公共请求头，请求结束后断开
+        struct curl_slist *headersTail = nullptr;
+        if (sharedHeaders) {
+            if (headers) {
+                for (headersTail = headers; headersTail->next; headersTail = headersTail->next) {
+                }
+                headersTail->next = sharedHeaders;
+            } else {
+                headers = sharedHeaders;
             }
         }
 
+        //  设置请求头
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
         // 处理请求体
         struct curl_httppost *formPost = nullptr;
         struct curl_httppost *lastPost = nullptr;
-        if (isMultipart) {
+        if (streamBody && callbackData->params.uploadFilePath.empty()) {
+            // 由编码器/加密器流式输出请求体
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(curl, CURLOPT_READFUNCTION, BodyReader::CurlRead);
+            curl_easy_setopt(curl, CURLOPT_READDATA, streamBody);
+            curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, BodyReader::CurlSeek);
+            curl_easy_setopt(curl, CURLOPT_SEEKDATA, streamBody);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(streamBody->TotalSize()));
+        } else if (isMultipart && !encoder) {
             for (const auto &form : callbackData->params.formData) {
                 if (!form.filePath.empty()) {
                     curl_formadd(&formPost, &lastPost, CURLFORM_COPYNAME, form.name.c_str(), CURLFORM_FILE,
@@ -644,63 +1631,140 @@ void ExecuteRequest(napi_env env, void *data) {
             }
         }
 
-        // 设置响应头接收缓冲区
-        std::string responseHeaders;
+        // 释放本次请求的请求头与表单（先断开共享的公共请求头）
+        auto freeRequestData = [&]() {
+            if (headersTail) {
+                headersTail->next = nullptr;
+            }
+            if (headers != sharedHeaders) {
+                curl_slist_free_all(headers);
+            }
+            if (isMultipart && !encoder) {
+                curl_formfree(formPost);
+            }
+        };
+
+        // 设置响应头接收缓冲区（直接写入请求参数，复用上下文时保留容量）
+        std::string &responseHeaders = callbackData->params.responseHeaders;
+        HeaderContext headerContext;
+        headerContext.curl = curl;
+        headerContext.headers = &responseHeaders;
+        headerContext.redirect = &callbackData->params.redirect;
         curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallback);
-        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &responseHeaders);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &headerContext);
 
-        std::string responseBody;
+        std::string &responseBody = callbackData->params.response;
+        ResponseWriter writer;
+        WriteBatcher batcher;
+        writer.curl = curl;
+        writer.responseHeaders = &responseHeaders;
+        if (callbackData->params.isPayloadCipher && callbackData->params.payloadCipher.decryptResponse) {
+            writer.cipherConfig = &callbackData->params.payloadCipher;
+            writer.requestIv = requestIv;
+            // 密文流无法从中间续传，解密下载总是从头开始
+            callbackData->params.resumeFromOffset = 0;
+        }
         // 设置下载文件接收缓冲区
         if (!callbackData->params.downloadFilePath.empty()) {
-            // 创建文件流并设置缓冲区
-            // 设置为不自动清空文件，允许追加写入
-            std::ios_base::openmode mode = std::ios::out | std::ios::binary;
-            callbackData->params.downloadFile =
-                new std::ofstream(callbackData->params.downloadFilePath,
-                                  callbackData->params.resumeFromOffset > 0 ? (mode | std::ios::app) : mode);
-            if (!callbackData->params.downloadFile->is_open()) {
+            // 续传时保留已下载的内容，由批量写入器按偏移异步写入
+            int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (callbackData->params.resumeFromOffset > 0 ? 0 : O_TRUNC);
+            callbackData->params.downloadFd = open(callbackData->params.downloadFilePath.c_str(), flags, 0644);
+            if (callbackData->params.downloadFd < 0) {
                 callbackData->params.errorMsg = "Failed to open downloadFile";
                 callbackData->params.responseCode = 101;
+                freeRequestData();
+                connectionPool.Release(poolKey, curl, false);
+                upstreamTicket.Abandon();
                 return;
             }
 
-            // 设置文件流缓冲区（64KB）
-            const size_t bufferSize = 131072; // 64KB
-            char *buffer = new char[bufferSize];
-            callbackData->params.downloadFile->rdbuf()->pubsetbuf(buffer, bufferSize);
-
-            // 保存缓冲区指针用于后续释放
-            callbackData->params.buffer = buffer; // 需要在DownloadContext中添加char* buffer;成员变量
+            // 写入块从复用池获取，大小随接收缓冲区调整
+            batcher.Open(callbackData->params.downloadFd, callbackData->params.resumeFromOffset,
+                         ReceiveTuner::BatchSize(receiveBufferSize));
             // 如果不是首次下载，启用断点续传
             if (callbackData->params.resumeFromOffset > 0) {
                 std::ostringstream range;
                 range << callbackData->params.resumeFromOffset << "-";
                 curl_easy_setopt(curl, CURLOPT_RANGE, range.str().c_str());
             }
+            writer.file = &batcher;
             curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteDownloadCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, callbackData->params.downloadFile);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &writer);
             curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L); // 返回错误时不写入文件
             curl_easy_setopt(curl, CURLOPT_TIMEOUT, 0); // 下载设置超时时间为无限大，表示不设置超时
         } else {                                        // 设置响应体接收缓冲区
+            writer.body = &responseBody;
             curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &writer);
         }
 
         // 执行请求
-        CURLcode res = curl_easy_perform(curl);
+        CURLcode res;
+        {
+            TransferWatch watch(envState, curl);
+            res = curl_easy_perform(curl);
+        }
+        if ((res == CURLE_OK || res == CURLE_HTTP_RETURNED_ERROR) && callbackData->params.verifyServer) {
+            // 只从已校验服务端证书的传输中记录HSTS、Alt-Svc与永久重定向，不可信的对端不能影响其他请求
+            originCache.Learn(curl);
+            for (const auto &hop : headerContext.permanent) {
+                RedirectCache::Instance().Store(hop.first, hop.second);
+            }
+        } else if (useAltService && (res == CURLE_COULDNT_RESOLVE_HOST || res == CURLE_COULDNT_CONNECT ||
+                                     res == CURLE_SSL_CONNECT_ERROR)) {
+            // 备用服务不可用，之后直连原主机
+            originCache.DropAltService(callbackData->params.url);
+        }
+        if (res == CURLE_OK && !FinishResponseWriter(&writer)) {
+            // 认证标签校验失败，丢弃已写入的明文
+            res = CURLE_WRITE_ERROR;
+        }
+        if (batcher.IsOpen() && !batcher.Close() && res == CURLE_OK) {
+            res = CURLE_WRITE_ERROR;
+        }
+        if (res == CURLE_OK) {
+            // 更新该主机的吞吐与RTT估计
+            ReceiveTuner::Instance().Record(poolKey, curl);
+        }
+        if (upstreamTicket.Valid()) {
+            // 登记端点结果，成功时以首字节时间更新延迟
+            long code = 0;
+            curl_off_t ttfb = 0;
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+            curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &ttfb);
+            FinishUpstream(upstreamTicket, res, code, static_cast<double>(ttfb) / 1000);
+        }
+        if (cachedRedirect) {
+            // 缓存的目标不再可用时删除，下次重新跟随重定向
+            long code = 0;
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+            if (res != CURLE_OK || code >= 400) {
+                RedirectCache::Instance().Forget(requestedUrl);
+            }
+        }
+        if (headerContext.blocked) {
+            callbackData->params.errorMsg = "Redirect to a different origin blocked";
+        } else if (writer.failed) {
+            callbackData->params.errorMsg = "Payload decrypt failed";
+        } else if (encryptedBody && encryptedBody->Failed()) {
+            callbackData->params.errorMsg = "Payload encrypt failed";
+        }
         if (res == CURLE_OK) {
             // 获取响应码
             long response_code;
             curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
             callbackData->params.responseCode = response_code;
-            // 保存响应头和响应体
-            callbackData->params.responseHeaders = responseHeaders;
+            // 响应头和响应体已直接写入请求参数
             if (!callbackData->params.downloadFilePath.empty()) {
                 //  下载完成
                 callbackData->params.response = "download finished";
             } else {
-                //  保存响应体
-                callbackData->params.response = responseBody;
+                if (TrafficRecorder::Instance().Active()) {
+                    RecordExchange(curl, callbackData->params);
+                }
+                if (!callbackData->params.isPackedResponse) {
+                    DecodeResponseText(callbackData->params);
+                }
             }
             // 获取性能数据
             if (callbackData->params.isPerformanceTiming) {
@@ -714,7 +1778,14 @@ void ExecuteRequest(napi_env env, void *data) {
                 curl_easy_getinfo(curl, CURLINFO_REDIRECT_TIME, &callbackData->params.performanceTiming.redirectTiming);
                 curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &callbackData->params.performanceTiming.totalFinishTiming);
             }
+            // 紧凑格式在取得性能数据后打包
+            if (callbackData->params.isPackedResponse) {
+                PackResponse(callbackData->params);
+            }
         } else {
+            // 失败时不返回已接收的部分响应
+            callbackData->params.responseHeaders.clear();
+            callbackData->params.response.clear();
             callbackData->params.responseCode = res;
             if (res == CURLE_HTTP_RETURNED_ERROR) { // CURLOPT_FAILONERROR为1时返回具体错误码
                 long response_code;
@@ -727,36 +1798,32 @@ void ExecuteRequest(napi_env env, void *data) {
                 callbackData->params.errorMsg = std::string(curl_easy_strerror(res));
             }
         }
+        if (headerContext.blocked) {
+            callbackData->params.responseCode = 117;
+        } else if (writer.failed || (encryptedBody && encryptedBody->Failed())) {
+            callbackData->params.responseCode = 113;
+        }
         // 清理
-        curl_slist_free_all(headers);
-        if (isMultipart) {
-            curl_formfree(formPost);
-        }
-        if (callbackData->params.downloadFile) {
-            //  关闭文件流并释放资源
-            callbackData->params.downloadFile->close();
-            delete callbackData->params.downloadFile;
-            callbackData->params.downloadFile = nullptr;
-        }
-        if (callbackData->params.uploadFile) {
-            callbackData->params.uploadFile->close();
-            delete callbackData->params.uploadFile;
-            callbackData->params.uploadFile = nullptr;
-        }
-        curl_easy_cleanup(curl);
+        freeRequestData();
+        if (callbackData->params.downloadFd >= 0) {
+            //  关闭文件（写入已在batcher.Close中全部完成）
+            close(callbackData->params.downloadFd);
+            callbackData->params.downloadFd = -1;
+            if (writer.failed) {
+                // 未通过认证的明文不保留
+                std::remove(callbackData->params.downloadFilePath.c_str());
+            }
+        }
+        // 成功（含HTTP错误码）的连接归还连接池，其余关闭
+        connectionPool.Release(poolKey, curl, res == CURLE_OK || res == CURLE_HTTP_RETURNED_ERROR);
     } catch (const std::exception &e) {
-        if (callbackData->params.downloadFile) {
-            //  关闭文件流并释放资源
-            callbackData->params.downloadFile->close();
-            delete callbackData->params.downloadFile;
-            callbackData->params.downloadFile = nullptr;
-        }
-        if (callbackData->params.uploadFile) {
-            callbackData->params.uploadFile->close();
-            delete callbackData->params.uploadFile;
-            callbackData->params.uploadFile = nullptr;
-        }
-        curl_easy_cleanup(curl);
+        if (callbackData->params.downloadFd >= 0) {
+            // 批量写入器已在离开作用域时等待写入完成
+            close(callbackData->params.downloadFd);
+            callbackData->params.downloadFd = -1;
+        }
+        connectionPool.Release(poolKey, curl, false);
+        upstreamTicket.Abandon();
         callbackData->params.responseCode = 2000;
         callbackData->params.errorMsg = std::string(e.what());
     }
@@ -786,14 +1853,210 @@ void ResponseErrorCB(napi_env &env, RequestCallbackData *&callbackData) {
 }
 
 /**
- * @brief 异步操作完成回调
- * 处理Promise解析/拒绝和资源清理
+ * @brief 复用上下文时保留容量的字符串上限，超出的字符串释放，避免缓存的上下文长期占用大块内存
+ */
+static const size_t kMaxRetainedCapacity = 65536;
+
+/**
+ * @brief 将回调数据重置为初始状态以便复用
+ * 请求参数恢复默认值，URL、请求体、响应头、响应体与表单列表保留已分配的容量
+ * @param callbackData 回调数据指针
+ */
+static void RecycleCallbackData(RequestCallbackData *callbackData) {
+    HttpRequestParams &params = callbackData->params;
+    std::string *retained[] = {&params.url, &params.extraDataStr, &params.responseHeaders, &params.response};
+    std::string kept[sizeof(retained) / sizeof(retained[0])];
+    for (size_t i = 0; i < sizeof(retained) / sizeof(retained[0]); i++) {
+        if (retained[i]->capacity() <= kMaxRetainedCapacity) {
+            kept[i].swap(*retained[i]);
+            kept[i].clear();
+        }
+    }
+    std::vector<FormData> formData;
+    formData.swap(params.formData);
+    formData.clear();
+
+    params = HttpRequestParams();
+    for (size_t i = 0; i < sizeof(retained) / sizeof(retained[0]); i++) {
+        retained[i]->swap(kept[i]);
+    }
+    params.formData.swap(formData);
+    callbackData->asyncWork = nullptr;
+    callbackData->deferred = nullptr;
+    callbackData->tsfn = nullptr;
+}
+
+/**
+ * @brief 释放回调数据
+ * @param env NAPI环境对象
+ * @param callbackData 回调数据指针
+ */
+static void ReleaseCallbackData(napi_env env, RequestCallbackData *callbackData) {
+    if (callbackData->params.foreground) {
+        PrefetchQueue::Instance().EndForeground();
+    }
+    // 清除requestID数据
+    if (callbackData->envState && callbackData->params.requestId != 0) {
+        std::lock_guard<std::mutex> lock(callbackData->envState->mutex);
+        auto &cancelRequests = callbackData->envState->cancelRequests;
+        auto it = cancelRequests.find(callbackData->params.requestId);
+        if (it != cancelRequests.end()) {
+            // 删除map中的key
+            cancelRequests.erase(it);
+        }
+    }
+    //  释放线程安全函数 避免内存泄漏
+    if (callbackData->tsfn) {
+        napi_release_threadsafe_function(callbackData->tsfn, napi_tsfn_abort);
+    }
+    if (callbackData->asyncWork) {
+        napi_delete_async_work(env, callbackData->asyncWork);
+    }
+    // 归还上下文
+    std::shared_ptr<EnvState> envState = std::move(callbackData->envState);
+    if (envState) {
+        RecycleCallbackData(callbackData);
+        envState->contextPool.Release(callbackData);
+    } else {
+        delete callbackData;
+    }
+}
+
+/**
+ * @brief 拒绝未启动的请求并释放
+ * @param env NAPI环境对象
+ * @param callbackData 回调数据指针
+ * @param code 错误码
+ * @param message 错误信息
+ */
+static void RejectRequest(napi_env env, RequestCallbackData *callbackData, int code, const char *message) {
+    callbackData->params.responseCode = code;
+    callbackData->params.errorMsg = message;
+    ResponseErrorCB(env, callbackData);
+    ReleaseCallbackData(env, callbackData);
+}
+
+void CompleteCB(napi_env env, napi_status status, void *data);
+
+/**
+ * @brief 创建并排队异步任务
+ * @param env NAPI环境对象
+ * @param callbackData 回调数据指针
+ */
+static void StartRequest(napi_env env, RequestCallbackData *callbackData) {
+    napi_value resourceName;
+    napi_create_string_utf8(env, "RequestCallback", NAPI_AUTO_LENGTH, &resourceName);
+    napi_create_async_work(env, nullptr, resourceName, ExecuteRequest, CompleteCB, callbackData,
+                           &callbackData->asyncWork);
+    napi_queue_async_work(env, callbackData->asyncWork);
+}
+
+/**
+ * @brief 排队截止时间定时器
+ * 执行槽位一直占满时没有请求结束来触发出队，由定时器在最早的截止时间到达时淘汰排队请求
+ */
+typedef struct QueueTimer {
+    uv_timer_t handle; ///< 定时器句柄
+    napi_env env;      ///< 所属env
+    EnvState *state;   ///< env级请求状态（env销毁前关闭定时器）
+} QueueTimer;
+
+/**
+ * @brief 拒绝已超过排队截止时间的请求
+ * @param env NAPI环境对象
+ * @param expired 已出队的请求
+ */
+static void RejectExpired(napi_env env, const std::vector<void *> &expired) {
+    for (void *request : expired) {
+        RejectRequest(env, static_cast<RequestCallbackData *>(request), 116, "Request expired in queue");
+    }
+}
+
+static void OnQueueTimer(uv_timer_t *handle);
+
+/**
+ * @brief 按排队请求中最早的截止时间设置定时器
+ * @param env NAPI环境对象
+ * @param state env级请求状态
+ */
+static void ScheduleQueueTimer(napi_env env, EnvState *state) {
+    AdmissionController::Clock::time_point deadline = state->admission.NextDeadline();
+    if (deadline == AdmissionController::Clock::time_point::max() || state->closing) {
+        if (state->queueTimer) {
+            uv_timer_stop(&state->queueTimer->handle);
+        }
+        return;
+    }
+    if (!state->queueTimer) {
+        uv_loop_s *loop = nullptr;
+        if (napi_get_uv_event_loop(env, &loop) != napi_ok || !loop) {
+            return;
+        }
+        auto *timer = new QueueTimer();
+        timer->env = env;
+        timer->state = state;
+        uv_timer_init(loop, &timer->handle);
+        timer->handle.data = timer;
+        // 定时器不阻止事件循环退出
+        uv_unref(reinterpret_cast<uv_handle_t *>(&timer->handle));
+        state->queueTimer = timer;
+    }
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - AdmissionController::Clock::now());
+    uint64_t timeout = static_cast<uint64_t>(std::max<int64_t>(wait.count() + 1, 0));
+    uv_timer_start(&state->queueTimer->handle, OnQueueTimer, timeout, 0);
+}
+
+/**
+ * @brief 关闭排队截止时间定时器（env销毁时）
+ * @param state env级请求状态
+ */
+static void CloseQueueTimer(EnvState *state) {
+    if (!state->queueTimer) {
+        return;
+    }
+    uv_timer_stop(&state->queueTimer->handle);
+    uv_close(reinterpret_cast<uv_handle_t *>(&state->queueTimer->handle),
+             [](uv_handle_t *handle) { delete static_cast<QueueTimer *>(handle->data); });
+    state->queueTimer = nullptr;
+}
+
+/**
+ * @brief 启动排队中的请求，丢弃已超过截止时间的请求
+ * @param env NAPI环境对象
+ * @param state env级请求状态
+ */
+static void DispatchQueued(napi_env env, EnvState *state) {
+    std::vector<void *> expired;
+    while (void *next = state->admission.Next(expired)) {
+        StartRequest(env, static_cast<RequestCallbackData *>(next));
+    }
+    RejectExpired(env, expired);
+    ScheduleQueueTimer(env, state);
+}
+
+/**
+ * @brief 定时器回调：淘汰到期的排队请求并重新设置定时器
+ */
+static void OnQueueTimer(uv_timer_t *handle) {
+    auto *timer = static_cast<QueueTimer *>(handle->data);
+    napi_handle_scope scope = nullptr;
+    napi_open_handle_scope(timer->env, &scope);
+    std::vector<void *> expired;
+    timer->state->admission.Expire(expired);
+    RejectExpired(timer->env, expired);
+    ScheduleQueueTimer(timer->env, timer->state);
+    if (scope) {
+        napi_close_handle_scope(timer->env, scope);
+    }
+}
+
+/**
+ * @brief 按请求结果解析或拒绝Promise
  * @param env NAPI环境对象
  * @param status 异步状态
- * @param data 回调数据指针
+ * @param callbackData 回调数据指针
  */
-void CompleteCB(napi_env env, napi_status status, void *data) {
-    RequestCallbackData *callbackData = reinterpret_cast<RequestCallbackData *>(data);
+static void SettleRequest(napi_env env, napi_status status, RequestCallbackData *callbackData) {
     try {
         if (status != napi_ok) {
             // 错误码+1000防止和curl错误冲突
@@ -801,6 +2064,39 @@ void CompleteCB(napi_env env, napi_status status, void *data) {
             ResponseErrorCB(env, callbackData);
         } else if (!callbackData->params.errorMsg.empty()) {
             ResponseErrorCB(env, callbackData);
+        } else if (!callbackData->params.ranges.empty()) {
+            // 多范围读取返回与请求范围一一对应的ArrayBuffer数组
+            const std::vector<std::string> &slices = callbackData->params.slices;
+            napi_value result;
+            napi_create_array_with_length(env, slices.size(), &result);
+            for (size_t i = 0; i < slices.size(); i++) {
+                napi_value arrayBuffer;
+                void *bufferData = nullptr;
+                napi_create_arraybuffer(env, slices[i].size(), &bufferData, &arrayBuffer);
+                if (bufferData != nullptr && !slices[i].empty()) {
+                    memcpy(bufferData, slices[i].data(), slices[i].size());
+                }
+                napi_set_element(env, result, static_cast<uint32_t>(i), arrayBuffer);
+            }
+            napi_resolve_deferred(env, callbackData->deferred, result);
+        } else if (callbackData->params.isPackedResponse) {
+            // 紧凑格式：补写总耗时后把打包的内存直接作为外部ArrayBuffer返回，不再复制
+            HttpRequestParams &params = callbackData->params;
+            if (params.isPerformanceTiming && params.packedResponse.size() >= kPackedHeaderSize &&
+                params.performanceTiming.totalFinishTiming >= 0) {
+                auto total = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - params.performanceTiming.startTime)
+                                 .count();
+                PutLittleEndian(params.packedResponse, kPackedTotalTimingOffset, static_cast<uint32_t>(total), 4);
+            }
+            std::string *packed = new std::string(std::move(params.packedResponse));
+            napi_value result;
+            if (napi_create_external_arraybuffer(env, &(*packed)[0], packed->size(), FinalizePackedResponse, packed,
+                                                 &result) != napi_ok) {
+                delete packed;
+                throw std::runtime_error("Failed to create packed response");
+            }
+            napi_resolve_deferred(env, callbackData->deferred, result);
         } else {
             // 解析Promise
             napi_value result;
@@ -832,9 +2128,7 @@ void CompleteCB(napi_env env, napi_status status, void *data) {
             }
 
             // 解析响应体
-            if ((contentType.find("application/octet-stream") != std::string::npos ||
-                 contentType.find("image/") != std::string::npos) &&
-                callbackData->params.downloadFilePath.empty()) {
+            if (IsBinaryContentType(contentType) && callbackData->params.downloadFilePath.empty()) {
                 // 返回 ArrayBuffer
                 napi_value arrayBuffer;
                 void *bufferData;
@@ -844,9 +2138,19 @@ void CompleteCB(napi_env env, napi_status status, void *data) {
                 }
                 napi_set_named_property(env, result, "body", arrayBuffer);
             } else {
+                // 文本已在传输线程中校验并转换，按存放形式直接创建字符串
                 napi_value responseBodyVal;
-                napi_create_string_utf8(env, callbackData->params.response.c_str(),
-                                        callbackData->params.response.length(), &responseBodyVal);
+                const HttpRequestParams &params = callbackData->params;
+                if (params.bodyForm == TextForm::LATIN1) {
+                    napi_create_string_latin1(env, params.response.c_str(), params.response.length(),
+                                              &responseBodyVal);
+                } else if (params.bodyForm == TextForm::UTF16) {
+                    napi_create_string_utf16(env, params.decodedResponse.c_str(), params.decodedResponse.length(),
+                                             &responseBodyVal);
+                } else {
+                    napi_create_string_utf8(env, params.response.c_str(), params.response.length(),
+                                            &responseBodyVal);
+                }
                 napi_set_named_property(env, result, "body", responseBodyVal);
             }
 
@@ -888,23 +2192,29 @@ void CompleteCB(napi_env env, napi_status status, void *data) {
         callbackData->params.errorMsg = std::string(e.what());
         ResponseErrorCB(env, callbackData);
     }
-    // 清除requestID数据
-    if (callbackData && callbackData->params.requestId != 0) {
-        std::lock_guard<std::mutex> lock(mCancel_mtx);
-        auto it = mCancelRequestMap.find(callbackData->params.requestId);
-        if (it != mCancelRequestMap.end()) {
-            // 删除map中的key
-            mCancelRequestMap.erase(it);
+}
+
+/**
+ * @brief 异步操作完成回调
+ * 处理Promise解析/拒绝和资源清理
+ * @param env NAPI环境对象
+ * @param status 异步状态
+ * @param data 回调数据指针
+ */
+void CompleteCB(napi_env env, napi_status status, void *data) {
+    RequestCallbackData *callbackData = reinterpret_cast<RequestCallbackData *>(data);
+    SettleRequest(env, status, callbackData);
+    std::shared_ptr<EnvState> envState = callbackData->envState;
+    bool expired = callbackData->params.expired;
+    ReleaseCallbackData(env, callbackData);
+    // 释放执行槽位，启动排队中的请求
+    if (envState) {
+        if (expired) {
+            envState->admission.RecordExpired();
         }
+        envState->admission.Finish();
+        DispatchQueued(env, envState.get());
     }
-    //  释放线程安全函数 避免内存泄漏
-    if (callbackData->tsfn) {
-        napi_release_threadsafe_function(callbackData->tsfn, napi_tsfn_abort);
-    }
-    napi_delete_async_work(env, callbackData->asyncWork);
-    // 释放内存
-    delete callbackData->params.buffer;
-    delete callbackData;
 }
 
 /**
@@ -1089,291 +2399,2190 @@ void convertFormData(struct napi_env__ *env, RequestCallbackData *callbackData,
 }
 
 /**
- * @brief 主请求处理函数
- * 创建并配置异步请求对象
+ * @brief 读取字符串值（不限长度）
  * @param env NAPI环境对象
- * @param info 回调信息
- * @return Promise对象
+ * @param value JS值
+ * @param out 输出字符串
+ * @return 值为字符串时返回true
  */
-napi_value Request(napi_env env, napi_callback_info info) {
-    size_t argc = 1;
-    napi_value args[1];
-    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+bool GetStringValue(napi_env env, napi_value value, std::string &out) {
+    size_t len = 0;
+    if (napi_get_value_string_utf8(env, value, nullptr, 0, &len) != napi_ok) {
+        return false;
+    }
+    std::string str(len + 1, '\0');
+    napi_get_value_string_utf8(env, value, &str[0], str.size(), &len);
+    str.resize(len);
+    out = str;
+    return true;
+}
 
-    // 创建Promise
-    napi_value promise;
-    napi_deferred deferred;
-    napi_create_promise(env, &deferred, &promise);
+/**
+ * @brief 读取对象的字符串属性（不限长度）
+ * @param env NAPI环境对象
+ * @param obj JS对象
+ * @param name 属性名
+ * @param out 输出字符串
+ * @return 属性存在且为字符串时返回true
+ */
+bool GetStringProperty(napi_env env, napi_value obj, const char *name, std::string &out) {
+    bool hasProp = false;
+    napi_has_named_property(env, obj, name, &hasProp);
+    if (!hasProp) {
+        return false;
+    }
+    napi_value value;
+    napi_get_named_property(env, obj, name, &value);
+    return GetStringValue(env, value, out);
+}
 
-    // 创建回调数据
-    RequestCallbackData *callbackData = new RequestCallbackData();
-    callbackData->deferred = deferred;
+/**
+ * @brief 读取对象的字符串数组属性
+ * @param env NAPI环境对象
+ * @param obj JS对象
+ * @param name 属性名
+ * @param out 输出字符串数组
+ * @return 属性存在且为数组时返回true
+ */
+bool GetStringArrayProperty(napi_env env, napi_value obj, const char *name, std::vector<std::string> &out) {
+    bool hasProp = false;
+    napi_has_named_property(env, obj, name, &hasProp);
+    if (!hasProp) {
+        return false;
+    }
+    napi_value array;
+    napi_get_named_property(env, obj, name, &array);
+    bool isArray = false;
+    napi_is_array(env, array, &isArray);
+    if (!isArray) {
+        return false;
+    }
+    uint32_t length = 0;
+    napi_get_array_length(env, array, &length);
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value item;
+        napi_get_element(env, array, i, &item);
+        char itemStr[256];
+        size_t itemLen = 0;
+        if (napi_get_value_string_utf8(env, item, itemStr, sizeof(itemStr), &itemLen) == napi_ok) {
+            out.push_back(std::string(itemStr, itemLen));
+        }
+    }
+    return true;
+}
 
-    // 解析参数
-    if (argc >= 1 && args[0] != nullptr) {
-        napi_valuetype type;
-        napi_typeof(env, args[0], &type);
+/**
+ * @brief 转换签名配置
+ * @param env NAPI环境对象
+ * @param callbackData 回调数据
+ * @param signatureProp 签名配置对象
+ */
+void convertSignature(napi_env env, RequestCallbackData *callbackData, napi_value &signatureProp) {
+    SignatureConfig &config = callbackData->params.signature;
+    config = SignatureConfig();
+    std::string algorithm;
+    if (!GetStringProperty(env, signatureProp, "algorithm", algorithm) ||
+        !ParseSignatureAlgorithm(algorithm, config.algorithm)) {
+        callbackData->params.errorMsg = "Unsupported signature algorithm: " + algorithm;
+        callbackData->params.responseCode = 112;
+        return;
+    }
+    GetStringProperty(env, signatureProp, "key", config.key);
+    GetStringProperty(env, signatureProp, "keyPath", config.keyPath);
+    GetStringProperty(env, signatureProp, "sm2Id", config.sm2Id);
+    GetStringProperty(env, signatureProp, "keyId", config.keyId);
+    GetStringProperty(env, signatureProp, "headerName", config.headerName);
+    GetStringProperty(env, signatureProp, "headerTemplate", config.headerTemplate);
+    GetStringProperty(env, signatureProp, "digestHeaderName", config.digestHeaderName);
+    GetStringProperty(env, signatureProp, "timestampHeaderName", config.timestampHeaderName);
+    GetStringArrayProperty(env, signatureProp, "signedHeaders", config.signedHeaders);
+    for (auto &name : config.signedHeaders) {
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char ch) { return std::tolower(ch); });
+    }
+    if (!GetStringArrayProperty(env, signatureProp, "canonical", config.canonical) || config.canonical.empty()) {
+        config.canonical = {"method", "path", "query", "headers", "bodyDigest"};
+    }
+    std::string encoding;
+    if (GetStringProperty(env, signatureProp, "encoding", encoding)) {
+        config.hexEncoding = encoding == "hex";
+    }
+    callbackData->params.isSignature = true;
+}
 
-        if (type == napi_object) {
-            // 解析performanceTiming
-            napi_value performanceTimingProp;
-            napi_get_named_property(env, args[0], "performanceTiming", &performanceTimingProp);
-            bool isPerformanceTiming;
-            if (napi_get_value_bool(env, performanceTimingProp, &isPerformanceTiming) == napi_ok &&
-                isPerformanceTiming) {
-                callbackData->params.isPerformanceTiming = isPerformanceTiming;
-                auto now = std::chrono::steady_clock::now();
-                PerformanceTiming timing;
-                timing.startTime = now;
-                timing.totalTiming = 0;
-                callbackData->params.performanceTiming = timing;
-            } else {
-                callbackData->params.isPerformanceTiming = false;
-            }
+/**
+ * @brief 读取对象的布尔属性
+ * @param env NAPI环境对象
+ * @param obj JS对象
+ * @param name 属性名
+ * @param out 输出值，属性不存在时保持不变
+ * @return 属性存在且为布尔值时返回true
+ */
+bool GetBoolProperty(napi_env env, napi_value obj, const char *name, bool &out) {
+    napi_value value;
+    bool result;
+    if (napi_get_named_property(env, obj, name, &value) == napi_ok &&
+        napi_get_value_bool(env, value, &result) == napi_ok) {
+        out = result;
+        return true;
+    }
+    return false;
+}
 
-            // 解析url
-            napi_value urlProp;
-            napi_get_named_property(env, args[0], "url", &urlProp);
-
-            char url[1024];
-            size_t urlLen;
-            napi_get_value_string_utf8(env, urlProp, url, sizeof(url), &urlLen);
-            callbackData->params.url = std::string(url);
-
-            // 解析method
-            bool hasMethodProp;
-            napi_has_named_property(env, args[0], "method", &hasMethodProp);
-            if (hasMethodProp) {
-                napi_value methodProp;
-                napi_get_named_property(env, args[0], "method", &methodProp);
-                char method[32];
-                size_t methodLen;
-                napi_get_value_string_utf8(env, methodProp, method, sizeof(method), &methodLen);
-                callbackData->params.method = std::string(method);
-            } else {
-                callbackData->params.method = "GET";
-            }
+/**
+ * @brief 读取对象的数字属性
+ * @param env NAPI环境对象
+ * @param obj JS对象
+ * @param name 属性名
+ * @param out 输出值，属性不存在时保持不变
+ * @return 属性存在且为数字时返回true
+ */
+static bool GetInt64Property(napi_env env, napi_value obj, const char *name, int64_t &out) {
+    napi_value value;
+    int64_t result;
+    if (napi_get_named_property(env, obj, name, &value) == napi_ok &&
+        napi_get_value_int64(env, value, &result) == napi_ok) {
+        out = result;
+        return true;
+    }
+    return false;
+}
 
-            // 解析readTimeout
-            bool hasReadTimeoutProp;
-            napi_has_named_property(env, args[0], "readTimeout", &hasReadTimeoutProp);
-            if (hasReadTimeoutProp) {
-                napi_value readTimeoutProp;
-                napi_get_named_property(env, args[0], "readTimeout", &readTimeoutProp);
-                int32_t readTimeout;
-                napi_get_value_int32(env, readTimeoutProp, &readTimeout);
-                callbackData->params.readTimeout = readTimeout;
-            } else {
-                callbackData->params.readTimeout = 15;
+/**
+ * @brief 读取对象的浮点数属性
+ * @param env NAPI环境对象
+ * @param obj JS对象
+ * @param name 属性名
+ * @param out 输出值，属性不存在时保持不变
+ * @return 属性存在且为数字时返回true
+ */
+static bool GetDoubleProperty(napi_env env, napi_value obj, const char *name, double &out) {
+    napi_value value;
+    double result;
+    if (napi_get_named_property(env, obj, name, &value) == napi_ok &&
+        napi_get_value_double(env, value, &result) == napi_ok) {
+        out = result;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 转换载荷加密配置
+ * @param env NAPI环境对象
+ * @param callbackData 回调数据
+ * @param cipherProp 载荷加密配置对象
+ */
+void convertPayloadCipher(napi_env env, RequestCallbackData *callbackData, napi_value &cipherProp) {
+    PayloadCipherConfig &config = callbackData->params.payloadCipher;
+    config = PayloadCipherConfig();
+    callbackData->params.isPayloadCipher = true;
+    std::string algorithm;
+    if (GetStringProperty(env, cipherProp, "algorithm", algorithm) &&
+        !ParsePayloadCipherMode(algorithm, config.mode)) {
+        callbackData->params.errorMsg = "Unsupported payload cipher: " + algorithm;
+        callbackData->params.responseCode = 113;
+        return;
+    }
+    std::string key;
+    GetStringProperty(env, cipherProp, "key", key);
+    if (!PayloadHexDecode(key, config.key) || config.key.size() != 16) {
+        callbackData->params.errorMsg = "Payload cipher key must be 16 bytes hex";
+        callbackData->params.responseCode = 113;
+        return;
+    }
+    std::string iv;
+    if (GetStringProperty(env, cipherProp, "iv", iv) && !PayloadHexDecode(iv, config.iv)) {
+        callbackData->params.errorMsg = "Payload cipher iv must be hex";
+        callbackData->params.responseCode = 113;
+        return;
+    }
+    GetStringProperty(env, cipherProp, "aad", config.aad);
+    GetStringProperty(env, cipherProp, "ivHeaderName", config.ivHeaderName);
+    GetBoolProperty(env, cipherProp, "encryptRequest", config.encryptRequest);
+    GetBoolProperty(env, cipherProp, "decryptResponse", config.decryptResponse);
+}
+
+/**
+ * @brief 解析重定向策略
+ * @param env NAPI环境对象
+ * @param callbackData 回调数据
+ * @param redirectProp 重定向策略对象
+ */
+void convertRedirect(napi_env env, RequestCallbackData *callbackData, napi_value redirectProp) {
+    RedirectPolicy &policy = callbackData->params.redirect;
+    GetBoolProperty(env, redirectProp, "follow", policy.follow);
+    GetBoolProperty(env, redirectProp, "sameOrigin", policy.sameOrigin);
+    int64_t maxRedirects;
+    if (GetInt64Property(env, redirectProp, "maxRedirects", maxRedirects)) {
+        policy.maxRedirects = static_cast<int>(std::max<int64_t>(maxRedirects, 0));
+    }
+    // 在这些状态码跳转时保持POST方法，其余改为GET
+    napi_value keepPostOn;
+    bool isArray = false;
+    if (napi_get_named_property(env, redirectProp, "keepPostOn", &keepPostOn) == napi_ok &&
+        napi_is_array(env, keepPostOn, &isArray) == napi_ok && isArray) {
+        uint32_t length = 0;
+        napi_get_array_length(env, keepPostOn, &length);
+        policy.keepPost = 0;
+        for (uint32_t i = 0; i < length; i++) {
+            napi_value element;
+            int32_t code = 0;
+            napi_get_element(env, keepPostOn, i, &element);
+            if (napi_get_value_int32(env, element, &code) != napi_ok) {
+                continue;
+            }
+            if (code == 301) {
+                policy.keepPost |= CURL_REDIR_POST_301;
+            } else if (code == 302) {
+                policy.keepPost |= CURL_REDIR_POST_302;
+            } else if (code == 303) {
+                policy.keepPost |= CURL_REDIR_POST_303;
             }
+        }
+    }
+}
 
-            // 解析connectTimeout
-            bool hasConnectTimeoutProp;
-            napi_has_named_property(env, args[0], "connectTimeout", &hasConnectTimeoutProp);
-            if (hasReadTimeoutProp) {
-                napi_value connectTimeoutProp;
-                napi_get_named_property(env, args[0], "connectTimeout", &connectTimeoutProp);
-                int32_t connectTimeout;
-                napi_get_value_int32(env, connectTimeoutProp, &connectTimeout);
-                callbackData->params.connectTimeout = connectTimeout;
-            } else {
-                callbackData->params.connectTimeout = 15;
+/**
+ * @brief 解析断点续传上传配置
+ * @param env NAPI环境对象
+ * @param callbackData 回调数据
+ * @param resumableProp 断点续传配置对象
+ */
+void convertResumableUpload(napi_env env, RequestCallbackData *callbackData, napi_value resumableProp) {
+    ResumableUploadConfig &config = callbackData->params.resumable;
+    config.enabled = true;
+    std::string protocol;
+    if (GetStringProperty(env, resumableProp, "protocol", protocol)) {
+        if (protocol == "tus") {
+            config.protocol = UploadProtocol::TUS;
+        } else if (protocol == "contentRange") {
+            config.protocol = UploadProtocol::CONTENT_RANGE;
+        } else {
+            callbackData->params.errorMsg = "Unsupported resumable upload protocol: " + protocol;
+            callbackData->params.responseCode = 118;
+            return;
+        }
+    }
+    int64_t value;
+    if (GetInt64Property(env, resumableProp, "chunkSize", value) && value > 0) {
+        config.chunkSize = value;
+    }
+    if (GetInt64Property(env, resumableProp, "maxRetries", value)) {
+        config.maxRetries = static_cast<int>(std::max<int64_t>(value, 0));
+    }
+}
+
+/**
+ * @brief 解析并行分块上传配置
+ * @param env NAPI环境对象
+ * @param callbackData 回调数据
+ * @param parallelProp 并行分块上传配置对象
+ */
+void convertParallelUpload(napi_env env, RequestCallbackData *callbackData, napi_value parallelProp) {
+    ParallelUploadConfig &config = callbackData->params.parallel;
+    config.enabled = true;
+    int64_t value;
+    if (GetInt64Property(env, parallelProp, "partSize", value) && value > 0) {
+        config.partSize = value;
+    }
+    if (GetInt64Property(env, parallelProp, "concurrency", value) && value > 0) {
+        config.concurrency = static_cast<int>(std::min<int64_t>(value, 16));
+    }
+    if (GetInt64Property(env, parallelProp, "maxRetries", value)) {
+        config.maxRetries = static_cast<int>(std::max<int64_t>(value, 0));
+    }
+    bool hasCredentials = false;
+    napi_value credentials;
+    napi_valuetype type = napi_undefined;
+    if (napi_has_named_property(env, parallelProp, "credentials", &hasCredentials) != napi_ok || !hasCredentials ||
+        napi_get_named_property(env, parallelProp, "credentials", &credentials) != napi_ok ||
+        napi_typeof(env, credentials, &type) != napi_ok || type != napi_object) {
+        return;
+    }
+    GetStringProperty(env, credentials, "accessKeyId", config.accessKeyId);
+    GetStringProperty(env, credentials, "secretAccessKey", config.secretAccessKey);
+    GetStringProperty(env, credentials, "sessionToken", config.sessionToken);
+    std::string region;
+    if (GetStringProperty(env, credentials, "region", region) && !region.empty()) {
+        config.region = region;
+    }
+    if (config.accessKeyId.empty() || config.secretAccessKey.empty()) {
+        callbackData->params.errorMsg = "Parallel upload credentials require accessKeyId and secretAccessKey";
+        callbackData->params.responseCode = 119;
+    }
+}
+
+/**
+ * @brief 请求参数属性名
+ */
+enum OptionKey {
+    OPT_URL,
+    OPT_METHOD,
+    OPT_EXTRA_DATA,
+    OPT_HEADERS,
+    OPT_READ_TIMEOUT,
+    OPT_CONNECT_TIMEOUT,
+    OPT_CA_PATH,
+    OPT_CLIENT_CERT_PATH,
+    OPT_IS_TLCP,
+    OPT_VERIFY_SERVER,
+    OPT_DEBUG,
+    OPT_REQUEST_ID,
+    OPT_MULTI_FORM_DATA_LIST,
+    OPT_DOWNLOAD_FILE_PATH,
+    OPT_UPLOAD_FILE_PATH,
+    OPT_ON_PROGRESS,
+    OPT_PERFORMANCE_TIMING,
+    OPT_SIGNATURE,
+    OPT_PAYLOAD_CIPHER,
+    OPT_BASE_URL,
+    OPT_PRIORITY,
+    OPT_DEADLINE,
+    OPT_REDIRECT,
+    OPT_RESUMABLE_UPLOAD,
+    OPT_PARALLEL_UPLOAD,
+    OPT_RESPONSE_CHARSET,
+    OPT_RESPONSE_FORMAT,
+    OPT_COUNT
+};
+
+/**
+ * @brief 属性名字符串，与OptionKey一一对应
+ */
+static const char *const kOptionKeyNames[OPT_COUNT] = {
+    "url",           "method",           "extraData",         "headers",
+    "readTimeout",   "connectTimeout",   "caPath",            "clientCertPath",
+    "isTLCP",        "verifyServer",     "debug",             "requestID",
+    "multiFormDataList", "downloadFilePath", "uploadFilePath", "onProgress",
+    "performanceTiming", "signature",    "payloadCipher",     "baseUrl",
+    "priority",      "deadline",         "redirect",          "resumableUpload",
+    "parallelUpload", "responseCharset", "responseFormat"};
+
+/**
+ * @brief 按属性名查找OptionKey
+ * @return 不是请求参数时返回OPT_COUNT
+ */
+static OptionKey FindOptionKey(const std::string &name) {
+    // 只读表，首次调用时创建
+    static const std::map<std::string, OptionKey> keys = []() {
+        std::map<std::string, OptionKey> table;
+        for (int i = 0; i < OPT_COUNT; i++) {
+            table.emplace(kOptionKeyNames[i], static_cast<OptionKey>(i));
+        }
+        return table;
+    }();
+    auto it = keys.find(name);
+    return it == keys.end() ? OPT_COUNT : it->second;
+}
+
+/**
+ * @brief 模块的env级数据
+ */
+typedef struct ModuleData {
+    std::shared_ptr<EnvState> state; ///< env级请求状态
+} ModuleData;
+
+/**
+ * @brief 释放env级数据
+ */
+static void ModuleDataFinalize(napi_env env, void *data, void *hint) {
+    delete static_cast<ModuleData *>(data);
+}
+
+/**
+ * @brief env销毁回调：中断该env进行中的传输并短暂等待其收尾，释放排队中的请求，之后不再启动该env的传输
+ * 超时仍未结束的传输持有env级请求状态，结束后自行释放，不访问已销毁的env
+ * @param arg env级请求状态
+ */
+static void EnvCleanupHook(void *arg) {
+    auto *holder = static_cast<std::shared_ptr<EnvState> *>(arg);
+    EnvState &state = **holder;
+    state.Close();
+    CloseQueueTimer(&state);
+    // 排队中的请求不再启动，JS也不再处理其Promise，直接释放
+    std::vector<void *> queued;
+    state.admission.Drain(queued);
+    for (void *request : queued) {
+        ReleaseCallbackData(nullptr, static_cast<RequestCallbackData *>(request));
+    }
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        if (!state.drained.wait_for(lock, std::chrono::milliseconds(kEnvDrainTimeout),
+                                    [&state]() { return state.inFlight == 0; })) {
+            OH_LOG_Print(LOG_APP, LOG_ERROR, 0xFF00, "GMCURL", "env closing with %{public}d transfers in flight",
+                         state.inFlight);
+        }
+    }
+    // 注销下载进度回调，之后下载线程不会再调用该线程安全函数
+    if (state.downloadProgress) {
+        DownloadManager::Instance().RemoveListener(state.downloadListener);
+        napi_release_threadsafe_function(state.downloadProgress, napi_tsfn_abort);
+        state.downloadProgress = nullptr;
+    }
+    delete holder;
+}
+
+/**
+ * @brief 创建env级数据
+ * @param env NAPI环境对象
+ */
+static void InitModuleData(napi_env env) {
+    auto *moduleData = new ModuleData();
+    moduleData->state = std::make_shared<EnvState>();
+    napi_add_env_cleanup_hook(env, EnvCleanupHook, new std::shared_ptr<EnvState>(moduleData->state));
+    napi_set_instance_data(env, moduleData, ModuleDataFinalize, nullptr);
+}
+
+/**
+ * @brief 获取env级请求状态
+ * @param env NAPI环境对象
+ * @return 请求状态，模块未初始化时为空
+ */
+static std::shared_ptr<EnvState> GetEnvState(napi_env env) {
+    ModuleData *moduleData = nullptr;
+    if (napi_get_instance_data(env, reinterpret_cast<void **>(&moduleData)) != napi_ok || !moduleData) {
+        return nullptr;
+    }
+    return moduleData->state;
+}
+
+/**
+ * @brief 获取回调数据（优先复用当前env缓存的上下文）
+ * @param env NAPI环境对象
+ * @return 回调数据指针
+ */
+static RequestCallbackData *AcquireCallbackData(napi_env env) {
+    std::shared_ptr<EnvState> state = GetEnvState(env);
+    RequestCallbackData *callbackData = state ? state->contextPool.Acquire() : new RequestCallbackData();
+    callbackData->envState = std::move(state);
+    return callbackData;
+}
+
+/**
+ * @brief 请求参数读取器
+ * 构造时一次枚举对象上存在的属性并取出参数值，之后按OptionKey直接读取；
+ * 请求通常只设置少数参数，未设置的参数不再各自调用N-API查找。未设置的参数（undefined/null）视为不存在
+ */
+class OptionReader {
+public:
+    OptionReader(napi_env env, napi_value obj) : env(env), obj(obj) {
+        napi_value names;
+        uint32_t count = 0;
+        if (napi_get_property_names(env, obj, &names) != napi_ok ||
+            napi_get_array_length(env, names, &count) != napi_ok) {
+            return;
+        }
+        std::string name;
+        for (uint32_t i = 0; i < count; i++) {
+            napi_value keyValue;
+            napi_value value;
+            napi_valuetype type;
+            if (napi_get_element(env, names, i, &keyValue) != napi_ok || !GetStringValue(env, keyValue, name)) {
+                continue;
             }
+            OptionKey key = FindOptionKey(name);
+            if (key != OPT_COUNT && napi_get_property(env, obj, keyValue, &value) == napi_ok &&
+                napi_typeof(env, value, &type) == napi_ok && type != napi_undefined && type != napi_null) {
+                values[key] = value;
+            }
+        }
+    }
+
+    /**
+     * @brief 读取参数值
+     * @return 参数存在时返回true
+     */
+    bool Get(OptionKey key, napi_value &value) const {
+        value = values[key];
+        return value != nullptr;
+    }
+
+    /**
+     * @brief 读取对象类型参数
+     */
+    bool GetObject(OptionKey key, napi_value &value) const {
+        napi_valuetype type;
+        return Get(key, value) && napi_typeof(env, value, &type) == napi_ok && type == napi_object;
+    }
+
+    /**
+     * @brief 读取字符串参数，不存在时out保持不变
+     */
+    bool GetString(OptionKey key, std::string &out) const {
+        napi_value value;
+        return Get(key, value) && GetStringValue(env, value, out);
+    }
+
+    /**
+     * @brief 读取布尔参数，不存在时out保持不变
+     */
+    bool GetBool(OptionKey key, bool &out) const {
+        napi_value value;
+        return Get(key, value) && napi_get_value_bool(env, value, &out) == napi_ok;
+    }
+
+    /**
+     * @brief 读取整数参数，不存在时out保持不变
+     */
+    bool GetInt32(OptionKey key, int32_t &out) const {
+        napi_value value;
+        return Get(key, value) && napi_get_value_int32(env, value, &out) == napi_ok;
+    }
+
+    napi_env env;   ///< NAPI环境对象
+    napi_value obj; ///< 参数对象
+
+private:
+    napi_value values[OPT_COUNT] = {}; ///< 已设置的参数值
+};
+
+/**
+ * @brief 解析可在客户端共享的请求配置
+ * 只覆盖对象中存在的属性，未出现的属性保持当前值（默认值或客户端配置）
+ * @param options 参数读取器
+ * @param callbackData 回调数据
+ */
+static void ParseSharedOptions(const OptionReader &options, RequestCallbackData *callbackData) {
+    HttpRequestParams &params = callbackData->params;
+
+    // 解析performanceTiming
+    options.GetBool(OPT_PERFORMANCE_TIMING, params.isPerformanceTiming);
+
+    // 解析method
+    options.GetString(OPT_METHOD, params.method);
+
+    // 解析超时时间
+    options.GetInt32(OPT_READ_TIMEOUT, params.readTimeout);
+    options.GetInt32(OPT_CONNECT_TIMEOUT, params.connectTimeout);
+
+    // 解析文本响应体的字符集
+    options.GetString(OPT_RESPONSE_CHARSET, params.responseCharset);
+
+    // 解析响应格式（'object'或'packed'）
+    std::string responseFormat;
+    if (options.GetString(OPT_RESPONSE_FORMAT, responseFormat)) {
+        params.isPackedResponse = responseFormat == "packed";
+    }
 
-            // 解析extraData
-            bool hasExtraDataProp;
-            napi_has_named_property(env, args[0], "extraData", &hasExtraDataProp);
-            //  POST或PUT请求
-            if (hasExtraDataProp && (callbackData->params.method == "POST" || callbackData->params.method == "PUT")) {
-                napi_value extraDataProp;
-                napi_get_named_property(env, args[0], "extraData", &extraDataProp);
+    // 解析排队优先级与截止时间
+    options.GetInt32(OPT_PRIORITY, params.priority);
+    int32_t deadline;
+    if (options.GetInt32(OPT_DEADLINE, deadline)) {
+        params.deadline = deadline;
+    }
+
+    // 解析传输层配置：caPath、客户端证书路径、tlcp、verifyServer、debug
+    bool transport = options.GetString(OPT_CA_PATH, params.caPath);
+    transport = options.GetString(OPT_CLIENT_CERT_PATH, params.clientCertPath) || transport;
+    transport = options.GetBool(OPT_IS_TLCP, params.isTLCP) || transport;
+    transport = options.GetBool(OPT_VERIFY_SERVER, params.verifyServer) || transport;
+    transport = options.GetBool(OPT_DEBUG, params.isDebug) || transport;
+    params.transportOverridden = params.transportOverridden || transport;
+    if (params.isDebug) {
+        OH_LOG_Print(LOG_APP, LOG_INFO, 0xFF00, "GMCURL", "Curl version: %{public}s", curl_version());
+    }
+
+    // 解析签名配置
+    napi_value signatureProp;
+    if (options.GetObject(OPT_SIGNATURE, signatureProp)) {
+        convertSignature(options.env, callbackData, signatureProp);
+    }
+
+    // 解析载荷加密配置
+    napi_value payloadCipherProp;
+    if (options.GetObject(OPT_PAYLOAD_CIPHER, payloadCipherProp)) {
+        convertPayloadCipher(options.env, callbackData, payloadCipherProp);
+    }
+
+    // 解析重定向策略
+    napi_value redirectProp;
+    if (options.GetObject(OPT_REDIRECT, redirectProp)) {
+        convertRedirect(options.env, callbackData, redirectProp);
+    }
+}
+
+/**
+ * @brief 解析请求头属性
+ * @param options 参数读取器
+ * @param callbackData 回调数据
+ */
+static void ParseHeadersOption(const OptionReader &options, RequestCallbackData *callbackData) {
+    napi_value headersProp;
+    if (options.GetObject(OPT_HEADERS, headersProp)) {
+        // 获取headersProp的键值对
+        napi_env env = options.env;
+        convertRequestHeader(env, callbackData, headersProp);
+    }
+}
 
-                convertRequestData(env, callbackData, extraDataProp);
+/**
+ * @brief 解析单次请求的参数
+ * @param options 参数读取器
+ * @param callbackData 回调数据
+ */
+static void ParseRequestOptions(const OptionReader &options, RequestCallbackData *callbackData) {
+    napi_env env = options.env;
+
+    // 解析url
+    options.GetString(OPT_URL, callbackData->params.url);
+
+    ParseSharedOptions(options, callbackData);
+
+    // 解析extraData（POST或PUT请求）
+    napi_value extraDataProp;
+    if ((callbackData->params.method == "POST" || callbackData->params.method == "PUT") &&
+        options.Get(OPT_EXTRA_DATA, extraDataProp)) {
+        convertRequestData(env, callbackData, extraDataProp);
+    }
+
+    // 解析formdata
+    napi_value extraFormDataProp;
+    if (callbackData->params.method == "POST" && options.GetObject(OPT_MULTI_FORM_DATA_LIST, extraFormDataProp)) {
+        // 调用上面定义的 convertFormData
+        convertFormData(env, callbackData, extraFormDataProp);
+    }
+
+    // 解析headers
+    ParseHeadersOption(options, callbackData);
+
+    // 解析请求ID
+    int32_t requestId;
+    if (options.GetInt32(OPT_REQUEST_ID, requestId)) {
+        callbackData->params.requestId = requestId;
+        if (callbackData->envState) {
+            std::lock_guard<std::mutex> lock(callbackData->envState->mutex);
+            callbackData->envState->cancelRequests[requestId] = false;
+        }
+    }
+
+    // 解析下载参数
+    if (options.GetString(OPT_DOWNLOAD_FILE_PATH, callbackData->params.downloadFilePath)) {
+        // 判断文件是否存在并解析文件大小
+        if (!callbackData->params.downloadFilePath.empty()) {
+            std::ifstream file(callbackData->params.downloadFilePath, std::ios::binary);
+            if (file.good()) {
+                callbackData->params.resumeFromOffset = getFileSize(callbackData->params.downloadFilePath);
             }
+            file.close();
+        }
+    }
 
-            // 解析formdata
-            bool hasFormDataProp;
-            napi_has_named_property(env, args[0], "multiFormDataList", &hasFormDataProp);
-            if (hasFormDataProp && callbackData->params.method == "POST") {
-                napi_value extraFormDataProp;
-                napi_get_named_property(env, args[0], "multiFormDataList", &extraFormDataProp);
-                napi_valuetype formDataType;
-                napi_typeof(env, extraFormDataProp, &formDataType);
-                if (formDataType == napi_object) {
-                    // 调用上面定义的 convertFormData
-                    convertFormData(env, callbackData, extraFormDataProp);
-                }
+    // 解析上传参数
+    options.GetString(OPT_UPLOAD_FILE_PATH, callbackData->params.uploadFilePath);
+    napi_value resumableProp;
+    if (options.GetObject(OPT_RESUMABLE_UPLOAD, resumableProp)) {
+        convertResumableUpload(env, callbackData, resumableProp);
+    }
+    napi_value parallelProp;
+    if (options.GetObject(OPT_PARALLEL_UPLOAD, parallelProp)) {
+        convertParallelUpload(env, callbackData, parallelProp);
+    }
+
+    // 解析进度回调
+    napi_value progressCallback;
+    if (options.Get(OPT_ON_PROGRESS, progressCallback)) {
+        napi_value resourceName = nullptr;
+        napi_create_string_utf8(env, "Thread-safe Progress CB", NAPI_AUTO_LENGTH, &resourceName);
+        //  创建线程安全函数
+        napi_create_threadsafe_function(env, progressCallback, nullptr, resourceName, 8, 1, nullptr, nullptr,
+                                        callbackData, ThreadSafeCallback, &callbackData->tsfn);
+    }
+}
+
+/**
+ * @brief 请求是否可以直接使用预取缓存（无请求体、下载、加密与签名的普通GET请求）
+ */
+static bool IsCacheableRequest(const HttpRequestParams &params) {
+    return params.errorMsg.empty() && params.method == "GET" && params.downloadFilePath.empty() &&
+           params.uploadFilePath.empty() && params.extraDataStr.empty() && params.extraDataBuffer == nullptr &&
+           params.formData.empty() && params.ranges.empty() && !params.isSignature && !params.isPayloadCipher &&
+           !params.resumable.enabled && !params.parallel.enabled;
+}
+
+/**
+ * @brief 请求的缓存变体：本次请求与客户端的请求头、TLS配置，与预取时的配置相同才命中缓存
+ */
+static std::string CacheVariantOf(const HttpRequestParams &params) {
+    std::map<std::string, std::string> headers;
+    if (params.client) {
+        headers = params.client->headers;
+    }
+    for (const auto &header : params.headers) {
+        headers[header.first] = header.second;
+    }
+    std::vector<std::string> lines;
+    for (const auto &header : headers) {
+        lines.push_back(header.first + ": " + header.second);
+    }
+    return ResponseCache::VariantOf(lines, params.caPath, params.clientCertPath, params.isTLCP, params.verifyServer);
+}
+
+/**
+ * @brief 提交异步请求任务（经过准入控制）
+ * @param env NAPI环境对象
+ * @param callbackData 回调数据
+ */
+static void QueueRequest(napi_env env, RequestCallbackData *callbackData) {
+    if (callbackData->params.isPerformanceTiming) {
+        callbackData->params.performanceTiming.startTime = std::chrono::steady_clock::now();
+        callbackData->params.performanceTiming.totalTiming = 0;
+    }
+
+    // 命中预取缓存时直接返回，不创建异步任务也不占用执行槽位
+    if (IsCacheableRequest(callbackData->params)) {
+        std::shared_ptr<const CachedResponse> cached =
+            ResponseCache::Instance().Find(callbackData->params.url, CacheVariantOf(callbackData->params));
+        if (cached) {
+            callbackData->params.responseCode = static_cast<int>(cached->status);
+            callbackData->params.responseHeaders = cached->headers;
+            callbackData->params.response = cached->body;
+            PrepareResponse(callbackData->params);
+            SettleRequest(env, napi_ok, callbackData);
+            ReleaseCallbackData(env, callbackData);
+            return;
+        }
+    }
+    // 前台请求提交后（含排队）暂停预取
+    callbackData->params.foreground = true;
+    PrefetchQueue::Instance().BeginForeground();
+
+    EnvState *state = callbackData->envState.get();
+    if (!state) {
+        StartRequest(env, callbackData);
+        return;
+    }
+
+    // 准入控制：超出执行上限的请求排队，队列满时按溢出策略处理
+    int64_t deadline = callbackData->params.deadline > 0 ? callbackData->params.deadline
+                                                         : state->admission.Config().queueTimeout;
+    if (deadline > 0) {
+        callbackData->params.deadlineTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(deadline);
+    }
+    void *dropped = nullptr;
+    std::vector<void *> expired;
+    AdmissionController::Result result = state->admission.Submit(callbackData, callbackData->params.priority,
+                                                                 callbackData->params.deadlineTime, dropped, expired);
+    RejectExpired(env, expired);
+    if (dropped) {
+        RejectRequest(env, static_cast<RequestCallbackData *>(dropped), 115, "Request dropped: queue full");
+    }
+    if (result == AdmissionController::Result::START) {
+        StartRequest(env, callbackData);
+    } else if (result == AdmissionController::Result::REJECTED) {
+        RejectRequest(env, callbackData, 115, "Request rejected: queue full");
+    }
+    ScheduleQueueTimer(env, state);
+}
+
+/**
+ * @brief 主请求处理函数
+ * 创建并配置异步请求对象
+ * @param env NAPI环境对象
+ * @param info 回调信息
+ * @return Promise对象
+ */
+napi_value Request(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    // 创建Promise
+    napi_value promise;
+    napi_deferred deferred;
+    napi_create_promise(env, &deferred, &promise);
+
+    // 创建回调数据
+    RequestCallbackData *callbackData = AcquireCallbackData(env);
+    callbackData->deferred = deferred;
+
+    // 解析参数
+    if (argc >= 1 && args[0] != nullptr) {
+        napi_valuetype type;
+        napi_typeof(env, args[0], &type);
+
+        if (type == napi_object) {
+            ParseRequestOptions(OptionReader(env, args[0]), callbackData);
+        } else if (type == napi_string) {
+            // 位置参数快速路径 request(url, headers?)：默认参数的GET请求，不查找其他参数
+            GetStringValue(env, args[0], callbackData->params.url);
+            napi_valuetype headersType = napi_undefined;
+            if (argc >= 2) {
+                napi_typeof(env, args[1], &headersType);
             }
+            if (headersType == napi_object) {
+                convertRequestHeader(env, callbackData, args[1]);
+            }
+        }
+    }
+
+    QueueRequest(env, callbackData);
+    return promise;
+}
+
+/**
+ * @brief 拼接客户端基础URL与请求路径
+ * @param baseUrl 基础URL
+ * @param path 请求路径，包含"://"时视为完整URL
+ * @return 完整URL
+ */
+static std::string ResolveClientUrl(const std::string &baseUrl, const std::string &path) {
+    if (baseUrl.empty() || path.find("://") != std::string::npos) {
+        return path;
+    }
+    if (path.empty()) {
+        return baseUrl;
+    }
+    bool baseSlash = baseUrl.back() == '/';
+    bool pathSlash = path.front() == '/';
+    if (baseSlash && pathSlash) {
+        return baseUrl + path.substr(1);
+    }
+    if (!baseSlash && !pathSlash && path.front() != '?') {
+        return baseUrl + "/" + path;
+    }
+    return baseUrl + path;
+}
+
+/**
+ * @brief 客户端请求
+ * client.request(pathOrOptions)，以客户端配置为基础，仅解析本次请求的差异部分
+ * @param env NAPI环境对象
+ * @param info 回调信息
+ * @return Promise对象
+ */
+static napi_value ClientRequest(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_value thisArg;
+    napi_get_cb_info(env, info, &argc, args, &thisArg, nullptr);
+
+    // 创建Promise
+    napi_value promise;
+    napi_deferred deferred;
+    napi_create_promise(env, &deferred, &promise);
+
+    // 创建回调数据
+    RequestCallbackData *callbackData = AcquireCallbackData(env);
+    callbackData->deferred = deferred;
+
+    std::shared_ptr<GmCurlClient> *holder = nullptr;
+    if (napi_unwrap(env, thisArg, reinterpret_cast<void **>(&holder)) != napi_ok || holder == nullptr) {
+        callbackData->params.errorMsg = "Invalid client";
+        callbackData->params.responseCode = 114;
+        QueueRequest(env, callbackData);
+        return promise;
+    }
+    const std::shared_ptr<GmCurlClient> &client = *holder;
+    callbackData->params = client->base;
+    callbackData->params.client = client;
+
+    // 解析参数：字符串为请求路径，对象为差异配置
+    if (argc >= 1 && args[0] != nullptr) {
+        napi_valuetype type;
+        napi_typeof(env, args[0], &type);
+        if (type == napi_string) {
+            GetStringValue(env, args[0], callbackData->params.url);
+        } else if (type == napi_object) {
+            ParseRequestOptions(OptionReader(env, args[0]), callbackData);
+        }
+    }
+    callbackData->params.url = ResolveClientUrl(client->baseUrl, callbackData->params.url);
+
+    QueueRequest(env, callbackData);
+    return promise;
+}
+
+/**
+ * @brief 客户端对象回收
+ */
+static void ClientFinalize(napi_env env, void *data, void *hint) {
+    // 进行中的请求仍持有客户端引用，最后一个请求结束后释放
+    delete static_cast<std::shared_ptr<GmCurlClient> *>(data);
+}
+
+/**
+ * 创建可复用的请求客户端
+ *
+ * @param env
+ * @param info
+ * @return 客户端对象
+ */
+static napi_value createClient(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    RequestCallbackData config;
+    std::shared_ptr<GmCurlClient> client = std::make_shared<GmCurlClient>();
+    if (argc >= 1 && args[0] != nullptr) {
+        napi_valuetype type;
+        napi_typeof(env, args[0], &type);
+        if (type == napi_object) {
+            OptionReader options(env, args[0]);
+            options.GetString(OPT_BASE_URL, client->baseUrl);
+            ParseSharedOptions(options, &config);
+            ParseHeadersOption(options, &config);
+        }
+    }
+    if (!config.params.errorMsg.empty()) {
+        napi_throw_error(env, std::to_string(config.params.responseCode).c_str(), config.params.errorMsg.c_str());
+        return nullptr;
+    }
+
+    // 冻结共享配置：公共请求头预构建，传输层配置预设到模板句柄
+    client->headers.swap(config.params.headers);
+    client->base = config.params;
+    client->base.transportOverridden = false;
+    for (const auto &pair : client->headers) {
+        std::string header = pair.first + ": " + pair.second;
+        client->defaultHeaders = curl_slist_append(client->defaultHeaders, header.c_str());
+    }
+    client->templateHandle = curl_easy_init();
+    if (!client->templateHandle) {
+        napi_throw_error(env, "102", "Curl initialization failed");
+        return nullptr;
+    }
+    ApplyTransportOptions(client->templateHandle, client->base);
+
+    napi_value clientObj;
+    napi_create_object(env, &clientObj);
+    auto *holder = new std::shared_ptr<GmCurlClient>(client);
+    napi_wrap(env, clientObj, holder, ClientFinalize, nullptr, nullptr);
+    napi_property_descriptor desc[] = {
+        {"request", nullptr, ClientRequest, nullptr, nullptr, nullptr, napi_default, nullptr}};
+    napi_define_properties(env, clientObj, sizeof(desc) / sizeof(desc[0]), desc);
+    return clientObj;
+}
+
+/**
+ * @brief 读取资源的多个字节范围
+ * 参数：url、范围数组[{start, end}]、可选的请求参数（请求头、超时、证书、requestID、maxParallel）
+ * @param env NAPI环境对象
+ * @param info 回调信息
+ * @return Promise<ArrayBuffer[]>，与范围数组一一对应
+ */
+static napi_value fetchRange(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3] = {nullptr};
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    napi_value promise;
+    napi_deferred deferred;
+    napi_create_promise(env, &deferred, &promise);
+    RequestCallbackData *callbackData = AcquireCallbackData(env);
+    callbackData->deferred = deferred;
+
+    napi_valuetype type = napi_undefined;
+    if (argc >= 3) {
+        napi_typeof(env, args[2], &type);
+    }
+    if (type == napi_object) {
+        ParseRequestOptions(OptionReader(env, args[2]), callbackData);
+        int64_t maxParallel;
+        if (GetInt64Property(env, args[2], "maxParallel", maxParallel) && maxParallel > 0) {
+            callbackData->params.rangeParallel = static_cast<int>(std::min<int64_t>(maxParallel, 16));
+        }
+    }
+    HttpRequestParams &params = callbackData->params;
+    params.method = "GET";
+    bool isArray = false;
+    uint32_t length = 0;
+    if (argc < 2 || !GetStringValue(env, args[0], params.url) || params.url.empty() ||
+        napi_is_array(env, args[1], &isArray) != napi_ok || !isArray ||
+        napi_get_array_length(env, args[1], &length) != napi_ok || length == 0) {
+        RejectRequest(env, callbackData, 120, "fetchRange requires a url and at least one range");
+        return promise;
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        ByteRange range;
+        napi_get_element(env, args[1], i, &element);
+        napi_typeof(env, element, &type);
+        if (type != napi_object || !GetInt64Property(env, element, "start", range.start)) {
+            RejectRequest(env, callbackData, 120, "Invalid byte range");
+            return promise;
+        }
+        GetInt64Property(env, element, "end", range.end);
+        if (!IsValidByteRange(range)) {
+            RejectRequest(env, callbackData, 120, "Invalid byte range");
+            return promise;
+        }
+        params.ranges.push_back(range);
+    }
+
+    QueueRequest(env, callbackData);
+    return promise;
+}
+
+/**
+ * 请求取消
+ *
+ * @param env
+ * @param info
+ * @return
+ */
+static napi_value cancelRequest(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    if (argc == 1) {
+        napi_valuetype type;
+        napi_typeof(env, args[0], &type);
+        if (type == napi_number) {
+            int32_t requestId;
+            napi_get_value_int32(env, args[0], &requestId);
+            std::shared_ptr<EnvState> state = GetEnvState(env);
+            if (!state) {
+                return nullptr;
+            }
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->cancelRequests.count(requestId) > 0) {
+                state->cancelRequests[requestId] = true;
+            }
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * 设置准入控制策略
+ *
+ * @param env
+ * @param info
+ * @return
+ */
+static napi_value setAdmissionPolicy(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    std::shared_ptr<EnvState> state = GetEnvState(env);
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) {
+        napi_typeof(env, args[0], &type);
+    }
+    if (!state || type != napi_object) {
+        return nullptr;
+    }
+    AdmissionConfig config = state->admission.Config();
+    int64_t value;
+    if (GetInt64Property(env, args[0], "maxInFlight", value)) {
+        config.maxInFlight = static_cast<int>(std::max<int64_t>(value, 1));
+    }
+    if (GetInt64Property(env, args[0], "maxQueued", value)) {
+        config.maxQueued = static_cast<int>(std::max<int64_t>(value, 0));
+    }
+    GetInt64Property(env, args[0], "queueTimeout", config.queueTimeout);
+    std::string policy;
+    if (GetStringProperty(env, args[0], "policy", policy) && !ParseOverflowPolicy(policy, config.policy)) {
+        napi_throw_error(env, "115", ("Unsupported admission policy: " + policy).c_str());
+        return nullptr;
+    }
+    state->admission.Configure(config);
+    // 放宽限制后立即启动排队中的请求
+    DispatchQueued(env, state.get());
+    return nullptr;
+}
+
+/**
+ * @brief 设置数字属性
+ */
+static void SetNumberProperty(napi_env env, napi_value obj, const char *name, int64_t value) {
+    napi_value val;
+    napi_create_int64(env, value, &val);
+    napi_set_named_property(env, obj, name, val);
+}
+
+/**
+ * @brief 设置复用池命中率属性（0~1，无请求时为0）
+ */
+static void SetRateProperty(napi_env env, napi_value obj, const char *name, const PoolStats &stats) {
+    int64_t total = stats.hits + stats.misses;
+    napi_value val;
+    napi_create_double(env, total > 0 ? static_cast<double>(stats.hits) / total : 0.0, &val);
+    napi_set_named_property(env, obj, name, val);
+}
+
+/**
+ * 设置连接池策略（进程级，对所有env生效）
+ *
+ * @param env
+ * @param info
+ * @return
+ */
+static napi_value setConnectionPolicy(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) {
+        napi_typeof(env, args[0], &type);
+    }
+    if (type != napi_object) {
+        return nullptr;
+    }
+    ConnectionPoolConfig config = ConnectionPool::Instance().Config();
+    int64_t value;
+    if (GetInt64Property(env, args[0], "maxConnections", value)) {
+        config.maxConnections = static_cast<int>(std::max<int64_t>(value, 0));
+    }
+    if (GetInt64Property(env, args[0], "maxConnectionsPerHost", value)) {
+        config.maxConnectionsPerHost = static_cast<int>(std::max<int64_t>(value, 0));
+    }
+    if (GetInt64Property(env, args[0], "maxIdleTime", value)) {
+        config.maxIdleTime = std::max<int64_t>(value, 0);
+    }
+    if (GetInt64Property(env, args[0], "maxConnectionAge", value)) {
+        config.maxConnectionAge = std::max<int64_t>(value, 0);
+    }
+    if (GetInt64Property(env, args[0], "tcpKeepAlive", value)) {
+        config.tcpKeepAlive = std::max<int64_t>(value, 0);
+    }
+    if (GetInt64Property(env, args[0], "pingInterval", value)) {
+        config.pingInterval = std::max<int64_t>(value, 0);
+    }
+    ConnectionPool::Instance().Configure(config);
+    return nullptr;
+}
+
+/**
+ * 获取连接池状态（进程级）
+ *
+ * @param env
+ * @param info
+ * @return 连接池状态对象
+ */
+static napi_value getConnectionPool(napi_env env, napi_callback_info info) {
+    std::vector<HostConnectionStats> stats = ConnectionPool::Instance().Stats();
+    napi_value result;
+    napi_create_object(env, &result);
+    napi_value hosts;
+    napi_create_array_with_length(env, stats.size(), &hosts);
+    int64_t idle = 0;
+    int64_t busy = 0;
+    for (size_t i = 0; i < stats.size(); i++) {
+        napi_value host;
+        napi_create_object(env, &host);
+        napi_value name;
+        napi_create_string_utf8(env, stats[i].host.c_str(), stats[i].host.size(), &name);
+        napi_set_named_property(env, host, "host", name);
+        SetNumberProperty(env, host, "open", stats[i].idle + stats[i].busy);
+        SetNumberProperty(env, host, "idle", stats[i].idle);
+        SetNumberProperty(env, host, "busy", stats[i].busy);
+        napi_set_element(env, hosts, i, host);
+        idle += stats[i].idle;
+        busy += stats[i].busy;
+    }
+    SetNumberProperty(env, result, "open", idle + busy);
+    SetNumberProperty(env, result, "idle", idle);
+    SetNumberProperty(env, result, "busy", busy);
+    napi_set_named_property(env, result, "hosts", hosts);
+    return result;
+}
+
+/**
+ * 关闭全部空闲连接，应用从后台恢复时调用可避免请求落到已失效的连接上
+ *
+ * @param env
+ * @param info
+ * @return 关闭的连接数
+ */
+static napi_value closeIdleConnections(napi_env env, napi_callback_info info) {
+    napi_value result;
+    napi_create_int32(env, ConnectionPool::Instance().CloseIdle(), &result);
+    return result;
+}
+
+/**
+ * @brief 启动下载管理器，下载句柄使用与普通请求相同的传输层配置
+ * @param directory 任务日志目录
+ */
+static void StartDownloadManager(const std::string &directory) {
+    DownloadManager::Instance().Start(directory, [](CURL *curl, const DownloadOptions &options) {
+        HttpRequestParams params;
+        params.caPath = options.caPath;
+        params.clientCertPath = options.clientCertPath;
+        params.isTLCP = options.isTLCP;
+        params.verifyServer = options.verifyServer;
+        ApplyTransportOptions(curl, params);
+        TransferEngine::Instance().Attach(curl);
+    });
+}
+
+/**
+ * 设置缓存目录并加载其中的HSTS与Alt-Svc缓存、下载任务及发件箱记录（进程级）
+ *
+ * @param env
+ * @param info
+ * @return
+ */
+static napi_value setCacheDirectory(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    std::string directory;
+    if (argc >= 1 && !GetStringValue(env, args[0], directory)) {
+        napi_throw_error(env, nullptr, "Cache directory must be a string");
+        return nullptr;
+    }
+    OriginCache::Instance().Load(directory);
+    UploadJournal::Instance().Load(directory);
+    Outbox::Instance().Load(directory);
+    StartDownloadManager(directory);
+    return nullptr;
+}
+
+/**
+ * 清空HSTS与Alt-Svc缓存
+ *
+ * @param env
+ * @param info
+ * @return
+ */
+static napi_value clearOriginCache(napi_env env, napi_callback_info info) {
+    OriginCache::Instance().Clear();
+    return nullptr;
+}
+
+/**
+ * @brief 创建下载任务信息对象
+ */
+static napi_value CreateDownloadInfoObject(napi_env env, const DownloadInfo &download) {
+    napi_value obj;
+    napi_create_object(env, &obj);
+    napi_value value;
+    napi_create_string_utf8(env, download.id.c_str(), download.id.size(), &value);
+    napi_set_named_property(env, obj, "id", value);
+    napi_create_string_utf8(env, download.url.c_str(), download.url.size(), &value);
+    napi_set_named_property(env, obj, "url", value);
+    napi_create_string_utf8(env, download.filePath.c_str(), download.filePath.size(), &value);
+    napi_set_named_property(env, obj, "filePath", value);
+    napi_create_string_utf8(env, DownloadStateName(download.state), NAPI_AUTO_LENGTH, &value);
+    napi_set_named_property(env, obj, "state", value);
+    SetNumberProperty(env, obj, "priority", download.priority);
+    SetNumberProperty(env, obj, "downloaded", download.downloaded);
+    SetNumberProperty(env, obj, "total", download.total);
+    if (!download.error.empty()) {
+        napi_create_string_utf8(env, download.error.c_str(), download.error.size(), &value);
+        napi_set_named_property(env, obj, "error", value);
+    }
+    return obj;
+}
+
+/**
+ * @brief 创建下载任务信息数组
+ */
+static napi_value CreateDownloadInfoArray(napi_env env, const std::vector<DownloadInfo> &downloads) {
+    napi_value array;
+    napi_create_array_with_length(env, downloads.size(), &array);
+    for (size_t i = 0; i < downloads.size(); i++) {
+        napi_set_element(env, array, i, CreateDownloadInfoObject(env, downloads[i]));
+    }
+    return array;
+}
+
+/**
+ * @brief 读取下载任务ID参数
+ * @return 参数为字符串时返回true
+ */
+static bool GetDownloadIdArg(napi_env env, napi_callback_info info, std::string &id) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    return argc >= 1 && GetStringValue(env, args[0], id);
+}
+
+/**
+ * @brief 读取对象的headers属性为"Name: value"列表
+ */
+static void GetHeaderLinesProperty(napi_env env, napi_value object, std::vector<std::string> &lines) {
+    napi_value headersProp;
+    napi_valuetype headersType = napi_undefined;
+    if (napi_get_named_property(env, object, "headers", &headersProp) == napi_ok) {
+        napi_typeof(env, headersProp, &headersType);
+    }
+    if (headersType != napi_object) {
+        return;
+    }
+    napi_value keys;
+    uint32_t length = 0;
+    napi_get_property_names(env, headersProp, &keys);
+    napi_get_array_length(env, keys, &length);
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value key;
+        napi_get_element(env, keys, i, &key);
+        std::string name;
+        std::string value;
+        if (GetStringValue(env, key, name) && GetStringProperty(env, headersProp, name.c_str(), value)) {
+            lines.push_back(name + ": " + value);
+        }
+    }
+}
+
+/**
+ * 添加下载任务（进程级，进程重启后自动恢复）
+ *
+ * @param env
+ * @param info
+ * @return 任务ID
+ */
+static napi_value addDownload(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) {
+        napi_typeof(env, args[0], &type);
+    }
+    DownloadOptions options;
+    if (type != napi_object || !GetStringProperty(env, args[0], "url", options.url) || options.url.empty() ||
+        !GetStringProperty(env, args[0], "filePath", options.filePath) || options.filePath.empty()) {
+        napi_throw_error(env, nullptr, "Download url and filePath are required");
+        return nullptr;
+    }
+    std::string id;
+    GetStringProperty(env, args[0], "id", id);
+    GetHeaderLinesProperty(env, args[0], options.headers);
+    int64_t value;
+    if (GetInt64Property(env, args[0], "priority", value)) {
+        options.priority = static_cast<int>(value);
+    }
+    if (GetInt64Property(env, args[0], "connectTimeout", value)) {
+        options.connectTimeout = static_cast<int>(std::max<int64_t>(value, 1));
+    }
+    GetStringProperty(env, args[0], "caPath", options.caPath);
+    GetStringProperty(env, args[0], "clientCertPath", options.clientCertPath);
+    GetBoolProperty(env, args[0], "isTLCP", options.isTLCP);
+    GetBoolProperty(env, args[0], "verifyServer", options.verifyServer);
+    id = DownloadManager::Instance().Add(options, id);
+    napi_value result;
+    napi_create_string_utf8(env, id.c_str(), id.size(), &result);
+    return result;
+}
+
+/**
+ * 暂停下载任务
+ *
+ * @param env
+ * @param info
+ * @return 任务是否存在
+ */
+static napi_value pauseDownload(napi_env env, napi_callback_info info) {
+    std::string id;
+    napi_value result;
+    napi_get_boolean(env, GetDownloadIdArg(env, info, id) && DownloadManager::Instance().Pause(id), &result);
+    return result;
+}
+
+/**
+ * 恢复暂停或失败的下载任务
+ *
+ * @param env
+ * @param info
+ * @return 任务是否存在
+ */
+static napi_value resumeDownload(napi_env env, napi_callback_info info) {
+    std::string id;
+    napi_value result;
+    napi_get_boolean(env, GetDownloadIdArg(env, info, id) && DownloadManager::Instance().Resume(id), &result);
+    return result;
+}
+
+/**
+ * 删除下载任务，未完成任务已下载的文件一并删除
+ *
+ * @param env
+ * @param info
+ * @return 任务是否存在
+ */
+static napi_value removeDownload(napi_env env, napi_callback_info info) {
+    std::string id;
+    napi_value result;
+    napi_get_boolean(env, GetDownloadIdArg(env, info, id) && DownloadManager::Instance().Remove(id), &result);
+    return result;
+}
+
+/**
+ * 获取全部下载任务
+ *
+ * @param env
+ * @param info
+ * @return 下载任务信息数组
+ */
+static napi_value getDownloads(napi_env env, napi_callback_info info) {
+    return CreateDownloadInfoArray(env, DownloadManager::Instance().List());
+}
+
+/**
+ * 设置下载并发限制（进程级）
+ *
+ * @param env
+ * @param info
+ * @return
+ */
+static napi_value setDownloadPolicy(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) {
+        napi_typeof(env, args[0], &type);
+    }
+    if (type != napi_object) {
+        return nullptr;
+    }
+    int64_t maxConcurrent = -1;
+    int64_t maxPerHost = -1;
+    GetInt64Property(env, args[0], "maxConcurrent", maxConcurrent);
+    GetInt64Property(env, args[0], "maxPerHost", maxPerHost);
+    DownloadManager::Instance().Configure(static_cast<int>(maxConcurrent), static_cast<int>(maxPerHost));
+    return nullptr;
+}
+
+/**
+ * @brief 下载进度线程安全回调，参数为本周期内发生变化的任务数组
+ */
+static void DownloadProgressCallback(napi_env env, napi_value js_callback, void *context, void *data) {
+    auto *downloads = static_cast<std::vector<DownloadInfo> *>(data);
+    if (env != nullptr && js_callback != nullptr) {
+        napi_value args[1] = {CreateDownloadInfoArray(env, *downloads)};
+        napi_value global;
+        napi_get_global(env, &global);
+        napi_call_function(env, global, js_callback, 1, args, nullptr);
+    }
+    delete downloads;
+}
 
-            // 解析headers
-            bool hasHeadersProp;
-            napi_has_named_property(env, args[0], "headers", &hasHeadersProp);
-            if (hasHeadersProp) {
-                napi_value headersProp;
-                napi_get_named_property(env, args[0], "headers", &headersProp);
-                napi_valuetype headersType;
-                napi_typeof(env, headersProp, &headersType);
-                if (headersType == napi_object) {
-                    // 获取headersProp的键值对
-                    convertRequestHeader(env, callbackData, headersProp);
-                }
-            }
+/**
+ * 设置当前env的下载进度回调，传入undefined取消
+ *
+ * @param env
+ * @param info
+ * @return
+ */
+static napi_value onDownloadProgress(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    std::shared_ptr<EnvState> state = GetEnvState(env);
+    if (!state) {
+        return nullptr;
+    }
+    if (state->downloadProgress) {
+        DownloadManager::Instance().RemoveListener(state->downloadListener);
+        napi_release_threadsafe_function(state->downloadProgress, napi_tsfn_release);
+        state->downloadProgress = nullptr;
+    }
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) {
+        napi_typeof(env, args[0], &type);
+    }
+    if (type != napi_function) {
+        return nullptr;
+    }
+    napi_value resourceName;
+    napi_create_string_utf8(env, "DownloadProgress", NAPI_AUTO_LENGTH, &resourceName);
+    napi_threadsafe_function tsfn;
+    if (napi_create_threadsafe_function(env, args[0], nullptr, resourceName, 0, 1, nullptr, nullptr, nullptr,
+                                        DownloadProgressCallback, &tsfn) != napi_ok) {
+        return nullptr;
+    }
+    // 不阻止env退出
+    napi_unref_threadsafe_function(env, tsfn);
+    state->downloadProgress = tsfn;
+    state->downloadListener = DownloadManager::Instance().AddListener([tsfn](const std::vector<DownloadInfo> &batch) {
+        auto *downloads = new std::vector<DownloadInfo>(batch);
+        if (napi_call_threadsafe_function(tsfn, downloads, napi_tsfn_nonblocking) != napi_ok) {
+            delete downloads;
+        }
+    });
+    return nullptr;
+}
 
-            // 解析caPath
-            napi_value caPathProp;
-            napi_get_named_property(env, args[0], "caPath", &caPathProp);
+/**
+ * @brief 设置预取线程的句柄配置回调并启动预取线程
+ */
+static void StartPrefetchQueue() {
+    PrefetchQueue::Instance().Start([](CURL *curl, const PrefetchOptions &options) {
+        HttpRequestParams params;
+        params.caPath = options.caPath;
+        params.clientCertPath = options.clientCertPath;
+        params.isTLCP = options.isTLCP;
+        params.verifyServer = options.verifyServer;
+        ApplyTransportOptions(curl, params);
+        TransferEngine::Instance().Attach(curl);
+    });
+}
 
-            char caPath[1024];
-            size_t caPathLen;
-            if (napi_get_value_string_utf8(env, caPathProp, caPath, sizeof(caPath), &caPathLen) == napi_ok) {
-                callbackData->params.caPath = std::string(caPath);
-            }
+/**
+ * 空闲时预取GET响应到进程级缓存（进程级，不创建JS对象），之后同一URL的请求直接从缓存返回
+ *
+ * @param env
+ * @param info
+ * @return 加入预取队列的URL数量（已缓存或已在队列中的URL不计入）
+ */
+static napi_value prefetch(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    bool isArray = false;
+    if (argc >= 1) {
+        napi_is_array(env, args[0], &isArray);
+    }
+    if (!isArray) {
+        napi_throw_error(env, nullptr, "Prefetch urls must be an array");
+        return nullptr;
+    }
+    std::vector<std::string> urls;
+    uint32_t length = 0;
+    napi_get_array_length(env, args[0], &length);
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        std::string url;
+        napi_get_element(env, args[0], i, &element);
+        if (GetStringValue(env, element, url) && !url.empty()) {
+            urls.push_back(url);
+        }
+    }
+    PrefetchOptions options;
+    napi_valuetype type = napi_undefined;
+    if (argc >= 2) {
+        napi_typeof(env, args[1], &type);
+    }
+    if (type == napi_object) {
+        GetHeaderLinesProperty(env, args[1], options.headers);
+        int64_t value;
+        if (GetInt64Property(env, args[1], "connectTimeout", value)) {
+            options.connectTimeout = static_cast<int>(std::max<int64_t>(value, 1));
+        }
+        if (GetInt64Property(env, args[1], "readTimeout", value)) {
+            options.readTimeout = static_cast<int>(std::max<int64_t>(value, 1));
+        }
+        if (GetInt64Property(env, args[1], "ttl", value)) {
+            options.ttl = std::max<int64_t>(value, 1);
+        }
+        if (GetInt64Property(env, args[1], "maxBytesPerSecond", value)) {
+            options.maxBytesPerSecond = std::max<int64_t>(value, 0);
+        }
+        GetStringProperty(env, args[1], "caPath", options.caPath);
+        GetStringProperty(env, args[1], "clientCertPath", options.clientCertPath);
+        GetBoolProperty(env, args[1], "isTLCP", options.isTLCP);
+        GetBoolProperty(env, args[1], "verifyServer", options.verifyServer);
+    }
+    napi_value result;
+    napi_create_uint32(env, static_cast<uint32_t>(PrefetchQueue::Instance().Add(urls, options)), &result);
+    return result;
+}
 
-            // 解析客户端证书路径
-            napi_value clientCertPathProp;
-            napi_get_named_property(env, args[0], "clientCertPath", &clientCertPathProp);
+/**
+ * 清空预取缓存与等待中的预取
+ *
+ * @param env
+ * @param info
+ * @return
+ */
+static napi_value clearResponseCache(napi_env env, napi_callback_info info) {
+    PrefetchQueue::Instance().Clear();
+    ResponseCache::Instance().Clear();
+    return nullptr;
+}
 
-            char clientCertPath[1024];
-            size_t clientCertPathLen;
-            if (napi_get_value_string_utf8(env, clientCertPathProp, clientCertPath, sizeof(clientCertPath),
-                                           &clientCertPathLen) == napi_ok) {
-                callbackData->params.clientCertPath = std::string(clientCertPath);
-            }
+/**
+ * @brief 设置发件箱的句柄配置回调并启动发送线程
+ */
+static void StartOutbox() {
+    Outbox::Instance().Start([](CURL *curl, const OutboxConfig &config) {
+        HttpRequestParams params;
+        params.caPath = config.caPath;
+        params.clientCertPath = config.clientCertPath;
+        params.isTLCP = config.isTLCP;
+        params.verifyServer = config.verifyServer;
+        ApplyTransportOptions(curl, params);
+        TransferEngine::Instance().Attach(curl);
+    });
+}
 
-            // 解析tlcp
-            napi_value tlcpProp;
-            napi_get_named_property(env, args[0], "isTLCP", &tlcpProp);
-            bool isTLCP;
-            if (napi_get_value_bool(env, tlcpProp, &isTLCP) == napi_ok) {
-                callbackData->params.isTLCP = isTLCP;
-            } else {
-                callbackData->params.isTLCP = false;
-            }
+/**
+ * 追加写请求到离线发件箱（进程级），写入磁盘日志后立即返回，由发件箱线程稍后发送
+ *
+ * @param env
+ * @param info
+ * @return 记录ID
+ */
+static napi_value enqueue(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) {
+        napi_typeof(env, args[0], &type);
+    }
+    if (type != napi_object) {
+        napi_throw_error(env, nullptr, "Outbox record must be an object");
+        return nullptr;
+    }
+    OutboxRecord record;
+    GetStringProperty(env, args[0], "url", record.url);
+    GetStringProperty(env, args[0], "method", record.method);
+    GetHeaderLinesProperty(env, args[0], record.headers);
+    napi_value dataProp;
+    napi_valuetype dataType = napi_undefined;
+    if (napi_get_named_property(env, args[0], "extraData", &dataProp) == napi_ok) {
+        napi_typeof(env, dataProp, &dataType);
+    }
+    bool isArrayBuffer = false;
+    if (dataType == napi_object) {
+        napi_is_arraybuffer(env, dataProp, &isArrayBuffer);
+    }
+    if (dataType == napi_string) {
+        GetStringValue(env, dataProp, record.body);
+    } else if (isArrayBuffer) {
+        void *buffer = nullptr;
+        size_t length = 0;
+        napi_get_arraybuffer_info(env, dataProp, &buffer, &length);
+        record.body.assign(static_cast<const char *>(buffer), length);
+    } else if (dataType == napi_object) {
+        record.body = ObjectToJson(env, dataProp);
+    }
+    if (record.url.empty() && record.body.empty()) {
+        napi_throw_error(env, nullptr, "Outbox record requires url or extraData");
+        return nullptr;
+    }
+    // 批量请求体中每条记录占一行（允许以一个换行结尾），记录内的换行会被拆成多条记录
+    if (record.url.empty() && record.body.find_first_of("\r\n") < record.body.size() - 1) {
+        napi_throw_error(env, nullptr, "Batched outbox record must be a single line");
+        return nullptr;
+    }
+    if (record.method.empty()) {
+        record.method = "POST";
+    }
+    napi_value result;
+    napi_create_int64(env, Outbox::Instance().Enqueue(std::move(record)), &result);
+    return result;
+}
 
-            // 解析verifyServer
-            napi_value verifyServerProp;
-            napi_get_named_property(env, args[0], "verifyServer", &verifyServerProp);
-            bool verifyServer;
-            if (napi_get_value_bool(env, verifyServerProp, &verifyServer) == napi_ok && !verifyServer) {
-                callbackData->params.verifyServer = verifyServer;
-            } else {
-                callbackData->params.verifyServer = true;
-            }
+/**
+ * 设置离线发件箱的批量请求地址、发送周期与重试策略（进程级）
+ *
+ * @param env
+ * @param info
+ * @return
+ */
+static napi_value setOutboxPolicy(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) {
+        napi_typeof(env, args[0], &type);
+    }
+    if (type != napi_object) {
+        return nullptr;
+    }
+    // 未指定的字段保持当前值
+    OutboxConfig config = Outbox::Instance().Config();
+    GetStringProperty(env, args[0], "endpoint", config.endpoint);
+    std::vector<std::string> headers;
+    GetHeaderLinesProperty(env, args[0], headers);
+    if (!headers.empty()) {
+        config.headers = headers;
+    }
+    GetStringProperty(env, args[0], "contentType", config.contentType);
+    GetBoolProperty(env, args[0], "compress", config.compress);
+    int64_t value;
+    if (GetInt64Property(env, args[0], "maxBatchRecords", value)) {
+        config.maxBatchRecords = static_cast<int>(std::max<int64_t>(value, 1));
+    }
+    if (GetInt64Property(env, args[0], "maxBatchBytes", value)) {
+        config.maxBatchBytes = std::max<int64_t>(value, 1);
+    }
+    if (GetInt64Property(env, args[0], "flushInterval", value)) {
+        config.flushInterval = std::max<int64_t>(value, 0);
+    }
+    if (GetInt64Property(env, args[0], "maxAttempts", value)) {
+        config.maxAttempts = static_cast<int>(std::max<int64_t>(value, 1));
+    }
+    if (GetInt64Property(env, args[0], "maxRecords", value)) {
+        config.maxRecords = std::max<int64_t>(value, 1);
+    }
+    if (GetInt64Property(env, args[0], "connectTimeout", value)) {
+        config.connectTimeout = static_cast<int>(std::max<int64_t>(value, 1));
+    }
+    if (GetInt64Property(env, args[0], "readTimeout", value)) {
+        config.readTimeout = static_cast<int>(std::max<int64_t>(value, 1));
+    }
+    GetStringProperty(env, args[0], "caPath", config.caPath);
+    GetStringProperty(env, args[0], "clientCertPath", config.clientCertPath);
+    GetBoolProperty(env, args[0], "isTLCP", config.isTLCP);
+    GetBoolProperty(env, args[0], "verifyServer", config.verifyServer);
+    Outbox::Instance().Configure(config);
+    return nullptr;
+}
 
-            // 解析debug
-            napi_value debugProp;
-            napi_get_named_property(env, args[0], "debug", &debugProp);
-            bool debug;
-            if (napi_get_value_bool(env, debugProp, &debug) == napi_ok && debug) {
-                callbackData->params.isDebug = debug;
-                OH_LOG_Print(LOG_APP, LOG_INFO, 0xFF00, "GMCURL", "Curl version: %{public}s", curl_version());
-            } else {
-                callbackData->params.isDebug = false;
-            }
+/**
+ * 立即发送离线发件箱中未在退避中的记录
+ *
+ * @param env
+ * @param info
+ * @return
+ */
+static napi_value flushOutbox(napi_env env, napi_callback_info info) {
+    Outbox::Instance().Flush();
+    return nullptr;
+}
 
-            // 解析请求ID
-            napi_value requestIdProp;
-            napi_get_named_property(env, args[0], "requestID", &requestIdProp);
-            int32_t requestId;
-            if (napi_get_value_int32(env, requestIdProp, &requestId) == napi_ok) {
-                callbackData->params.requestId = requestId;
-                std::lock_guard<std::mutex> lock(mCancel_mtx);
-                mCancelRequestMap[requestId] = false;
-            } else {
-                callbackData->params.requestId = 0;
-            }
+/**
+ * 开始录制请求与响应（进程级，覆盖已有文件）
+ *
+ * @param env
+ * @param info
+ * @return 录制文件是否创建成功
+ */
+static napi_value startRecording(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    std::string filePath;
+    if (argc < 1 || !GetStringValue(env, args[0], filePath) || filePath.empty()) {
+        napi_throw_error(env, nullptr, "Recording filePath must be a non-empty string");
+        return nullptr;
+    }
+    napi_value result;
+    napi_get_boolean(env, TrafficRecorder::Instance().Start(filePath), &result);
+    return result;
+}
 
-            // 解析下载参数
-            bool hasDownloadProp;
-            napi_has_named_property(env, args[0], "downloadFilePath", &hasDownloadProp);
-            if (hasDownloadProp) {
-                // 解析下载路径
-                napi_value downloadProp;
-                napi_get_named_property(env, args[0], "downloadFilePath", &downloadProp);
-                char downloadPath[1024];
-                size_t downloadPathLen;
-                napi_get_value_string_utf8(env, downloadProp, downloadPath, sizeof(downloadPath), &downloadPathLen);
-                callbackData->params.downloadFilePath = std::string(downloadPath);
-                // 判断文件是否存在并解析文件大小
-                if (!callbackData->params.downloadFilePath.empty()) {
-                    std::ifstream file(callbackData->params.downloadFilePath, std::ios::binary);
-                    if (file.good()) {
-                        callbackData->params.resumeFromOffset = getFileSize(callbackData->params.downloadFilePath);
-                    }
-                    file.close();
-                }
-            }
+/**
+ * 结束录制
+ *
+ * @param env
+ * @param info
+ * @return 本次录制的请求数
+ */
+static napi_value stopRecording(napi_env env, napi_callback_info info) {
+    napi_value result;
+    napi_create_int64(env, TrafficRecorder::Instance().Stop(), &result);
+    return result;
+}
 
-            // 解析上传参数
-            bool hasUploadProp;
-            napi_has_named_property(env, args[0], "uploadFilePath", &hasUploadProp);
-            if (hasUploadProp) {
-                napi_value uploadProp;
-                napi_get_named_property(env, args[0], "uploadFilePath", &uploadProp);
-                char uploadPath[1024];
-                size_t uploadPathLen;
-                napi_get_value_string_utf8(env, uploadProp, uploadPath, sizeof(uploadPath), &uploadPathLen);
-                callbackData->params.uploadFilePath = std::string(uploadPath, uploadPathLen);
-            }
+/**
+ * 加载录制文件并在127.0.0.1上启动回放服务器（进程级，已启动时先停止）
+ *
+ * @param env
+ * @param info
+ * @return 监听端口，启动失败时为0
+ */
+static napi_value startReplayServer(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    std::string filePath;
+    if (argc < 1 || !GetStringValue(env, args[0], filePath) || filePath.empty()) {
+        napi_throw_error(env, nullptr, "Recording filePath must be a non-empty string");
+        return nullptr;
+    }
+    ReplayOptions options;
+    napi_valuetype type = napi_undefined;
+    if (argc >= 2) {
+        napi_typeof(env, args[1], &type);
+    }
+    if (type == napi_object) {
+        GetDoubleProperty(env, args[1], "latencyScale", options.latencyScale);
+        GetDoubleProperty(env, args[1], "bandwidthScale", options.bandwidthScale);
+    }
+    napi_value result;
+    napi_create_int32(env, ReplayServer::Instance().Start(filePath, options), &result);
+    return result;
+}
 
-            // 解析进度回调
-            bool hasProgressCBProp;
-            napi_has_named_property(env, args[0], "onProgress", &hasProgressCBProp);
-            if (hasProgressCBProp) {
-                napi_value progressCallback;
-                napi_get_named_property(env, args[0], "onProgress", &progressCallback);
-                napi_value resourceName = nullptr;
-                napi_create_string_utf8(env, "Thread-safe Progress CB", NAPI_AUTO_LENGTH, &resourceName);
-                //  创建线程安全函数
-                napi_create_threadsafe_function(env, progressCallback, nullptr, resourceName, 8, 1, nullptr, nullptr,
-                                                callbackData, ThreadSafeCallback, &callbackData->tsfn);
-            }
-        }
+/**
+ * 停止回放服务器
+ *
+ * @param env
+ * @param info
+ * @return
+ */
+static napi_value stopReplayServer(napi_env env, napi_callback_info info) {
+    ReplayServer::Instance().Stop();
+    return nullptr;
+}
+
+/**
+ * 启用网络故障注入（进程级，测试用），之后配置的请求经本地代理转发；已启用时按新配置重新开始
+ *
+ * @param env
+ * @param info
+ * @return 代理端口，启动失败时为0
+ */
+static napi_value startFaultInjection(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) {
+        napi_typeof(env, args[0], &type);
+    }
+    if (type != napi_object) {
+        napi_throw_error(env, nullptr, "Fault injection config must be an object");
+        return nullptr;
+    }
+    FaultConfig config;
+    int64_t value;
+    if (GetInt64Property(env, args[0], "seed", value)) {
+        config.seed = static_cast<uint32_t>(value);
+    }
+    napi_value rules;
+    bool isArray = false;
+    if (napi_get_named_property(env, args[0], "rules", &rules) == napi_ok) {
+        napi_is_array(env, rules, &isArray);
+    }
+    uint32_t length = 0;
+    if (isArray) {
+        napi_get_array_length(env, rules, &length);
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        napi_get_element(env, rules, i, &element);
+        FaultRule rule;
+        GetStringProperty(env, element, "host", rule.host);
+        GetInt64Property(env, element, "latency", rule.latency);
+        GetInt64Property(env, element, "jitter", rule.jitter);
+        GetInt64Property(env, element, "bandwidth", rule.bandwidth);
+        GetDoubleProperty(env, element, "stallRate", rule.stallRate);
+        GetInt64Property(env, element, "stallDuration", rule.stallDuration);
+        GetDoubleProperty(env, element, "resetRate", rule.resetRate);
+        GetInt64Property(env, element, "resetWithinBytes", rule.resetWithinBytes);
+        GetInt64Property(env, element, "handshakeDelay", rule.handshakeDelay);
+        config.rules.push_back(rule);
     }
+    napi_value result;
+    napi_create_int32(env, FaultInjector::Instance().Start(config), &result);
+    return result;
+}
 
-    // 创建异步任务
-    napi_value resourceName;
-    napi_create_string_utf8(env, "RequestCallback", NAPI_AUTO_LENGTH, &resourceName);
-    napi_create_async_work(env, nullptr, resourceName, ExecuteRequest, CompleteCB, callbackData,
-                           &callbackData->asyncWork);
-    napi_queue_async_work(env, callbackData->asyncWork);
+/**
+ * 停止网络故障注入，之后配置的请求直接连接
+ *
+ * @param env
+ * @param info
+ * @return
+ */
+static napi_value stopFaultInjection(napi_env env, napi_callback_info info) {
+    FaultInjector::Instance().Stop();
+    return nullptr;
+}
 
-    return promise;
+/**
+ * @brief 设置预建连接的句柄配置回调并启动预建线程
+ */
+static void StartUpstreamBalancer() {
+    UpstreamBalancer::Instance().Start([](CURL *curl, const UpstreamConfig &config) {
+        HttpRequestParams params;
+        params.caPath = config.caPath;
+        params.clientCertPath = config.clientCertPath;
+        params.isTLCP = config.isTLCP;
+        params.verifyServer = config.verifyServer;
+        ApplyTransportOptions(curl, params);
+        TransferEngine::Instance().Attach(curl);
+    });
 }
 
 /**
- * 请求取消
+ * 添加或替换上游组（进程级），之后以upstream://组名/路径发起的请求由负载均衡选择端点
  *
  * @param env
  * @param info
  * @return
  */
-static napi_value cancelRequest(napi_env env, napi_callback_info info) {
+static napi_value setUpstream(napi_env env, napi_callback_info info) {
     size_t argc = 1;
     napi_value args[1];
     napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
-
-    if (argc == 1) {
-        napi_valuetype type;
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) {
         napi_typeof(env, args[0], &type);
-        if (type == napi_number) {
-            int32_t requestId;
-            napi_get_value_int32(env, args[0], &requestId);
-            std::lock_guard<std::mutex> lock(mCancel_mtx);
-            if (mCancelRequestMap.count(requestId) > 0) {
-                mCancelRequestMap[requestId] = true;
-            }
+    }
+    if (type != napi_object) {
+        napi_throw_error(env, nullptr, "Upstream config must be an object");
+        return nullptr;
+    }
+    UpstreamConfig config;
+    GetStringProperty(env, args[0], "name", config.name);
+    napi_value endpoints;
+    bool isArray = false;
+    if (napi_get_named_property(env, args[0], "endpoints", &endpoints) == napi_ok) {
+        napi_is_array(env, endpoints, &isArray);
+    }
+    uint32_t length = 0;
+    if (isArray) {
+        napi_get_array_length(env, endpoints, &length);
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value element;
+        std::string url;
+        napi_get_element(env, endpoints, i, &element);
+        if (GetStringValue(env, element, url)) {
+            config.endpoints.push_back(url);
         }
     }
+    int64_t value;
+    if (GetInt64Property(env, args[0], "failureThreshold", value)) {
+        config.failureThreshold = static_cast<int>(std::max<int64_t>(value, 1));
+    }
+    GetInt64Property(env, args[0], "ejectionTime", config.ejectionTime);
+    GetInt64Property(env, args[0], "decayTime", config.decayTime);
+    if (GetInt64Property(env, args[0], "warmConnections", value)) {
+        config.warmConnections = static_cast<int>(std::max<int64_t>(value, 0));
+    }
+    GetStringProperty(env, args[0], "warmPath", config.warmPath);
+    GetStringProperty(env, args[0], "caPath", config.caPath);
+    GetStringProperty(env, args[0], "clientCertPath", config.clientCertPath);
+    GetBoolProperty(env, args[0], "isTLCP", config.isTLCP);
+    GetBoolProperty(env, args[0], "verifyServer", config.verifyServer);
+    if (GetInt64Property(env, args[0], "connectTimeout", value)) {
+        config.connectTimeout = static_cast<int>(std::max<int64_t>(value, 1));
+    }
+    if (!UpstreamBalancer::Instance().Configure(config)) {
+        napi_throw_error(env, nullptr, "Upstream config requires a name and at least one endpoint");
+    }
     return nullptr;
 }
 
+/**
+ * 删除上游组（进程级），进行中的请求不受影响
+ *
+ * @param env
+ * @param info
+ * @return 上游组是否存在
+ */
+static napi_value removeUpstream(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, nullptr, nullptr);
+    std::string name;
+    bool removed = argc >= 1 && GetStringValue(env, args[0], name) && UpstreamBalancer::Instance().Remove(name);
+    napi_value result;
+    napi_get_boolean(env, removed, &result);
+    return result;
+}
+
+/**
+ * @brief 创建上游组状态数组
+ */
+static napi_value CreateUpstreamStatsArray(napi_env env, const std::vector<UpstreamStats> &groups) {
+    napi_value array;
+    napi_create_array_with_length(env, groups.size(), &array);
+    for (size_t i = 0; i < groups.size(); i++) {
+        napi_value group;
+        napi_create_object(env, &group);
+        napi_value name;
+        napi_create_string_utf8(env, groups[i].name.c_str(), groups[i].name.length(), &name);
+        napi_set_named_property(env, group, "name", name);
+        SetNumberProperty(env, group, "ejections", groups[i].ejections);
+        SetNumberProperty(env, group, "warmups", groups[i].warmups);
+        const std::vector<UpstreamEndpointStats> &stats = groups[i].endpoints;
+        napi_value endpoints;
+        napi_create_array_with_length(env, stats.size(), &endpoints);
+        for (size_t j = 0; j < stats.size(); j++) {
+            napi_value endpoint;
+            napi_create_object(env, &endpoint);
+            napi_value url;
+            napi_create_string_utf8(env, stats[j].url.c_str(), stats[j].url.length(), &url);
+            napi_set_named_property(env, endpoint, "url", url);
+            napi_value latency;
+            napi_create_double(env, stats[j].latency, &latency);
+            napi_set_named_property(env, endpoint, "latency", latency);
+            SetNumberProperty(env, endpoint, "inFlight", stats[j].inFlight);
+            SetNumberProperty(env, endpoint, "requests", stats[j].requests);
+            SetNumberProperty(env, endpoint, "failures", stats[j].failures);
+            napi_value ejected;
+            napi_get_boolean(env, stats[j].ejected, &ejected);
+            napi_set_named_property(env, endpoint, "ejected", ejected);
+            napi_set_element(env, endpoints, static_cast<uint32_t>(j), endpoint);
+        }
+        napi_set_named_property(env, group, "endpoints", endpoints);
+        napi_set_element(env, array, static_cast<uint32_t>(i), group);
+    }
+    return array;
+}
+
+/**
+ * @brief 创建内存统计对象
+ */
+static napi_value CreateMemoryStatsObject(napi_env env, const MemoryStats &stats) {
+    napi_value obj;
+    napi_create_object(env, &obj);
+    napi_value tracked;
+    napi_get_boolean(env, stats.tracked, &tracked);
+    napi_set_named_property(env, obj, "tracked", tracked);
+    SetNumberProperty(env, obj, "liveBytes", stats.liveBytes);
+    SetNumberProperty(env, obj, "peakBytes", stats.peakBytes);
+    SetNumberProperty(env, obj, "allocations", stats.allocations);
+    SetNumberProperty(env, obj, "frees", stats.frees);
+    return obj;
+}
+
+/**
+ * 获取当前env的运行指标
+ *
+ * @param env
+ * @param info
+ * @return 指标对象
+ */
+static napi_value getMetrics(napi_env env, napi_callback_info info) {
+    napi_value metrics;
+    napi_create_object(env, &metrics);
+    std::shared_ptr<EnvState> state = GetEnvState(env);
+    if (!state) {
+        return metrics;
+    }
+
+    // 准入控制指标
+    const AdmissionController &admission = state->admission;
+    const AdmissionStats &stats = admission.Stats();
+    napi_value admissionObj;
+    napi_create_object(env, &admissionObj);
+    SetNumberProperty(env, admissionObj, "queueDepth", static_cast<int64_t>(admission.QueueDepth()));
+    SetNumberProperty(env, admissionObj, "inFlight", admission.InFlight());
+    SetNumberProperty(env, admissionObj, "admitted", stats.admitted);
+    SetNumberProperty(env, admissionObj, "queued", stats.queued);
+    SetNumberProperty(env, admissionObj, "rejected", stats.rejected);
+    SetNumberProperty(env, admissionObj, "dropped", stats.dropped);
+    SetNumberProperty(env, admissionObj, "expired", stats.expired);
+    napi_set_named_property(env, metrics, "admission", admissionObj);
+
+    napi_value poolObj;
+    napi_create_object(env, &poolObj);
+    PoolStats contextStats = state->contextPool.Stats();
+    PoolStats bufferStats = BufferPool::Instance().Stats();
+    SetNumberProperty(env, poolObj, "contextHits", contextStats.hits);
+    SetNumberProperty(env, poolObj, "contextMisses", contextStats.misses);
+    SetRateProperty(env, poolObj, "contextHitRate", contextStats);
+    SetNumberProperty(env, poolObj, "cachedContexts", static_cast<int64_t>(contextStats.cached));
+    SetNumberProperty(env, poolObj, "bufferHits", bufferStats.hits);
+    SetNumberProperty(env, poolObj, "bufferMisses", bufferStats.misses);
+    SetRateProperty(env, poolObj, "bufferHitRate", bufferStats);
+    SetNumberProperty(env, poolObj, "cachedBuffers", static_cast<int64_t>(bufferStats.cached));
+    napi_set_named_property(env, metrics, "pool", poolObj);
+
+    // 网络栈内存指标（进程级）
+    napi_value memoryObj = CreateMemoryStatsObject(env, GetTotalMemoryStats());
+    napi_set_named_property(env, memoryObj, "curl", CreateMemoryStatsObject(env, GetMemoryStats(MemorySource::CURL)));
+    napi_set_named_property(env, memoryObj, "tls", CreateMemoryStatsObject(env, GetMemoryStats(MemorySource::TLS)));
+    napi_set_named_property(env, metrics, "memory", memoryObj);
+
+    // 文件I/O指标（进程级）
+    FileIoEngine &fileIo = FileIoEngine::Instance();
+    FileIoStats fileIoStats = fileIo.Stats();
+    napi_value fileIoObj;
+    napi_create_object(env, &fileIoObj);
+    napi_value backend;
+    napi_create_string_utf8(env, FileIoBackendName(fileIo.Backend()), NAPI_AUTO_LENGTH, &backend);
+    napi_set_named_property(env, fileIoObj, "backend", backend);
+    SetNumberProperty(env, fileIoObj, "writes", fileIoStats.writes);
+    SetNumberProperty(env, fileIoObj, "reads", fileIoStats.reads);
+    SetNumberProperty(env, fileIoObj, "bytesWritten", fileIoStats.bytesWritten);
+    SetNumberProperty(env, fileIoObj, "bytesRead", fileIoStats.bytesRead);
+    SetNumberProperty(env, fileIoObj, "stalls", fileIoStats.stalls);
+    napi_set_named_property(env, metrics, "fileIo", fileIoObj);
+
+    // 预取指标（进程级）
+    PrefetchStats prefetchStats = PrefetchQueue::Instance().Stats();
+    ResponseCacheStats cacheStats = ResponseCache::Instance().Stats();
+    napi_value prefetchObj;
+    napi_create_object(env, &prefetchObj);
+    SetNumberProperty(env, prefetchObj, "pending", prefetchStats.pending);
+    SetNumberProperty(env, prefetchObj, "completed", prefetchStats.completed);
+    SetNumberProperty(env, prefetchObj, "failed", prefetchStats.failed);
+    SetNumberProperty(env, prefetchObj, "yielded", prefetchStats.yielded);
+    SetNumberProperty(env, prefetchObj, "cacheEntries", cacheStats.entries);
+    SetNumberProperty(env, prefetchObj, "cacheBytes", cacheStats.bytes);
+    SetNumberProperty(env, prefetchObj, "cacheHits", cacheStats.hits);
+    napi_set_named_property(env, metrics, "prefetch", prefetchObj);
+
+    // 发件箱指标（进程级）
+    OutboxStats outboxStats = Outbox::Instance().Stats();
+    napi_value outboxObj;
+    napi_create_object(env, &outboxObj);
+    SetNumberProperty(env, outboxObj, "pending", outboxStats.pending);
+    SetNumberProperty(env, outboxObj, "sent", outboxStats.sent);
+    SetNumberProperty(env, outboxObj, "batches", outboxStats.batches);
+    SetNumberProperty(env, outboxObj, "retries", outboxStats.retries);
+    SetNumberProperty(env, outboxObj, "dropped", outboxStats.dropped);
+    napi_set_named_property(env, metrics, "outbox", outboxObj);
+
+    // 回放服务器指标（进程级）
+    ReplayStats replayStats = ReplayServer::Instance().Stats();
+    napi_value replayObj;
+    napi_create_object(env, &replayObj);
+    SetNumberProperty(env, replayObj, "exchanges", replayStats.exchanges);
+    SetNumberProperty(env, replayObj, "served", replayStats.served);
+    SetNumberProperty(env, replayObj, "missed", replayStats.missed);
+    SetNumberProperty(env, replayObj, "connections", replayStats.connections);
+    napi_set_named_property(env, metrics, "replay", replayObj);
+
+    // 故障注入指标（进程级）
+    FaultStats faultStats = FaultInjector::Instance().Stats();
+    napi_value faultObj;
+    napi_create_object(env, &faultObj);
+    SetNumberProperty(env, faultObj, "connections", faultStats.connections);
+    SetNumberProperty(env, faultObj, "stalls", faultStats.stalls);
+    SetNumberProperty(env, faultObj, "resets", faultStats.resets);
+    SetNumberProperty(env, faultObj, "failures", faultStats.failures);
+    napi_set_named_property(env, metrics, "fault", faultObj);
+
+    // 负载均衡指标（进程级）
+    napi_set_named_property(env, metrics, "upstream",
+                            CreateUpstreamStatsArray(env, UpstreamBalancer::Instance().Stats()));
+    return metrics;
+}
+
 EXTERN_C_START
 static napi_value gmsslInit(napi_env env, napi_value exports) {
+    InitModuleData(env);
     napi_property_descriptor desc[] = {
         {"request", nullptr, Request, nullptr, nullptr, nullptr, napi_default, nullptr},
-        {"cancelRequest", nullptr, cancelRequest, nullptr, nullptr, nullptr, napi_default, nullptr}};
+        {"cancelRequest", nullptr, cancelRequest, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"createClient", nullptr, createClient, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"fetchRange", nullptr, fetchRange, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"setAdmissionPolicy", nullptr, setAdmissionPolicy, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"getMetrics", nullptr, getMetrics, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"setConnectionPolicy", nullptr, setConnectionPolicy, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"getConnectionPool", nullptr, getConnectionPool, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"closeIdleConnections", nullptr, closeIdleConnections, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"setCacheDirectory", nullptr, setCacheDirectory, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"clearOriginCache", nullptr, clearOriginCache, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"addDownload", nullptr, addDownload, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"pauseDownload", nullptr, pauseDownload, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"resumeDownload", nullptr, resumeDownload, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"removeDownload", nullptr, removeDownload, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"getDownloads", nullptr, getDownloads, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"setDownloadPolicy", nullptr, setDownloadPolicy, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"onDownloadProgress", nullptr, onDownloadProgress, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"prefetch", nullptr, prefetch, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"clearResponseCache", nullptr, clearResponseCache, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"enqueue", nullptr, enqueue, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"setOutboxPolicy", nullptr, setOutboxPolicy, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"flushOutbox", nullptr, flushOutbox, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"startRecording", nullptr, startRecording, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"stopRecording", nullptr, stopRecording, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"startReplayServer", nullptr, startReplayServer, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"stopReplayServer", nullptr, stopReplayServer, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"startFaultInjection", nullptr, startFaultInjection, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"stopFaultInjection", nullptr, stopFaultInjection, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"setUpstream", nullptr, setUpstream, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"removeUpstream", nullptr, removeUpstream, nullptr, nullptr, nullptr, napi_default, nullptr}};
     napi_define_properties(env, exports, sizeof(desc) / sizeof(desc[0]), desc);
+    // 首个env加载时启动下载管理器（恢复上次未完成的下载任务）、预取线程、发件箱发送线程与连接预建线程
+    static std::once_flag downloadStarted;
+    std::call_once(downloadStarted, []() {
+        StartDownloadManager(kDefaultCacheDirectory);
+        StartPrefetchQueue();
+        StartOutbox();
+        StartUpstreamBalancer();
+    });
     return exports;
 }
 EXTERN_C_END
@@ -1388,4 +4597,14 @@ static napi_module gmsslModule = {
     .reserved = {0},
 };
 
-extern "C" __attribute__((constructor)) void RegisterGMSSLModule(void) { napi_module_register(&gmsslModule); }
+extern "C" __attribute__((constructor)) void RegisterGMSSLModule(void) {
+    // 显式初始化libcurl全局环境（非线程安全），避免首个请求在工作线程中惰性初始化
+    if (!InitNetworkMemoryTracking()) {
+        OH_LOG_Print(LOG_APP, LOG_ERROR, 0xFF00, "GMCURL", "curl global init failed");
+    }
+    // 加载上次保存的HSTS与Alt-Svc缓存与断点续传记录
+    OriginCache::Instance().Load(kDefaultCacheDirectory);
+    UploadJournal::Instance().Load(kDefaultCacheDirectory);
+    Outbox::Instance().Load(kDefaultCacheDirectory);
+    napi_module_register(&gmsslModule);
+}
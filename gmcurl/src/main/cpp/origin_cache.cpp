@@ -0,0 +1,404 @@
+#include "origin_cache.h"
+#include "journal_file.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <strings.h>
+#include <thread>
+#include <vector>
+
+/**
+ * @file origin_cache.cpp
+ * @brief 进程级HSTS与Alt-Svc缓存实现
+ */
+
+const char *const kDefaultCacheDirectory = "/data/storage/el2/base/cache/gmcurl";
+
+namespace {
+
+/**
+ * @brief 每类缓存最多保存的条目数，超出时淘汰最早过期的条目
+ */
+const size_t kMaxEntries = 256;
+
+/**
+ * @brief 缓存文件名
+ */
+const char *const kCacheFileName = "origins.txt";
+
+/**
+ * @brief 变化后延迟写入的时间（秒），合并短时间内的多次变化
+ */
+const int kSaveDelay = 2;
+
+/**
+ * @brief Alt-Svc默认有效期（秒）
+ */
+const int64_t kDefaultAltSvcMaxAge = 86400;
+
+/**
+ * @brief 解析后的URL
+ */
+typedef struct UrlParts {
+    std::string scheme; ///< 协议（小写）
+    std::string host;   ///< 主机（小写）
+    std::string port;   ///< 端口（未指定时为协议默认端口）
+} UrlParts;
+
+bool ParseUrl(const std::string &url, UrlParts &parts) {
+    CURLU *handle = curl_url();
+    if (!handle) {
+        return false;
+    }
+    char *scheme = nullptr;
+    char *host = nullptr;
+    char *port = nullptr;
+    bool ok = curl_url_set(handle, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK &&
+              curl_url_get(handle, CURLUPART_SCHEME, &scheme, 0) == CURLUE_OK &&
+              curl_url_get(handle, CURLUPART_HOST, &host, 0) == CURLUE_OK &&
+              curl_url_get(handle, CURLUPART_PORT, &port, CURLU_DEFAULT_PORT) == CURLUE_OK;
+    if (ok) {
+        parts.scheme = scheme;
+        parts.host = host;
+        parts.port = port;
+        std::transform(parts.host.begin(), parts.host.end(), parts.host.begin(), ::tolower);
+    }
+    curl_free(scheme);
+    curl_free(host);
+    curl_free(port);
+    curl_url_cleanup(handle);
+    return ok;
+}
+
+bool IsIpLiteral(const std::string &host) {
+    if (host.find(':') != std::string::npos || host.find('[') != std::string::npos) {
+        return true;
+    }
+    return std::all_of(host.begin(), host.end(), [](char ch) { return isdigit(ch) || ch == '.'; });
+}
+
+int64_t NowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+std::string Trim(const std::string &value) {
+    size_t begin = value.find_first_not_of(" \t\"");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = value.find_last_not_of(" \t\"");
+    return value.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief 按分隔符拆分（不处理引号内的分隔符，HSTS/Alt-Svc的取值中不会出现）
+ */
+std::vector<std::string> Split(const std::string &value, char separator) {
+    std::vector<std::string> result;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, separator)) {
+        result.push_back(Trim(item));
+    }
+    return result;
+}
+
+bool ParseNumber(const std::string &value, int64_t &out) {
+    if (value.empty() || !std::all_of(value.begin(), value.end(), ::isdigit) || value.size() > 12) {
+        return false;
+    }
+    out = std::stoll(value);
+    return true;
+}
+
+/**
+ * @brief 超出上限时淘汰最早过期的条目
+ */
+template <typename Map> void EvictOverflow(Map &entries) {
+    while (entries.size() > kMaxEntries) {
+        auto oldest = std::min_element(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+            return a.second.expires < b.second.expires;
+        });
+        entries.erase(oldest);
+    }
+}
+
+} // namespace
+
+OriginCache &OriginCache::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static OriginCache *cache = new OriginCache();
+    return *cache;
+}
+
+void OriginCache::Load(const std::string &newDirectory) {
+    std::lock_guard<std::mutex> lock(mutex);
+    directory = newDirectory;
+    if (directory.empty()) {
+        return;
+    }
+    std::ifstream file(directory + "/" + kCacheFileName);
+    std::string line;
+    int64_t now = NowSeconds();
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string type;
+        fields >> type;
+        if (type == "hsts") {
+            std::string host;
+            HstsEntry entry;
+            int includeSubDomains = 0;
+            if (fields >> host >> entry.expires >> includeSubDomains && entry.expires > now) {
+                entry.includeSubDomains = includeSubDomains != 0;
+                hsts[host] = entry;
+            }
+        } else if (type == "altsvc") {
+            std::string origin;
+            AltSvcEntry entry;
+            if (fields >> origin >> entry.host >> entry.port >> entry.expires && entry.expires > now) {
+                altSvc[origin] = entry;
+            }
+        }
+    }
+    EvictOverflow(hsts);
+    EvictOverflow(altSvc);
+}
+
+bool OriginCache::UpgradeUrl(std::string &url) {
+    if (url.size() < 7 || strncasecmp(url.c_str(), "http://", 7) != 0) {
+        return false;
+    }
+    UrlParts parts;
+    if (!ParseUrl(url, parts)) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        int64_t now = NowSeconds();
+        bool matched = false;
+        // 依次匹配主机本身及各级父域名（父域名需包含子域名）
+        for (size_t pos = 0; pos != std::string::npos && !matched;) {
+            std::string domain = parts.host.substr(pos);
+            auto it = hsts.find(domain);
+            if (it != hsts.end() && it->second.expires > now && (pos == 0 || it->second.includeSubDomains)) {
+                matched = true;
+            }
+            pos = parts.host.find('.', pos);
+            pos = pos == std::string::npos ? pos : pos + 1;
+        }
+        if (!matched) {
+            return false;
+        }
+    }
+    CURLU *handle = curl_url();
+    if (!handle) {
+        return false;
+    }
+    bool upgraded = false;
+    char *port = nullptr;
+    char *result = nullptr;
+    if (curl_url_set(handle, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK &&
+        curl_url_set(handle, CURLUPART_SCHEME, "https", 0) == CURLUE_OK) {
+        // 显式的80端口改为443，其他显式端口保留
+        if (curl_url_get(handle, CURLUPART_PORT, &port, 0) == CURLUE_OK && strcmp(port, "80") == 0) {
+            curl_url_set(handle, CURLUPART_PORT, nullptr, 0);
+        }
+        if (curl_url_get(handle, CURLUPART_URL, &result, 0) == CURLUE_OK) {
+            url = result;
+            upgraded = true;
+        }
+    }
+    curl_free(port);
+    curl_free(result);
+    curl_url_cleanup(handle);
+    return upgraded;
+}
+
+bool OriginCache::FindAltService(const std::string &url, std::string &connectTo) {
+    if (url.size() < 8 || strncasecmp(url.c_str(), "https://", 8) != 0) {
+        return false;
+    }
+    UrlParts parts;
+    if (!ParseUrl(url, parts)) {
+        return false;
+    }
+    std::string origin = parts.host + ":" + parts.port;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = altSvc.find(origin);
+    if (it == altSvc.end() || it->second.expires <= NowSeconds()) {
+        return false;
+    }
+    connectTo = origin + ":" + it->second.host + ":" + std::to_string(it->second.port);
+    return true;
+}
+
+void OriginCache::DropAltService(const std::string &url) {
+    UrlParts parts;
+    if (!ParseUrl(url, parts)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (altSvc.erase(parts.host + ":" + parts.port) > 0) {
+        ScheduleSave();
+    }
+}
+
+void OriginCache::Learn(CURL *curl) {
+    char *effectiveUrl = nullptr;
+    if (curl_easy_getinfo(curl, CURLINFO_EFFECTIVE_URL, &effectiveUrl) != CURLE_OK || effectiveUrl == nullptr) {
+        return;
+    }
+    UrlParts parts;
+    // 只信任HTTPS响应中的声明
+    if (!ParseUrl(effectiveUrl, parts) || parts.scheme != "https") {
+        return;
+    }
+    int64_t now = NowSeconds();
+    struct curl_header *header = nullptr;
+    if (!IsIpLiteral(parts.host) &&
+        curl_easy_header(curl, "Strict-Transport-Security", 0, CURLH_HEADER, -1, &header) == CURLHE_OK) {
+        LearnHsts(parts.host, header->value, now);
+    }
+    if (curl_easy_header(curl, "Alt-Svc", 0, CURLH_HEADER, -1, &header) == CURLHE_OK) {
+        LearnAltSvc(parts.host + ":" + parts.port, parts.host, header->value, now);
+    }
+}
+
+void OriginCache::LearnHsts(const std::string &host, const char *value, int64_t now) {
+    int64_t maxAge = -1;
+    bool includeSubDomains = false;
+    for (const std::string &directive : Split(value, ';')) {
+        if (strncasecmp(directive.c_str(), "max-age=", 8) == 0) {
+            ParseNumber(Trim(directive.substr(8)), maxAge);
+        } else if (strcasecmp(directive.c_str(), "includeSubDomains") == 0) {
+            includeSubDomains = true;
+        }
+    }
+    if (maxAge < 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = hsts.find(host);
+    if (maxAge == 0) {
+        if (it != hsts.end()) {
+            hsts.erase(it);
+            ScheduleSave();
+        }
+        return;
+    }
+    HstsEntry entry;
+    entry.expires = now + maxAge;
+    entry.includeSubDomains = includeSubDomains;
+    // 同一策略的重复声明只在有效期明显变化时写盘
+    bool changed = it == hsts.end() || it->second.includeSubDomains != includeSubDomains ||
+                   entry.expires - it->second.expires > maxAge / 10;
+    hsts[host] = entry;
+    EvictOverflow(hsts);
+    if (changed) {
+        ScheduleSave();
+    }
+}
+
+void OriginCache::LearnAltSvc(const std::string &origin, const std::string &host, const char *value, int64_t now) {
+    bool found = false;
+    AltSvcEntry entry;
+    if (strcasecmp(Trim(value).c_str(), "clear") != 0) {
+        for (const std::string &alternative : Split(value, ',')) {
+            std::vector<std::string> params = Split(alternative, ';');
+            if (params.empty() || strncasecmp(params[0].c_str(), "h2=", 3) != 0) {
+                continue;
+            }
+            // h2="备用主机:端口"，备用主机为空表示同一主机
+            std::string authority = Trim(params[0].substr(3));
+            size_t colon = authority.rfind(':');
+            int64_t port = 0;
+            if (colon == std::string::npos || !ParseNumber(authority.substr(colon + 1), port) || port <= 0 ||
+                port > 65535) {
+                continue;
+            }
+            int64_t maxAge = kDefaultAltSvcMaxAge;
+            for (size_t i = 1; i < params.size(); i++) {
+                if (strncasecmp(params[i].c_str(), "ma=", 3) == 0) {
+                    ParseNumber(Trim(params[i].substr(3)), maxAge);
+                }
+            }
+            entry.host = colon == 0 ? host : authority.substr(0, colon);
+            entry.port = static_cast<int>(port);
+            entry.expires = now + maxAge;
+            found = maxAge > 0;
+            break;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = altSvc.find(origin);
+    if (!found) {
+        // 新的声明替换旧的备用服务
+        if (it != altSvc.end()) {
+            altSvc.erase(it);
+            ScheduleSave();
+        }
+        return;
+    }
+    bool changed = it == altSvc.end() || it->second.host != entry.host || it->second.port != entry.port;
+    altSvc[origin] = entry;
+    EvictOverflow(altSvc);
+    if (changed) {
+        ScheduleSave();
+    }
+}
+
+void OriginCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    hsts.clear();
+    altSvc.clear();
+    ScheduleSave();
+}
+
+void OriginCache::ScheduleSave() {
+    // 需持有互斥锁
+    if (directory.empty()) {
+        return;
+    }
+    dirty = true;
+    if (!writerStarted) {
+        writerStarted = true;
+        std::thread([this] { SaveLoop(); }).detach();
+    }
+    dirtyChanged.notify_all();
+}
+
+std::string OriginCache::Serialize() {
+    // 需持有互斥锁
+    std::ostringstream out;
+    for (const auto &item : hsts) {
+        out << "hsts " << item.first << " " << item.second.expires << " " << (item.second.includeSubDomains ? 1 : 0)
+            << "\n";
+    }
+    for (const auto &item : altSvc) {
+        out << "altsvc " << item.first << " " << item.second.host << " " << item.second.port << " "
+            << item.second.expires << "\n";
+    }
+    return out.str();
+}
+
+void OriginCache::SaveLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        dirtyChanged.wait(lock, [this] { return dirty; });
+        // 延迟写入，合并连续的变化
+        dirtyChanged.wait_for(lock, std::chrono::seconds(kSaveDelay));
+        std::string content = Serialize();
+        std::string target = directory;
+        dirty = false;
+        lock.unlock();
+        if (!target.empty()) {
+            WriteJournalFile(target, kCacheFileName, content);
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef GMCURL_ORIGIN_CACHE_H
+#define GMCURL_ORIGIN_CACHE_H
+
+#include "curl.h"
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+ * @file origin_cache.h
+ * @brief 进程级HSTS与Alt-Svc缓存
+ *
+ * - HSTS：记录HTTPS响应中的Strict-Transport-Security，之后发往该主机（及includeSubDomains子域名）的http://请求
+ *   在发送前直接改写为https://，省去一次重定向往返
+ * - Alt-Svc：记录HTTPS响应中声明的h2备用服务，之后的连接通过CURLOPT_CONNECT_TO直连备用地址并使用HTTP/2，
+ *   证书仍按原主机名校验；本库未启用HTTP/3，h3备用服务忽略
+ * 缓存保存在缓存目录下的origins.txt中，模块加载时读取，变化后由后台线程延迟写入（先写临时文件再重命名）。
+ */
+
+/**
+ * @brief 默认缓存目录（应用沙箱缓存目录）
+ */
+extern const char *const kDefaultCacheDirectory;
+
+/**
+ * @brief 进程级HSTS与Alt-Svc缓存
+ */
+class OriginCache {
+public:
+    /**
+     * @brief 获取进程级实例（首次调用时创建，进程退出前不释放）
+     */
+    static OriginCache &Instance();
+
+    OriginCache(const OriginCache &) = delete;
+    OriginCache &operator=(const OriginCache &) = delete;
+
+    /**
+     * @brief 设置缓存目录并加载其中的缓存（与内存中的条目合并）
+     * @param directory 缓存目录，为空时只保存在内存中
+     */
+    void Load(const std::string &directory);
+
+    /**
+     * @brief 对HSTS主机将http://改写为https://
+     * @param url 请求URL（原地改写）
+     * @return 是否改写
+     */
+    bool UpgradeUrl(std::string &url);
+
+    /**
+     * @brief 查找URL的h2备用服务
+     * @param url 请求URL
+     * @param connectTo 输出CURLOPT_CONNECT_TO条目（"主机:端口:备用主机:备用端口"）
+     * @return 是否存在有效的备用服务
+     */
+    bool FindAltService(const std::string &url, std::string &connectTo);
+
+    /**
+     * @brief 备用服务连接失败时删除，之后的请求直连原主机
+     * @param url 请求URL
+     */
+    void DropAltService(const std::string &url);
+
+    /**
+     * @brief 从已完成请求的响应头中学习HSTS与Alt-Svc
+     * @param curl 已完成传输的cURL句柄
+     */
+    void Learn(CURL *curl);
+
+    /**
+     * @brief 清空缓存（包括磁盘文件）
+     */
+    void Clear();
+
+private:
+    OriginCache() = default;
+
+    /**
+     * @brief HSTS条目
+     */
+    typedef struct HstsEntry {
+        int64_t expires = 0;            ///< 过期时间（秒，Unix时间）
+        bool includeSubDomains = false; ///< 是否包含子域名
+    } HstsEntry;
+
+    /**
+     * @brief Alt-Svc条目
+     */
+    typedef struct AltSvcEntry {
+        std::string host; ///< 备用主机
+        int port = 0;     ///< 备用端口
+        int64_t expires;  ///< 过期时间（秒，Unix时间）
+    } AltSvcEntry;
+
+    void LearnHsts(const std::string &host, const char *value, int64_t now);
+    void LearnAltSvc(const std::string &origin, const std::string &host, const char *value, int64_t now);
+    void ScheduleSave();
+    void SaveLoop();
+    std::string Serialize();
+
+    std::mutex mutex;                            ///< 互斥锁
+    std::condition_variable dirtyChanged;        ///< 唤醒写入线程
+    std::string directory;                       ///< 缓存目录
+    std::map<std::string, HstsEntry> hsts;       ///< 主机 -> HSTS条目
+    std::map<std::string, AltSvcEntry> altSvc;   ///< 主机:端口 -> 备用服务
+    bool dirty = false;                          ///< 是否有未写入的变化
+    bool writerStarted = false;                  ///< 写入线程是否已启动
+};
+
+#endif // GMCURL_ORIGIN_CACHE_H
@@ -0,0 +1,402 @@
+#include "outbox.h"
+#include "body_reader.h"
+#include "journal_file.h"
+#include "resumable_upload.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <zlib.h>
+
+/**
+ * @file outbox.cpp
+ * @brief 进程级离线发件箱实现
+ */
+
+namespace {
+
+/**
+ * @brief 日志文件名
+ */
+const char *const kLogFileName = "outbox.log";
+
+/**
+ * @brief 重试等待的最长时间（秒）
+ */
+const int kMaxBackoffSeconds = 300;
+
+/**
+ * @brief 日志中的失效行超过该数量且多于有效记录时重写日志
+ */
+const size_t kRewriteThreshold = 256;
+
+std::string SerializeRecord(const OutboxRecord &record) {
+    std::ostringstream out;
+    out << "record " << record.id << "\n";
+    out << "url " << JournalEscape(record.url) << "\n";
+    out << "method " << JournalEscape(record.method) << "\n";
+    for (const std::string &header : record.headers) {
+        out << "header " << JournalEscape(header) << "\n";
+    }
+    out << "body " << JournalEscape(record.body) << "\n";
+    out << "end\n";
+    return out.str();
+}
+
+/**
+ * @brief gzip压缩
+ */
+bool GzipCompress(const std::string &input, std::string &output) {
+    z_stream stream = {};
+    // windowBits + 16 生成gzip格式
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    output.resize(deflateBound(&stream, static_cast<uLong>(input.size())));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef *>(&output[0]);
+    stream.avail_out = static_cast<uInt>(output.size());
+    int result = deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result == Z_STREAM_END;
+}
+
+} // namespace
+
+Outbox &Outbox::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static Outbox *outbox = new Outbox();
+    return *outbox;
+}
+
+void Outbox::Load(const std::string &newDirectory) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (loaded && directory == newDirectory) {
+        return;
+    }
+    if (loaded && !directory.empty()) {
+        // 未发送的记录移动到新目录，避免切换回原目录时重复发送
+        std::remove((directory + "/" + kLogFileName).c_str());
+    }
+    loaded = true;
+    directory = newDirectory;
+    std::ifstream file(directory + "/" + kLogFileName, std::ios::binary);
+    std::map<int64_t, OutboxRecord> records;
+    OutboxRecord record;
+    bool inRecord = false;
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t space = line.find(' ');
+        std::string key = line.substr(0, space);
+        std::string value = space == std::string::npos ? "" : line.substr(space + 1);
+        if (key == "record") {
+            record = OutboxRecord();
+            record.id = atoll(value.c_str());
+            inRecord = true;
+        } else if (key == "done") {
+            records.erase(atoll(value.c_str()));
+        } else if (!inRecord) {
+            continue;
+        } else if (key == "url") {
+            record.url = JournalUnescape(value);
+        } else if (key == "method") {
+            record.method = JournalUnescape(value);
+        } else if (key == "header") {
+            record.headers.push_back(JournalUnescape(value));
+        } else if (key == "body") {
+            record.body = JournalUnescape(value);
+        } else if (key == "end") {
+            // 不完整的记录（写入时进程退出）丢弃
+            records[record.id] = record;
+            inRecord = false;
+        }
+    }
+    // 日志中的ID只在文件内有效，合并后重新编号
+    auto now = std::chrono::steady_clock::now();
+    for (auto &item : records) {
+        Entry entry;
+        entry.record = std::move(item.second);
+        entry.record.id = nextId++;
+        entry.enqueued = now;
+        entry.retryAfter = now;
+        entries[entry.record.id] = std::move(entry);
+    }
+    Rewrite();
+    wakeup.notify_all();
+}
+
+void Outbox::Start(OutboxConfigurator newConfigurator) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!configurator) {
+        configurator = newConfigurator;
+    }
+    if (!started) {
+        started = true;
+        std::thread([this] { Loop(); }).detach();
+    }
+}
+
+void Outbox::Configure(const OutboxConfig &newConfig) {
+    std::lock_guard<std::mutex> lock(mutex);
+    config = newConfig;
+    wakeup.notify_all();
+}
+
+OutboxConfig Outbox::Config() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return config;
+}
+
+int64_t Outbox::Enqueue(OutboxRecord record) {
+    std::lock_guard<std::mutex> lock(mutex);
+    int64_t id = nextId++;
+    record.id = id;
+    Append(SerializeRecord(record));
+    Entry &entry = entries[record.id];
+    entry.record = std::move(record);
+    entry.enqueued = std::chrono::steady_clock::now();
+    entry.retryAfter = entry.enqueued;
+    // 超出上限时丢弃最早的记录（发送中的记录由发送线程处理）
+    while (static_cast<int64_t>(entries.size()) > std::max<int64_t>(config.maxRecords, 1)) {
+        auto oldest = std::find_if(entries.begin(), entries.end(),
+                                   [this](const auto &item) { return !sending.count(item.first); });
+        if (oldest == entries.end()) {
+            break;
+        }
+        Remove(oldest->first);
+        stats.dropped++;
+    }
+    wakeup.notify_all();
+    return id;
+}
+
+void Outbox::Flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    flushRequested = true;
+    wakeup.notify_all();
+}
+
+OutboxStats Outbox::Stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    OutboxStats result = stats;
+    result.pending = static_cast<int64_t>(entries.size());
+    return result;
+}
+
+bool Outbox::IsDue(const Entry &entry, std::chrono::steady_clock::time_point now, bool flushing) const {
+    // 需持有互斥锁
+    if (sending.count(entry.record.id) || (entry.record.url.empty() && config.endpoint.empty()) ||
+        entry.retryAfter > now) {
+        return false;
+    }
+    return flushing || entry.enqueued + std::chrono::milliseconds(config.flushInterval) <= now;
+}
+
+std::chrono::steady_clock::time_point Outbox::NextDue() const {
+    // 需持有互斥锁
+    auto next = std::chrono::steady_clock::time_point::max();
+    for (const auto &item : entries) {
+        const Entry &entry = item.second;
+        if (sending.count(item.first) || (entry.record.url.empty() && config.endpoint.empty())) {
+            continue;
+        }
+        auto due = std::max(entry.retryAfter, entry.enqueued + std::chrono::milliseconds(config.flushInterval));
+        next = std::min(next, due);
+    }
+    return next;
+}
+
+size_t Outbox::BatchCount() const {
+    // 需持有互斥锁
+    if (config.endpoint.empty()) {
+        return 0;
+    }
+    auto now = std::chrono::steady_clock::now();
+    return std::count_if(entries.begin(), entries.end(), [this, now](const auto &item) {
+        return item.second.record.url.empty() && !sending.count(item.first) && item.second.retryAfter <= now;
+    });
+}
+
+void Outbox::Loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        auto ready = [this] {
+            return flushRequested || BatchCount() >= static_cast<size_t>(std::max(config.maxBatchRecords, 1));
+        };
+        if (!ready()) {
+            // 新记录、配置变化与退避结束都会改变下一次发送时间，唤醒后重新计算
+            auto next = NextDue();
+            if (next == std::chrono::steady_clock::time_point::max()) {
+                wakeup.wait(lock);
+                continue;
+            }
+            if (next > std::chrono::steady_clock::now()) {
+                wakeup.wait_until(lock, next);
+                continue;
+            }
+        }
+        bool flushing = ready();
+        flushRequested = false;
+        auto now = std::chrono::steady_clock::now();
+        std::vector<OutboxRecord> direct;
+        std::vector<std::vector<OutboxRecord>> batches;
+        int64_t batchBytes = 0;
+        for (const auto &item : entries) {
+            if (!IsDue(item.second, now, flushing)) {
+                continue;
+            }
+            const OutboxRecord &record = item.second.record;
+            if (!record.url.empty()) {
+                direct.push_back(record);
+            } else {
+                int64_t size = static_cast<int64_t>(record.body.size()) + 1;
+                if (batches.empty() || static_cast<int>(batches.back().size()) >= config.maxBatchRecords ||
+                    batchBytes + size > config.maxBatchBytes) {
+                    batches.emplace_back();
+                    batchBytes = 0;
+                }
+                batches.back().push_back(record);
+                batchBytes += size;
+            }
+            sending.insert(item.first);
+        }
+        OutboxConfig snapshot = config;
+        lock.unlock();
+
+        for (const OutboxRecord &record : direct) {
+            Outcome outcome = Send(record.method, record.url, record.headers, record.body, snapshot);
+            lock.lock();
+            Settle({record.id}, outcome);
+            lock.unlock();
+        }
+        for (const std::vector<OutboxRecord> &batch : batches) {
+            // 每条记录一行
+            std::string body;
+            std::vector<int64_t> ids;
+            for (const OutboxRecord &record : batch) {
+                body += record.body;
+                if (body.empty() || body.back() != '\n') {
+                    body += '\n';
+                }
+                ids.push_back(record.id);
+            }
+            std::vector<std::string> headers = snapshot.headers;
+            headers.push_back("Content-Type: " + snapshot.contentType);
+            std::string compressed;
+            if (snapshot.compress && GzipCompress(body, compressed)) {
+                body.swap(compressed);
+                headers.push_back("Content-Encoding: gzip");
+            }
+            Outcome outcome = Send("POST", snapshot.endpoint, headers, body, snapshot);
+            lock.lock();
+            if (outcome == Outcome::SENT) {
+                stats.batches++;
+            }
+            Settle(ids, outcome);
+            lock.unlock();
+        }
+        lock.lock();
+        if (logLines > kRewriteThreshold && logLines > entries.size() * 2) {
+            Rewrite();
+        }
+    }
+}
+
+Outbox::Outcome Outbox::Send(const std::string &method, const std::string &url,
+                             const std::vector<std::string> &headers, const std::string &body,
+                             const OutboxConfig &snapshot) {
+    MemoryBodyReader reader(body.data(), body.size());
+    UploadResult response;
+    CURLcode result = PerformUploadRequest(method, url, {}, headers, &reader, [this, &snapshot](CURL *curl) {
+        if (configurator) {
+            configurator(curl, snapshot);
+        }
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, static_cast<long>(snapshot.connectTimeout));
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, static_cast<long>(snapshot.readTimeout));
+    }, response);
+    if (result != CURLE_OK) {
+        // 网络不可用时记录保留在发件箱中，证书等配置错误由最大发送次数兜底
+        return Outcome::RETRY;
+    }
+    if (response.status >= 200 && response.status < 300) {
+        return Outcome::SENT;
+    }
+    if (response.status >= 500 || response.status == 408 || response.status == 429) {
+        return Outcome::RETRY;
+    }
+    return Outcome::DROP;
+}
+
+void Outbox::Settle(const std::vector<int64_t> &ids, Outcome outcome) {
+    // 需持有互斥锁
+    auto now = std::chrono::steady_clock::now();
+    for (int64_t id : ids) {
+        sending.erase(id);
+        auto it = entries.find(id);
+        if (it == entries.end()) {
+            continue;
+        }
+        Entry &entry = it->second;
+        entry.attempts++;
+        if (outcome == Outcome::SENT) {
+            Remove(id);
+            stats.sent++;
+        } else if (outcome == Outcome::DROP || entry.attempts >= std::max(config.maxAttempts, 1)) {
+            Remove(id);
+            stats.dropped++;
+        } else {
+            int backoff = std::min(kMaxBackoffSeconds, 1 << std::min(entry.attempts, 16));
+            entry.retryAfter = now + std::chrono::seconds(backoff);
+            stats.retries++;
+        }
+    }
+}
+
+void Outbox::Remove(int64_t id) {
+    // 需持有互斥锁
+    if (entries.erase(id) > 0) {
+        Append("done " + std::to_string(id) + "\n");
+    }
+}
+
+void Outbox::Append(const std::string &text) {
+    // 需持有互斥锁
+    logLines++;
+    if (fd < 0) {
+        return;
+    }
+    size_t written = 0;
+    while (written < text.size()) {
+        ssize_t n = write(fd, text.data() + written, text.size() - written);
+        if (n <= 0) {
+            return;
+        }
+        written += static_cast<size_t>(n);
+    }
+}
+
+void Outbox::Rewrite() {
+    // 需持有互斥锁
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    logLines = entries.size();
+    if (directory.empty()) {
+        return;
+    }
+    std::string content;
+    for (const auto &item : entries) {
+        content += SerializeRecord(item.second.record);
+    }
+    WriteJournalFile(directory, kLogFileName, content);
+    std::string path = directory + "/" + kLogFileName;
+    fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+}
@@ -0,0 +1,172 @@
+#ifndef GMCURL_OUTBOX_H
+#define GMCURL_OUTBOX_H
+
+#include "curl.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @file outbox.h
+ * @brief 进程级离线发件箱（存储转发）
+ *
+ * 埋点上报等非紧急写请求先追加到缓存目录的outbox.log中，由专用线程稍后发送：
+ * - 指定URL的记录单独发送；未指定URL的记录按条数与大小合并为一个批量请求（每条一行，可gzip压缩）发往配置的地址
+ * - 记录在加入后等待一个发送周期再发送，便于合并；批量记录达到条数上限时立即发送
+ * - 网络错误、5xx、408与429按指数退避重试，超过最大发送次数或其他4xx时丢弃
+ * - 已发送的记录以done行追加到日志，失效行过多时重写日志；进程重启后未发送的记录继续发送
+ */
+
+/**
+ * @brief 发件箱配置
+ */
+typedef struct OutboxConfig {
+    std::string endpoint;                             ///< 批量请求地址，为空时未指定URL的记录保留不发送
+    std::vector<std::string> headers;                 ///< 批量请求的附加请求头（"Name: value"）
+    std::string contentType = "application/x-ndjson"; ///< 批量请求体类型
+    bool compress = true;                             ///< 批量请求体是否gzip压缩
+    int maxBatchRecords = 100;                        ///< 单个批量请求的最大记录数
+    int64_t maxBatchBytes = 262144;                   ///< 单个批量请求体（压缩前）的最大字节数
+    int64_t flushInterval = 5000;                     ///< 发送周期（毫秒）
+    int maxAttempts = 10;                             ///< 单条记录的最大发送次数
+    int64_t maxRecords = 10000;                       ///< 最多保留的记录数，超出时丢弃最早的记录
+    std::string caPath;                               ///< CA证书路径
+    std::string clientCertPath;                       ///< 客户端证书目录
+    bool isTLCP = false;                              ///< 是否使用TLCP
+    bool verifyServer = true;                         ///< 是否校验服务端证书
+    int connectTimeout = 15;                          ///< 连接超时（秒）
+    int readTimeout = 30;                             ///< 请求超时（秒）
+} OutboxConfig;
+
+/**
+ * @brief 发件箱记录
+ */
+typedef struct OutboxRecord {
+    int64_t id = 0;                   ///< 记录ID
+    std::string url;                  ///< 请求URL，为空表示合并到批量请求
+    std::string method = "POST";      ///< 请求方法
+    std::vector<std::string> headers; ///< 请求头（"Name: value"，批量记录忽略）
+    std::string body;                 ///< 请求体
+} OutboxRecord;
+
+/**
+ * @brief 发件箱统计
+ */
+typedef struct OutboxStats {
+    int64_t pending = 0; ///< 未发送的记录数
+    int64_t sent = 0;    ///< 已发送的记录数
+    int64_t batches = 0; ///< 已发送的批量请求数
+    int64_t retries = 0; ///< 重试次数
+    int64_t dropped = 0; ///< 丢弃的记录数
+} OutboxStats;
+
+/**
+ * @brief 句柄配置回调（传输层配置与共享缓存）
+ */
+typedef std::function<void(CURL *, const OutboxConfig &)> OutboxConfigurator;
+
+/**
+ * @brief 进程级离线发件箱
+ */
+class Outbox {
+public:
+    /**
+     * @brief 获取进程级实例
+     */
+    static Outbox &Instance();
+
+    Outbox(const Outbox &) = delete;
+    Outbox &operator=(const Outbox &) = delete;
+
+    /**
+     * @brief 加载目录中的日志（再次调用时合并新目录中的记录，未发送的记录移动到新目录），目录为空时只保存在内存中
+     */
+    void Load(const std::string &directory);
+
+    /**
+     * @brief 设置句柄配置回调并启动发送线程
+     */
+    void Start(OutboxConfigurator configurator);
+
+    /**
+     * @brief 更新配置
+     */
+    void Configure(const OutboxConfig &config);
+
+    /**
+     * @brief 当前配置
+     */
+    OutboxConfig Config();
+
+    /**
+     * @brief 追加记录（写入日志后返回）
+     * @return 记录ID
+     */
+    int64_t Enqueue(OutboxRecord record);
+
+    /**
+     * @brief 立即发送所有未在退避中的记录
+     */
+    void Flush();
+
+    /**
+     * @brief 统计信息
+     */
+    OutboxStats Stats();
+
+private:
+    Outbox() = default;
+
+    /**
+     * @brief 未发送的记录
+     */
+    typedef struct Entry {
+        OutboxRecord record;                              ///< 记录
+        int attempts = 0;                                 ///< 已发送次数
+        std::chrono::steady_clock::time_point enqueued;   ///< 加入时间
+        std::chrono::steady_clock::time_point retryAfter; ///< 退避结束时间
+    } Entry;
+
+    /**
+     * @brief 单次发送结果
+     */
+    enum class Outcome {
+        SENT,  ///< 已发送
+        RETRY, ///< 稍后重试
+        DROP   ///< 不可重试，丢弃
+    };
+
+    void Loop();
+    bool IsDue(const Entry &entry, std::chrono::steady_clock::time_point now, bool flushing) const;
+    std::chrono::steady_clock::time_point NextDue() const;
+    size_t BatchCount() const;
+    Outcome Send(const std::string &method, const std::string &url, const std::vector<std::string> &headers,
+                 const std::string &body, const OutboxConfig &snapshot);
+    void Settle(const std::vector<int64_t> &ids, Outcome outcome);
+    void Remove(int64_t id);
+    void Append(const std::string &text);
+    void Rewrite();
+
+    std::mutex mutex;                 ///< 互斥锁
+    std::condition_variable wakeup;   ///< 记录、配置或发送请求变化
+    std::map<int64_t, Entry> entries; ///< 记录ID -> 未发送的记录（按加入顺序）
+    std::set<int64_t> sending;        ///< 发送中的记录ID
+    OutboxConfig config;              ///< 配置
+    OutboxConfigurator configurator;  ///< 句柄配置回调
+    std::string directory;            ///< 日志目录
+    int fd = -1;                      ///< 日志文件描述符
+    size_t logLines = 0;              ///< 日志中的记录与done行数
+    int64_t nextId = 1;               ///< 下一个记录ID
+    bool loaded = false;              ///< 是否已加载日志
+    bool started = false;             ///< 发送线程是否已启动
+    bool flushRequested = false;      ///< 是否请求立即发送
+    OutboxStats stats;                ///< 统计（pending在读取时计算）
+};
+
+#endif // GMCURL_OUTBOX_H
@@ -0,0 +1,327 @@
+#include "parallel_upload.h"
+#include <algorithm>
+#include <sys/stat.h>
+#include <thread>
+
+/**
+ * @file parallel_upload.cpp
+ * @brief 并行分块上传实现
+ */
+
+namespace {
+
+/**
+ * @brief S3允许的最大分块数
+ */
+const int64_t kMaxParts = 10000;
+
+/**
+ * @brief 最大并发分块数
+ */
+const int kMaxConcurrency = 16;
+
+/**
+ * @brief 重试等待的最长时间（秒）
+ */
+const int kMaxBackoffSeconds = 30;
+
+/**
+ * @brief 进度回调的间隔
+ */
+const int kProgressIntervalMs = 200;
+
+/**
+ * @brief 取XML中首个指定元素的文本
+ */
+std::string XmlElement(const std::string &xml, const std::string &name) {
+    std::string open = "<" + name + ">";
+    size_t begin = xml.find(open);
+    if (begin == std::string::npos) {
+        return "";
+    }
+    begin += open.size();
+    size_t end = xml.find("</" + name + ">", begin);
+    return end == std::string::npos ? "" : xml.substr(begin, end - begin);
+}
+
+std::string XmlEscape(const std::string &value) {
+    std::string result;
+    result.reserve(value.size());
+    for (char ch : value) {
+        if (ch == '&') {
+            result += "&amp;";
+        } else if (ch == '<') {
+            result += "&lt;";
+        } else if (ch == '>') {
+            result += "&gt;";
+        } else {
+            result += ch;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 服务端暂时不可用（可重试）
+ */
+bool IsStatusRetriable(long status) { return status >= 500 || status == 408 || status == 429; }
+
+std::chrono::steady_clock::duration Backoff(int retries) {
+    return std::chrono::seconds(std::min(1 << std::min(retries - 1, 5), kMaxBackoffSeconds));
+}
+
+} // namespace
+
+ParallelUpload::ParallelUpload(const std::string &url, const std::string &filePath,
+                               const ParallelUploadConfig &config, const std::vector<std::string> &headers)
+    : url(url), filePath(filePath), config(config), headers(headers) {
+    if (this->config.partSize <= 0) {
+        this->config.partSize = ParallelUploadConfig().partSize;
+    }
+    this->config.concurrency = std::max(1, std::min(this->config.concurrency, kMaxConcurrency));
+    this->config.maxRetries = std::max(0, this->config.maxRetries);
+    control.owner = this;
+}
+
+UploadResult ParallelUpload::Run(const UploadConfigurator &newConfigurator, const UploadProgress &newProgress) {
+    UploadResult out;
+    struct stat st;
+    if (stat(filePath.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        out.result = CURLE_READ_ERROR;
+        out.error = "Failed to open file for upload";
+        return out;
+    }
+    configurator = &newConfigurator;
+    progress = &newProgress;
+    total = static_cast<int64_t>(st.st_size);
+
+    // 初始化上传，取得UploadId
+    out.result = PerformWithRetry("POST", Target("uploads"), {}, nullptr, out);
+    if (out.result != CURLE_OK || out.status != 200) {
+        Finish();
+        return out;
+    }
+    std::string id = XmlElement(out.body, "UploadId");
+    char *escaped = id.empty() ? nullptr : curl_easy_escape(nullptr, id.c_str(), static_cast<int>(id.size()));
+    if (!escaped) {
+        out.error = "Multipart upload initiation response without UploadId";
+        Finish();
+        return out;
+    }
+    uploadId = escaped;
+    curl_free(escaped);
+
+    // 分块数超过上限时增大分块，空文件上传一个空分块
+    int64_t partSize = std::max(config.partSize, (total + kMaxParts - 1) / kMaxParts);
+    for (int64_t offset = 0; offset < total || parts.empty(); offset += partSize) {
+        std::unique_ptr<Part> part(new Part());
+        part->owner = this;
+        part->number = static_cast<int>(parts.size()) + 1;
+        part->offset = offset;
+        part->length = std::min(partSize, total - offset);
+        parts.push_back(std::move(part));
+    }
+    remaining = parts.size();
+
+    std::vector<std::thread> workers;
+    size_t count = std::min(static_cast<size_t>(config.concurrency), parts.size());
+    for (size_t i = 0; i < count; i++) {
+        workers.emplace_back(&ParallelUpload::Worker, this);
+    }
+    // 调用线程汇总各分块进度
+    bool canceled = false;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (remaining > 0 && !aborting) {
+        changed.wait_for(lock, std::chrono::milliseconds(kProgressIntervalMs));
+        int64_t uploaded = confirmed;
+        for (const auto &part : parts) {
+            if (part->running) {
+                uploaded += part->sent;
+            }
+        }
+        lock.unlock();
+        if (newProgress && newProgress(uploaded, total)) {
+            canceled = true;
+            aborting = true;
+        }
+        lock.lock();
+    }
+    lock.unlock();
+    changed.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    if (canceled || failed) {
+        if (canceled) {
+            out = UploadResult();
+            out.result = CURLE_ABORTED_BY_CALLBACK;
+        } else {
+            out = failure;
+        }
+        out.offset = confirmed;
+        Abort();
+        Finish();
+        return out;
+    }
+
+    // 按分块序号提交ETag列表
+    std::string xml = "<CompleteMultipartUpload>";
+    for (const auto &part : parts) {
+        xml += "<Part><PartNumber>" + std::to_string(part->number) + "</PartNumber><ETag>" + XmlEscape(part->etag) +
+               "</ETag></Part>";
+    }
+    xml += "</CompleteMultipartUpload>";
+    MemoryBodyReader body(xml.data(), xml.size());
+    out.result = PerformWithRetry("POST", Target("uploadId=" + uploadId), {"Content-Type: application/xml"}, &body,
+                                  out);
+    out.offset = total;
+    // 完成请求可能在200响应中返回错误
+    if (out.result != CURLE_OK || out.status != 200 || out.body.find("<Error>") != std::string::npos) {
+        if (out.result == CURLE_OK && out.status == 200) {
+            out.error = "Multipart upload completion failed";
+        }
+        Abort();
+    }
+    Finish();
+    return out;
+}
+
+void ParallelUpload::Worker() {
+    while (Part *part = NextPart()) {
+        SendPart(*part);
+    }
+}
+
+ParallelUpload::Part *ParallelUpload::NextPart() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!aborting) {
+        auto now = std::chrono::steady_clock::now();
+        auto earliest = std::chrono::steady_clock::time_point::max();
+        for (const auto &part : parts) {
+            if (!part->etag.empty() || part->running) {
+                continue;
+            }
+            if (part->retryAt <= now) {
+                part->running = true;
+                return part.get();
+            }
+            earliest = std::min(earliest, part->retryAt);
+        }
+        // 其余分块已完成或正由其他线程上传
+        if (earliest == std::chrono::steady_clock::time_point::max()) {
+            return nullptr;
+        }
+        changed.wait_until(lock, earliest);
+    }
+    return nullptr;
+}
+
+void ParallelUpload::SendPart(Part &part) {
+    FileBodyReader body(filePath, part.offset, part.length);
+    UploadResult out;
+    // 分块请求体为原始文件数据，不沿用附加请求头中的Content-Type
+    std::string query = "partNumber=" + std::to_string(part.number) + "&uploadId=" + uploadId;
+    CURLcode result = Perform("PUT", Target(query), {"Content-Type:"}, &body, &part, out);
+    std::string etag;
+    bool uploaded = result == CURLE_OK && out.status == 200 && FindResponseHeader(out.headers, "ETag", etag) &&
+                    !etag.empty();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    part.running = false;
+    part.sent = 0;
+    if (uploaded) {
+        part.etag = etag;
+        confirmed += part.length;
+        remaining--;
+    } else if (!aborting && part.retries < config.maxRetries &&
+               (result == CURLE_OK ? IsStatusRetriable(out.status) : IsUploadRetriable(result))) {
+        part.retries++;
+        part.retryAt = std::chrono::steady_clock::now() + Backoff(part.retries);
+    } else if (!failed && !aborting) {
+        // 重试耗尽或不可恢复的错误，中断其余分块
+        failed = true;
+        failure = out;
+        failure.result = result;
+        if (result == CURLE_OK && out.status == 200) {
+            failure.error = "Part upload response without ETag";
+        }
+        aborting = true;
+    }
+    changed.notify_all();
+}
+
+std::string ParallelUpload::Target(const std::string &query) const {
+    return url + (url.find('?') == std::string::npos ? "?" : "&") + query;
+}
+
+CURLcode ParallelUpload::Perform(const std::string &method, const std::string &target,
+                                 const std::vector<std::string> &extra, BodyReader *body, Part *part,
+                                 UploadResult &out) {
+    std::vector<std::string> protocolHeaders = extra;
+    if (!config.accessKeyId.empty() && !config.sessionToken.empty()) {
+        protocolHeaders.push_back("X-Amz-Security-Token: " + config.sessionToken);
+    }
+    const UploadConfigurator &setup = *configurator;
+    return PerformUploadRequest(method, target, protocolHeaders, headers, body,
+                                [this, &setup, part](CURL *curl) {
+                                    setup(curl, 0);
+                                    if (!config.accessKeyId.empty()) {
+                                        // 分块请求体不参与签名（x-amz-content-sha256: UNSIGNED-PAYLOAD）
+                                        std::string provider = "aws:amz:" + config.region + ":s3";
+                                        curl_easy_setopt(curl, CURLOPT_AWS_SIGV4, provider.c_str());
+                                        curl_easy_setopt(curl, CURLOPT_USERNAME, config.accessKeyId.c_str());
+                                        curl_easy_setopt(curl, CURLOPT_PASSWORD, config.secretAccessKey.c_str());
+                                    }
+                                    if (part) {
+                                        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+                                        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, PartProgress);
+                                        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, part);
+                                    }
+                                },
+                                out);
+}
+
+CURLcode ParallelUpload::PerformWithRetry(const std::string &method, const std::string &target,
+                                          const std::vector<std::string> &extra, BodyReader *body,
+                                          UploadResult &out) {
+    int retries = 0;
+    while (true) {
+        if (body) {
+            body->Rewind();
+        }
+        CURLcode result = Perform(method, target, extra, body, &control, out);
+        bool retriable = result == CURLE_OK ? IsStatusRetriable(out.status) : IsUploadRetriable(result);
+        if (!retriable || retries >= config.maxRetries || aborting) {
+            return result;
+        }
+        retries++;
+        std::this_thread::sleep_for(Backoff(retries));
+    }
+}
+
+void ParallelUpload::Finish() {
+    configurator = nullptr;
+    progress = nullptr;
+}
+
+void ParallelUpload::Abort() {
+    // 不安装进度回调，中断状态下仍能发出放弃请求
+    UploadResult out;
+    Perform("DELETE", Target("uploadId=" + uploadId), {}, nullptr, nullptr, out);
+}
+
+int ParallelUpload::PartProgress(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal,
+                                 curl_off_t ulnow) {
+    auto *part = static_cast<Part *>(clientp);
+    ParallelUpload *owner = part->owner;
+    // 初始化与完成请求在调用线程中执行，直接检查是否中断
+    if (part == &owner->control) {
+        if (*owner->progress && (*owner->progress)(owner->confirmed, owner->total)) {
+            owner->aborting = true;
+        }
+    } else {
+        part->sent = static_cast<int64_t>(ulnow);
+    }
+    return owner->aborting ? 1 : 0;
+}
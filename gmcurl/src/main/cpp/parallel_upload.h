@@ -0,0 +1,119 @@
+#ifndef GMCURL_PARALLEL_UPLOAD_H
+#define GMCURL_PARALLEL_UPLOAD_H
+
+#include "body_reader.h"
+#include "resumable_upload.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @file parallel_upload.h
+ * @brief 并行分块上传（S3 Multipart Upload）
+ *
+ * 大文件切分为多个分块，由多个线程各自从连接池取用句柄并行上传，单个TCP连接的吞吐不再是上限：
+ * - 初始化：POST 对象URL?uploads，从响应XML中取得UploadId
+ * - 上传分块：PUT 对象URL?partNumber=N&uploadId=ID，记录响应的ETag；单个分块失败时按指数退避重试
+ * - 完成：POST 对象URL?uploadId=ID，请求体为按分块序号排列的ETag列表
+ * - 任一分块重试耗尽、被取消或完成请求失败时，DELETE 对象URL?uploadId=ID 放弃本次上传
+ * 配置访问密钥时由libcurl按AWS Signature V4签名（分块请求体不参与签名），适用于S3兼容存储（如MinIO）。
+ */
+
+/**
+ * @brief 并行分块上传配置
+ */
+typedef struct ParallelUploadConfig {
+    bool enabled = false;             ///< 是否启用并行分块上传
+    int64_t partSize = 8388608;       ///< 分块大小（默认8MB，S3要求除最后一块外不小于5MB）
+    int concurrency = 4;              ///< 同时上传的分块数
+    int maxRetries = 3;               ///< 单个分块的最大重试次数
+    std::string accessKeyId;          ///< 访问密钥ID（为空时不签名）
+    std::string secretAccessKey;      ///< 访问密钥
+    std::string sessionToken;         ///< 临时凭证令牌（可选）
+    std::string region = "us-east-1"; ///< 签名区域
+} ParallelUploadConfig;
+
+/**
+ * @brief 上传进度回调（在调用线程中调用）
+ * @return 是否中断上传
+ */
+typedef std::function<bool(int64_t uploaded, int64_t total)> UploadProgress;
+
+/**
+ * @brief 单个文件的并行分块上传（调用线程等待所有分块完成）
+ */
+class ParallelUpload {
+public:
+    /**
+     * @param url 对象URL
+     * @param filePath 文件路径
+     * @param config 并行分块上传配置
+     * @param headers 附加请求头（"Name: value"），随每个请求发送
+     */
+    ParallelUpload(const std::string &url, const std::string &filePath, const ParallelUploadConfig &config,
+                   const std::vector<std::string> &headers);
+
+    /**
+     * @brief 执行上传直到完成、失败或中断
+     * @param configurator 请求配置回调（传输层配置与超时，可在多个线程中同时调用）
+     * @param progress 进度回调（返回true时中断上传并放弃已上传的分块）
+     * @return 完成请求的响应，失败时为失败请求的响应
+     */
+    UploadResult Run(const UploadConfigurator &configurator, const UploadProgress &progress);
+
+private:
+    /**
+     * @brief 分块
+     */
+    typedef struct Part {
+        ParallelUpload *owner = nullptr;               ///< 所属上传
+        int number = 0;                                ///< 分块序号（从1开始）
+        int64_t offset = 0;                            ///< 文件偏移
+        int64_t length = 0;                            ///< 分块长度
+        std::string etag;                              ///< 服务端返回的ETag
+        bool running = false;                          ///< 是否正在上传
+        int retries = 0;                               ///< 已重试次数
+        std::chrono::steady_clock::time_point retryAt; ///< 下次重试时间
+        std::atomic<int64_t> sent{0};                  ///< 本次尝试已发送的字节数
+    } Part;
+
+    void Worker();
+    Part *NextPart();
+    void SendPart(Part &part);
+    std::string Target(const std::string &query) const;
+    CURLcode Perform(const std::string &method, const std::string &target, const std::vector<std::string> &extra,
+                     BodyReader *body, Part *part, UploadResult &out);
+    CURLcode PerformWithRetry(const std::string &method, const std::string &target,
+                              const std::vector<std::string> &extra, BodyReader *body, UploadResult &out);
+    void Abort();
+    void Finish();
+    static int PartProgress(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal,
+                            curl_off_t ulnow);
+
+    std::string url;                                  ///< 对象URL
+    std::string filePath;                             ///< 文件路径
+    ParallelUploadConfig config;                      ///< 配置
+    std::vector<std::string> headers;                 ///< 附加请求头
+    const UploadConfigurator *configurator = nullptr; ///< 请求配置回调（Run期间有效）
+    const UploadProgress *progress = nullptr;         ///< 进度回调（Run期间有效）
+    std::string uploadId;                             ///< 上传ID（已URL编码）
+    int64_t total = 0;                                ///< 文件大小
+
+    std::mutex mutex;                         ///< 互斥锁（分块状态与失败结果）
+    std::condition_variable changed;          ///< 分块状态变化
+    std::vector<std::unique_ptr<Part>> parts; ///< 全部分块
+    Part control;                             ///< 初始化/完成请求的进度（用于中断）
+    size_t remaining = 0;                     ///< 未完成的分块数
+    int64_t confirmed = 0;                    ///< 已完成分块的总字节数
+    std::atomic<bool> aborting{false};        ///< 中断所有分块
+    bool failed = false;                      ///< 是否已有分块失败
+    UploadResult failure;                     ///< 首个失败分块的响应
+};
+
+#endif // GMCURL_PARALLEL_UPLOAD_H
@@ -0,0 +1,271 @@
+#include "payload_cipher.h"
+#include <algorithm>
+#include <cstring>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+/**
+ * @file payload_cipher.cpp
+ * @brief SM4 应用层载荷加解密实现（基于libcrypto）
+ */
+
+namespace {
+
+/**
+ * @brief GCM认证标签长度
+ */
+const size_t kGcmTagSize = 16;
+
+/**
+ * @brief SM4分组长度
+ */
+const size_t kSm4BlockSize = 16;
+
+/**
+ * @brief 加密时单次读取的明文大小
+ */
+const size_t kEncryptChunkSize = 65536;
+
+/**
+ * @brief 线程复用的加解密上下文，线程退出时释放
+ */
+typedef struct ThreadCipherContexts {
+    EVP_CIPHER_CTX *encrypt = nullptr; ///< 加密上下文
+    EVP_CIPHER_CTX *decrypt = nullptr; ///< 解密上下文
+
+    ~ThreadCipherContexts() {
+        EVP_CIPHER_CTX_free(encrypt);
+        EVP_CIPHER_CTX_free(decrypt);
+    }
+} ThreadCipherContexts;
+
+EVP_CIPHER_CTX *AcquireThreadContext(bool encrypt) {
+    thread_local ThreadCipherContexts contexts;
+    EVP_CIPHER_CTX *&ctx = encrypt ? contexts.encrypt : contexts.decrypt;
+    if (ctx == nullptr) {
+        ctx = EVP_CIPHER_CTX_new();
+    }
+    return ctx;
+}
+
+const EVP_CIPHER *CipherOf(PayloadCipherMode mode) {
+    // 算法对象只获取一次，所有线程共享
+    static EVP_CIPHER *gcm = EVP_CIPHER_fetch(nullptr, "SM4-GCM", nullptr);
+    static EVP_CIPHER *cbc = EVP_CIPHER_fetch(nullptr, "SM4-CBC", nullptr);
+    return mode == PayloadCipherMode::SM4_GCM ? gcm : cbc;
+}
+
+} // namespace
+
+bool ParsePayloadCipherMode(const std::string &name, PayloadCipherMode &mode) {
+    if (name == "SM4-GCM" || name == "sm4-gcm") {
+        mode = PayloadCipherMode::SM4_GCM;
+    } else if (name == "SM4-CBC" || name == "sm4-cbc") {
+        mode = PayloadCipherMode::SM4_CBC;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool PayloadHexDecode(const std::string &hex, std::string &out) {
+    if (hex.size() % 2 != 0) {
+        return false;
+    }
+    out.clear();
+    out.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int value = 0;
+        for (size_t j = i; j < i + 2; j++) {
+            char ch = hex[j];
+            value <<= 4;
+            if (ch >= '0' && ch <= '9') {
+                value |= ch - '0';
+            } else if (ch >= 'a' && ch <= 'f') {
+                value |= ch - 'a' + 10;
+            } else if (ch >= 'A' && ch <= 'F') {
+                value |= ch - 'A' + 10;
+            } else {
+                return false;
+            }
+        }
+        out.push_back(static_cast<char>(value));
+    }
+    return true;
+}
+
+std::string PayloadHexEncode(const std::string &data) {
+    static const char hex[] = "0123456789abcdef";
+    std::string result;
+    result.reserve(data.size() * 2);
+    for (unsigned char ch : data) {
+        result.push_back(hex[ch >> 4]);
+        result.push_back(hex[ch & 0x0F]);
+    }
+    return result;
+}
+
+bool GeneratePayloadIv(PayloadCipherMode mode, std::string &iv) {
+    iv.assign(mode == PayloadCipherMode::SM4_GCM ? 12 : kSm4BlockSize, '\0');
+    return RAND_bytes(reinterpret_cast<unsigned char *>(&iv[0]), static_cast<int>(iv.size())) == 1;
+}
+
+PayloadCipher::PayloadCipher(const PayloadCipherConfig &config, bool encrypt)
+    : config(config), encrypt(encrypt), ctx(AcquireThreadContext(encrypt)) {}
+
+bool PayloadCipher::Init(const std::string &iv) {
+    initialized = false;
+    tail.clear();
+    const EVP_CIPHER *cipher = CipherOf(config.mode);
+    if (ctx == nullptr || cipher == nullptr || config.key.size() != kSm4BlockSize) {
+        return false;
+    }
+    if (EVP_CipherInit_ex(ctx, cipher, nullptr, nullptr, nullptr, encrypt ? 1 : 0) != 1) {
+        return false;
+    }
+    if (config.mode == PayloadCipherMode::SM4_GCM) {
+        if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, static_cast<int>(iv.size()), nullptr) != 1) {
+            return false;
+        }
+    } else if (iv.size() != kSm4BlockSize) {
+        return false;
+    }
+    if (EVP_CipherInit_ex(ctx, nullptr, nullptr, reinterpret_cast<const unsigned char *>(config.key.data()),
+                          reinterpret_cast<const unsigned char *>(iv.data()), encrypt ? 1 : 0) != 1) {
+        return false;
+    }
+    if (config.mode == PayloadCipherMode::SM4_GCM && !config.aad.empty()) {
+        int outLen = 0;
+        if (EVP_CipherUpdate(ctx, nullptr, &outLen, reinterpret_cast<const unsigned char *>(config.aad.data()),
+                             static_cast<int>(config.aad.size())) != 1) {
+            return false;
+        }
+    }
+    initialized = true;
+    return true;
+}
+
+bool PayloadCipher::Process(const char *data, size_t len, std::string &out) {
+    if (len == 0) {
+        return true;
+    }
+    size_t offset = out.size();
+    out.resize(offset + len + kSm4BlockSize);
+    int outLen = 0;
+    if (EVP_CipherUpdate(ctx, reinterpret_cast<unsigned char *>(&out[offset]), &outLen,
+                         reinterpret_cast<const unsigned char *>(data), static_cast<int>(len)) != 1) {
+        out.resize(offset);
+        return false;
+    }
+    out.resize(offset + outLen);
+    return true;
+}
+
+bool PayloadCipher::Update(const char *data, size_t len, std::string &out) {
+    if (!initialized) {
+        return false;
+    }
+    if (encrypt || config.mode != PayloadCipherMode::SM4_GCM) {
+        return Process(data, len, out);
+    }
+    // GCM解密：始终保留最后16字节作为认证标签
+    if (len >= kGcmTagSize) {
+        if (!Process(tail.data(), tail.size(), out) || !Process(data, len - kGcmTagSize, out)) {
+            return false;
+        }
+        tail.assign(data + len - kGcmTagSize, kGcmTagSize);
+        return true;
+    }
+    tail.append(data, len);
+    if (tail.size() > kGcmTagSize) {
+        size_t excess = tail.size() - kGcmTagSize;
+        if (!Process(tail.data(), excess, out)) {
+            return false;
+        }
+        tail.erase(0, excess);
+    }
+    return true;
+}
+
+bool PayloadCipher::Final(std::string &out) {
+    if (!initialized) {
+        return false;
+    }
+    initialized = false;
+    if (!encrypt && config.mode == PayloadCipherMode::SM4_GCM) {
+        if (tail.size() != kGcmTagSize ||
+            EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, static_cast<int>(kGcmTagSize), &tail[0]) != 1) {
+            return false;
+        }
+    }
+    size_t offset = out.size();
+    out.resize(offset + kSm4BlockSize);
+    int outLen = 0;
+    if (EVP_CipherFinal_ex(ctx, reinterpret_cast<unsigned char *>(&out[offset]), &outLen) != 1) {
+        out.resize(offset);
+        return false;
+    }
+    out.resize(offset + outLen);
+    if (encrypt && config.mode == PayloadCipherMode::SM4_GCM) {
+        offset = out.size();
+        out.resize(offset + kGcmTagSize);
+        if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, static_cast<int>(kGcmTagSize), &out[offset]) != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int64_t PayloadCipher::CipherTextSize(PayloadCipherMode mode, int64_t plainSize) {
+    if (mode == PayloadCipherMode::SM4_GCM) {
+        return plainSize + static_cast<int64_t>(kGcmTagSize);
+    }
+    return (plainSize / kSm4BlockSize + 1) * kSm4BlockSize;
+}
+
+EncryptingBodyReader::EncryptingBodyReader(const PayloadCipherConfig &config, const std::string &iv,
+                                           BodyReader *source)
+    : cipher(config, true), iv(iv), source(source), plain(kEncryptChunkSize, '\0') {
+    failed = !cipher.Init(iv);
+}
+
+size_t EncryptingBodyReader::Read(char *buffer, size_t length) {
+    size_t written = 0;
+    while (written < length && !failed) {
+        if (pendingOffset < pending.size()) {
+            size_t chunk = std::min(length - written, pending.size() - pendingOffset);
+            memcpy(buffer + written, pending.data() + pendingOffset, chunk);
+            pendingOffset += chunk;
+            written += chunk;
+            continue;
+        }
+        if (finished) {
+            break;
+        }
+        pending.clear();
+        pendingOffset = 0;
+        size_t got = source->Read(&plain[0], plain.size());
+        if (source->Failed()) {
+            return 0;
+        }
+        if (got > 0) {
+            failed = !cipher.Update(plain.data(), got, pending);
+        } else {
+            finished = true;
+            failed = !cipher.Final(pending);
+        }
+    }
+    return failed ? 0 : written;
+}
+
+bool EncryptingBodyReader::Rewind() {
+    pending.clear();
+    pendingOffset = 0;
+    finished = false;
+    failed = !source->Rewind() || !cipher.Init(iv);
+    return !failed;
+}
+
+int64_t EncryptingBodyReader::TotalSize() const {
+    return PayloadCipher::CipherTextSize(cipher.Mode(), source->TotalSize());
+}
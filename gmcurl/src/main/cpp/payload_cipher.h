@@ -0,0 +1,138 @@
+#ifndef GMCURL_PAYLOAD_CIPHER_H
+#define GMCURL_PAYLOAD_CIPHER_H
+
+#include "body_reader.h"
+#include <string>
+
+/**
+ * @file payload_cipher.h
+ * @brief SM4 应用层载荷加解密阶段
+ *
+ * 在TLCP之上对请求体/响应体做SM4-GCM或SM4-CBC加密：
+ * - SM4-GCM：密文后追加16字节认证标签，IV默认12字节
+ * - SM4-CBC：PKCS#7填充，IV为16字节
+ * 请求体在读取路径中流式加密，响应体在写入回调中流式解密，明文不会整体驻留内存。
+ * 加解密上下文（EVP_CIPHER_CTX）按线程复用，同一线程同一时刻最多一个加密器和一个解密器。
+ */
+
+struct evp_cipher_ctx_st;
+
+/**
+ * @brief 载荷加密模式
+ */
+enum class PayloadCipherMode {
+    SM4_GCM, ///< SM4-GCM
+    SM4_CBC  ///< SM4-CBC（PKCS#7填充）
+};
+
+/**
+ * @brief 载荷加密配置
+ */
+typedef struct PayloadCipherConfig {
+    PayloadCipherMode mode = PayloadCipherMode::SM4_GCM; ///< 加密模式
+    std::string key;                                     ///< 16字节密钥
+    std::string iv;                                      ///< IV，为空时每个请求随机生成
+    std::string aad;                                     ///< GCM附加认证数据
+    std::string ivHeaderName = "X-Payload-IV";           ///< 传递IV的请求/响应头（十六进制）
+    bool encryptRequest = true;                          ///< 是否加密请求体
+    bool decryptResponse = true;                         ///< 是否解密响应体
+} PayloadCipherConfig;
+
+/**
+ * @brief 解析加密模式名称
+ * @param name 'SM4-GCM' | 'SM4-CBC'
+ * @param mode 输出模式
+ * @return 是否支持
+ */
+bool ParsePayloadCipherMode(const std::string &name, PayloadCipherMode &mode);
+
+/**
+ * @brief 十六进制字符串解码
+ * @param hex 十六进制字符串
+ * @param out 输出字节
+ * @return 是否为合法十六进制
+ */
+bool PayloadHexDecode(const std::string &hex, std::string &out);
+
+/**
+ * @brief 十六进制编码
+ */
+std::string PayloadHexEncode(const std::string &data);
+
+/**
+ * @brief 生成随机IV
+ * @param mode 加密模式
+ * @param iv 输出IV
+ * @return 是否成功
+ */
+bool GeneratePayloadIv(PayloadCipherMode mode, std::string &iv);
+
+/**
+ * @brief 流式SM4加解密器
+ */
+class PayloadCipher {
+public:
+    PayloadCipher(const PayloadCipherConfig &config, bool encrypt);
+
+    PayloadCipher(const PayloadCipher &) = delete;
+    PayloadCipher &operator=(const PayloadCipher &) = delete;
+
+    /**
+     * @brief 使用指定IV(重新)初始化
+     */
+    bool Init(const std::string &iv);
+
+    /**
+     * @brief 处理一段数据，结果追加到out
+     */
+    bool Update(const char *data, size_t len, std::string &out);
+
+    /**
+     * @brief 结束处理，GCM加密时输出认证标签，GCM解密时校验认证标签
+     */
+    bool Final(std::string &out);
+
+    /**
+     * @brief 加密模式
+     */
+    PayloadCipherMode Mode() const { return config.mode; }
+
+    /**
+     * @brief 明文长度对应的密文长度
+     */
+    static int64_t CipherTextSize(PayloadCipherMode mode, int64_t plainSize);
+
+private:
+    bool Process(const char *data, size_t len, std::string &out);
+
+    const PayloadCipherConfig &config; ///< 加密配置
+    bool encrypt;                      ///< 加密/解密
+    evp_cipher_ctx_st *ctx = nullptr;  ///< 线程复用的加解密上下文
+    std::string tail;                  ///< GCM解密时暂存的末尾认证标签
+    bool initialized = false;          ///< 是否已初始化
+};
+
+/**
+ * @brief 流式加密请求体，包装明文请求体
+ */
+class EncryptingBodyReader : public BodyReader {
+public:
+    EncryptingBodyReader(const PayloadCipherConfig &config, const std::string &iv, BodyReader *source);
+
+    size_t Read(char *buffer, size_t length) override;
+    bool Rewind() override;
+    int64_t TotalSize() const override;
+    bool Failed() const override { return failed || source->Failed(); }
+
+private:
+    PayloadCipher cipher;     ///< 加密器
+    std::string iv;           ///< IV
+    BodyReader *source;       ///< 明文请求体
+    std::string plain;        ///< 明文读取缓冲区
+    std::string pending;      ///< 待输出密文
+    size_t pendingOffset = 0; ///< 待输出密文偏移
+    bool finished = false;    ///< 明文是否读取完毕
+    bool failed = false;      ///< 加密错误标识
+};
+
+#endif // GMCURL_PAYLOAD_CIPHER_H
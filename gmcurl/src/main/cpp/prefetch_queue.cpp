@@ -0,0 +1,251 @@
+#include "prefetch_queue.h"
+#include "connection_pool.h"
+#include "response_cache.h"
+#include "resumable_upload.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+/**
+ * @file prefetch_queue.cpp
+ * @brief 进程级空闲预取队列实现
+ */
+
+namespace {
+
+/**
+ * @brief 前台请求全部结束后开始预取前的等待时间
+ */
+const std::chrono::milliseconds kIdleGrace(200);
+
+/**
+ * @brief 同一URL被前台请求中断的最大次数，超过后放弃
+ */
+const int kMaxYields = 3;
+
+/**
+ * @brief 单次预取的接收状态
+ */
+typedef struct FetchState {
+    std::atomic<int> *foreground = nullptr; ///< 前台请求数
+    std::string headers;                    ///< 响应头原始数据
+    std::string body;                       ///< 响应体
+} FetchState;
+
+size_t ReadHeader(char *data, size_t size, size_t nmemb, void *userp) {
+    auto *state = static_cast<FetchState *>(userp);
+    size_t len = size * nmemb;
+    // 重定向与100 Continue等中间响应的响应头不保留
+    if (len > 5 && strncmp(data, "HTTP/", 5) == 0) {
+        state->headers.clear();
+    }
+    state->headers.append(data, len);
+    return len;
+}
+
+size_t WriteBody(char *data, size_t size, size_t nmemb, void *userp) {
+    auto *state = static_cast<FetchState *>(userp);
+    size_t len = size * nmemb;
+    // 超过单个缓存条目上限的响应不预取
+    if (state->body.size() + len > ResponseCache::kMaxEntryBytes) {
+        return 0;
+    }
+    state->body.append(data, len);
+    return len;
+}
+
+/**
+ * @brief 按Cache-Control计算缓存有效期（秒），不可缓存时返回0
+ */
+int64_t CacheLifetime(const std::string &headers, int64_t ttl) {
+    // 按请求头区分的响应无法判断是否适用于之后的请求
+    std::string vary;
+    if (FindResponseHeader(headers, "Vary", vary)) {
+        return 0;
+    }
+    std::string cacheControl;
+    if (!FindResponseHeader(headers, "Cache-Control", cacheControl)) {
+        return ttl;
+    }
+    std::transform(cacheControl.begin(), cacheControl.end(), cacheControl.begin(), ::tolower);
+    if (cacheControl.find("no-store") != std::string::npos || cacheControl.find("no-cache") != std::string::npos ||
+        cacheControl.find("private") != std::string::npos) {
+        return 0;
+    }
+    size_t pos = cacheControl.find("max-age=");
+    if (pos != std::string::npos) {
+        int64_t maxAge = atoll(cacheControl.c_str() + pos + strlen("max-age="));
+        return std::max<int64_t>(0, std::min(ttl, maxAge));
+    }
+    return ttl;
+}
+
+} // namespace
+
+PrefetchQueue &PrefetchQueue::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static PrefetchQueue *queue = new PrefetchQueue();
+    return *queue;
+}
+
+void PrefetchQueue::Start(PrefetchConfigurator newConfigurator) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!configurator) {
+        configurator = newConfigurator;
+    }
+    if (!started) {
+        started = true;
+        std::thread([this] { Loop(); }).detach();
+    }
+}
+
+size_t PrefetchQueue::Add(const std::vector<std::string> &urls, const PrefetchOptions &options) {
+    auto shared = std::make_shared<const PrefetchOptions>(options);
+    std::string variant = ResponseCache::VariantOf(options.headers, options.caPath, options.clientCertPath,
+                                                   options.isTLCP, options.verifyServer);
+    size_t added = 0;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const std::string &url : urls) {
+        bool queued = std::any_of(tasks.begin(), tasks.end(), [&url, &variant](const Task &task) {
+            return task.url == url && task.variant == variant;
+        });
+        if (url.empty() || queued || ResponseCache::Instance().Contains(url, variant)) {
+            continue;
+        }
+        Task task;
+        task.url = url;
+        task.options = shared;
+        task.variant = variant;
+        tasks.push_back(task);
+        added++;
+    }
+    if (added > 0) {
+        wakeup.notify_all();
+    }
+    return added;
+}
+
+void PrefetchQueue::Clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.clear();
+}
+
+void PrefetchQueue::BeginForeground() { foreground++; }
+
+void PrefetchQueue::EndForeground() {
+    if (--foreground == 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        wakeup.notify_all();
+    }
+}
+
+PrefetchStats PrefetchQueue::Stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    PrefetchStats result = stats;
+    result.pending = static_cast<int64_t>(tasks.size());
+    return result;
+}
+
+void PrefetchQueue::Loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeup.wait(lock, [this] { return !tasks.empty() && foreground.load() == 0; });
+        // 前台请求刚结束时往往紧跟着下一个请求，空闲一段时间后再开始
+        if (wakeup.wait_for(lock, kIdleGrace, [this] { return foreground.load() > 0; }) || tasks.empty()) {
+            continue;
+        }
+        Task task = tasks.front();
+        tasks.pop_front();
+        lock.unlock();
+        Outcome outcome = ResponseCache::Instance().Contains(task.url, task.variant) ? Outcome::CACHED : Fetch(task);
+        lock.lock();
+        if (outcome == Outcome::YIELDED) {
+            stats.yielded++;
+            if (++task.yields <= kMaxYields) {
+                tasks.push_front(task);
+            } else {
+                stats.failed++;
+            }
+        } else if (outcome == Outcome::CACHED) {
+            stats.completed++;
+        } else {
+            stats.failed++;
+        }
+    }
+}
+
+PrefetchQueue::Outcome PrefetchQueue::Fetch(const Task &task) {
+    const PrefetchOptions &options = *task.options;
+    ConnectionPool &connectionPool = ConnectionPool::Instance();
+    std::string poolKey = ConnectionPool::KeyOf(task.url);
+    CURL *curl = connectionPool.Acquire(poolKey);
+    if (!curl) {
+        curl = curl_easy_init();
+    }
+    if (!curl) {
+        connectionPool.Release(poolKey, nullptr, false);
+        return Outcome::FAILED;
+    }
+    if (configurator) {
+        configurator(curl, options);
+    }
+    connectionPool.Prepare(curl);
+    FetchState state;
+    state.foreground = &foreground;
+    curl_slist *headerList = nullptr;
+    for (const std::string &header : options.headers) {
+        headerList = curl_slist_append(headerList, header.c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, task.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
+    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 10L);
+    curl_easy_setopt(curl, CURLOPT_REDIR_PROTOCOLS_STR, "http,https");
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, static_cast<long>(options.connectTimeout));
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, static_cast<long>(options.readTimeout));
+    if (options.maxBytesPerSecond > 0) {
+        curl_easy_setopt(curl, CURLOPT_MAX_RECV_SPEED_LARGE, static_cast<curl_off_t>(options.maxBytesPerSecond));
+    }
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, ReadHeader);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &state);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &state);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, Progress);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &state);
+
+    CURLcode result = curl_easy_perform(curl);
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+    curl_slist_free_all(headerList);
+    connectionPool.Release(poolKey, curl, result == CURLE_OK);
+
+    if (result == CURLE_ABORTED_BY_CALLBACK) {
+        return Outcome::YIELDED;
+    }
+    if (result != CURLE_OK || status != 200) {
+        return Outcome::FAILED;
+    }
+    int64_t lifetime = CacheLifetime(state.headers, options.ttl);
+    if (lifetime <= 0) {
+        return Outcome::FAILED;
+    }
+    auto response = std::make_shared<CachedResponse>();
+    response->status = status;
+    response->headers = std::move(state.headers);
+    response->body = std::move(state.body);
+    response->variant = task.variant;
+    response->expires = std::chrono::steady_clock::now() + std::chrono::seconds(lifetime);
+    ResponseCache::Instance().Store(task.url, std::move(response));
+    return Outcome::CACHED;
+}
+
+int PrefetchQueue::Progress(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal,
+                            curl_off_t ulnow) {
+    auto *state = static_cast<FetchState *>(clientp);
+    // 出现前台请求时让出网络
+    return state->foreground->load() > 0 ? 1 : 0;
+}
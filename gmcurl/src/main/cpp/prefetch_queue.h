@@ -0,0 +1,136 @@
+#ifndef GMCURL_PREFETCH_QUEUE_H
+#define GMCURL_PREFETCH_QUEUE_H
+
+#include "curl.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @file prefetch_queue.h
+ * @brief 进程级空闲预取队列
+ *
+ * 预取的URL由专用线程依次以GET请求取回，结果保存到响应缓存（见response_cache.h），不创建任何JS对象：
+ * - 只在没有前台请求（request()/客户端请求/fetchRange，含排队中的请求）时启动，前台请求全部结束后再等待200ms
+ * - 预取过程中出现前台请求时立即中断，该URL回到队首，前台请求结束后重新预取
+ * - 每次只执行一个预取，接收速度不超过配置的带宽上限
+ * - 只缓存200响应；Cache-Control为no-store/no-cache/private或带有Vary响应头时不缓存，max-age短于配置的有效期时以max-age为准
+ * - 缓存条目记录预取使用的请求头与TLS配置，只有相同配置的请求命中
+ */
+
+/**
+ * @brief 预取配置
+ */
+typedef struct PrefetchOptions {
+    std::vector<std::string> headers; ///< 请求头（"Name: value"）
+    std::string caPath;               ///< CA证书路径
+    std::string clientCertPath;       ///< 客户端证书目录
+    bool isTLCP = false;              ///< 是否使用TLCP
+    bool verifyServer = true;         ///< 是否校验服务端证书
+    int connectTimeout = 15;          ///< 连接超时（秒）
+    int readTimeout = 30;             ///< 请求超时（秒）
+    int64_t ttl = 300;                ///< 缓存有效期（秒）
+    int64_t maxBytesPerSecond = 0;    ///< 接收速度上限（字节/秒），0表示不限
+} PrefetchOptions;
+
+/**
+ * @brief 预取统计
+ */
+typedef struct PrefetchStats {
+    int64_t pending = 0;   ///< 等待预取的URL数
+    int64_t completed = 0; ///< 已缓存的URL数
+    int64_t failed = 0;    ///< 失败或不可缓存的URL数
+    int64_t yielded = 0;   ///< 因前台请求中断的次数
+} PrefetchStats;
+
+/**
+ * @brief 句柄配置回调（传输层配置与共享缓存）
+ */
+typedef std::function<void(CURL *, const PrefetchOptions &)> PrefetchConfigurator;
+
+/**
+ * @brief 进程级空闲预取队列
+ */
+class PrefetchQueue {
+public:
+    /**
+     * @brief 获取进程级实例
+     */
+    static PrefetchQueue &Instance();
+
+    PrefetchQueue(const PrefetchQueue &) = delete;
+    PrefetchQueue &operator=(const PrefetchQueue &) = delete;
+
+    /**
+     * @brief 设置句柄配置回调并启动预取线程
+     */
+    void Start(PrefetchConfigurator configurator);
+
+    /**
+     * @brief 添加预取URL（已缓存或已在队列中的URL跳过）
+     * @return 加入队列的URL数
+     */
+    size_t Add(const std::vector<std::string> &urls, const PrefetchOptions &options);
+
+    /**
+     * @brief 清空等待中的预取
+     */
+    void Clear();
+
+    /**
+     * @brief 登记一个前台请求开始（提交时调用，含排队）
+     */
+    void BeginForeground();
+
+    /**
+     * @brief 登记一个前台请求结束
+     */
+    void EndForeground();
+
+    /**
+     * @brief 统计信息
+     */
+    PrefetchStats Stats();
+
+private:
+    PrefetchQueue() = default;
+
+    /**
+     * @brief 预取任务
+     */
+    typedef struct Task {
+        std::string url;                                ///< URL
+        std::shared_ptr<const PrefetchOptions> options; ///< 配置
+        std::string variant;                            ///< 请求变体（缓存键的一部分）
+        int yields = 0;                                 ///< 被前台请求中断的次数
+    } Task;
+
+    /**
+     * @brief 单次预取结果
+     */
+    enum class Outcome {
+        CACHED, ///< 已缓存
+        FAILED, ///< 失败或不可缓存
+        YIELDED ///< 被前台请求中断
+    };
+
+    void Loop();
+    Outcome Fetch(const Task &task);
+    static int Progress(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
+
+    std::mutex mutex;                  ///< 互斥锁
+    std::condition_variable wakeup;    ///< 队列或前台请求数变化
+    std::deque<Task> tasks;            ///< 等待中的预取
+    std::atomic<int> foreground{0};    ///< 进行中或排队中的前台请求数
+    PrefetchConfigurator configurator; ///< 句柄配置回调
+    bool started = false;              ///< 预取线程是否已启动
+    PrefetchStats stats;               ///< 统计（pending在读取时计算）
+};
+
+#endif // GMCURL_PREFETCH_QUEUE_H
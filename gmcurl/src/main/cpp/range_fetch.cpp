@@ -0,0 +1,395 @@
+#include "range_fetch.h"
+#include "connection_pool.h"
+#include "resumable_upload.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <thread>
+
+/**
+ * @file range_fetch.cpp
+ * @brief 多范围读取实现
+ */
+
+namespace {
+
+/**
+ * @brief 服务端忽略Range时允许接收的完整资源上限（16MB）
+ */
+const size_t kMaxFullResponse = 16777216;
+
+/**
+ * @brief 最多记录的不支持多范围请求的主机数量
+ */
+const size_t kMaxSingleRangeHosts = 256;
+
+/**
+ * @brief 不支持多范围请求的主机
+ */
+typedef struct SingleRangeHosts {
+    std::mutex mutex;            ///< 互斥锁
+    std::set<std::string> hosts; ///< 协议://主机:端口
+} SingleRangeHosts;
+
+SingleRangeHosts &GetSingleRangeHosts() {
+    // 进程内所有env共用，不随任何env销毁
+    static SingleRangeHosts *hosts = new SingleRangeHosts();
+    return *hosts;
+}
+
+bool IsSingleRangeHost(const std::string &host) {
+    SingleRangeHosts &hosts = GetSingleRangeHosts();
+    std::lock_guard<std::mutex> lock(hosts.mutex);
+    return hosts.hosts.count(host) > 0;
+}
+
+void AddSingleRangeHost(const std::string &host) {
+    SingleRangeHosts &hosts = GetSingleRangeHosts();
+    std::lock_guard<std::mutex> lock(hosts.mutex);
+    if (hosts.hosts.size() >= kMaxSingleRangeHosts) {
+        hosts.hosts.clear();
+    }
+    hosts.hosts.insert(host);
+}
+
+/**
+ * @brief 解析"bytes 起始-结束/总大小"，总大小为"*"时为-1
+ */
+bool ParseContentRange(const std::string &value, int64_t &start, int64_t &end, int64_t &total) {
+    long long first = 0;
+    long long last = 0;
+    char totalText[32] = {0};
+    if (sscanf(value.c_str(), "bytes %lld-%lld/%31s", &first, &last, totalText) != 3 || first < 0 || last < first) {
+        return false;
+    }
+    start = first;
+    end = last;
+    total = strcmp(totalText, "*") == 0 ? -1 : atoll(totalText);
+    return true;
+}
+
+size_t ReadHeader(char *data, size_t size, size_t nmemb, void *userp) {
+    auto *headers = static_cast<std::string *>(userp);
+    size_t len = size * nmemb;
+    // 重定向与100 Continue等中间响应的响应头不保留
+    if (len > 5 && strncmp(data, "HTTP/", 5) == 0) {
+        headers->clear();
+    }
+    headers->append(data, len);
+    return len;
+}
+
+} // namespace
+
+bool IsValidByteRange(const ByteRange &range) {
+    if (range.start < 0) {
+        return range.end == -1;
+    }
+    return range.end == -1 || range.end >= range.start;
+}
+
+RangeFetch::RangeFetch(const std::string &url, const std::vector<ByteRange> &ranges,
+                       const std::vector<std::string> &headers, int maxParallel)
+    : url(url), ranges(ranges), headers(headers), maxParallel(std::max(1, maxParallel)) {}
+
+RangeFetchResult RangeFetch::Run(const RangeConfigurator &newConfigurator, const std::function<bool()> &newCanceled) {
+    configurator = &newConfigurator;
+    canceled = &newCanceled;
+    slices.assign(ranges.size(), std::string());
+    covered.assign(ranges.size(), false);
+    RangeFetchResult out;
+    // 已知只支持单范围的主机直接并行发送
+    if (ranges.size() > 1 && !IsSingleRangeHost(ConnectionPool::KeyOf(url))) {
+        FetchMultipart(out);
+    }
+    bool failed = out.result != CURLE_OK || !out.error.empty() || (out.status != 0 && out.status != 200 &&
+                                                                      out.status != 206);
+    if (!failed && std::find(covered.begin(), covered.end(), false) != covered.end()) {
+        FetchEach(out);
+        failed = out.result != CURLE_OK || !out.error.empty() || (out.status != 200 && out.status != 206);
+    }
+    if (!failed && std::find(covered.begin(), covered.end(), false) != covered.end()) {
+        out.error = "Server response does not cover all requested ranges";
+        failed = true;
+    }
+    if (!failed) {
+        out.slices = std::move(slices);
+        out.size = size;
+    }
+    configurator = nullptr;
+    canceled = nullptr;
+    return out;
+}
+
+CURLcode RangeFetch::Perform(const std::string &rangeSpec, Response &out) {
+    ConnectionPool &connectionPool = ConnectionPool::Instance();
+    std::string poolKey = ConnectionPool::KeyOf(url);
+    CURL *curl = connectionPool.Acquire(poolKey);
+    if (!curl) {
+        curl = curl_easy_init();
+    }
+    if (!curl) {
+        connectionPool.Release(poolKey, nullptr, false);
+        return CURLE_FAILED_INIT;
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    (*configurator)(curl);
+    connectionPool.Prepare(curl);
+    curl_slist *headerList = nullptr;
+    for (const std::string &header : headers) {
+        headerList = curl_slist_append(headerList, header.c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
+    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(curl, CURLOPT_RANGE, rangeSpec.c_str());
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, ReadHeader);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &out.headers);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &out);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, TransferProgress);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, this);
+
+    CURLcode result = curl_easy_perform(curl);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &out.status);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+    curl_slist_free_all(headerList);
+    connectionPool.Release(poolKey, curl, result == CURLE_OK);
+    return result;
+}
+
+void RangeFetch::FetchMultipart(RangeFetchResult &out) {
+    std::string spec;
+    for (const ByteRange &range : ranges) {
+        spec += (spec.empty() ? "" : ",") + Spec(range);
+    }
+    Response response;
+    CURLcode result = Perform(spec, response);
+    std::lock_guard<std::mutex> lock(mutex);
+    out.headers = response.headers;
+    if (result != CURLE_OK) {
+        if (response.tooLarge) {
+            out.error = "Server ignored Range and the full resource exceeds 16MB";
+        } else {
+            out.result = result;
+        }
+        return;
+    }
+    std::string contentType;
+    FindResponseHeader(response.headers, "Content-Type", contentType);
+    if (Accept(response, out) && response.status == 206 && contentType.find("multipart/byteranges") == 0) {
+        return;
+    }
+    // 只返回了单个范围（或完整资源），之后该主机直接发送单范围请求
+    if (response.status == 206 || response.status == 200) {
+        AddSingleRangeHost(ConnectionPool::KeyOf(url));
+    }
+}
+
+void RangeFetch::FetchEach(RangeFetchResult &out) {
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < ranges.size(); i++) {
+        if (!covered[i]) {
+            pending.push_back(i);
+        }
+    }
+    std::atomic<size_t> next{0};
+    bool failed = false;
+    auto worker = [this, &pending, &next, &failed, &out]() {
+        while (!aborting) {
+            size_t index = next++;
+            if (index >= pending.size()) {
+                return;
+            }
+            size_t i = pending[index];
+            Response response;
+            CURLcode result = Perform(Spec(ranges[i]), response);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (failed) {
+                return;
+            }
+            if (out.headers.empty()) {
+                out.headers = response.headers;
+            }
+            if (result != CURLE_OK || !Accept(response, out)) {
+                if (response.tooLarge) {
+                    out.error = "Server ignored Range and the full resource exceeds 16MB";
+                } else if (result != CURLE_OK) {
+                    out.result = result;
+                }
+                failed = true;
+                aborting = true;
+                return;
+            }
+            // 总大小未知的单范围响应即为该范围的数据
+            if (!covered[i] && response.status == 206) {
+                slices[i] = std::move(response.body);
+                covered[i] = true;
+            }
+        }
+    };
+    size_t count = std::min(static_cast<size_t>(maxParallel), pending.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < count; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : workers) {
+        thread.join();
+    }
+}
+
+bool RangeFetch::Accept(const Response &response, RangeFetchResult &out) {
+    out.status = response.status;
+    if (response.status != 200 && response.status != 206) {
+        return false;
+    }
+    // 各响应须来自同一版本的资源
+    std::string responseEtag;
+    if (FindResponseHeader(response.headers, "ETag", responseEtag) && !responseEtag.empty()) {
+        if (!etag.empty() && etag != responseEtag) {
+            out.error = "Resource changed during range fetch";
+            return false;
+        }
+        etag = responseEtag;
+    }
+    if (response.status == 200) {
+        // 服务端忽略Range，返回完整资源
+        if (!Cover(0, response.body.data(), response.body.size(), static_cast<int64_t>(response.body.size()))) {
+            out.error = "Resource changed during range fetch";
+            return false;
+        }
+        return true;
+    }
+    std::string contentType;
+    FindResponseHeader(response.headers, "Content-Type", contentType);
+    std::string contentRange;
+    int64_t start = 0;
+    int64_t end = 0;
+    int64_t total = 0;
+    if (contentType.find("multipart/byteranges") != 0) {
+        if (!FindResponseHeader(response.headers, "Content-Range", contentRange) ||
+            !ParseContentRange(contentRange, start, end, total) ||
+            static_cast<int64_t>(response.body.size()) != end - start + 1) {
+            out.error = "Invalid Content-Range in range response";
+            return false;
+        }
+        if (!Cover(start, response.body.data(), response.body.size(), total)) {
+            out.error = "Resource changed during range fetch";
+            return false;
+        }
+        return true;
+    }
+
+    // multipart/byteranges：每个部分有各自的Content-Range
+    size_t boundaryPos = contentType.find("boundary=");
+    std::string boundary = boundaryPos == std::string::npos ? "" : contentType.substr(boundaryPos + 9);
+    boundary = boundary.substr(0, boundary.find(';'));
+    if (boundary.size() >= 2 && boundary.front() == '"' && boundary.back() == '"') {
+        boundary = boundary.substr(1, boundary.size() - 2);
+    }
+    if (boundary.empty()) {
+        out.error = "Invalid multipart/byteranges response";
+        return false;
+    }
+    const std::string &body = response.body;
+    std::string delimiter = "--" + boundary;
+    size_t pos = body.find(delimiter);
+    while (pos != std::string::npos) {
+        pos += delimiter.size();
+        if (body.compare(pos, 2, "--") == 0) {
+            break;
+        }
+        size_t headerEnd = body.find("\r\n\r\n", pos);
+        if (headerEnd == std::string::npos ||
+            !FindResponseHeader(body.substr(pos, headerEnd - pos), "Content-Range", contentRange) ||
+            !ParseContentRange(contentRange, start, end, total)) {
+            out.error = "Invalid multipart/byteranges response";
+            return false;
+        }
+        size_t dataStart = headerEnd + 4;
+        size_t length = static_cast<size_t>(end - start + 1);
+        if (dataStart + length > body.size()) {
+            out.error = "Invalid multipart/byteranges response";
+            return false;
+        }
+        if (!Cover(start, body.data() + dataStart, length, total)) {
+            out.error = "Resource changed during range fetch";
+            return false;
+        }
+        pos = body.find(delimiter, dataStart + length);
+    }
+    return true;
+}
+
+bool RangeFetch::Cover(int64_t offset, const char *data, size_t length, int64_t total) {
+    if (total >= 0) {
+        if (size >= 0 && size != total) {
+            return false;
+        }
+        size = total;
+    }
+    int64_t known = size;
+    for (size_t i = 0; i < ranges.size(); i++) {
+        if (covered[i]) {
+            continue;
+        }
+        // 后缀范围与到末尾的范围需要资源总大小才能确定位置
+        const ByteRange &range = ranges[i];
+        int64_t first = range.start;
+        int64_t last = range.end;
+        if (range.start < 0 || range.end < 0 || (known >= 0 && range.end >= known)) {
+            if (known < 0) {
+                continue;
+            }
+            first = range.start < 0 ? std::max<int64_t>(known + range.start, 0) : range.start;
+            last = known - 1;
+        }
+        // 超出资源末尾的范围没有数据
+        if (known >= 0 && first >= known) {
+            slices[i].clear();
+            covered[i] = true;
+            continue;
+        }
+        if (first >= offset && last < offset + static_cast<int64_t>(length)) {
+            slices[i].assign(data + (first - offset), static_cast<size_t>(last - first + 1));
+            covered[i] = true;
+        }
+    }
+    return true;
+}
+
+std::string RangeFetch::Spec(const ByteRange &range) {
+    if (range.start < 0) {
+        return std::to_string(range.start);
+    }
+    return std::to_string(range.start) + "-" + (range.end < 0 ? "" : std::to_string(range.end));
+}
+
+int RangeFetch::TransferProgress(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal,
+                                 curl_off_t ulnow) {
+    auto *fetch = static_cast<RangeFetch *>(clientp);
+    if (!fetch->aborting && (*fetch->canceled)()) {
+        fetch->aborting = true;
+    }
+    return fetch->aborting ? 1 : 0;
+}
+
+size_t RangeFetch::WriteBody(char *data, size_t size, size_t nmemb, void *userp) {
+    auto *out = static_cast<Response *>(userp);
+    size_t len = size * nmemb;
+    // 忽略Range的完整资源超过上限时中断
+    if (out->status == 0) {
+        long status = 0;
+        sscanf(out->headers.c_str(), "HTTP/%*s %ld", &status);
+        out->status = status;
+    }
+    if (out->status == 200 && out->body.size() + len > kMaxFullResponse) {
+        out->tooLarge = true;
+        return 0;
+    }
+    out->body.append(data, len);
+    return len;
+}
@@ -0,0 +1,110 @@
+#ifndef GMCURL_RANGE_FETCH_H
+#define GMCURL_RANGE_FETCH_H
+
+#include "curl.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @file range_fetch.h
+ * @brief 多范围读取
+ *
+ * 一次读取远程资源中的多个字节范围（如归档文件的索引、媒体容器的尾部），每个范围得到一段数据：
+ * - 多个范围先合并为一个多范围请求（Range: bytes=a-b,c-d），服务端以multipart/byteranges返回各范围
+ * - 服务端只返回单个范围时，记录该主机不支持多范围请求，未覆盖的范围改为并行发送的单范围请求
+ * - 服务端忽略Range返回完整资源（200）时，不超过16MB的响应体直接按范围切分
+ * 各响应的资源总大小或ETag不一致时视为资源在读取期间发生变化。
+ */
+
+/**
+ * @brief 字节范围
+ */
+typedef struct ByteRange {
+    int64_t start = 0; ///< 起始位置，负数表示资源末尾的-start个字节
+    int64_t end = -1;  ///< 结束位置（含），-1表示到资源末尾
+} ByteRange;
+
+/**
+ * @brief 多范围读取结果
+ */
+typedef struct RangeFetchResult {
+    CURLcode result = CURLE_OK;      ///< 传输结果
+    long status = 0;                 ///< HTTP状态码（失败时为失败请求的状态码）
+    std::string headers;             ///< 第一个响应的响应头原始数据
+    std::vector<std::string> slices; ///< 与请求范围一一对应的数据
+    int64_t size = -1;               ///< 资源总大小，-1表示未知
+    std::string error;               ///< 协议错误，为空表示无
+} RangeFetchResult;
+
+/**
+ * @brief 单个范围请求的配置回调（传输层配置、超时与重定向，可在多个线程中同时调用）
+ */
+typedef std::function<void(CURL *)> RangeConfigurator;
+
+/**
+ * @brief 检查范围是否有效（起始位置不大于结束位置，后缀范围不指定结束位置）
+ */
+bool IsValidByteRange(const ByteRange &range);
+
+/**
+ * @brief 读取单个资源的多个字节范围（调用线程等待所有范围完成）
+ */
+class RangeFetch {
+public:
+    /**
+     * @param url 资源URL
+     * @param ranges 字节范围
+     * @param headers 附加请求头（"Name: value"），随每个请求发送
+     * @param maxParallel 单范围请求的最大并发数
+     */
+    RangeFetch(const std::string &url, const std::vector<ByteRange> &ranges, const std::vector<std::string> &headers,
+               int maxParallel);
+
+    /**
+     * @brief 执行读取
+     * @param configurator 请求配置回调
+     * @param canceled 取消检查（在传输线程中调用）
+     */
+    RangeFetchResult Run(const RangeConfigurator &configurator, const std::function<bool()> &canceled);
+
+private:
+    /**
+     * @brief 单个响应
+     */
+    typedef struct Response {
+        long status = 0;       ///< HTTP状态码
+        std::string headers;   ///< 响应头原始数据
+        std::string body;      ///< 响应体
+        bool tooLarge = false; ///< 完整资源响应超过上限
+    } Response;
+
+    CURLcode Perform(const std::string &rangeSpec, Response &out);
+    void FetchMultipart(RangeFetchResult &out);
+    void FetchEach(RangeFetchResult &out);
+    bool Accept(const Response &response, RangeFetchResult &out);
+    bool Cover(int64_t offset, const char *data, size_t length, int64_t size);
+    static std::string Spec(const ByteRange &range);
+    static int TransferProgress(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal,
+                                curl_off_t ulnow);
+    static size_t WriteBody(char *data, size_t size, size_t nmemb, void *userp);
+
+    std::string url;                                 ///< 资源URL
+    std::vector<ByteRange> ranges;                   ///< 字节范围
+    std::vector<std::string> headers;                ///< 附加请求头
+    int maxParallel = 4;                             ///< 单范围请求的最大并发数
+    const RangeConfigurator *configurator = nullptr; ///< 请求配置回调（Run期间有效）
+    const std::function<bool()> *canceled = nullptr; ///< 取消检查（Run期间有效）
+
+    std::mutex mutex;                  ///< 互斥锁（结果、资源标识）
+    std::vector<std::string> slices;   ///< 各范围的数据
+    std::vector<bool> covered;         ///< 各范围是否已取得
+    int64_t size = -1;                 ///< 资源总大小
+    std::string etag;                  ///< 资源ETag
+    std::atomic<bool> aborting{false}; ///< 中断所有请求
+};
+
+#endif // GMCURL_RANGE_FETCH_H
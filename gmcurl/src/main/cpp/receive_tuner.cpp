@@ -0,0 +1,115 @@
+#include "receive_tuner.h"
+#include "file_io.h"
+#include <algorithm>
+
+/**
+ * @file receive_tuner.cpp
+ * @brief 接收缓冲区调优实现
+ */
+
+namespace {
+
+/**
+ * @brief 最多记录的主机数量
+ */
+const size_t kMaxLinks = 256;
+
+/**
+ * @brief 参与吞吐估计的最小响应体大小（小响应的耗时主要是时延）
+ */
+const curl_off_t kMinSampleBytes = 262144;
+
+/**
+ * @brief 指数加权平均中新样本的权重
+ */
+const double kSampleWeight = 0.3;
+
+/**
+ * @brief 写入块最小大小
+ */
+const size_t kMinBatchSize = 131072;
+
+/**
+ * @brief 向上取整到2的幂
+ */
+long RoundUpPowerOfTwo(double value) {
+    long result = 1;
+    while (result < value && result < CURL_MAX_READ_SIZE) {
+        result <<= 1;
+    }
+    return result;
+}
+
+/**
+ * @brief 合并新样本
+ */
+void Blend(double &estimate, double sample) {
+    estimate = estimate > 0 ? estimate + kSampleWeight * (sample - estimate) : sample;
+}
+
+} // namespace
+
+ReceiveTuner &ReceiveTuner::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static ReceiveTuner *tuner = new ReceiveTuner();
+    return *tuner;
+}
+
+long ReceiveTuner::BufferSize(const std::string &host, bool bulk) {
+    double product = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = links.find(host);
+        if (it != links.end()) {
+            product = it->second.bytesPerSecond * it->second.rttSeconds;
+        }
+    }
+    long floor = bulk ? kBulkBufferSize : CURL_MAX_WRITE_SIZE;
+    long ceiling = bulk ? CURL_MAX_READ_SIZE : kMaxRequestBufferSize;
+    long size = std::min<long>(std::max(RoundUpPowerOfTwo(product), floor), ceiling);
+    // 普通请求未测得更大的带宽时延积时保持默认值
+    return !bulk && size <= CURL_MAX_WRITE_SIZE ? 0 : size;
+}
+
+void ReceiveTuner::Record(const std::string &host, CURL *curl) {
+    curl_off_t bytes = 0;
+    curl_off_t namelookup = 0;
+    curl_off_t connect = 0;
+    curl_off_t pretransfer = 0;
+    curl_off_t starttransfer = 0;
+    curl_off_t total = 0;
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &bytes);
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &namelookup);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &pretransfer);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &starttransfer);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    LinkEstimate &link = links[host];
+    // 新建连接时TCP握手耗时即一个RTT；复用连接时以首字节等待时间作为上界
+    if (connect > namelookup) {
+        Blend(link.rttSeconds, (connect - namelookup) / 1e6);
+    } else if (link.rttSeconds <= 0 && starttransfer > pretransfer) {
+        link.rttSeconds = (starttransfer - pretransfer) / 1e6;
+    }
+    // 吞吐只按接收响应体的时间计算
+    if (bytes >= kMinSampleBytes && total > starttransfer) {
+        Blend(link.bytesPerSecond, bytes / ((total - starttransfer) / 1e6));
+    }
+    link.updated = nextUpdate++;
+    if (links.size() > kMaxLinks) {
+        auto oldest = std::min_element(links.begin(), links.end(), [](const auto &a, const auto &b) {
+            return a.second.updated < b.second.updated;
+        });
+        links.erase(oldest);
+    }
+}
+
+size_t ReceiveTuner::BatchSize(long bufferSize) {
+    // 每个写入块容纳数次接收，整块写入文件
+    size_t maxSize = FileIoEngine::kBlockSize;
+    size_t size = static_cast<size_t>(std::max(bufferSize, 0L)) * 4;
+    size = std::min(std::max(size, kMinBatchSize), maxSize);
+    return size / WriteBatcher::kAlignment * WriteBatcher::kAlignment;
+}
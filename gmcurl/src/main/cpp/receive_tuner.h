@@ -0,0 +1,82 @@
+#ifndef GMCURL_RECEIVE_TUNER_H
+#define GMCURL_RECEIVE_TUNER_H
+
+#include "curl.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+ * @file receive_tuner.h
+ * @brief 接收缓冲区调优
+ *
+ * - ReceiveTuner：按"协议://主机:端口"记录最近传输测得的吞吐与RTT，以带宽时延积决定下一次传输的
+ *   CURLOPT_BUFFERSIZE（libcurl在传输开始时分配接收缓冲区，传输中途不能调整）。
+ *   下载至少使用128KB、最大10MB；普通请求在测得更大的带宽时延积前保持libcurl默认值，最大256KB，
+ *   避免发往高带宽、高时延主机的每个小请求都分配数MB的接收缓冲区
+ * - 下载文件的写入块（WriteBatcher，见file_io.h）大小随接收缓冲区变化
+ */
+
+/**
+ * @brief 主机链路估计
+ */
+typedef struct LinkEstimate {
+    double bytesPerSecond = 0; ///< 吞吐（字节/秒，指数加权平均）
+    double rttSeconds = 0;     ///< 往返时延（秒，指数加权平均）
+    int64_t updated = 0;       ///< 更新序号（用于淘汰最久未更新的主机）
+} LinkEstimate;
+
+/**
+ * @brief 进程级接收缓冲区调优器（线程安全）
+ */
+class ReceiveTuner {
+public:
+    /**
+     * @brief 下载使用的最小接收缓冲区（128KB）
+     */
+    static const long kBulkBufferSize = 131072;
+
+    /**
+     * @brief 普通请求使用的最大接收缓冲区（256KB）
+     */
+    static const long kMaxRequestBufferSize = 262144;
+
+    /**
+     * @brief 获取进程级实例
+     */
+    static ReceiveTuner &Instance();
+
+    ReceiveTuner(const ReceiveTuner &) = delete;
+    ReceiveTuner &operator=(const ReceiveTuner &) = delete;
+
+    /**
+     * @brief 计算接收缓冲区大小
+     * @param host 协议://主机:端口
+     * @param bulk 是否为文件下载
+     * @return 缓冲区大小，0表示使用libcurl默认值
+     */
+    long BufferSize(const std::string &host, bool bulk);
+
+    /**
+     * @brief 记录一次成功传输的吞吐与RTT
+     * @param host 协议://主机:端口
+     * @param curl 已完成传输的句柄
+     */
+    void Record(const std::string &host, CURL *curl);
+
+    /**
+     * @brief 与接收缓冲区匹配的写入块大小（4KB对齐，128KB~1MB）
+     */
+    static size_t BatchSize(long bufferSize);
+
+private:
+    ReceiveTuner() = default;
+
+    std::mutex mutex;                          ///< 互斥锁
+    std::map<std::string, LinkEstimate> links; ///< 主机 -> 链路估计
+    int64_t nextUpdate = 0;                    ///< 下一个更新序号
+};
+
+#endif // GMCURL_RECEIVE_TUNER_H
@@ -0,0 +1,125 @@
+#include "redirect_cache.h"
+#include "curl.h"
+#include <algorithm>
+#include <cctype>
+#include <set>
+
+/**
+ * @file redirect_cache.cpp
+ * @brief 重定向策略与永久重定向缓存实现
+ */
+
+namespace {
+
+/**
+ * @brief 最多缓存的永久重定向数量
+ */
+const size_t kMaxEntries = 128;
+
+std::string OriginOf(const std::string &url) {
+    std::string origin;
+    CURLU *handle = curl_url();
+    if (!handle) {
+        return origin;
+    }
+    char *scheme = nullptr;
+    char *host = nullptr;
+    char *port = nullptr;
+    if (curl_url_set(handle, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK &&
+        curl_url_get(handle, CURLUPART_SCHEME, &scheme, 0) == CURLUE_OK &&
+        curl_url_get(handle, CURLUPART_HOST, &host, 0) == CURLUE_OK &&
+        curl_url_get(handle, CURLUPART_PORT, &port, CURLU_DEFAULT_PORT) == CURLUE_OK) {
+        origin = std::string(scheme) + "://" + host + ":" + port;
+        std::transform(origin.begin(), origin.end(), origin.begin(), ::tolower);
+    }
+    curl_free(scheme);
+    curl_free(host);
+    curl_free(port);
+    curl_url_cleanup(handle);
+    return origin;
+}
+
+} // namespace
+
+bool ResolveRedirectLocation(const std::string &base, const std::string &location, std::string &out) {
+    CURLU *handle = curl_url();
+    if (!handle) {
+        return false;
+    }
+    char *result = nullptr;
+    bool ok = curl_url_set(handle, CURLUPART_URL, base.c_str(), 0) == CURLUE_OK &&
+              curl_url_set(handle, CURLUPART_URL, location.c_str(), 0) == CURLUE_OK &&
+              curl_url_get(handle, CURLUPART_URL, &result, 0) == CURLUE_OK;
+    if (ok) {
+        out = result;
+    }
+    curl_free(result);
+    curl_url_cleanup(handle);
+    return ok;
+}
+
+bool IsSameOrigin(const std::string &a, const std::string &b) {
+    std::string origin = OriginOf(a);
+    return !origin.empty() && origin == OriginOf(b);
+}
+
+RedirectCache &RedirectCache::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static RedirectCache *cache = new RedirectCache();
+    return *cache;
+}
+
+bool RedirectCache::Resolve(std::string &url, const RedirectPolicy &policy) {
+    if (!policy.follow) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string current = url;
+    std::set<std::string> visited{current};
+    int hops = 0;
+    for (auto it = index.find(current); it != index.end() && hops < policy.maxRedirects; it = index.find(current)) {
+        const std::string &target = it->second->second;
+        // 跳转环时停在当前位置（缓存只含同源跳转，同源策略总是满足）
+        if (visited.count(target)) {
+            break;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        current = target;
+        visited.insert(current);
+        hops++;
+    }
+    if (hops == 0) {
+        return false;
+    }
+    url = current;
+    return true;
+}
+
+void RedirectCache::Store(const std::string &from, const std::string &to) {
+    // 跨源目标会收到原请求的全部请求头，且可能从https降级为http
+    if (from == to || !IsSameOrigin(from, to)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(from);
+    if (it != index.end()) {
+        it->second->second = to;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    entries.emplace_front(from, to);
+    index[from] = entries.begin();
+    if (entries.size() > kMaxEntries) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+void RedirectCache::Forget(const std::string &url) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(url);
+    if (it != index.end()) {
+        entries.erase(it->second);
+        index.erase(it);
+    }
+}
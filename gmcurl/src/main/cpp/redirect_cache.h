@@ -0,0 +1,86 @@
+#ifndef GMCURL_REDIRECT_CACHE_H
+#define GMCURL_REDIRECT_CACHE_H
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+ * @file redirect_cache.h
+ * @brief 重定向策略与永久重定向缓存
+ *
+ * 所有请求按重定向策略由libcurl跟随重定向；响应头回调中解析每一跳的Location，
+ * 跨域跳转在同源策略下中止请求，同源的301/308跳转记入进程级缓存。
+ * 之后的GET请求在发送前沿缓存直接改写为最终URL，不再经过重定向（redirectTiming为0）。
+ * 跨源跳转（包括https改为http）不缓存：改写后的请求会携带全部自定义请求头，而跟随跨源跳转时libcurl会去掉认证信息。
+ * 未校验服务端证书的传输不记录跳转，避免不可信的对端影响其他请求。
+ * 使用缓存目标的请求失败或返回4xx/5xx时删除对应条目。
+ */
+
+/**
+ * @brief 重定向策略
+ */
+typedef struct RedirectPolicy {
+    bool follow = true;      ///< 是否跟随重定向
+    int maxRedirects = 10;   ///< 最大跳转次数
+    bool sameOrigin = false; ///< 是否只允许同源（协议、主机、端口相同）跳转
+    long keepPost = 0;       ///< 保持POST方法的跳转（CURL_REDIR_POST_301/302/303组合），307/308始终保持
+} RedirectPolicy;
+
+/**
+ * @brief 按当前URL解析Location（支持相对地址）
+ * @param base 当前URL
+ * @param location Location响应头的值
+ * @param out 输出绝对URL
+ * @return 是否解析成功
+ */
+bool ResolveRedirectLocation(const std::string &base, const std::string &location, std::string &out);
+
+/**
+ * @brief 两个URL是否同源
+ */
+bool IsSameOrigin(const std::string &a, const std::string &b);
+
+/**
+ * @brief 进程级永久重定向缓存（LRU）
+ */
+class RedirectCache {
+public:
+    /**
+     * @brief 获取进程级实例（首次调用时创建，进程退出前不释放）
+     */
+    static RedirectCache &Instance();
+
+    RedirectCache(const RedirectCache &) = delete;
+    RedirectCache &operator=(const RedirectCache &) = delete;
+
+    /**
+     * @brief 沿缓存解析最终URL
+     * @param url 请求URL（命中时原地改写）
+     * @param policy 重定向策略（跳转次数同样适用于缓存）
+     * @return 是否命中
+     */
+    bool Resolve(std::string &url, const RedirectPolicy &policy);
+
+    /**
+     * @brief 记录永久重定向，跨源跳转不记录
+     */
+    void Store(const std::string &from, const std::string &to);
+
+    /**
+     * @brief 删除以url为起点的缓存条目
+     */
+    void Forget(const std::string &url);
+
+private:
+    RedirectCache() = default;
+
+    typedef std::list<std::pair<std::string, std::string>> EntryList;
+
+    std::mutex mutex;                                   ///< 互斥锁
+    EntryList entries;                                  ///< 缓存条目（最近使用的在前）
+    std::map<std::string, EntryList::iterator> index;   ///< 起点URL -> 缓存条目
+};
+
+#endif // GMCURL_REDIRECT_CACHE_H
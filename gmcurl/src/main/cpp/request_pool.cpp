@@ -0,0 +1,81 @@
+#include "request_pool.h"
+#include <cstdlib>
+#include <new>
+
+/**
+ * @file request_pool.cpp
+ * @brief I/O缓冲区复用池实现
+ */
+
+namespace {
+
+/**
+ * @brief 每个大小级别最多缓存的I/O缓冲区字节数（4MB），小缓冲区可缓存更多个
+ */
+const size_t kMaxCachedBytes = 4194304;
+
+/**
+ * @brief 缓冲区对齐（页大小）
+ */
+const size_t kBufferAlignment = 4096;
+
+} // namespace
+
+BufferPool &BufferPool::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static BufferPool *pool = new BufferPool();
+    return *pool;
+}
+
+size_t BufferPool::SizeClass(size_t size) {
+    size_t result = kMinBufferSize;
+    while (result < size && result < kBufferSize) {
+        result <<= 1;
+    }
+    return result;
+}
+
+char *BufferPool::Acquire(size_t size) {
+    size_t capacity = SizeClass(size);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<char *> &freeList = freeLists[capacity];
+        if (!freeList.empty()) {
+            char *buffer = freeList.back();
+            freeList.pop_back();
+            stats.hits++;
+            return buffer;
+        }
+        stats.misses++;
+    }
+    void *buffer = nullptr;
+    if (posix_memalign(&buffer, kBufferAlignment, capacity) != 0) {
+        throw std::bad_alloc();
+    }
+    return static_cast<char *>(buffer);
+}
+
+void BufferPool::Release(char *buffer, size_t size) {
+    if (buffer == nullptr) {
+        return;
+    }
+    size_t capacity = SizeClass(size);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<char *> &freeList = freeLists[capacity];
+        if (freeList.size() < kMaxCachedBytes / capacity) {
+            freeList.push_back(buffer);
+            return;
+        }
+    }
+    free(buffer);
+}
+
+PoolStats BufferPool::Stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    PoolStats result = stats;
+    for (const auto &item : freeLists) {
+        result.cached += item.second.size();
+    }
+    return result;
+}
@@ -0,0 +1,138 @@
+#ifndef GMCURL_REQUEST_POOL_H
+#define GMCURL_REQUEST_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/**
+ * @file request_pool.h
+ * @brief 请求上下文与I/O缓冲区复用池
+ *
+ * - ObjectPool：按env缓存请求上下文对象，只在JS线程中分配和回收，不加锁；
+ *   回收的上下文保留响应体等大字符串的容量，下一个请求直接复用，避免逐请求的分配器往返
+ * - BufferPool：进程级缓存4KB对齐的I/O缓冲区（下载写入块、上传预读块），按2的幂分级缓存，在传输线程获取和归还
+ * 两类池都有缓存上限，超出上限的对象直接释放，并统计命中率。
+ */
+
+/**
+ * @brief 复用池统计
+ */
+typedef struct PoolStats {
+    int64_t hits = 0;   ///< 命中次数（复用缓存对象）
+    int64_t misses = 0; ///< 未命中次数（新分配）
+    size_t cached = 0;  ///< 当前缓存数量
+} PoolStats;
+
+/**
+ * @brief 对象复用池（非线程安全）
+ */
+template <typename T> class ObjectPool {
+public:
+    explicit ObjectPool(size_t maxCached) : maxCached(maxCached) {}
+
+    ~ObjectPool() {
+        for (T *object : freeList) {
+            delete object;
+        }
+    }
+
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    /**
+     * @brief 获取对象，优先复用缓存
+     */
+    T *Acquire() {
+        if (freeList.empty()) {
+            stats.misses++;
+            return new T();
+        }
+        stats.hits++;
+        T *object = freeList.back();
+        freeList.pop_back();
+        return object;
+    }
+
+    /**
+     * @brief 归还对象，调用方需先将对象重置为初始状态
+     */
+    void Release(T *object) {
+        if (freeList.size() < maxCached) {
+            freeList.push_back(object);
+        } else {
+            delete object;
+        }
+    }
+
+    /**
+     * @brief 统计数据
+     */
+    PoolStats Stats() const {
+        PoolStats result = stats;
+        result.cached = freeList.size();
+        return result;
+    }
+
+private:
+    size_t maxCached;          ///< 最大缓存数量
+    std::vector<T *> freeList; ///< 空闲对象
+    PoolStats stats;           ///< 统计数据
+};
+
+/**
+ * @brief 进程级I/O缓冲区复用池（线程安全）
+ */
+class BufferPool {
+public:
+    /**
+     * @brief 最大缓冲区大小（1MB）
+     */
+    static const size_t kBufferSize = 1048576;
+
+    /**
+     * @brief 最小缓冲区大小（4KB），更小的请求按此分配
+     */
+    static const size_t kMinBufferSize = 4096;
+
+    /**
+     * @brief 获取进程级实例
+     */
+    static BufferPool &Instance();
+
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    /**
+     * @brief 获取4KB对齐的缓冲区，大小向上取整到2的幂（不超过kBufferSize）
+     * @param size 需要的字节数
+     */
+    char *Acquire(size_t size = kBufferSize);
+
+    /**
+     * @brief 归还缓冲区（允许nullptr）
+     * @param size 获取时传入的字节数
+     */
+    void Release(char *buffer, size_t size = kBufferSize);
+
+    /**
+     * @brief 实际分配的大小
+     */
+    static size_t SizeClass(size_t size);
+
+    /**
+     * @brief 统计数据
+     */
+    PoolStats Stats();
+
+private:
+    BufferPool() = default;
+
+    std::mutex mutex;                                ///< 互斥锁
+    std::map<size_t, std::vector<char *>> freeLists; ///< 分配大小 -> 空闲缓冲区
+    PoolStats stats;                                 ///< 统计数据
+};
+
+#endif // GMCURL_REQUEST_POOL_H
@@ -0,0 +1,341 @@
+#include "request_signer.h"
+#include <algorithm>
+#include <chrono>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/pem.h>
+
+/**
+ * @file request_signer.cpp
+ * @brief 请求签名阶段实现（基于libcrypto）
+ */
+
+namespace {
+
+/**
+ * @brief 流式读取时使用的分块大小
+ */
+const size_t kDigestChunkSize = 65536;
+
+std::string ToLower(const std::string &str) {
+    std::string result = str;
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char ch) { return std::tolower(ch); });
+    return result;
+}
+
+std::string Trim(const std::string &str) {
+    size_t begin = str.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return str.substr(begin, end - begin + 1);
+}
+
+std::string HexEncode(const unsigned char *data, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+    std::string result;
+    result.reserve(len * 2);
+    for (size_t i = 0; i < len; i++) {
+        result.push_back(hex[data[i] >> 4]);
+        result.push_back(hex[data[i] & 0x0F]);
+    }
+    return result;
+}
+
+std::string Base64Encode(const unsigned char *data, size_t len) {
+    std::string result(4 * ((len + 2) / 3) + 1, '\0');
+    int outLen = EVP_EncodeBlock(reinterpret_cast<unsigned char *>(&result[0]), data, static_cast<int>(len));
+    result.resize(outLen > 0 ? outLen : 0);
+    return result;
+}
+
+const EVP_MD *DigestOf(SignatureAlgorithm algorithm) {
+    return algorithm == SignatureAlgorithm::HMAC_SHA256 ? EVP_sha256() : EVP_sm3();
+}
+
+/**
+ * @brief 流式计算请求体摘要
+ */
+bool DigestBody(const SignInput &input, const EVP_MD *md, std::string &digestHex, std::string &errorMsg) {
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    if (!ctx || EVP_DigestInit_ex(ctx, md, nullptr) != 1) {
+        EVP_MD_CTX_free(ctx);
+        errorMsg = "Digest init failed";
+        return false;
+    }
+    bool ok = true;
+    if (input.body) {
+        std::vector<char> chunk(kDigestChunkSize);
+        input.body->Rewind();
+        size_t got;
+        while ((got = input.body->Read(chunk.data(), chunk.size())) > 0) {
+            EVP_DigestUpdate(ctx, chunk.data(), got);
+        }
+        if (input.body->Failed()) {
+            errorMsg = "Failed to read request body";
+            ok = false;
+        }
+        input.body->Rewind();
+    }
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestLen = 0;
+    if (ok && EVP_DigestFinal_ex(ctx, digest, &digestLen) != 1) {
+        errorMsg = "Digest final failed";
+        ok = false;
+    }
+    EVP_MD_CTX_free(ctx);
+    if (ok) {
+        digestHex = HexEncode(digest, digestLen);
+    }
+    return ok;
+}
+
+/**
+ * @brief 在实际发送的请求头中查找（不区分大小写），host缺省时从URL推导
+ */
+std::string FindHeader(const SignInput &input, const std::string &lowerName, const std::string &host) {
+    for (const struct curl_slist *list : {input.headers, input.sharedHeaders}) {
+        for (const struct curl_slist *it = list; it != nullptr; it = it->next) {
+            std::string line = it->data;
+            size_t colonPos = line.find(':');
+            if (colonPos != std::string::npos && ToLower(Trim(line.substr(0, colonPos))) == lowerName) {
+                return Trim(line.substr(colonPos + 1));
+            }
+        }
+    }
+    if (lowerName == "host") {
+        return host;
+    }
+    return "";
+}
+
+/**
+ * @brief 查询参数按名称、值排序
+ */
+std::string SortQuery(const std::string &query) {
+    std::vector<std::string> pairs;
+    size_t start = 0;
+    while (start <= query.size() && !query.empty()) {
+        size_t end = query.find('&', start);
+        if (end == std::string::npos) {
+            end = query.size();
+        }
+        if (end > start) {
+            pairs.push_back(query.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const std::string &a, const std::string &b) {
+        std::string keyA = a.substr(0, a.find('='));
+        std::string keyB = b.substr(0, b.find('='));
+        return keyA != keyB ? keyA < keyB : a < b;
+    });
+    std::string result;
+    for (size_t i = 0; i < pairs.size(); i++) {
+        if (i > 0) {
+            result += "&";
+        }
+        result += pairs[i];
+    }
+    return result;
+}
+
+bool SignHmac(const SignatureConfig &config, const std::string &content, std::string &signature,
+              std::string &errorMsg) {
+    unsigned char mac[EVP_MAX_MD_SIZE];
+    unsigned int macLen = 0;
+    if (!HMAC(DigestOf(config.algorithm), config.key.data(), static_cast<int>(config.key.size()),
+              reinterpret_cast<const unsigned char *>(content.data()), content.size(), mac, &macLen)) {
+        errorMsg = "HMAC failed";
+        return false;
+    }
+    signature = config.hexEncoding ? HexEncode(mac, macLen) : Base64Encode(mac, macLen);
+    return true;
+}
+
+bool SignSm2(const SignatureConfig &config, const std::string &content, std::string &signature,
+             std::string &errorMsg) {
+    BIO *bio = config.keyPath.empty() ? BIO_new_mem_buf(config.key.data(), static_cast<int>(config.key.size()))
+                                      : BIO_new_file(config.keyPath.c_str(), "r");
+    if (!bio) {
+        errorMsg = "Failed to load SM2 private key";
+        return false;
+    }
+    EVP_PKEY *pkey = PEM_read_bio_PrivateKey(bio, nullptr, nullptr, nullptr);
+    BIO_free(bio);
+    if (!pkey) {
+        errorMsg = "Invalid SM2 private key";
+        return false;
+    }
+    bool ok = false;
+    EVP_MD_CTX *mdCtx = EVP_MD_CTX_new();
+    EVP_PKEY_CTX *pkeyCtx = EVP_PKEY_CTX_new(pkey, nullptr);
+    if (mdCtx && pkeyCtx &&
+        EVP_PKEY_CTX_set1_id(pkeyCtx, config.sm2Id.data(), static_cast<int>(config.sm2Id.size())) > 0) {
+        EVP_MD_CTX_set_pkey_ctx(mdCtx, pkeyCtx);
+        size_t sigLen = 0;
+        if (EVP_DigestSignInit(mdCtx, nullptr, EVP_sm3(), nullptr, pkey) == 1 &&
+            EVP_DigestSignUpdate(mdCtx, content.data(), content.size()) == 1 &&
+            EVP_DigestSignFinal(mdCtx, nullptr, &sigLen) == 1) {
+            std::vector<unsigned char> sig(sigLen);
+            if (EVP_DigestSignFinal(mdCtx, sig.data(), &sigLen) == 1) {
+                signature = config.hexEncoding ? HexEncode(sig.data(), sigLen) : Base64Encode(sig.data(), sigLen);
+                ok = true;
+            }
+        }
+    }
+    if (!ok) {
+        errorMsg = "SM2 sign failed";
+    }
+    EVP_MD_CTX_free(mdCtx);
+    EVP_PKEY_CTX_free(pkeyCtx);
+    EVP_PKEY_free(pkey);
+    return ok;
+}
+
+void ReplaceAll(std::string &str, const std::string &from, const std::string &to) {
+    size_t pos = 0;
+    while ((pos = str.find(from, pos)) != std::string::npos) {
+        str.replace(pos, from.size(), to);
+        pos += to.size();
+    }
+}
+
+const char *AlgorithmName(SignatureAlgorithm algorithm) {
+    switch (algorithm) {
+    case SignatureAlgorithm::HMAC_SM3:
+        return "HMAC-SM3";
+    case SignatureAlgorithm::SM2:
+        return "SM2";
+    default:
+        return "HMAC-SHA256";
+    }
+}
+
+} // namespace
+
+bool ParseSignatureAlgorithm(const std::string &name, SignatureAlgorithm &algorithm) {
+    std::string upper = name;
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char ch) { return std::toupper(ch); });
+    if (upper == "HMAC-SHA256") {
+        algorithm = SignatureAlgorithm::HMAC_SHA256;
+    } else if (upper == "HMAC-SM3") {
+        algorithm = SignatureAlgorithm::HMAC_SM3;
+    } else if (upper == "SM2") {
+        algorithm = SignatureAlgorithm::SM2;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool SignRequest(const SignatureConfig &config, const SignInput &input, std::vector<std::string> &outHeaders,
+                 std::string &errorMsg) {
+    // 解析URL路径、查询串与主机
+    std::string path = "/";
+    std::string query;
+    std::string host;
+    CURLU *url = curl_url();
+    if (!url || curl_url_set(url, CURLUPART_URL, input.url.c_str(), 0) != CURLUE_OK) {
+        curl_url_cleanup(url);
+        errorMsg = "Invalid url";
+        return false;
+    }
+    char *part = nullptr;
+    if (curl_url_get(url, CURLUPART_PATH, &part, 0) == CURLUE_OK && part) {
+        path = part;
+        curl_free(part);
+    }
+    part = nullptr;
+    if (curl_url_get(url, CURLUPART_QUERY, &part, 0) == CURLUE_OK && part) {
+        query = part;
+        curl_free(part);
+    }
+    part = nullptr;
+    if (curl_url_get(url, CURLUPART_HOST, &part, 0) == CURLUE_OK && part) {
+        host = part;
+        curl_free(part);
+    }
+    part = nullptr;
+    if (curl_url_get(url, CURLUPART_PORT, &part, 0) == CURLUE_OK && part) {
+        host += std::string(":") + part;
+        curl_free(part);
+    }
+    curl_url_cleanup(url);
+
+    // 时间戳
+    std::string timestamp = std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                               std::chrono::system_clock::now().time_since_epoch())
+                                               .count());
+    if (!config.timestampHeaderName.empty()) {
+        outHeaders.push_back(config.timestampHeaderName + ": " + timestamp);
+    }
+
+    // 请求体摘要
+    std::string bodyDigest;
+    bool needDigest = !config.digestHeaderName.empty() ||
+                      std::find(config.canonical.begin(), config.canonical.end(), "bodyDigest") !=
+                          config.canonical.end();
+    if (needDigest && !DigestBody(input, DigestOf(config.algorithm), bodyDigest, errorMsg)) {
+        return false;
+    }
+    if (!config.digestHeaderName.empty()) {
+        outHeaders.push_back(config.digestHeaderName + ": " + bodyDigest);
+    }
+
+    // 按规范拼接签名原文
+    std::string signedHeaderNames;
+    for (size_t i = 0; i < config.signedHeaders.size(); i++) {
+        signedHeaderNames += (i > 0 ? ";" : "") + config.signedHeaders[i];
+    }
+    std::string content;
+    for (size_t i = 0; i < config.canonical.size(); i++) {
+        const std::string &component = config.canonical[i];
+        if (i > 0) {
+            content += "\n";
+        }
+        if (component == "method") {
+            std::string method = input.method;
+            std::transform(method.begin(), method.end(), method.begin(),
+                           [](unsigned char ch) { return std::toupper(ch); });
+            content += method;
+        } else if (component == "path") {
+            content += path;
+        } else if (component == "query") {
+            content += SortQuery(query);
+        } else if (component == "headers") {
+            for (size_t j = 0; j < config.signedHeaders.size(); j++) {
+                const std::string &name = config.signedHeaders[j];
+                std::string value = name == ToLower(config.timestampHeaderName) ? timestamp
+                                                                                 : FindHeader(input, name, host);
+                content += (j > 0 ? "\n" : "") + name + ":" + value;
+            }
+        } else if (component == "signedHeaders") {
+            content += signedHeaderNames;
+        } else if (component == "timestamp") {
+            content += timestamp;
+        } else if (component == "bodyDigest") {
+            content += bodyDigest;
+        } else {
+            errorMsg = "Unknown canonical component: " + component;
+            return false;
+        }
+    }
+
+    // 计算签名
+    std::string signature;
+    bool ok = config.algorithm == SignatureAlgorithm::SM2 ? SignSm2(config, content, signature, errorMsg)
+                                                           : SignHmac(config, content, signature, errorMsg);
+    if (!ok) {
+        return false;
+    }
+    std::string value = config.headerTemplate;
+    ReplaceAll(value, "{algorithm}", AlgorithmName(config.algorithm));
+    ReplaceAll(value, "{keyId}", config.keyId);
+    ReplaceAll(value, "{signedHeaders}", signedHeaderNames);
+    ReplaceAll(value, "{timestamp}", timestamp);
+    ReplaceAll(value, "{signature}", signature);
+    outHeaders.push_back(config.headerName + ": " + value);
+    return true;
+}
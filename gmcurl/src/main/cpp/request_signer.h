@@ -0,0 +1,81 @@
+#ifndef GMCURL_REQUEST_SIGNER_H
+#define GMCURL_REQUEST_SIGNER_H
+
+#include "curl.h"
+#include "body_reader.h"
+#include <string>
+#include <vector>
+
+/**
+ * @file request_signer.h
+ * @brief 请求签名阶段
+ *
+ * 在异步线程中、请求发送前对请求进行签名，签名原文由声明式规范（canonical）按顺序拼接：
+ * - method：大写请求方法
+ * - path：URL路径（未解码）
+ * - query：按参数排序后的查询串
+ * - headers：signedHeaders中每个请求头一行，格式为"小写名称:去除首尾空格的值"
+ * - signedHeaders：以';'连接的小写请求头名称
+ * - timestamp：签名时间戳（毫秒）
+ * - bodyDigest：请求体摘要（十六进制小写，HMAC-SHA256使用SHA256，HMAC-SM3/SM2使用SM3）
+ * 各部分以'\n'连接。请求体摘要为流式计算，上传文件与multipart表单均分块读取，不会整体加载到内存。
+ */
+
+/**
+ * @brief 签名算法
+ */
+enum class SignatureAlgorithm {
+    HMAC_SHA256, ///< HMAC-SHA256
+    HMAC_SM3,    ///< HMAC-SM3
+    SM2          ///< SM2签名（SM3摘要）
+};
+
+/**
+ * @brief 签名配置
+ */
+typedef struct SignatureConfig {
+    SignatureAlgorithm algorithm = SignatureAlgorithm::HMAC_SHA256; ///< 签名算法
+    std::string key;                                                ///< HMAC密钥或SM2私钥PEM内容
+    std::string keyPath;                                            ///< SM2私钥PEM文件路径
+    std::string sm2Id = "1234567812345678";                         ///< SM2用户ID
+    std::string keyId;                                              ///< 密钥标识
+    std::vector<std::string> signedHeaders;                         ///< 参与签名的请求头（小写）
+    std::vector<std::string> canonical;                             ///< 签名原文组成规范
+    std::string headerName = "X-Signature";                         ///< 签名输出请求头
+    std::string headerTemplate = "{signature}";                     ///< 签名请求头值模板
+    std::string digestHeaderName;                                   ///< 请求体摘要输出请求头（可选）
+    std::string timestampHeaderName;                                ///< 时间戳输出请求头（可选）
+    bool hexEncoding = false;                                       ///< 签名编码，默认base64
+} SignatureConfig;
+
+/**
+ * @brief 待签名的请求内容
+ */
+typedef struct SignInput {
+    std::string method;               ///< 请求方法
+    std::string url;                  ///< 请求URL
+    const struct curl_slist *headers = nullptr;       ///< 实际发送的请求头
+    const struct curl_slist *sharedHeaders = nullptr; ///< 实际发送的客户端公共请求头（可选）
+    BodyReader *body = nullptr;                       ///< 实际发送的请求体（为空表示无请求体）
+} SignInput;
+
+/**
+ * @brief 解析签名算法名称
+ * @param name 'HMAC-SHA256' | 'HMAC-SM3' | 'SM2'
+ * @param algorithm 输出算法
+ * @return 是否支持该算法
+ */
+bool ParseSignatureAlgorithm(const std::string &name, SignatureAlgorithm &algorithm);
+
+/**
+ * @brief 对请求签名
+ * @param config 签名配置
+ * @param input 请求内容
+ * @param outHeaders 需要追加的请求头（"Name: value"）
+ * @param errorMsg 失败原因
+ * @return 是否成功
+ */
+bool SignRequest(const SignatureConfig &config, const SignInput &input, std::vector<std::string> &outHeaders,
+                 std::string &errorMsg);
+
+#endif // GMCURL_REQUEST_SIGNER_H
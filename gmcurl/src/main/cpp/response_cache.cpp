@@ -0,0 +1,106 @@
+#include "response_cache.h"
+#include <algorithm>
+#include <cctype>
+
+/**
+ * @file response_cache.cpp
+ * @brief 进程级内存响应缓存实现
+ */
+
+namespace {
+
+size_t EntrySize(const CachedResponse &response) { return response.headers.size() + response.body.size(); }
+
+} // namespace
+
+ResponseCache &ResponseCache::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static ResponseCache *cache = new ResponseCache();
+    return *cache;
+}
+
+std::string ResponseCache::VariantOf(const std::vector<std::string> &headerLines, const std::string &caPath,
+                                     const std::string &clientCertPath, bool isTLCP, bool verifyServer) {
+    std::vector<std::string> lines;
+    for (const std::string &line : headerLines) {
+        size_t colon = line.find(':');
+        std::string name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        std::string value = colon == std::string::npos ? std::string() : line.substr(colon + 1);
+        size_t start = value.find_first_not_of(' ');
+        lines.push_back(name + ":" + (start == std::string::npos ? std::string() : value.substr(start)));
+    }
+    std::sort(lines.begin(), lines.end());
+    std::string variant;
+    for (const std::string &line : lines) {
+        variant += line + "\n";
+    }
+    variant += "ca=" + caPath + "\ncert=" + clientCertPath + "\ntlcp=" + (isTLCP ? "1" : "0") + "\nverify=" +
+               (verifyServer ? "1" : "0");
+    return variant;
+}
+
+std::shared_ptr<const CachedResponse> ResponseCache::Find(const std::string &url, const std::string &variant) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(url);
+    if (it == entries.end() || it->second.response->variant != variant) {
+        return nullptr;
+    }
+    if (it->second.response->expires <= std::chrono::steady_clock::now()) {
+        Erase(it);
+        return nullptr;
+    }
+    recent.splice(recent.begin(), recent, it->second.position);
+    hits++;
+    return it->second.response;
+}
+
+bool ResponseCache::Contains(const std::string &url, const std::string &variant) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(url);
+    return it != entries.end() && it->second.response->variant == variant &&
+           it->second.response->expires > std::chrono::steady_clock::now();
+}
+
+void ResponseCache::Store(const std::string &url, std::shared_ptr<const CachedResponse> response) {
+    size_t size = EntrySize(*response);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(url);
+    if (it != entries.end()) {
+        Erase(it);
+    }
+    if (size > kMaxEntryBytes) {
+        return;
+    }
+    // 淘汰最久未使用的条目
+    while (bytes + size > kMaxBytes && !recent.empty()) {
+        Erase(entries.find(recent.back()));
+    }
+    recent.push_front(url);
+    Entry &entry = entries[url];
+    entry.response = std::move(response);
+    entry.position = recent.begin();
+    bytes += size;
+}
+
+void ResponseCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    recent.clear();
+    bytes = 0;
+}
+
+ResponseCacheStats ResponseCache::Stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ResponseCacheStats stats;
+    stats.entries = static_cast<int64_t>(entries.size());
+    stats.bytes = static_cast<int64_t>(bytes);
+    stats.hits = hits;
+    return stats;
+}
+
+void ResponseCache::Erase(std::map<std::string, Entry>::iterator it) {
+    bytes -= EntrySize(*it->second.response);
+    recent.erase(it->second.position);
+    entries.erase(it);
+}
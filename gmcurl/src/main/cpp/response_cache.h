@@ -0,0 +1,126 @@
+#ifndef GMCURL_RESPONSE_CACHE_H
+#define GMCURL_RESPONSE_CACHE_H
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @file response_cache.h
+ * @brief 进程级内存响应缓存
+ *
+ * 保存预取（见prefetch_queue.h）得到的GET响应，之后对同一URL的request()在JS线程中直接返回，
+ * 不创建异步任务也不发送请求。条目按有效期过期，总大小超过上限时淘汰最久未使用的条目。
+ *
+ * 每个条目记录取得响应时的请求变体（请求头与TLS配置），只有变体相同的请求命中，
+ * 不同凭证或证书的请求不会得到其他调用方的响应。
+ */
+
+/**
+ * @brief 缓存的响应
+ */
+typedef struct CachedResponse {
+    long status = 0;                               ///< HTTP状态码
+    std::string headers;                           ///< 响应头原始数据
+    std::string body;                              ///< 响应体
+    std::string variant;                           ///< 请求变体（见ResponseCache::VariantOf）
+    std::chrono::steady_clock::time_point expires; ///< 过期时间
+} CachedResponse;
+
+/**
+ * @brief 响应缓存统计
+ */
+typedef struct ResponseCacheStats {
+    int64_t entries = 0; ///< 条目数
+    int64_t bytes = 0;   ///< 响应头与响应体总大小
+    int64_t hits = 0;    ///< 命中次数
+} ResponseCacheStats;
+
+/**
+ * @brief 进程级内存响应缓存（线程安全）
+ */
+class ResponseCache {
+public:
+    /**
+     * @brief 总大小上限（32MB）
+     */
+    static const size_t kMaxBytes = 33554432;
+
+    /**
+     * @brief 单个响应的大小上限（4MB）
+     */
+    static const size_t kMaxEntryBytes = 4194304;
+
+    /**
+     * @brief 获取进程级实例
+     */
+    static ResponseCache &Instance();
+
+    ResponseCache(const ResponseCache &) = delete;
+    ResponseCache &operator=(const ResponseCache &) = delete;
+
+    /**
+     * @brief 计算请求变体
+     * @param headerLines 请求头（"Name: value"），名称不区分大小写，与顺序无关
+     * @param caPath CA证书路径
+     * @param clientCertPath 客户端证书目录
+     * @param isTLCP 是否使用TLCP
+     * @param verifyServer 是否校验服务端证书
+     */
+    static std::string VariantOf(const std::vector<std::string> &headerLines, const std::string &caPath,
+                                 const std::string &clientCertPath, bool isTLCP, bool verifyServer);
+
+    /**
+     * @brief 查找未过期且变体相同的响应（计入命中次数，过期的条目删除）
+     * @param url 请求URL
+     * @param variant 请求变体
+     * @return 缓存的响应，未命中时为空
+     */
+    std::shared_ptr<const CachedResponse> Find(const std::string &url, const std::string &variant);
+
+    /**
+     * @brief 是否有未过期且变体相同的响应（不计入命中次数）
+     */
+    bool Contains(const std::string &url, const std::string &variant);
+
+    /**
+     * @brief 保存响应（替换同一URL的旧响应，超过单个响应上限时不保存）
+     */
+    void Store(const std::string &url, std::shared_ptr<const CachedResponse> response);
+
+    /**
+     * @brief 清空缓存
+     */
+    void Clear();
+
+    /**
+     * @brief 统计信息
+     */
+    ResponseCacheStats Stats();
+
+private:
+    ResponseCache() = default;
+
+    /**
+     * @brief 缓存条目
+     */
+    typedef struct Entry {
+        std::shared_ptr<const CachedResponse> response; ///< 响应
+        std::list<std::string>::iterator position;      ///< 在使用顺序中的位置
+    } Entry;
+
+    void Erase(std::map<std::string, Entry>::iterator it);
+
+    std::mutex mutex;                     ///< 互斥锁
+    std::map<std::string, Entry> entries; ///< URL -> 条目
+    std::list<std::string> recent;        ///< 使用顺序（最近使用的在前）
+    size_t bytes = 0;                     ///< 总大小
+    int64_t hits = 0;                     ///< 命中次数
+};
+
+#endif // GMCURL_RESPONSE_CACHE_H
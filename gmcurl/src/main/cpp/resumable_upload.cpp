@@ -0,0 +1,516 @@
+#include "resumable_upload.h"
+#include "connection_pool.h"
+#include "journal_file.h"
+#include "redirect_cache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <strings.h>
+#include <sys/stat.h>
+#include <thread>
+
+/**
+ * @file resumable_upload.cpp
+ * @brief 断点续传上传实现
+ */
+
+namespace {
+
+/**
+ * @brief 记录文件名
+ */
+const char *const kJournalFileName = "uploads.journal";
+
+/**
+ * @brief 最多保留的记录数量
+ */
+const size_t kMaxRecords = 64;
+
+/**
+ * @brief tus协议版本
+ */
+const char *const kTusVersion = "Tus-Resumable: 1.0.0";
+
+/**
+ * @brief 重试等待的最长时间（秒）
+ */
+const int kMaxBackoffSeconds = 30;
+
+std::string RecordKey(const std::string &url, const std::string &filePath) { return url + "\n" + filePath; }
+
+/**
+ * @brief 解析非负整数
+ */
+bool ParseOffset(const std::string &value, int64_t &out) {
+    if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    out = atoll(value.c_str());
+    return true;
+}
+
+/**
+ * @brief 请求头名称（"Name: value"中冒号前的部分）是否相同
+ */
+bool SameHeaderName(const std::string &a, const std::string &b) {
+    size_t lenA = a.find(':');
+    size_t lenB = b.find(':');
+    return lenA != std::string::npos && lenA == lenB && strncasecmp(a.c_str(), b.c_str(), lenA) == 0;
+}
+
+size_t ReadHeader(char *data, size_t size, size_t nmemb, void *userp) {
+    auto *out = static_cast<UploadResult *>(userp);
+    size_t len = size * nmemb;
+    // 100 Continue等中间响应的响应头不保留
+    if (len > 5 && strncmp(data, "HTTP/", 5) == 0) {
+        out->headers.clear();
+    }
+    out->headers.append(data, len);
+    return len;
+}
+
+size_t WriteBody(char *data, size_t size, size_t nmemb, void *userp) {
+    auto *out = static_cast<UploadResult *>(userp);
+    out->body.append(data, size * nmemb);
+    return size * nmemb;
+}
+
+} // namespace
+
+bool FindResponseHeader(const std::string &headers, const char *name, std::string &out) {
+    size_t nameLen = strlen(name);
+    std::istringstream lines(headers);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.size() > nameLen && line[nameLen] == ':' && strncasecmp(line.c_str(), name, nameLen) == 0) {
+            size_t begin = line.find_first_not_of(" \t", nameLen + 1);
+            size_t end = line.find_last_not_of(" \t\r");
+            out = begin == std::string::npos || end < begin ? "" : line.substr(begin, end - begin + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IsUploadRetriable(CURLcode result) {
+    return result == CURLE_RECV_ERROR || result == CURLE_SEND_ERROR || result == CURLE_PARTIAL_FILE ||
+           result == CURLE_GOT_NOTHING || result == CURLE_OPERATION_TIMEDOUT || result == CURLE_HTTP2_STREAM ||
+           result == CURLE_HTTP2 || result == CURLE_COULDNT_CONNECT || result == CURLE_COULDNT_RESOLVE_HOST ||
+           result == CURLE_SSL_CONNECT_ERROR;
+}
+
+UploadJournal &UploadJournal::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static UploadJournal *journal = new UploadJournal();
+    return *journal;
+}
+
+void UploadJournal::Load(const std::string &newDirectory) {
+    std::lock_guard<std::mutex> lock(mutex);
+    directory = newDirectory;
+    std::ifstream file(directory + "/" + kJournalFileName);
+    std::string line;
+    std::string url;
+    std::string path;
+    UploadRecord record;
+    while (std::getline(file, line)) {
+        size_t space = line.find(' ');
+        std::string key = line.substr(0, space);
+        std::string value = space == std::string::npos ? "" : JournalUnescape(line.substr(space + 1));
+        if (key == "upload") {
+            url = value;
+            path.clear();
+            record = UploadRecord();
+        } else if (key == "path") {
+            path = value;
+        } else if (key == "location") {
+            record.location = value;
+        } else if (key == "offset") {
+            record.offset = atoll(value.c_str());
+        } else if (key == "size") {
+            record.size = atoll(value.c_str());
+        } else if (key == "modified") {
+            record.modified = atoll(value.c_str());
+        } else if (key == "end" && !url.empty() && !path.empty()) {
+            // 已有的记录较新
+            std::string recordKey = RecordKey(url, path);
+            if (!records.count(recordKey)) {
+                record.updated = nextUpdate++;
+                records[recordKey] = record;
+            }
+            url.clear();
+        }
+    }
+}
+
+bool UploadJournal::Find(const std::string &url, const std::string &filePath, UploadRecord &record) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = records.find(RecordKey(url, filePath));
+    if (it == records.end()) {
+        return false;
+    }
+    record = it->second;
+    return true;
+}
+
+void UploadJournal::Store(const std::string &url, const std::string &filePath, const UploadRecord &record) {
+    std::lock_guard<std::mutex> lock(mutex);
+    UploadRecord &stored = records[RecordKey(url, filePath)];
+    stored = record;
+    stored.updated = nextUpdate++;
+    if (records.size() > kMaxRecords) {
+        auto oldest = std::min_element(records.begin(), records.end(), [](const auto &a, const auto &b) {
+            return a.second.updated < b.second.updated;
+        });
+        records.erase(oldest);
+    }
+    Save();
+}
+
+void UploadJournal::Remove(const std::string &url, const std::string &filePath) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (records.erase(RecordKey(url, filePath)) > 0) {
+        Save();
+    }
+}
+
+void UploadJournal::Save() {
+    // 需持有互斥锁
+    if (directory.empty()) {
+        return;
+    }
+    std::ostringstream out;
+    for (const auto &item : records) {
+        size_t split = item.first.find('\n');
+        const UploadRecord &record = item.second;
+        out << "upload " << JournalEscape(item.first.substr(0, split)) << "\n";
+        out << "path " << JournalEscape(item.first.substr(split + 1)) << "\n";
+        out << "location " << JournalEscape(record.location) << "\n";
+        out << "offset " << record.offset << "\n";
+        out << "size " << record.size << "\n";
+        out << "modified " << record.modified << "\n";
+        out << "end\n";
+    }
+    WriteJournalFile(directory, kJournalFileName, out.str());
+}
+
+ResumableUpload::ResumableUpload(const std::string &url, const std::string &filePath,
+                                 const ResumableUploadConfig &config, const std::vector<std::string> &headers)
+    : url(url), filePath(filePath), config(config), headers(headers) {
+    if (this->config.chunkSize <= 0) {
+        this->config.chunkSize = ResumableUploadConfig().chunkSize;
+    }
+}
+
+UploadResult ResumableUpload::Run(const UploadConfigurator &newConfigurator, const UploadCanceled &canceled) {
+    UploadResult out;
+    struct stat st;
+    if (stat(filePath.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        out.result = CURLE_READ_ERROR;
+        out.error = "Failed to open file for upload";
+        return out;
+    }
+    configurator = &newConfigurator;
+    size = static_cast<int64_t>(st.st_size);
+    modified = static_cast<int64_t>(st.st_mtime);
+
+    // 文件未变化时沿用记录的会话，位置以服务端查询结果为准
+    UploadJournal &journal = UploadJournal::Instance();
+    UploadRecord record;
+    bool resumed = journal.Find(url, filePath, record) && record.size == size && record.modified == modified;
+    if (resumed) {
+        location = record.location;
+    } else {
+        journal.Remove(url, filePath);
+    }
+    if (config.protocol == UploadProtocol::CONTENT_RANGE) {
+        location = url;
+        // 新的上传直接从头发送，空文件需要一次查询请求完成上传
+        offset = !resumed && size > 0 ? 0 : -1;
+    }
+
+    int failures = 0;
+    while (true) {
+        Step step;
+        if (location.empty()) {
+            step = Create(out);
+        } else if (offset < 0) {
+            step = Query(out);
+        } else if (offset >= size) {
+            step = Step::COMPLETE;
+        } else {
+            step = SendChunk(out);
+        }
+        if (step == Step::OK) {
+            failures = 0;
+            continue;
+        }
+        if (step == Step::COMPLETE) {
+            journal.Remove(url, filePath);
+            out.offset = size;
+            break;
+        }
+        out.offset = std::max<int64_t>(offset, 0);
+        if (step == Step::FAIL || ++failures > config.maxRetries) {
+            break;
+        }
+        offset = -1;
+        if (step == Step::RESTART) {
+            // 服务端会话已失效，重新创建并从头上传
+            location.clear();
+            journal.Remove(url, filePath);
+        } else if (step == Step::RETRY) {
+            // 指数退避，等待期间响应取消
+            auto until = std::chrono::steady_clock::now() +
+                         std::chrono::seconds(std::min(1 << std::min(failures - 1, 5), kMaxBackoffSeconds));
+            bool stopped = false;
+            while (!stopped && std::chrono::steady_clock::now() < until) {
+                stopped = canceled();
+                if (!stopped) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
+            }
+            if (stopped) {
+                out.result = CURLE_ABORTED_BY_CALLBACK;
+                break;
+            }
+        }
+    }
+    configurator = nullptr;
+    return out;
+}
+
+ResumableUpload::Step ResumableUpload::Create(UploadResult &out) {
+    std::vector<std::string> extra{kTusVersion, "Upload-Length: " + std::to_string(size)};
+    Step step = Classify(Perform("POST", url, extra, 0, -1, out), out);
+    if (step != Step::OK) {
+        return step;
+    }
+    std::string value;
+    if (out.status != 201) {
+        return Step::FAIL;
+    }
+    if (!FindResponseHeader(out.headers, "Location", value) || !ResolveRedirectLocation(url, value, location)) {
+        out.error = "Upload creation response without Location";
+        return Step::FAIL;
+    }
+    offset = 0;
+    Persist();
+    return Step::OK;
+}
+
+ResumableUpload::Step ResumableUpload::Query(UploadResult &out) {
+    std::string value;
+    if (config.protocol == UploadProtocol::TUS) {
+        Step step = Classify(Perform("HEAD", location, {kTusVersion}, 0, -1, out), out);
+        if (step != Step::OK) {
+            return step;
+        }
+        if (out.status == 404 || out.status == 410 || out.status == 403) {
+            return Step::RESTART;
+        }
+        if (out.status != 200 && out.status != 204) {
+            return Step::FAIL;
+        }
+        int64_t confirmed = 0;
+        if (!FindResponseHeader(out.headers, "Upload-Offset", value) || !ParseOffset(value, confirmed) ||
+            confirmed > size) {
+            out.error = "Invalid Upload-Offset in response";
+            return Step::FAIL;
+        }
+        offset = confirmed;
+    } else {
+        std::vector<std::string> extra{"Content-Range: bytes */" + std::to_string(size)};
+        Step step = Classify(Perform("PUT", location, extra, 0, 0, out), out);
+        if (step != Step::OK) {
+            return step;
+        }
+        if (out.status == 200 || out.status == 201) {
+            offset = size;
+            return Step::COMPLETE;
+        }
+        if (out.status != 308) {
+            if (out.status == 404 || out.status == 410) {
+                out.error = "Upload session expired";
+            }
+            return Step::FAIL;
+        }
+        // Range: bytes=0-最后接收的位置，没有Range表示尚未接收数据
+        int64_t last = -1;
+        if (FindResponseHeader(out.headers, "Range", value) && value.compare(0, 8, "bytes=0-") == 0 &&
+            (!ParseOffset(value.substr(8), last) || last >= size)) {
+            out.error = "Invalid Range in response";
+            return Step::FAIL;
+        }
+        offset = last + 1;
+    }
+    Persist();
+    return offset >= size && config.protocol == UploadProtocol::TUS ? Step::COMPLETE : Step::OK;
+}
+
+ResumableUpload::Step ResumableUpload::SendChunk(UploadResult &out) {
+    int64_t length = std::min(config.chunkSize, size - offset);
+    std::string value;
+    if (config.protocol == UploadProtocol::TUS) {
+        std::vector<std::string> extra{kTusVersion, "Upload-Offset: " + std::to_string(offset),
+                                       "Content-Type: application/offset+octet-stream"};
+        Step step = Classify(Perform("PATCH", location, extra, offset, length, out), out);
+        if (step != Step::OK) {
+            return step;
+        }
+        if (out.status == 409) {
+            return Step::REQUERY;
+        }
+        if (out.status == 404 || out.status == 410 || out.status == 403) {
+            return Step::RESTART;
+        }
+        if (out.status != 200 && out.status != 204) {
+            return Step::FAIL;
+        }
+        int64_t confirmed = 0;
+        if (!FindResponseHeader(out.headers, "Upload-Offset", value) || !ParseOffset(value, confirmed) ||
+            confirmed <= offset || confirmed > size) {
+            out.error = "Invalid Upload-Offset in response";
+            return Step::FAIL;
+        }
+        offset = confirmed;
+    } else {
+        std::string range = "Content-Range: bytes " + std::to_string(offset) + "-" +
+                            std::to_string(offset + length - 1) + "/" + std::to_string(size);
+        std::vector<std::string> extra{range};
+        if (std::none_of(headers.begin(), headers.end(),
+                         [](const std::string &header) { return SameHeaderName(header, "Content-Type:"); })) {
+            extra.push_back("Content-Type: application/octet-stream");
+        }
+        Step step = Classify(Perform("PUT", location, extra, offset, length, out), out);
+        if (step != Step::OK) {
+            return step;
+        }
+        if (out.status == 200 || out.status == 201) {
+            offset = size;
+            return Step::COMPLETE;
+        }
+        if (out.status != 308) {
+            if (out.status == 404 || out.status == 410) {
+                out.error = "Upload session expired";
+            }
+            return Step::FAIL;
+        }
+        int64_t last = -1;
+        if (!FindResponseHeader(out.headers, "Range", value) || value.compare(0, 8, "bytes=0-") != 0 ||
+            !ParseOffset(value.substr(8), last) || last + 1 <= offset || last >= size) {
+            // 服务端没有确认本块，重新查询位置
+            return Step::REQUERY;
+        }
+        offset = last + 1;
+    }
+    Persist();
+    return offset >= size ? Step::COMPLETE : Step::OK;
+}
+
+CURLcode PerformUploadRequest(const std::string &method, const std::string &target,
+                              const std::vector<std::string> &protocolHeaders, const std::vector<std::string> &headers,
+                              BodyReader *body, const std::function<void(CURL *)> &setup, UploadResult &out) {
+    out.status = 0;
+    out.headers.clear();
+    out.body.clear();
+    ConnectionPool &connectionPool = ConnectionPool::Instance();
+    std::string poolKey = ConnectionPool::KeyOf(target);
+    CURL *curl = connectionPool.Acquire(poolKey);
+    if (!curl) {
+        curl = curl_easy_init();
+    }
+    if (!curl) {
+        connectionPool.Release(poolKey, nullptr, false);
+        return CURLE_FAILED_INIT;
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, target.c_str());
+    setup(curl);
+    connectionPool.Prepare(curl);
+    // 协议请求头优先于附加请求头
+    curl_slist *headerList = nullptr;
+    for (const std::string &header : protocolHeaders) {
+        headerList = curl_slist_append(headerList, header.c_str());
+    }
+    for (const std::string &header : headers) {
+        if (std::none_of(protocolHeaders.begin(), protocolHeaders.end(),
+                         [&header](const std::string &item) { return SameHeaderName(item, header); })) {
+            headerList = curl_slist_append(headerList, header.c_str());
+        }
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, ReadHeader);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &out);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &out);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 0L);
+    if (body) {
+        curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, BodyReader::CurlRead);
+        curl_easy_setopt(curl, CURLOPT_READDATA, body);
+        curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, BodyReader::CurlSeek);
+        curl_easy_setopt(curl, CURLOPT_SEEKDATA, body);
+        curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(body->TotalSize()));
+    } else if (method == "HEAD") {
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    } else {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "");
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(0));
+        if (method != "POST") {
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+        }
+    }
+
+    CURLcode result = curl_easy_perform(curl);
+    if (result == CURLE_OK && body && body->Failed()) {
+        result = CURLE_READ_ERROR;
+    }
+    if (result == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &out.status);
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+    curl_slist_free_all(headerList);
+    connectionPool.Release(poolKey, curl, result == CURLE_OK);
+    return result;
+}
+
+CURLcode ResumableUpload::Perform(const std::string &method, const std::string &target,
+                                  const std::vector<std::string> &extra, int64_t bodyOffset, int64_t bodyLength,
+                                  UploadResult &out) {
+    std::unique_ptr<BodyReader> body;
+    if (bodyLength > 0) {
+        body.reset(new FileBodyReader(filePath, bodyOffset, bodyLength));
+    } else if (bodyLength == 0) {
+        body.reset(new MemoryBodyReader("", 0));
+    }
+    int64_t confirmed = std::max<int64_t>(offset, 0);
+    const UploadConfigurator &setup = *configurator;
+    return PerformUploadRequest(method, target, extra, headers, body.get(),
+                                [&setup, confirmed](CURL *curl) { setup(curl, confirmed); }, out);
+}
+
+ResumableUpload::Step ResumableUpload::Classify(CURLcode result, UploadResult &out) {
+    out.result = result;
+    if (result != CURLE_OK) {
+        return IsUploadRetriable(result) ? Step::RETRY : Step::FAIL;
+    }
+    // 服务端暂时不可用，等待后查询位置继续
+    if (out.status >= 500 || out.status == 408 || out.status == 429) {
+        return Step::RETRY;
+    }
+    return Step::OK;
+}
+
+void ResumableUpload::Persist() {
+    UploadRecord record;
+    record.location = location;
+    record.offset = std::max<int64_t>(offset, 0);
+    record.size = size;
+    record.modified = modified;
+    UploadJournal::Instance().Store(url, filePath, record);
+}
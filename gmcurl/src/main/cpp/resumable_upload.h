@@ -0,0 +1,203 @@
+#ifndef GMCURL_RESUMABLE_UPLOAD_H
+#define GMCURL_RESUMABLE_UPLOAD_H
+
+#include "body_reader.h"
+#include "curl.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @file resumable_upload.h
+ * @brief 断点续传上传
+ *
+ * 大文件按固定大小分块上传，每块得到服务端确认后把确认位置写入缓存目录下的uploads.journal；
+ * 失败或进程重启后先向服务端查询已接收的位置，再从该位置继续上传：
+ * - tus协议（1.0.0）：POST创建上传会话（Upload-Length）得到Location，HEAD查询Upload-Offset，
+ *   PATCH按Upload-Offset追加分块
+ * - Content-Range协议：以范围为"*"的Content-Range发送空请求体的PUT查询位置（308响应的Range头），
+ *   PUT携带"Content-Range: bytes 起始-结束/总大小"上传分块，308表示继续，200/201表示完成
+ * 文件大小或修改时间变化后已记录的会话作废，从头上传。
+ */
+
+/**
+ * @brief 断点续传协议
+ */
+enum class UploadProtocol {
+    TUS,          ///< tus 1.0.0
+    CONTENT_RANGE ///< 位置查询 + Content-Range分块
+};
+
+/**
+ * @brief 断点续传配置
+ */
+typedef struct ResumableUploadConfig {
+    bool enabled = false;                          ///< 是否启用断点续传
+    UploadProtocol protocol = UploadProtocol::TUS; ///< 协议
+    int64_t chunkSize = 8388608;                   ///< 分块大小（默认8MB）
+    int maxRetries = 5;                            ///< 连续失败的最大重试次数
+} ResumableUploadConfig;
+
+/**
+ * @brief 断点续传结果（最后一次请求的响应）
+ */
+typedef struct UploadResult {
+    CURLcode result = CURLE_OK; ///< 传输结果
+    long status = 0;            ///< HTTP状态码
+    std::string headers;        ///< 响应头原始数据
+    std::string body;           ///< 响应体
+    std::string error;          ///< 协议错误（服务端响应不符合协议），为空表示无
+    int64_t offset = 0;         ///< 服务端已确认的位置
+} UploadResult;
+
+/**
+ * @brief 分块请求配置回调（传输层配置、超时与进度）
+ * @param curl 请求句柄
+ * @param offset 本次请求开始前服务端已确认的位置
+ */
+typedef std::function<void(CURL *, int64_t offset)> UploadConfigurator;
+
+/**
+ * @brief 是否已取消（重试等待期间检查）
+ */
+typedef std::function<bool()> UploadCanceled;
+
+/**
+ * @brief 执行上传协议中的单个请求（从连接池取用句柄，不跟随重定向）
+ * @param method 请求方法（无请求体时HEAD不接收响应体，其余方法发送空请求体）
+ * @param target 请求URL
+ * @param protocolHeaders 协议请求头（与附加请求头同名时优先）
+ * @param headers 附加请求头
+ * @param body 请求体，为空表示无请求体
+ * @param setup 句柄配置（传输层配置、超时与进度）
+ * @param out 响应状态码、响应头与响应体
+ * @return 传输结果
+ */
+CURLcode PerformUploadRequest(const std::string &method, const std::string &target,
+                              const std::vector<std::string> &protocolHeaders, const std::vector<std::string> &headers,
+                              BodyReader *body, const std::function<void(CURL *)> &setup, UploadResult &out);
+
+/**
+ * @brief 在响应头原始数据中查找响应头的值（去除首尾空白）
+ */
+bool FindResponseHeader(const std::string &headers, const char *name, std::string &out);
+
+/**
+ * @brief 是否为网络中断类错误（可重试）
+ */
+bool IsUploadRetriable(CURLcode result);
+
+/**
+ * @brief 已确认位置的持久化记录
+ */
+typedef struct UploadRecord {
+    std::string location; ///< 上传会话URL
+    int64_t offset = 0;   ///< 服务端已确认的位置
+    int64_t size = 0;     ///< 文件大小
+    int64_t modified = 0; ///< 文件修改时间（秒）
+    int64_t updated = 0;  ///< 更新序号（用于淘汰最久未更新的记录）
+} UploadRecord;
+
+/**
+ * @brief 进程级断点续传记录（线程安全，每次更新立即写入文件）
+ */
+class UploadJournal {
+public:
+    /**
+     * @brief 获取进程级实例
+     */
+    static UploadJournal &Instance();
+
+    UploadJournal(const UploadJournal &) = delete;
+    UploadJournal &operator=(const UploadJournal &) = delete;
+
+    /**
+     * @brief 加载记录文件（再次调用时合并新目录中的记录并改为写入新目录）
+     */
+    void Load(const std::string &directory);
+
+    /**
+     * @brief 查找记录
+     * @param url 上传URL
+     * @param filePath 文件路径
+     */
+    bool Find(const std::string &url, const std::string &filePath, UploadRecord &record);
+
+    /**
+     * @brief 保存记录
+     */
+    void Store(const std::string &url, const std::string &filePath, const UploadRecord &record);
+
+    /**
+     * @brief 删除记录
+     */
+    void Remove(const std::string &url, const std::string &filePath);
+
+private:
+    UploadJournal() = default;
+
+    void Save();
+
+    std::mutex mutex;                            ///< 互斥锁
+    std::map<std::string, UploadRecord> records; ///< URL + 文件路径 -> 记录
+    std::string directory;                       ///< 记录文件目录
+    int64_t nextUpdate = 0;                      ///< 下一个更新序号
+};
+
+/**
+ * @brief 单个文件的断点续传上传（在调用线程中同步执行）
+ */
+class ResumableUpload {
+public:
+    /**
+     * @param url 上传URL（tus为创建会话的地址，Content-Range为上传会话地址）
+     * @param filePath 文件路径
+     * @param config 断点续传配置
+     * @param headers 附加请求头（"Name: value"），随每个请求发送
+     */
+    ResumableUpload(const std::string &url, const std::string &filePath, const ResumableUploadConfig &config,
+                    const std::vector<std::string> &headers);
+
+    /**
+     * @brief 执行上传直到完成、失败或取消
+     * @param configurator 分块请求配置回调
+     * @param canceled 取消检查
+     */
+    UploadResult Run(const UploadConfigurator &configurator, const UploadCanceled &canceled);
+
+private:
+    /**
+     * @brief 单次请求的处理结果
+     */
+    enum class Step {
+        OK,       ///< 成功
+        COMPLETE, ///< 服务端已接收全部数据
+        REQUERY,  ///< 位置不一致，重新查询
+        RESTART,  ///< 会话失效，重新创建
+        RETRY,    ///< 网络错误，等待后重试
+        FAIL      ///< 不可恢复的错误
+    };
+
+    Step Create(UploadResult &out);
+    Step Query(UploadResult &out);
+    Step SendChunk(UploadResult &out);
+    CURLcode Perform(const std::string &method, const std::string &target, const std::vector<std::string> &extra,
+                     int64_t bodyOffset, int64_t bodyLength, UploadResult &out);
+    Step Classify(CURLcode result, UploadResult &out);
+    void Persist();
+
+    std::string url;                                  ///< 上传URL
+    std::string filePath;                             ///< 文件路径
+    ResumableUploadConfig config;                     ///< 配置
+    std::vector<std::string> headers;                 ///< 附加请求头
+    const UploadConfigurator *configurator = nullptr; ///< 分块请求配置回调（Run期间有效）
+    std::string location;                             ///< 上传会话URL
+    int64_t size = 0;                                 ///< 文件大小
+    int64_t modified = 0;                             ///< 文件修改时间
+    int64_t offset = -1;                              ///< 服务端已确认的位置，-1表示未知
+};
+
+#endif // GMCURL_RESUMABLE_UPLOAD_H
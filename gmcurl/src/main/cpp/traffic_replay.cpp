@@ -0,0 +1,521 @@
+#include "traffic_replay.h"
+#include "journal_file.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <sstream>
+#include <strings.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <zlib.h>
+
+/**
+ * @file traffic_replay.cpp
+ * @brief 流量录制与本地回放实现
+ */
+
+namespace {
+
+/**
+ * @brief 录制文件首行
+ */
+const char *const kRecordingMagic = "gmcurl-recording 1";
+
+/**
+ * @brief 回放时每次发送的最大字节数
+ */
+const size_t kSendChunk = 16384;
+
+/**
+ * @brief 请求头的最大长度
+ */
+const size_t kMaxRequestHead = 65536;
+
+/**
+ * @brief 回放时由服务器重新生成的响应头（录制的响应体已解压、已去除分块编码）
+ */
+const char *const kHopHeaders[] = {"Content-Length", "Transfer-Encoding", "Content-Encoding", "Connection",
+                                   "Keep-Alive"};
+
+/**
+ * @brief 录制时替换值的认证相关响应头（Set-Cookie只替换Cookie值，保留名称与属性）
+ */
+const char *const kSensitiveHeaders[] = {"Set-Cookie", "Set-Cookie2", "Authorization", "Proxy-Authorization",
+                                         "Authentication-Info", "Proxy-Authentication-Info"};
+
+/**
+ * @brief 替换敏感响应头的值
+ */
+void RedactHeader(std::string &header) {
+    size_t colon = header.find(':');
+    std::string name = header.substr(0, colon);
+    if (std::none_of(std::begin(kSensitiveHeaders), std::end(kSensitiveHeaders),
+                     [&name](const char *sensitive) { return strcasecmp(name.c_str(), sensitive) == 0; })) {
+        return;
+    }
+    if (strncasecmp(name.c_str(), "Set-Cookie", 10) != 0) {
+        header = name + ": redacted";
+        return;
+    }
+    size_t equal = header.find('=', colon);
+    if (equal == std::string::npos) {
+        header = name + ": redacted";
+        return;
+    }
+    size_t end = header.find(';', equal);
+    header.replace(equal + 1, (end == std::string::npos ? header.size() : end) - equal - 1, "redacted");
+}
+
+/**
+ * @brief 去除URL的协议与主机部分，返回路径（含查询参数）
+ */
+std::string PathOf(const std::string &url) {
+    size_t scheme = url.find("://");
+    if (scheme == std::string::npos) {
+        return url.empty() ? "/" : url;
+    }
+    size_t path = url.find_first_of("/?#", scheme + 3);
+    if (path == std::string::npos) {
+        return "/";
+    }
+    std::string result = url.substr(path, url.find('#', path) - path);
+    return result[0] == '/' ? result : "/" + result;
+}
+
+std::string ExchangeKey(const std::string &method, const std::string &path, const std::string &hash) {
+    return hash.empty() ? method + " " + path : method + " " + path + " " + hash;
+}
+
+bool SendAll(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool LoadRecording(const std::string &filePath, std::map<std::string, std::vector<RecordedExchange>> &out,
+                   int64_t &count) {
+    // gzopen同样可以读取未压缩的文件（如手工编写的录制文件）
+    gzFile file = gzopen(filePath.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::string content;
+    char buffer[65536];
+    int n;
+    while ((n = gzread(file, buffer, sizeof(buffer))) > 0) {
+        content.append(buffer, static_cast<size_t>(n));
+    }
+    gzclose(file);
+    std::istringstream lines(content);
+    std::string line;
+    if (!std::getline(lines, line) || line != kRecordingMagic) {
+        return false;
+    }
+    RecordedExchange exchange;
+    while (std::getline(lines, line)) {
+        size_t space = line.find(' ');
+        std::string key = line.substr(0, space);
+        std::string value = space == std::string::npos ? "" : line.substr(space + 1);
+        if (key == "exchange") {
+            exchange = RecordedExchange();
+        } else if (key == "method") {
+            exchange.method = JournalUnescape(value);
+        } else if (key == "url") {
+            exchange.url = JournalUnescape(value);
+        } else if (key == "request") {
+            exchange.requestHash = value;
+        } else if (key == "status") {
+            exchange.status = atol(value.c_str());
+        } else if (key == "ttfb") {
+            exchange.ttfb = std::max<int64_t>(0, atoll(value.c_str()));
+        } else if (key == "total") {
+            exchange.total = std::max<int64_t>(0, atoll(value.c_str()));
+        } else if (key == "header") {
+            exchange.headers.push_back(JournalUnescape(value));
+        } else if (key == "body") {
+            exchange.body = JournalUnescape(value);
+        } else if (key == "end" && exchange.status > 0) {
+            out[ExchangeKey(exchange.method, PathOf(exchange.url), exchange.requestHash)].push_back(exchange);
+            count++;
+        }
+    }
+    return count > 0;
+}
+
+} // namespace
+
+std::string RequestBodyHash(const void *data, size_t size) {
+    if (!data || size == 0) {
+        return "";
+    }
+    uLong crc = crc32(0L, Z_NULL, 0);
+    const Bytef *bytes = static_cast<const Bytef *>(data);
+    while (size > 0) {
+        uInt length = static_cast<uInt>(std::min<size_t>(size, 1U << 30));
+        crc = crc32(crc, bytes, length);
+        bytes += length;
+        size -= length;
+    }
+    char text[9];
+    snprintf(text, sizeof(text), "%08lx", static_cast<unsigned long>(crc & 0xffffffffUL));
+    return text;
+}
+
+TrafficRecorder &TrafficRecorder::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static TrafficRecorder *recorder = new TrafficRecorder();
+    return *recorder;
+}
+
+bool TrafficRecorder::Start(const std::string &filePath) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file) {
+        gzclose(static_cast<gzFile>(file));
+    }
+    recorded = 0;
+    file = gzopen(filePath.c_str(), "wb");
+    std::string magic = std::string(kRecordingMagic) + "\n";
+    if (file && (gzputs(static_cast<gzFile>(file), magic.c_str()) < 0 ||
+                 gzflush(static_cast<gzFile>(file), Z_SYNC_FLUSH) != Z_OK)) {
+        gzclose(static_cast<gzFile>(file));
+        file = nullptr;
+    }
+    active = file != nullptr;
+    return active;
+}
+
+int64_t TrafficRecorder::Stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    active = false;
+    if (file) {
+        gzclose(static_cast<gzFile>(file));
+        file = nullptr;
+    }
+    return recorded;
+}
+
+void TrafficRecorder::Record(RecordedExchange exchange, const std::string &rawHeaders) {
+    // 状态行之后的响应头
+    size_t start = rawHeaders.find('\n');
+    while (start != std::string::npos && start + 1 < rawHeaders.size()) {
+        size_t end = rawHeaders.find('\n', start + 1);
+        std::string header = rawHeaders.substr(start + 1, (end == std::string::npos ? rawHeaders.size() : end) -
+                                                              start - 1);
+        while (!header.empty() && (header.back() == '\r' || header.back() == '\n')) {
+            header.pop_back();
+        }
+        if (header.find(':') != std::string::npos) {
+            RedactHeader(header);
+            exchange.headers.push_back(header);
+        }
+        start = end;
+    }
+    std::ostringstream out;
+    out << "exchange\n";
+    out << "method " << JournalEscape(exchange.method) << "\n";
+    out << "url " << JournalEscape(exchange.url) << "\n";
+    if (!exchange.requestHash.empty()) {
+        out << "request " << exchange.requestHash << "\n";
+    }
+    out << "status " << exchange.status << "\n";
+    out << "ttfb " << exchange.ttfb << "\n";
+    out << "total " << exchange.total << "\n";
+    for (const std::string &header : exchange.headers) {
+        out << "header " << JournalEscape(header) << "\n";
+    }
+    out << "body " << JournalEscape(exchange.body) << "\n";
+    out << "end\n";
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!active || !file) {
+        return;
+    }
+    // 每个请求写入后同步刷新，进程异常退出时已录制的请求仍可读取
+    std::string text = out.str();
+    gzwrite(static_cast<gzFile>(file), text.data(), static_cast<unsigned>(text.size()));
+    gzflush(static_cast<gzFile>(file), Z_SYNC_FLUSH);
+    recorded++;
+}
+
+ReplayServer &ReplayServer::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static ReplayServer *server = new ReplayServer();
+    return *server;
+}
+
+int ReplayServer::Start(const std::string &filePath, const ReplayOptions &options) {
+    Stop();
+    auto newSession = std::make_shared<Session>();
+    newSession->options = options;
+    if (!LoadRecording(filePath, newSession->exchanges, newSession->stats.exchanges)) {
+        return 0;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return 0;
+    }
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, 64) != 0 ||
+        getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length) != 0) {
+        close(fd);
+        return 0;
+    }
+    newSession->listenFd = fd;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        session = newSession;
+    }
+    std::thread(Accept, newSession).detach();
+    return ntohs(address.sin_port);
+}
+
+void ReplayServer::Stop() {
+    std::shared_ptr<Session> current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current.swap(session);
+    }
+    if (!current) {
+        return;
+    }
+    current->stopping = true;
+    // 唤醒阻塞在accept/recv中的线程，套接字由各线程自行关闭
+    shutdown(current->listenFd, SHUT_RDWR);
+    std::lock_guard<std::mutex> lock(current->mutex);
+    for (int fd : current->connections) {
+        shutdown(fd, SHUT_RDWR);
+    }
+}
+
+ReplayStats ReplayServer::Stats() {
+    std::shared_ptr<Session> current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = session;
+    }
+    if (!current) {
+        return ReplayStats();
+    }
+    std::lock_guard<std::mutex> lock(current->mutex);
+    return current->stats;
+}
+
+void ReplayServer::Accept(std::shared_ptr<Session> session) {
+    while (!session->stopping) {
+        int fd = accept4(session->listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            if (session->stopping) {
+                close(fd);
+                break;
+            }
+            session->connections.insert(fd);
+            session->stats.connections++;
+        }
+        std::thread(Serve, session, fd).detach();
+    }
+    close(session->listenFd);
+}
+
+void ReplayServer::Serve(std::shared_ptr<Session> session, int fd) {
+    std::string buffer;
+    char chunk[8192];
+    bool keepAlive = true;
+    while (keepAlive && !session->stopping) {
+        size_t headEnd;
+        while ((headEnd = buffer.find("\r\n\r\n")) == std::string::npos && buffer.size() < kMaxRequestHead) {
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) {
+                headEnd = std::string::npos;
+                buffer.clear();
+                keepAlive = false;
+                break;
+            }
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+        if (headEnd == std::string::npos) {
+            break;
+        }
+        std::string head = buffer.substr(0, headEnd);
+        buffer.erase(0, headEnd + 4);
+
+        // 请求行
+        size_t lineEnd = head.find("\r\n");
+        std::string requestLine = head.substr(0, lineEnd);
+        size_t first = requestLine.find(' ');
+        size_t second = requestLine.find(' ', first == std::string::npos ? first : first + 1);
+        if (first == std::string::npos || second == std::string::npos) {
+            break;
+        }
+        std::string method = requestLine.substr(0, first);
+        std::string target = requestLine.substr(first + 1, second - first - 1);
+        keepAlive = requestLine.compare(second + 1, std::string::npos, "HTTP/1.1") == 0;
+
+        // 请求头
+        int64_t contentLength = 0;
+        bool chunked = false;
+        bool expectContinue = false;
+        size_t pos = lineEnd;
+        while (pos != std::string::npos && pos + 2 < head.size()) {
+            size_t next = head.find("\r\n", pos + 2);
+            std::string header = head.substr(pos + 2, (next == std::string::npos ? head.size() : next) - pos - 2);
+            size_t colon = header.find(':');
+            if (colon != std::string::npos) {
+                std::string name = header.substr(0, colon);
+                std::string value = header.substr(colon + 1);
+                value.erase(0, value.find_first_not_of(" \t"));
+                if (strcasecmp(name.c_str(), "Content-Length") == 0) {
+                    contentLength = atoll(value.c_str());
+                } else if (strcasecmp(name.c_str(), "Transfer-Encoding") == 0) {
+                    chunked = strcasestr(value.c_str(), "chunked") != nullptr;
+                } else if (strcasecmp(name.c_str(), "Expect") == 0) {
+                    expectContinue = strcasecmp(value.c_str(), "100-continue") == 0;
+                } else if (strcasecmp(name.c_str(), "Connection") == 0) {
+                    keepAlive = keepAlive && strcasecmp(value.c_str(), "close") != 0;
+                }
+            }
+            pos = next;
+        }
+        if (expectContinue) {
+            const char *interim = "HTTP/1.1 100 Continue\r\n\r\n";
+            SendAll(fd, interim, strlen(interim));
+        }
+        // 读取请求体并计算摘要后丢弃（分块请求体读取到结束块为止，不计算摘要）
+        bool complete = true;
+        std::string bodyHash;
+        if (chunked) {
+            size_t end;
+            while ((end = buffer.find("\r\n0\r\n\r\n")) == std::string::npos &&
+                   buffer.compare(0, 5, "0\r\n\r\n") != 0) {
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    complete = false;
+                    break;
+                }
+                buffer.append(chunk, static_cast<size_t>(n));
+            }
+            if (complete) {
+                end = buffer.compare(0, 5, "0\r\n\r\n") == 0 ? 5 : end + 7;
+                buffer.erase(0, end);
+            }
+        } else {
+            while (static_cast<int64_t>(buffer.size()) < contentLength) {
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    complete = false;
+                    break;
+                }
+                buffer.append(chunk, static_cast<size_t>(n));
+            }
+            if (complete) {
+                bodyHash = RequestBodyHash(buffer.data(), static_cast<size_t>(contentLength));
+                buffer.erase(0, static_cast<size_t>(contentLength));
+            }
+        }
+        if (!complete || !Respond(*session, fd, method, target, bodyHash, keepAlive)) {
+            break;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->connections.erase(fd);
+    }
+    close(fd);
+}
+
+bool ReplayServer::Respond(Session &session, int fd, const std::string &method, const std::string &target,
+                           const std::string &bodyHash, bool keepAlive) {
+    // 代理形式的请求目标只取路径
+    std::string path = PathOf(target);
+    std::string key = ExchangeKey(method, path, bodyHash);
+    const RecordedExchange *exchange = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(session.mutex);
+        auto it = session.exchanges.find(key);
+        if (it == session.exchanges.end() && !bodyHash.empty()) {
+            key = ExchangeKey(method, path, "");
+            it = session.exchanges.find(key);
+        }
+        if (it != session.exchanges.end()) {
+            size_t &cursor = session.cursors[key];
+            exchange = &it->second[cursor % it->second.size()];
+            cursor++;
+            session.stats.served++;
+        } else {
+            session.stats.missed++;
+        }
+    }
+    const char *connection = keepAlive ? "keep-alive" : "close";
+    if (!exchange) {
+        std::string body = "No recorded exchange for " + key + "\n";
+        std::string response = "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: " +
+                               std::to_string(body.size()) + "\r\nConnection: " + connection + "\r\n\r\n" + body;
+        return SendAll(fd, response.data(), response.size());
+    }
+
+    // 按缩放后的首字节时间等待
+    const ReplayOptions &options = session.options;
+    if (options.latencyScale > 0 && exchange->ttfb > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(
+            static_cast<int64_t>(static_cast<double>(exchange->ttfb) * 1000 * options.latencyScale)));
+    }
+    std::string response = "HTTP/1.1 " + std::to_string(exchange->status) + " Replayed\r\n";
+    for (const std::string &header : exchange->headers) {
+        std::string name = header.substr(0, header.find(':'));
+        if (std::none_of(std::begin(kHopHeaders), std::end(kHopHeaders),
+                         [&name](const char *hop) { return strcasecmp(name.c_str(), hop) == 0; })) {
+            response += header + "\r\n";
+        }
+    }
+    const std::string &body = exchange->body;
+    bool hasBody = method != "HEAD" && exchange->status != 204 && exchange->status != 304;
+    response += "Content-Length: " + std::to_string(hasBody ? body.size() : 0) + "\r\n";
+    response += std::string("Connection: ") + connection + "\r\n\r\n";
+    if (!SendAll(fd, response.data(), response.size())) {
+        return false;
+    }
+    if (!hasBody || body.empty()) {
+        return keepAlive;
+    }
+
+    // 按缩放后的传输速度分块发送响应体
+    int64_t transfer = exchange->total - exchange->ttfb;
+    if (options.bandwidthScale <= 0 || transfer <= 0) {
+        return SendAll(fd, body.data(), body.size()) && keepAlive;
+    }
+    double duration = static_cast<double>(transfer) * 1000 / options.bandwidthScale;
+    auto begin = std::chrono::steady_clock::now();
+    size_t sent = 0;
+    while (sent < body.size()) {
+        size_t length = std::min(kSendChunk, body.size() - sent);
+        if (!SendAll(fd, body.data() + sent, length)) {
+            return false;
+        }
+        sent += length;
+        auto due = begin + std::chrono::microseconds(static_cast<int64_t>(
+                               duration * static_cast<double>(sent) / static_cast<double>(body.size())));
+        std::this_thread::sleep_until(due);
+    }
+    return keepAlive;
+}
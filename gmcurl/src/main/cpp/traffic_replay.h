@@ -0,0 +1,183 @@
+#ifndef GMCURL_TRAFFIC_REPLAY_H
+#define GMCURL_TRAFFIC_REPLAY_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @file traffic_replay.h
+ * @brief 流量录制与本地回放
+ *
+ * 录制模式下，普通请求（不含下载、分块上传与多范围读取）的请求方法、URL、请求体摘要、响应与耗时追加到录制文件中；
+ * 回放服务器在127.0.0.1上按请求方法、路径（含查询参数）与请求体摘要返回录制的响应，按原始或缩放后的首字节时间与
+ * 传输速度发送，使性能测试可以在没有外部网络的环境中重现真实流量。
+ *
+ * - 请求体摘要为请求体的CRC32（十六进制），只记录字符串与ArrayBuffer请求体；流式、表单与文件请求体不记录摘要，
+ *   没有摘要的录制响应匹配任意请求体。请求头不录制
+ * - 录制的响应头中Set-Cookie的值与认证相关响应头（Authentication-Info等）的值替换为redacted；
+ *   响应体原样录制，可能包含令牌等敏感数据，录制文件只应用于测试环境
+ *
+ * 录制文件为gzip压缩的文本，每个请求一段（值中的\\、换行与回车转义），回放时也可以读取未压缩的文本：
+ * @code
+ * gmcurl-recording 1
+ * exchange
+ * method POST
+ * url https://example.com/api
+ * request cd697c6a
+ * status 200
+ * ttfb 35
+ * total 120
+ * header Content-Type: application/json
+ * body {"page":1}
+ * end
+ * @endcode
+ */
+
+/**
+ * @brief 录制的请求与响应
+ */
+typedef struct RecordedExchange {
+    std::string method = "GET";       ///< 请求方法
+    std::string url;                  ///< 请求URL
+    std::string requestHash;          ///< 请求体摘要（见RequestBodyHash），为空时匹配任意请求体
+    long status = 0;                  ///< HTTP状态码
+    int64_t ttfb = 0;                 ///< 首字节时间（毫秒）
+    int64_t total = 0;                ///< 总耗时（毫秒）
+    std::vector<std::string> headers; ///< 响应头（"Name: value"）
+    std::string body;                 ///< 响应体（已解压）
+} RecordedExchange;
+
+/**
+ * @brief 计算录制与回放匹配使用的请求体摘要
+ * @return 请求体的CRC32（8位十六进制），请求体为空时返回空字符串
+ */
+std::string RequestBodyHash(const void *data, size_t size);
+
+/**
+ * @brief 进程级流量录制器
+ */
+class TrafficRecorder {
+public:
+    /**
+     * @brief 获取进程级实例
+     */
+    static TrafficRecorder &Instance();
+
+    TrafficRecorder(const TrafficRecorder &) = delete;
+    TrafficRecorder &operator=(const TrafficRecorder &) = delete;
+
+    /**
+     * @brief 开始录制（覆盖已有文件，正在录制时先结束之前的录制）
+     * @return 文件是否创建成功
+     */
+    bool Start(const std::string &filePath);
+
+    /**
+     * @brief 结束录制
+     * @return 本次录制的请求数
+     */
+    int64_t Stop();
+
+    /**
+     * @brief 是否正在录制（无锁，供传输线程快速判断）
+     */
+    bool Active() const { return active.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 追加一个请求
+     * @param rawHeaders 响应头原始数据（只保留最终响应的响应头）
+     */
+    void Record(RecordedExchange exchange, const std::string &rawHeaders);
+
+private:
+    TrafficRecorder() = default;
+
+    std::mutex mutex;                ///< 互斥锁
+    void *file = nullptr;            ///< 录制文件（gzFile）
+    std::atomic<bool> active{false}; ///< 是否正在录制
+    int64_t recorded = 0;            ///< 本次录制的请求数
+};
+
+/**
+ * @brief 回放配置
+ */
+typedef struct ReplayOptions {
+    double latencyScale = 1.0;   ///< 首字节时间的缩放倍数，0表示不等待
+    double bandwidthScale = 1.0; ///< 传输速度的缩放倍数，0表示不限速
+} ReplayOptions;
+
+/**
+ * @brief 回放统计
+ */
+typedef struct ReplayStats {
+    int64_t exchanges = 0;   ///< 录制文件中的请求数
+    int64_t served = 0;      ///< 返回录制响应的次数
+    int64_t missed = 0;      ///< 没有匹配的录制响应（返回404）的次数
+    int64_t connections = 0; ///< 接受的连接数
+} ReplayStats;
+
+/**
+ * @brief 进程级回放服务器（HTTP/1.1，只监听127.0.0.1）
+ *
+ * 同一请求方法、路径与请求体摘要录制了多个响应时按录制顺序轮流返回；没有摘要相同的录制响应时使用没有摘要的录制响应。
+ * 分块编码的请求体不计算摘要，只匹配没有摘要的录制响应。
+ */
+class ReplayServer {
+public:
+    /**
+     * @brief 获取进程级实例
+     */
+    static ReplayServer &Instance();
+
+    ReplayServer(const ReplayServer &) = delete;
+    ReplayServer &operator=(const ReplayServer &) = delete;
+
+    /**
+     * @brief 加载录制文件并启动（正在运行时先停止）
+     * @return 监听端口，文件无法读取、没有录制的请求或监听失败时返回0
+     */
+    int Start(const std::string &filePath, const ReplayOptions &options);
+
+    /**
+     * @brief 停止并断开所有连接
+     */
+    void Stop();
+
+    /**
+     * @brief 当前回放的统计信息
+     */
+    ReplayStats Stats();
+
+private:
+    ReplayServer() = default;
+
+    /**
+     * @brief 一次启动的回放状态（由监听线程与连接线程共享）
+     */
+    typedef struct Session {
+        std::map<std::string, std::vector<RecordedExchange>> exchanges; ///< 请求方法 + 路径 + 摘要 -> 录制的响应
+        std::map<std::string, size_t> cursors;                          ///< 请求方法 + 路径 + 摘要 -> 下一个响应
+        ReplayOptions options;                                          ///< 回放配置
+        int listenFd = -1;                                              ///< 监听套接字
+        std::set<int> connections;                                      ///< 活动连接
+        std::atomic<bool> stopping{false};                              ///< 是否已停止
+        std::mutex mutex;                                               ///< 互斥锁（游标、连接、统计）
+        ReplayStats stats;                                              ///< 统计
+    } Session;
+
+    static void Accept(std::shared_ptr<Session> session);
+    static void Serve(std::shared_ptr<Session> session, int fd);
+    static bool Respond(Session &session, int fd, const std::string &method, const std::string &target,
+                        const std::string &bodyHash, bool keepAlive);
+
+    std::mutex mutex;                 ///< 互斥锁
+    std::shared_ptr<Session> session; ///< 当前回放，未启动时为空
+};
+
+#endif // GMCURL_TRAFFIC_REPLAY_H
@@ -0,0 +1,75 @@
+#include "transfer_engine.h"
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @file transfer_engine.cpp
+ * @brief 进程级共享传输引擎实现
+ */
+
+TransferEngine &TransferEngine::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static TransferEngine *engine = new TransferEngine();
+    return *engine;
+}
+
+TransferEngine::TransferEngine() {
+    share = curl_share_init();
+    if (share) {
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, Lock);
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, Unlock);
+        curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+}
+
+void TransferEngine::Attach(CURL *curl) {
+    if (share) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, share);
+    }
+    // 连接创建时记录关闭回调，句柄重置后已有连接仍按此登记关闭
+    curl_easy_setopt(curl, CURLOPT_OPENSOCKETFUNCTION, OpenSocket);
+    curl_easy_setopt(curl, CURLOPT_OPENSOCKETDATA, curl);
+    curl_easy_setopt(curl, CURLOPT_CLOSESOCKETFUNCTION, CloseSocket);
+    curl_easy_setopt(curl, CURLOPT_CLOSESOCKETDATA, curl);
+}
+
+void TransferEngine::Interrupt(CURL *curl) {
+    std::lock_guard<std::mutex> lock(socketMutex);
+    auto range = sockets.equal_range(curl);
+    for (auto it = range.first; it != range.second; ++it) {
+        shutdown(it->second, SHUT_RDWR);
+    }
+}
+
+curl_socket_t TransferEngine::OpenSocket(void *clientp, curlsocktype purpose, struct curl_sockaddr *address) {
+    curl_socket_t item = socket(address->family, address->socktype | SOCK_CLOEXEC, address->protocol);
+    if (item != CURL_SOCKET_BAD) {
+        TransferEngine &engine = Instance();
+        std::lock_guard<std::mutex> lock(engine.socketMutex);
+        engine.sockets.emplace(static_cast<CURL *>(clientp), item);
+    }
+    return item;
+}
+
+int TransferEngine::CloseSocket(void *clientp, curl_socket_t item) {
+    TransferEngine &engine = Instance();
+    std::lock_guard<std::mutex> lock(engine.socketMutex);
+    auto range = engine.sockets.equal_range(static_cast<CURL *>(clientp));
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == item) {
+            engine.sockets.erase(it);
+            break;
+        }
+    }
+    return close(item);
+}
+
+void TransferEngine::Lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *userp) {
+    static_cast<TransferEngine *>(userp)->locks[data].lock();
+}
+
+void TransferEngine::Unlock(CURL *handle, curl_lock_data data, void *userp) {
+    static_cast<TransferEngine *>(userp)->locks[data].unlock();
+}
@@ -0,0 +1,59 @@
+#ifndef GMCURL_TRANSFER_ENGINE_H
+#define GMCURL_TRANSFER_ENGINE_H
+
+#include "curl.h"
+#include <map>
+#include <mutex>
+
+/**
+ * @file transfer_engine.h
+ * @brief 进程级共享传输引擎
+ *
+ * 加载libgmcurl.so的所有env（主线程与各ArkTS Worker）共用同一个传输引擎：
+ * DNS缓存与TLS/TLCP会话缓存放入进程级curl share对象，不同Worker发往同一服务的请求可直接复用解析结果并恢复会话。
+ * 连接缓存不放入share对象（libcurl不支持跨线程并发共享连接）。
+ * 每个env的请求状态（取消标识、进行中的传输）由env级数据各自维护，互不竞争。
+ * 接入的句柄由传输引擎创建和关闭套接字并按句柄登记，env销毁时可关闭其进行中传输的连接读写，立即中断传输。
+ */
+
+/**
+ * @brief 进程级共享传输引擎
+ */
+class TransferEngine {
+public:
+    /**
+     * @brief 获取进程级实例（首次调用时创建，进程退出前不释放）
+     */
+    static TransferEngine &Instance();
+
+    TransferEngine(const TransferEngine &) = delete;
+    TransferEngine &operator=(const TransferEngine &) = delete;
+
+    /**
+     * @brief 将cURL句柄接入共享缓存
+     * @param curl cURL句柄
+     */
+    void Attach(CURL *curl);
+
+    /**
+     * @brief 关闭句柄所有连接的读写，阻塞在收发上的传输立即返回错误
+     * 只能中断调用方独占使用中的句柄；描述符仍由libcurl关闭
+     * @param curl cURL句柄
+     */
+    void Interrupt(CURL *curl);
+
+private:
+    TransferEngine();
+
+    static void Lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *userp);
+    static void Unlock(CURL *handle, curl_lock_data data, void *userp);
+    static curl_socket_t OpenSocket(void *clientp, curlsocktype purpose, struct curl_sockaddr *address);
+    static int CloseSocket(void *clientp, curl_socket_t item);
+
+    CURLSH *share = nullptr;                      ///< 共享对象
+    std::mutex locks[CURL_LOCK_DATA_LAST];        ///< 按数据类型加锁
+    std::mutex socketMutex;                       ///< 保护sockets，关闭描述符时同样持有，中断不会误关已复用的描述符
+    std::multimap<CURL *, curl_socket_t> sockets; ///< 各句柄已打开的套接字
+};
+
+#endif // GMCURL_TRANSFER_ENGINE_H
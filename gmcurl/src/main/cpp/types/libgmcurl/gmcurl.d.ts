@@ -13,6 +13,17 @@ export type HttpHeaders = {
   [key: string]: string;
 }
 
+/**
+ * 响应格式
+ * - 'object'：返回HttpResponse对象(默认)
+ * - 'packed'：返回单个ArrayBuffer，状态码、响应头、性能指标与响应体按紧凑格式排列，以PackedResponse按需解析。
+ *   布局(小端序)：0 uint32魔数0x4B504D47；4 uint16版本号1；6 uint16标志位(bit0表示包含性能指标)；8 int32响应码；
+ *   12 uint32响应头数量；16 uint32响应头区长度；20 uint32响应体长度；24 8个int32性能指标(毫秒，不存在时为-1，
+ *   依次为dns、tcp、tls、firstSend、firstReceive、totalFinish、redirect、total)；56起为响应头区，每项为uint16名称长度、
+ *   uint32值长度、名称、值(UTF-8)；之后为响应体原始字节
+ */
+export type ResponseFormat = 'object' | 'packed';
+
 /**
  * 进度回调
  */
@@ -93,6 +104,305 @@ export interface MultiFormData {
   data?: string | Object | ArrayBuffer;
 }
 
+/**
+ * 签名算法
+ */
+export type SignatureAlgorithm = 'HMAC-SHA256' | 'HMAC-SM3' | 'SM2';
+
+/**
+ * 签名原文组成部分
+ * method: 大写请求方法
+ * path: URL路径
+ * query: 按参数排序后的查询串
+ * headers: signedHeaders中每个请求头一行，格式为"小写名称:值"
+ * signedHeaders: 以';'连接的小写请求头名称
+ * timestamp: 签名时间戳（毫秒）
+ * bodyDigest: 请求体摘要（十六进制，HMAC-SHA256使用SHA256，其余使用SM3）
+ */
+export type SignatureComponent = 'method' | 'path' | 'query' | 'headers' | 'signedHeaders' | 'timestamp' |
+  'bodyDigest';
+
+/**
+ * 请求签名配置
+ * 签名在异步线程中、请求发送前完成，请求体（含上传文件、multipart表单）以流式方式计算摘要
+ */
+export interface SignatureOptions {
+  /**
+   * 签名算法
+   */
+  algorithm: SignatureAlgorithm;
+
+  /**
+   * HMAC密钥，或SM2私钥PEM内容
+   */
+  key?: string;
+
+  /**
+   * SM2私钥PEM文件路径
+   */
+  keyPath?: string;
+
+  /**
+   * SM2用户ID(默认1234567812345678)
+   */
+  sm2Id?: string;
+
+  /**
+   * 密钥标识，可在headerTemplate中通过{keyId}引用
+   */
+  keyId?: string;
+
+  /**
+   * 参与签名的请求头名称
+   */
+  signedHeaders?: string[];
+
+  /**
+   * 签名原文组成规范，各部分以'\n'连接(默认['method', 'path', 'query', 'headers', 'bodyDigest'])
+   */
+  canonical?: SignatureComponent[];
+
+  /**
+   * 签名输出请求头(默认X-Signature)
+   */
+  headerName?: string;
+
+  /**
+   * 签名请求头值模板，支持{algorithm}/{keyId}/{signedHeaders}/{timestamp}/{signature}(默认'{signature}')
+   */
+  headerTemplate?: string;
+
+  /**
+   * 请求体摘要输出请求头（不设置则不输出）
+   */
+  digestHeaderName?: string;
+
+  /**
+   * 时间戳输出请求头（不设置则不输出）
+   */
+  timestampHeaderName?: string;
+
+  /**
+   * 签名编码(默认base64)
+   */
+  encoding?: 'base64' | 'hex';
+}
+
+/**
+ * 载荷加密算法
+ */
+export type PayloadCipherAlgorithm = 'SM4-GCM' | 'SM4-CBC';
+
+/**
+ * 应用层载荷加密配置
+ * SM4-GCM密文后追加16字节认证标签；SM4-CBC使用PKCS#7填充。
+ * 请求体在读取路径中流式加密，响应体(仅2xx)在写入时流式解密，开启解密的下载不支持断点续传
+ */
+export interface PayloadCipherOptions {
+  /**
+   * 加密算法(默认SM4-GCM)
+   */
+  algorithm?: PayloadCipherAlgorithm;
+
+  /**
+   * 16字节密钥(十六进制)
+   */
+  key: string;
+
+  /**
+   * IV(十六进制，GCM为12字节，CBC为16字节)，不设置时每个请求随机生成
+   */
+  iv?: string;
+
+  /**
+   * GCM附加认证数据
+   */
+  aad?: string;
+
+  /**
+   * 传递IV的请求头(十六进制)，响应中存在同名响应头时使用其IV解密(默认X-Payload-IV，空字符串表示不传递)
+   */
+  ivHeaderName?: string;
+
+  /**
+   * 是否加密请求体(默认true)
+   */
+  encryptRequest?: boolean;
+
+  /**
+   * 是否解密响应体(默认true)
+   */
+  decryptResponse?: boolean;
+}
+
+/**
+ * 重定向策略
+ * 同源的301/308跳转会被缓存，之后的GET请求直接请求最终URL；跨源跳转与verifyServer为false的请求不写入缓存
+ */
+export interface RedirectPolicy {
+  /**
+   * 是否跟随重定向(默认true)
+   */
+  follow?: boolean;
+
+  /**
+   * 最大跳转次数(默认10)，超过时返回libcurl错误码47
+   */
+  maxRedirects?: number;
+
+  /**
+   * 是否只允许同源(协议、主机、端口相同)跳转(默认false)，跨域跳转返回错误码117
+   */
+  sameOrigin?: boolean;
+
+  /**
+   * 在这些状态码跳转时保持POST方法(可选301、302、303，默认为空即改为GET)，307/308始终保持
+   */
+  keepPostOn?: number[];
+}
+
+/**
+ * 断点续传协议
+ * - tus: tus 1.0.0（POST创建会话，HEAD查询Upload-Offset，PATCH追加分块）
+ * - contentRange: url为上传会话地址，PUT携带Content-Range上传分块，308表示继续
+ */
+export type ResumableUploadProtocol = 'tus' | 'contentRange';
+
+/**
+ * 断点续传上传配置（与uploadFilePath配合使用，不支持签名与载荷加密）
+ */
+export interface ResumableUploadOptions {
+  /**
+   * 协议(默认'tus')
+   */
+  protocol?: ResumableUploadProtocol;
+
+  /**
+   * 分块大小(字节，默认8MB)
+   */
+  chunkSize?: number;
+
+  /**
+   * 连续失败的最大重试次数(默认5)，每次重试前查询服务端已接收的位置
+   */
+  maxRetries?: number;
+}
+
+/**
+ * S3访问凭证（AWS Signature V4签名）
+ */
+export interface S3Credentials {
+  /**
+   * 访问密钥ID
+   */
+  accessKeyId: string;
+
+  /**
+   * 访问密钥
+   */
+  secretAccessKey: string;
+
+  /**
+   * 临时凭证令牌(可选，以X-Amz-Security-Token请求头发送)
+   */
+  sessionToken?: string;
+
+  /**
+   * 签名区域(默认'us-east-1')
+   */
+  region?: string;
+}
+
+/**
+ * 并行分块上传配置（S3 Multipart Upload，与uploadFilePath配合使用，不支持签名、载荷加密与断点续传）
+ */
+export interface ParallelUploadOptions {
+  /**
+   * 分块大小(字节，默认8MB，S3要求除最后一块外不小于5MB)
+   */
+  partSize?: number;
+
+  /**
+   * 同时上传的分块数(默认4，最多16)
+   */
+  concurrency?: number;
+
+  /**
+   * 单个分块的最大重试次数(默认3)
+   */
+  maxRetries?: number;
+
+  /**
+   * 访问凭证，不设置时不签名
+   */
+  credentials?: S3Credentials;
+}
+
+/**
+ * 字节范围
+ */
+export interface ByteRange {
+  /**
+   * 起始位置，负数表示资源末尾的-start个字节(如-1024为最后1KB)
+   */
+  start: number;
+
+  /**
+   * 结束位置(含)，不设置表示到资源末尾；start为负数时不能设置
+   */
+  end?: number;
+}
+
+/**
+ * 多范围读取选项
+ */
+export interface RangeRequestOptions {
+  /**
+   * 请求头
+   */
+  headers?: HttpHeaders;
+
+  /**
+   * 单个请求的超时时间(秒，默认15)
+   */
+  readTimeout?: number;
+
+  /**
+   * 连接超时时间(秒，默认15)
+   */
+  connectTimeout?: number;
+
+  /**
+   * CA证书路径
+   */
+  caPath?: string;
+
+  /**
+   * 客户端证书目录
+   */
+  clientCertPath?: string;
+
+  /**
+   * 是否使用TLCP
+   */
+  isTLCP?: boolean;
+
+  /**
+   * 是否校验服务端证书，默认true
+   */
+  verifyServer?: boolean;
+
+  /**
+   * 请求ID(用于cancelRequest取消)
+   */
+  requestID?: number;
+
+  /**
+   * 服务端不支持多范围请求时，单范围请求的最大并发数(默认4，最多16)
+   */
+  maxParallel?: number;
+}
+
 /**
  * HTTP请求选项接口
  */
@@ -187,57 +497,1351 @@ export interface HttpRequestOptions {
    * 性能统计(默认false不使用)
    */
   performanceTiming?: boolean;
-}
 
-/**
- * HTTP响应接口
- */
-export interface HttpResponse {
   /**
-   * 响应状态码
+   * 请求签名配置
    */
-  responseCode: number;
+  signature?: SignatureOptions;
 
   /**
-   * 响应头
+   * 应用层载荷加密配置
    */
-  headers: HttpHeaders;
+  payloadCipher?: PayloadCipherOptions;
 
   /**
-   * 响应体（根据Content-Type自动转换）
+   * 排队优先级，越大越优先(默认0)
    */
-  body: string | ArrayBuffer;
+  priority?: number;
 
   /**
-   * 性能数据
+   * 排队截止时间(毫秒)，从发起请求开始计算，超时仍未启动的请求被丢弃(默认使用准入控制的queueTimeout)
    */
-  performanceTiming?:  PerformanceTiming;
-}
+  deadline?: number;
 
-/**
- * HTTP错误接口
- */
-export interface HttpResponseError {
   /**
-   * 错误码
+   * 重定向策略
    */
-  code: number;
+  redirect?: RedirectPolicy;
 
   /**
-   * 错误信息
+   * 断点续传上传配置，设置后uploadFilePath按分块上传，失败或应用重启后从服务端已确认的位置继续
    */
-  message: string;
+  resumableUpload?: ResumableUploadOptions;
+
+  /**
+   * 并行分块上传配置，设置后uploadFilePath按S3 Multipart Upload协议由多个连接并行上传，url为对象URL
+   */
+  parallelUpload?: ParallelUploadOptions;
+
+  /**
+   * 文本响应体的字符集，如'gbk'、'gb18030'、'utf-16le'、'iso-8859-1'(默认按响应头Content-Type的charset，没有时按UTF-8)
+   */
+  responseCharset?: string;
+
+  /**
+   * 响应格式(默认'object')，为'packed'时请求返回的Promise解析为ArrayBuffer，见ResponseFormat
+   */
+  responseFormat?: ResponseFormat;
 }
 
 /**
- * 发起HTTP请求
- * @param options
- * @returns
+ * 客户端配置接口
+ * 创建时冻结：公共请求头预构建，传输层配置(caPath/clientCertPath/isTLCP/verifyServer/debug)预设到模板句柄
  */
-export function request(options: HttpRequestOptions): Promise<HttpResponse>;
+export interface ClientConfig {
+  /**
+   * 基础URL，client.request传入的相对路径拼接在其后
+   */
+  baseUrl?: string;
 
-/**
- * 取消HTTP请求
- * @param requestID
+  /**
+   * HTTP方法(默认GET)
+   */
+  method?: HttpMethod;
+
+  /**
+   * 公共请求头
+   */
+  headers?: HttpHeaders;
+
+  /**
+   * 读取超时时间（秒）
+   */
+  readTimeout?: number;
+
+  /**
+   * 连接超时时间（秒）
+   */
+  connectTimeout?: number;
+
+  /**
+   * CA证书路径(全路径包含文件名 PEM格式)
+   */
+  caPath?: string;
+
+  /**
+   * 客户端证书路径
+   */
+  clientCertPath?: string;
+
+  /**
+   * 验证服务器证书(默认true验证)
+   */
+  verifyServer?: boolean;
+
+  /**
+   * 是否使用国密协议(默认false不使用)
+   */
+  isTLCP?: boolean;
+
+  /**
+   * 调试模式(默认false不使用)
+   */
+  debug?: boolean;
+
+  /**
+   * 性能统计(默认false不使用)
+   */
+  performanceTiming?: boolean;
+
+  /**
+   * 请求签名配置
+   */
+  signature?: SignatureOptions;
+
+  /**
+   * 应用层载荷加密配置
+   */
+  payloadCipher?: PayloadCipherOptions;
+
+  /**
+   * 排队优先级，越大越优先(默认0)
+   */
+  priority?: number;
+
+  /**
+   * 排队截止时间(毫秒)
+   */
+  deadline?: number;
+
+  /**
+   * 重定向策略
+   */
+  redirect?: RedirectPolicy;
+
+  /**
+   * 文本响应体的字符集
+   */
+  responseCharset?: string;
+
+  /**
+   * 响应格式
+   */
+  responseFormat?: ResponseFormat;
+}
+
+/**
+ * 客户端请求选项接口
+ * 只需给出与客户端配置不同的部分；url为相对路径时拼接在baseUrl之后，headers与公共请求头合并(同名覆盖)。
+ * 覆盖传输层配置的请求不复用模板句柄
+ */
+export interface ClientRequestOptions extends Partial<HttpRequestOptions> {
+}
+
+/**
+ * 可复用的请求客户端
+ */
+export interface GMHttpClient {
+  /**
+   * 发起HTTP请求
+   * @param pathOrOptions 请求路径(或完整URL)，或请求选项
+   */
+  request(pathOrOptions: string | ClientRequestOptions): Promise<HttpResponse>;
+}
+
+/**
+ * 队列溢出策略
+ * reject: 拒绝新请求
+ * dropOldest: 挤出队列中优先级最低(同优先级中最早)的请求，其优先级高于新请求时拒绝新请求
+ * wait: 依靠截止时间淘汰，挤出截止时间最早的请求，队列中都没有截止时间或新请求更早到期时拒绝新请求
+ */
+export type OverflowPolicy = 'reject' | 'dropOldest' | 'wait';
+
+/**
+ * 准入控制策略(按线程/Worker独立生效)
+ */
+export interface AdmissionPolicy {
+  /**
+   * 最大同时执行请求数(默认32)
+   */
+  maxInFlight?: number;
+
+  /**
+   * 最大排队请求数，所有溢出策略都受此限制(默认256)
+   */
+  maxQueued?: number;
+
+  /**
+   * 队列溢出策略(默认wait)
+   */
+  policy?: OverflowPolicy;
+
+  /**
+   * 默认排队截止时间(毫秒)，0表示不限(默认0)
+   */
+  queueTimeout?: number;
+}
+
+/**
+ * 连接池策略(进程级，对所有线程/Worker生效)
+ */
+export interface ConnectionPolicy {
+  /**
+   * 最大连接数(默认32)，请求结束时超出的连接直接关闭
+   */
+  maxConnections?: number;
+
+  /**
+   * 单个主机最大连接数(默认6)
+   */
+  maxConnectionsPerHost?: number;
+
+  /**
+   * 最长空闲时间(秒，默认60)
+   */
+  maxIdleTime?: number;
+
+  /**
+   * 最长存活时间(秒)，0表示不限(默认0)
+   */
+  maxConnectionAge?: number;
+
+  /**
+   * TCP keepalive探测间隔(秒)，0表示关闭(默认30)
+   */
+  tcpKeepAlive?: number;
+
+  /**
+   * 空闲HTTP/2连接的PING间隔(秒)，0表示关闭(默认30)
+   */
+  pingInterval?: number;
+}
+
+/**
+ * 连接数量
+ */
+export interface ConnectionCount {
+  /**
+   * 打开的连接数(空闲+使用中)
+   */
+  open: number;
+
+  /**
+   * 空闲连接数
+   */
+  idle: number;
+
+  /**
+   * 使用中的连接数
+   */
+  busy: number;
+}
+
+/**
+ * 单个主机的连接状态
+ */
+export interface HostConnectionState extends ConnectionCount {
+  /**
+   * 协议://主机:端口
+   */
+  host: string;
+}
+
+/**
+ * 连接池状态
+ */
+export interface ConnectionPoolState extends ConnectionCount {
+  /**
+   * 各主机连接状态
+   */
+  hosts: HostConnectionState[];
+}
+
+/**
+ * 下载任务配置
+ */
+export interface DownloadOptions {
+  /**
+   * 下载URL
+   */
+  url: string;
+
+  /**
+   * 保存路径
+   */
+  filePath: string;
+
+  /**
+   * 任务ID，不传时自动生成；已存在的ID直接返回，不重复添加
+   */
+  id?: string;
+
+  /**
+   * 请求头（随任务明文保存在应用沙箱内的任务日志中，用于进程重启后续传）
+   */
+  headers?: HttpHeaders;
+
+  /**
+   * 优先级，数值大的先启动，默认0
+   */
+  priority?: number;
+
+  /**
+   * CA证书路径
+   */
+  caPath?: string;
+
+  /**
+   * 客户端证书目录
+   */
+  clientCertPath?: string;
+
+  /**
+   * 是否使用TLCP
+   */
+  isTLCP?: boolean;
+
+  /**
+   * 是否校验服务端证书，默认true
+   */
+  verifyServer?: boolean;
+
+  /**
+   * 连接超时（秒），默认15
+   */
+  connectTimeout?: number;
+}
+
+/**
+ * 预取配置
+ */
+export interface PrefetchOptions {
+  /**
+   * 请求头
+   */
+  headers?: HttpHeaders;
+
+  /**
+   * 缓存有效期（秒），默认300；响应Cache-Control的max-age更短时以max-age为准
+   */
+  ttl?: number;
+
+  /**
+   * 接收速度上限（字节/秒），默认0不限
+   */
+  maxBytesPerSecond?: number;
+
+  /**
+   * CA证书路径
+   */
+  caPath?: string;
+
+  /**
+   * 客户端证书目录
+   */
+  clientCertPath?: string;
+
+  /**
+   * 是否使用TLCP
+   */
+  isTLCP?: boolean;
+
+  /**
+   * 是否校验服务端证书，默认true
+   */
+  verifyServer?: boolean;
+
+  /**
+   * 连接超时（秒），默认15
+   */
+  connectTimeout?: number;
+
+  /**
+   * 请求超时（秒），默认30
+   */
+  readTimeout?: number;
+}
+
+/**
+ * 发件箱记录
+ */
+export interface OutboxRequest {
+  /**
+   * 请求URL，不传时合并到批量请求（见OutboxPolicy.endpoint）
+   */
+  url?: string;
+
+  /**
+   * 请求方法，默认POST
+   */
+  method?: HttpMethod;
+
+  /**
+   * 请求头（批量记录忽略）
+   */
+  headers?: HttpHeaders;
+
+  /**
+   * 请求体，对象按JSON序列化；批量记录中每条占一行，除结尾外包含换行的批量记录被拒绝（抛出异常）
+   */
+  extraData?: string | Object | ArrayBuffer;
+}
+
+/**
+ * 发件箱策略
+ */
+export interface OutboxPolicy {
+  /**
+   * 批量请求地址，未设置时不指定URL的记录保留在发件箱中
+   */
+  endpoint?: string;
+
+  /**
+   * 批量请求的附加请求头
+   */
+  headers?: HttpHeaders;
+
+  /**
+   * 批量请求体类型，默认application/x-ndjson
+   */
+  contentType?: string;
+
+  /**
+   * 批量请求体是否gzip压缩，默认true
+   */
+  compress?: boolean;
+
+  /**
+   * 单个批量请求的最大记录数，默认100，达到时立即发送
+   */
+  maxBatchRecords?: number;
+
+  /**
+   * 单个批量请求体（压缩前）的最大字节数，默认262144
+   */
+  maxBatchBytes?: number;
+
+  /**
+   * 发送周期（毫秒），记录加入后最多等待该时间再发送，默认5000
+   */
+  flushInterval?: number;
+
+  /**
+   * 单条记录的最大发送次数，默认10
+   */
+  maxAttempts?: number;
+
+  /**
+   * 最多保留的记录数，超出时丢弃最早的记录，默认10000
+   */
+  maxRecords?: number;
+
+  /**
+   * CA证书路径
+   */
+  caPath?: string;
+
+  /**
+   * 客户端证书目录
+   */
+  clientCertPath?: string;
+
+  /**
+   * 是否使用TLCP
+   */
+  isTLCP?: boolean;
+
+  /**
+   * 是否校验服务端证书，默认true
+   */
+  verifyServer?: boolean;
+
+  /**
+   * 连接超时（秒），默认15
+   */
+  connectTimeout?: number;
+
+  /**
+   * 请求超时（秒），默认30
+   */
+  readTimeout?: number;
+}
+
+/**
+ * 回放配置
+ */
+export interface ReplayOptions {
+  /**
+   * 首字节时间的缩放倍数，默认1（与录制时相同），0表示不等待
+   */
+  latencyScale?: number;
+
+  /**
+   * 传输速度的缩放倍数，默认1（与录制时相同），2表示速度加倍，0表示不限速
+   */
+  bandwidthScale?: number;
+}
+
+/**
+ * 故障规则
+ */
+export interface FaultRule {
+  /**
+   * 目标主机，'*.example.com'匹配子域名，不传或'*'匹配所有主机
+   */
+  host?: string;
+
+  /**
+   * 单向延迟（毫秒），建立隧道时等待一个往返
+   */
+  latency?: number;
+
+  /**
+   * 每个数据块附加的随机延迟上限（毫秒）
+   */
+  jitter?: number;
+
+  /**
+   * 每个方向的带宽（字节/秒），默认不限速
+   */
+  bandwidth?: number;
+
+  /**
+   * 每16KB数据发生停顿的概率（0~1），模拟丢包后的重传等待
+   */
+  stallRate?: number;
+
+  /**
+   * 停顿时长（毫秒），默认1000
+   */
+  stallDuration?: number;
+
+  /**
+   * 每个连接被重置的概率（0~1）
+   */
+  resetRate?: number;
+
+  /**
+   * 重置发生在客户端收到的前多少字节内（随机位置），默认65536，0表示建立隧道后立即重置
+   */
+  resetWithinBytes?: number;
+
+  /**
+   * 服务端首个数据块（TLS为ServerHello）的附加延迟（毫秒），模拟慢握手
+   */
+  handshakeDelay?: number;
+}
+
+/**
+ * 故障注入配置
+ */
+export interface FaultInjectionConfig {
+  /**
+   * 规则，按顺序匹配第一条，没有匹配的规则时直接转发
+   */
+  rules: FaultRule[];
+
+  /**
+   * 随机数种子，默认1；相同的种子与请求顺序得到相同的故障序列
+   */
+  seed?: number;
+}
+
+/**
+ * 上游组配置
+ */
+export interface UpstreamConfig {
+  /**
+   * 组名，请求以'upstream://组名/路径'发起
+   */
+  name: string;
+
+  /**
+   * 端点地址，如'https://10.0.0.1:8443'，可带路径前缀
+   */
+  endpoints: string[];
+
+  /**
+   * 连续失败(传输错误或5xx)多少次后摘除端点，默认3
+   */
+  failureThreshold?: number;
+
+  /**
+   * 首次摘除时长(毫秒)，默认10000；到期后再次失败时翻倍，最长8倍
+   */
+  ejectionTime?: number;
+
+  /**
+   * 延迟EWMA的衰减时间常数(毫秒)，默认10000
+   */
+  decayTime?: number;
+
+  /**
+   * 保持预建连接的端点数(按得分取最好的几个)，默认2，0表示不预建
+   */
+  warmConnections?: number;
+
+  /**
+   * 预建连接使用的路径(HEAD请求)，默认'/'
+   */
+  warmPath?: string;
+
+  /**
+   * 预建连接的CA证书路径，与请求一致时预建的连接才能被复用
+   */
+  caPath?: string;
+
+  /**
+   * 预建连接的客户端证书目录
+   */
+  clientCertPath?: string;
+
+  /**
+   * 预建连接是否使用TLCP
+   */
+  isTLCP?: boolean;
+
+  /**
+   * 预建连接是否校验服务端证书，默认true
+   */
+  verifyServer?: boolean;
+
+  /**
+   * 预建连接的连接超时(秒)，默认15
+   */
+  connectTimeout?: number;
+}
+
+/**
+ * 下载任务状态
+ */
+export type DownloadState = 'queued' | 'running' | 'paused' | 'completed' | 'failed';
+
+/**
+ * 下载任务信息
+ */
+export interface DownloadInfo {
+  /**
+   * 任务ID
+   */
+  id: string;
+
+  /**
+   * 下载URL
+   */
+  url: string;
+
+  /**
+   * 保存路径
+   */
+  filePath: string;
+
+  /**
+   * 优先级
+   */
+  priority: number;
+
+  /**
+   * 任务状态
+   */
+  state: DownloadState;
+
+  /**
+   * 已下载字节数
+   */
+  downloaded: number;
+
+  /**
+   * 总字节数，未知时为-1
+   */
+  total: number;
+
+  /**
+   * 失败原因
+   */
+  error?: string;
+}
+
+/**
+ * 下载并发限制
+ */
+export interface DownloadPolicy {
+  /**
+   * 最大同时下载数，默认4
+   */
+  maxConcurrent?: number;
+
+  /**
+   * 单个主机最大同时下载数，默认2
+   */
+  maxPerHost?: number;
+}
+
+/**
+ * 下载进度回调，参数为本周期内状态或进度发生变化的任务
+ */
+export type DownloadProgressCallback = (downloads: DownloadInfo[]) => void;
+
+/**
+ * 准入控制指标
+ */
+export interface AdmissionMetrics {
+  /**
+   * 排队中的请求数
+   */
+  queueDepth: number;
+
+  /**
+   * 执行中的请求数
+   */
+  inFlight: number;
+
+  /**
+   * 已启动请求数
+   */
+  admitted: number;
+
+  /**
+   * 曾进入队列的请求数
+   */
+  queued: number;
+
+  /**
+   * 队列满被拒绝的新请求数
+   */
+  rejected: number;
+
+  /**
+   * 被挤出队列的请求数
+   */
+  dropped: number;
+
+  /**
+   * 超过截止时间被丢弃的请求数
+   */
+  expired: number;
+}
+
+/**
+ * 复用池指标
+ */
+export interface PoolMetrics {
+  /**
+   * 请求上下文复用次数
+   */
+  contextHits: number;
+
+  /**
+   * 请求上下文新分配次数
+   */
+  contextMisses: number;
+
+  /**
+   * 请求上下文命中率（0~1）
+   */
+  contextHitRate: number;
+
+  /**
+   * 当前缓存的请求上下文数量
+   */
+  cachedContexts: number;
+
+  /**
+   * 下载缓冲区复用次数（进程级）
+   */
+  bufferHits: number;
+
+  /**
+   * 下载缓冲区新分配次数（进程级）
+   */
+  bufferMisses: number;
+
+  /**
+   * 下载缓冲区命中率（0~1）
+   */
+  bufferHitRate: number;
+
+  /**
+   * 当前缓存的下载缓冲区数量
+   */
+  cachedBuffers: number;
+}
+
+/**
+ * 内存统计
+ */
+export interface MemoryUsage {
+  /**
+   * 是否已接入统计分配器（未接入时其余字段为0）
+   */
+  tracked: boolean;
+
+  /**
+   * 当前占用字节数
+   */
+  liveBytes: number;
+
+  /**
+   * 峰值占用字节数
+   */
+  peakBytes: number;
+
+  /**
+   * 分配次数
+   */
+  allocations: number;
+
+  /**
+   * 释放次数
+   */
+  frees: number;
+}
+
+/**
+ * 网络栈内存指标（进程级，合计libcurl与libcrypto）
+ */
+export interface MemoryMetrics extends MemoryUsage {
+  /**
+   * libcurl内存
+   */
+  curl: MemoryUsage;
+
+  /**
+   * libcrypto（TLS/TLCP）内存
+   */
+  tls: MemoryUsage;
+}
+
+/**
+ * 文件I/O后端
+ */
+export type FileIoBackend = 'io_uring' | 'threadPool';
+
+/**
+ * 文件I/O指标（进程级，下载写入与上传读取）
+ */
+export interface FileIoMetrics {
+  /**
+   * 当前后端（io_uring不可用时为threadPool）
+   */
+  backend: FileIoBackend;
+
+  /**
+   * 完成的写操作数
+   */
+  writes: number;
+
+  /**
+   * 完成的读操作数
+   */
+  reads: number;
+
+  /**
+   * 写入字节数
+   */
+  bytesWritten: number;
+
+  /**
+   * 读取字节数
+   */
+  bytesRead: number;
+
+  /**
+   * 传输线程等待磁盘的次数
+   */
+  stalls: number;
+}
+
+/**
+ * 预取指标（进程级）
+ */
+export interface PrefetchMetrics {
+  /**
+   * 等待预取的URL数
+   */
+  pending: number;
+
+  /**
+   * 已缓存的URL数
+   */
+  completed: number;
+
+  /**
+   * 失败或不可缓存的URL数
+   */
+  failed: number;
+
+  /**
+   * 因前台请求中断的次数
+   */
+  yielded: number;
+
+  /**
+   * 缓存条目数
+   */
+  cacheEntries: number;
+
+  /**
+   * 缓存占用字节数
+   */
+  cacheBytes: number;
+
+  /**
+   * 请求命中缓存的次数
+   */
+  cacheHits: number;
+}
+
+/**
+ * 发件箱指标（进程级）
+ */
+export interface OutboxMetrics {
+  /**
+   * 未发送的记录数
+   */
+  pending: number;
+
+  /**
+   * 已发送的记录数
+   */
+  sent: number;
+
+  /**
+   * 已发送的批量请求数
+   */
+  batches: number;
+
+  /**
+   * 重试次数
+   */
+  retries: number;
+
+  /**
+   * 超过最大发送次数、4xx响应或超出保留上限而丢弃的记录数
+   */
+  dropped: number;
+}
+
+/**
+ * 回放指标（进程级）
+ */
+export interface ReplayMetrics {
+  /**
+   * 录制文件中的请求数
+   */
+  exchanges: number;
+
+  /**
+   * 返回录制响应的次数
+   */
+  served: number;
+
+  /**
+   * 没有匹配的录制响应（返回404）的次数
+   */
+  missed: number;
+
+  /**
+   * 接受的连接数
+   */
+  connections: number;
+}
+
+/**
+ * 故障注入指标（进程级）
+ */
+export interface FaultMetrics {
+  /**
+   * 代理的连接数
+   */
+  connections: number;
+
+  /**
+   * 注入的停顿次数
+   */
+  stalls: number;
+
+  /**
+   * 重置的连接数
+   */
+  resets: number;
+
+  /**
+   * 目标主机无法连接的次数
+   */
+  failures: number;
+}
+
+/**
+ * 上游端点状态
+ */
+export interface UpstreamEndpointMetrics {
+  /**
+   * 端点地址
+   */
+  url: string;
+
+  /**
+   * 首字节时间EWMA(毫秒)，0表示还没有样本
+   */
+  latency: number;
+
+  /**
+   * 进行中的请求数
+   */
+  inFlight: number;
+
+  /**
+   * 已完成的请求数
+   */
+  requests: number;
+
+  /**
+   * 失败次数(含预建连接失败)
+   */
+  failures: number;
+
+  /**
+   * 是否处于摘除中
+   */
+  ejected: boolean;
+}
+
+/**
+ * 上游组状态
+ */
+export interface UpstreamMetrics {
+  /**
+   * 组名
+   */
+  name: string;
+
+  /**
+   * 各端点状态
+   */
+  endpoints: UpstreamEndpointMetrics[];
+
+  /**
+   * 摘除次数
+   */
+  ejections: number;
+
+  /**
+   * 预建的连接数
+   */
+  warmups: number;
+}
+
+/**
+ * 运行指标
+ */
+export interface GmCurlMetrics {
+  /**
+   * 准入控制指标
+   */
+  admission: AdmissionMetrics;
+
+  /**
+   * 复用池指标
+   */
+  pool: PoolMetrics;
+
+  /**
+   * 网络栈内存指标
+   */
+  memory: MemoryMetrics;
+
+  /**
+   * 文件I/O指标
+   */
+  fileIo: FileIoMetrics;
+
+  /**
+   * 预取指标
+   */
+  prefetch: PrefetchMetrics;
+
+  /**
+   * 发件箱指标
+   */
+  outbox: OutboxMetrics;
+
+  /**
+   * 回放指标
+   */
+  replay: ReplayMetrics;
+
+  /**
+   * 故障注入指标
+   */
+  fault: FaultMetrics;
+
+  /**
+   * 负载均衡指标(进程级)
+   */
+  upstream: UpstreamMetrics[];
+}
+
+/**
+ * HTTP响应接口
+ */
+export interface HttpResponse {
+  /**
+   * 响应状态码
+   */
+  responseCode: number;
+
+  /**
+   * 响应头
+   */
+  headers: HttpHeaders;
+
+  /**
+   * 响应体（根据Content-Type自动转换）
+   */
+  body: string | ArrayBuffer;
+
+  /**
+   * 性能数据
+   */
+  performanceTiming?:  PerformanceTiming;
+}
+
+/**
+ * HTTP错误接口
+ */
+export interface HttpResponseError {
+  /**
+   * 错误码
+   */
+  code: number;
+
+  /**
+   * 错误信息
+   */
+  message: string;
+}
+
+/**
+ * 发起HTTP请求
+ * @param options
+ * @returns
+ */
+export function request(options: HttpRequestOptions): Promise<HttpResponse>;
+
+/**
+ * 发起GET请求(位置参数快速路径，其余参数使用默认值)
+ * @param url 请求URL
+ * @param headers 请求头
+ * @returns
+ */
+export function request(url: string, headers?: HttpHeaders): Promise<HttpResponse>;
+
+/**
+ * 读取资源的多个字节范围(如归档文件的索引、媒体容器的尾部)
+ * 服务端支持multipart/byteranges时只发送一个多范围请求，否则并行发送单范围请求
+ * @param url 资源URL
+ * @param ranges 字节范围
+ * @param options 请求选项
+ * @returns 与ranges一一对应的数据，超出资源末尾的范围为空ArrayBuffer
+ */
+export function fetchRange(url: string, ranges: ByteRange[], options?: RangeRequestOptions): Promise<ArrayBuffer[]>;
+
+/**
+ * 取消HTTP请求
+ * @param requestID
+ */
+export function cancelRequest(requestID: number): void;
+
+/**
+ * 创建可复用的请求客户端
+ * @param config 客户端配置
+ * @returns 客户端对象
+ */
+export function createClient(config: ClientConfig): GMHttpClient;
+
+/**
+ * 设置准入控制策略(仅对当前线程/Worker生效)
+ * @param policy 准入控制策略
+ */
+export function setAdmissionPolicy(policy: AdmissionPolicy): void;
+
+/**
+ * 设置连接池策略(进程级)
+ * @param policy 连接池策略
+ */
+export function setConnectionPolicy(policy: ConnectionPolicy): void;
+
+/**
+ * 获取连接池状态(进程级)
+ * @returns 连接池状态
+ */
+export function getConnectionPool(): ConnectionPoolState;
+
+/**
+ * 关闭全部空闲连接，应用从后台恢复时调用
+ * @returns 关闭的连接数
+ */
+export function closeIdleConnections(): number;
+
+/**
+ * 设置缓存目录并加载其中的HSTS与Alt-Svc缓存、下载任务及发件箱记录(进程级)
+ * 默认使用应用沙箱缓存目录/data/storage/el2/base/cache/gmcurl，传入空字符串时只在内存中缓存
+ * @param directory 缓存目录
+ */
+export function setCacheDirectory(directory: string): void;
+
+/**
+ * 清空HSTS与Alt-Svc缓存
+ */
+export function clearOriginCache(): void;
+
+/**
+ * 添加下载任务(进程级)，任务保存在缓存目录中，进程重启后自动恢复
+ * @param options 下载任务配置
+ * @returns 任务ID
+ */
+export function addDownload(options: DownloadOptions): string;
+
+/**
+ * 暂停下载任务
+ * @param id 任务ID
+ * @returns 任务是否存在
+ */
+export function pauseDownload(id: string): boolean;
+
+/**
+ * 恢复暂停或失败的下载任务
+ * @param id 任务ID
+ * @returns 任务是否存在
+ */
+export function resumeDownload(id: string): boolean;
+
+/**
+ * 删除下载任务，未完成任务已下载的文件一并删除
+ * @param id 任务ID
+ * @returns 任务是否存在
+ */
+export function removeDownload(id: string): boolean;
+
+/**
+ * 获取全部下载任务
+ * @returns 下载任务信息
+ */
+export function getDownloads(): DownloadInfo[];
+
+/**
+ * 设置下载并发限制(进程级)
+ * @param policy 并发限制
+ */
+export function setDownloadPolicy(policy: DownloadPolicy): void;
+
+/**
+ * 设置当前线程/Worker的下载进度回调，传入undefined取消
+ * @param callback 进度回调，每500ms最多调用一次
+ */
+export function onDownloadProgress(callback?: DownloadProgressCallback): void;
+
+/**
+ * 空闲时预取GET响应到内存缓存(进程级)，只在没有前台请求时执行，不创建JS对象
+ * 之后同一URL的GET请求（无请求体、下载、签名与加密，且请求头与TLS配置和预取时相同）直接从缓存返回
+ * @param urls 预取的URL
+ * @param options 预取配置
+ * @returns 加入预取队列的URL数量（已缓存或已在队列中的URL不计入）
+ */
+export function prefetch(urls: string[], options?: PrefetchOptions): number;
+
+/**
+ * 清空预取缓存与等待中的预取
+ */
+export function clearResponseCache(): void;
+
+/**
+ * 追加写请求到离线发件箱(进程级)，写入缓存目录中的日志后立即返回，进程重启后未发送的记录继续发送
+ * 网络错误、5xx、408与429按指数退避重试，其他4xx或超过最大发送次数时丢弃
+ * @param request 发件箱记录
+ * @returns 记录ID
+ */
+export function enqueue(request: OutboxRequest): number;
+
+/**
+ * 设置发件箱策略(进程级)，未指定的字段保持当前值
+ * @param policy 发件箱策略
+ */
+export function setOutboxPolicy(policy: OutboxPolicy): void;
+
+/**
+ * 立即发送发件箱中未在退避中的记录
+ */
+export function flushOutbox(): void;
+
+/**
+ * 开始录制(进程级)，之后完成的普通请求（不含下载、多范围读取与分块上传）追加到录制文件（gzip压缩）
+ * 录制文件包含响应体，响应头中Set-Cookie与认证相关响应头的值录制为redacted，请求头不录制
+ * @param filePath 录制文件路径，已存在时覆盖
+ * @returns 文件是否创建成功
+ */
+export function startRecording(filePath: string): boolean;
+
+/**
+ * 结束录制
+ * @returns 本次录制的请求数
+ */
+export function stopRecording(): number;
+
+/**
+ * 启动本地回放服务器(进程级，只监听127.0.0.1)，按请求方法、路径（含查询参数）与请求体摘要返回录制的响应，
+ * 同一请求录制了多个响应时轮流返回，没有匹配的录制响应时返回404；正在运行时先停止
+ * @param filePath 录制文件路径
+ * @param options 回放配置
+ * @returns 监听端口，文件无法读取或没有录制的请求时返回0
+ */
+export function startReplayServer(filePath: string, options?: ReplayOptions): number;
+
+/**
+ * 停止回放服务器
+ */
+export function stopReplayServer(): void;
+
+/**
+ * 启用网络故障注入(进程级，测试用)：之后的请求经127.0.0.1上的隧道代理转发，按规则注入延迟、抖动、限速、停顿、
+ * 连接重置与慢握手；已启用时按新配置重新开始（统计与连接序号清零）
+ * @param config 故障注入配置
+ * @returns 代理端口，启动失败时返回0
+ */
+export function startFaultInjection(config: FaultInjectionConfig): number;
+
+/**
+ * 停止网络故障注入，断开经代理的连接
+ */
+export function stopFaultInjection(): void;
+
+/**
+ * 添加或替换上游组(进程级)：之后以'upstream://组名/路径'发起的请求按延迟EWMA与进行中请求数在两个随机端点中
+ * 选择较优的一个，连续失败的端点暂时摘除，后台为最好的端点预建连接；替换时地址不变的端点保留状态
+ * @param config 上游组配置
+ */
+export function setUpstream(config: UpstreamConfig): void;
+
+/**
+ * 删除上游组，进行中的请求不受影响
+ * @param name 组名
+ * @returns 组是否存在
+ */
+export function removeUpstream(name: string): boolean;
+
+/**
+ * 获取当前线程/Worker的运行指标
+ * @returns 运行指标
  */
-export function cancelRequest(requestID: number): void;
\ No newline at end of file
+export function getMetrics(): GmCurlMetrics;
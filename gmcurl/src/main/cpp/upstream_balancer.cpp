@@ -0,0 +1,399 @@
+#include "upstream_balancer.h"
+#include "connection_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+/**
+ * @file upstream_balancer.cpp
+ * @brief 进程级客户端负载均衡实现
+ */
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief upstream://地址前缀
+ */
+const std::string kUpstreamScheme = "upstream://";
+
+/**
+ * @brief 预建连接的检查周期
+ */
+const std::chrono::seconds kWarmInterval(10);
+
+/**
+ * @brief 摘除时长最多翻倍的次数（最长为首次摘除时长的8倍）
+ */
+const int kMaxEjectionDoublings = 3;
+
+/**
+ * @brief 拼接端点地址与请求路径
+ * @param base 端点地址（可带路径前缀）
+ * @param rest 请求路径（含查询参数），可为空
+ */
+std::string JoinUrl(const std::string &base, const std::string &rest) {
+    std::string url = base;
+    while (!url.empty() && url.back() == '/') {
+        url.pop_back();
+    }
+    if (rest.empty() || rest[0] != '/') {
+        url += '/';
+    }
+    return url + rest;
+}
+
+} // namespace
+
+/**
+ * @brief 端点
+ */
+typedef struct UpstreamEndpoint {
+    std::string url;                ///< 端点地址
+    double latency = 0;             ///< 首字节时间EWMA（毫秒），0表示还没有样本
+    Clock::time_point sampled;      ///< 最近一个样本的时间
+    int inFlight = 0;               ///< 进行中的请求数
+    int consecutiveFailures = 0;    ///< 连续失败次数
+    int consecutiveEjections = 0;   ///< 连续摘除次数（成功后清零）
+    Clock::time_point ejectedUntil; ///< 摘除到期时间
+    int64_t requests = 0;           ///< 已完成的请求数
+    int64_t failures = 0;           ///< 失败次数（含预建连接失败）
+} UpstreamEndpoint;
+
+/**
+ * @brief 上游组
+ */
+typedef struct UpstreamGroup {
+    UpstreamConfig config;                                    ///< 配置
+    std::vector<std::shared_ptr<UpstreamEndpoint>> endpoints; ///< 端点
+    int64_t ejections = 0;                                    ///< 摘除次数
+    int64_t warmups = 0;                                      ///< 预建的连接数
+} UpstreamGroup;
+
+namespace {
+
+/**
+ * @brief 端点当前是否可用（未被摘除或摘除已到期）
+ */
+bool Available(const UpstreamEndpoint &endpoint, Clock::time_point now) {
+    return now >= endpoint.ejectedUntil;
+}
+
+/**
+ * @brief 端点的选择代价：延迟EWMA×(进行中请求数+1)，没有样本的端点按组内平均延迟计算
+ */
+double Cost(const UpstreamEndpoint &endpoint, double fallback) {
+    double latency = endpoint.latency > 0 ? endpoint.latency : fallback;
+    return latency * (endpoint.inFlight + 1);
+}
+
+/**
+ * @brief 组内有样本的端点的平均延迟，都没有样本时返回1
+ */
+double AverageLatency(const UpstreamGroup &group) {
+    double sum = 0;
+    int count = 0;
+    for (const auto &endpoint : group.endpoints) {
+        if (endpoint->latency > 0) {
+            sum += endpoint->latency;
+            count++;
+        }
+    }
+    return count > 0 ? sum / count : 1;
+}
+
+} // namespace
+
+UpstreamTicket::~UpstreamTicket() {
+    if (endpoint) {
+        std::lock_guard<std::mutex> lock(UpstreamBalancer::Instance().mutex);
+        endpoint->inFlight--;
+    }
+}
+
+void UpstreamTicket::Finish(bool success, double latency) {
+    if (!endpoint) {
+        return;
+    }
+    UpstreamBalancer &balancer = UpstreamBalancer::Instance();
+    {
+        std::lock_guard<std::mutex> lock(balancer.mutex);
+        endpoint->inFlight--;
+        endpoint->requests++;
+        balancer.Record(*group, *endpoint, success, latency);
+    }
+    endpoint.reset();
+    group.reset();
+}
+
+void UpstreamTicket::Abandon() {
+    if (!endpoint) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(UpstreamBalancer::Instance().mutex);
+        endpoint->inFlight--;
+        endpoint->requests++;
+    }
+    endpoint.reset();
+    group.reset();
+}
+
+UpstreamBalancer &UpstreamBalancer::Instance() {
+    // 进程内所有env共用，不随任何env销毁
+    static UpstreamBalancer *balancer = new UpstreamBalancer();
+    return *balancer;
+}
+
+bool UpstreamBalancer::IsUpstreamUrl(const std::string &url) {
+    return url.compare(0, kUpstreamScheme.size(), kUpstreamScheme) == 0;
+}
+
+void UpstreamBalancer::Start(UpstreamConfigurator newConfigurator) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!configurator) {
+        configurator = newConfigurator;
+    }
+    if (!started) {
+        started = true;
+        std::thread([this] { Loop(); }).detach();
+    }
+}
+
+bool UpstreamBalancer::Configure(const UpstreamConfig &config) {
+    std::vector<std::string> urls;
+    for (const std::string &url : config.endpoints) {
+        if (!url.empty() && std::find(urls.begin(), urls.end(), url) == urls.end()) {
+            urls.push_back(url);
+        }
+    }
+    if (config.name.empty() || urls.empty()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<UpstreamGroup> &group = groups[config.name];
+        if (!group) {
+            group = std::make_shared<UpstreamGroup>();
+        }
+        group->config = config;
+        group->config.endpoints = urls;
+        group->config.failureThreshold = std::max(config.failureThreshold, 1);
+        group->config.ejectionTime = std::max<int64_t>(config.ejectionTime, 0);
+        group->config.decayTime = std::max<int64_t>(config.decayTime, 1);
+        group->config.warmConnections = std::max(config.warmConnections, 0);
+        // 地址不变的端点保留延迟与失败状态，进行中的请求仍登记到原端点
+        std::vector<std::shared_ptr<UpstreamEndpoint>> endpoints;
+        for (const std::string &url : urls) {
+            auto it = std::find_if(group->endpoints.begin(), group->endpoints.end(),
+                                   [&url](const std::shared_ptr<UpstreamEndpoint> &item) { return item->url == url; });
+            if (it != group->endpoints.end()) {
+                endpoints.push_back(*it);
+            } else {
+                auto endpoint = std::make_shared<UpstreamEndpoint>();
+                endpoint->url = url;
+                endpoints.push_back(endpoint);
+            }
+        }
+        group->endpoints = std::move(endpoints);
+    }
+    wakeup.notify_all();
+    return true;
+}
+
+bool UpstreamBalancer::Remove(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return groups.erase(name) > 0;
+}
+
+bool UpstreamBalancer::Resolve(std::string &url, UpstreamTicket &ticket) {
+    size_t start = kUpstreamScheme.size();
+    size_t end = url.find_first_of("/?#", start);
+    std::string name = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    std::string rest = end == std::string::npos ? std::string() : url.substr(end);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = groups.find(name);
+    if (found == groups.end()) {
+        return false;
+    }
+    const std::shared_ptr<UpstreamGroup> &group = found->second;
+    Clock::time_point now = Clock::now();
+    std::vector<size_t> candidates;
+    for (size_t i = 0; i < group->endpoints.size(); i++) {
+        if (Available(*group->endpoints[i], now)) {
+            candidates.push_back(i);
+        }
+    }
+    size_t chosen = 0;
+    if (candidates.empty()) {
+        // 全部被摘除时选择最早到期的端点
+        for (size_t i = 1; i < group->endpoints.size(); i++) {
+            if (group->endpoints[i]->ejectedUntil < group->endpoints[chosen]->ejectedUntil) {
+                chosen = i;
+            }
+        }
+    } else if (candidates.size() == 1) {
+        chosen = candidates[0];
+    } else {
+        // 随机取两个不同的可用端点，选择代价较小的一个
+        std::uniform_int_distribution<size_t> pick(0, candidates.size() - 1);
+        size_t first = pick(random);
+        size_t second = std::uniform_int_distribution<size_t>(0, candidates.size() - 2)(random);
+        if (second >= first) {
+            second++;
+        }
+        double fallback = AverageLatency(*group);
+        const UpstreamEndpoint &a = *group->endpoints[candidates[first]];
+        const UpstreamEndpoint &b = *group->endpoints[candidates[second]];
+        chosen = Cost(b, fallback) < Cost(a, fallback) ? candidates[second] : candidates[first];
+    }
+    ticket.group = group;
+    ticket.endpoint = group->endpoints[chosen];
+    ticket.endpoint->inFlight++;
+    url = JoinUrl(ticket.endpoint->url, rest);
+    return true;
+}
+
+void UpstreamBalancer::Record(UpstreamGroup &group, UpstreamEndpoint &endpoint, bool success, double latency) {
+    Clock::time_point now = Clock::now();
+    if (success) {
+        endpoint.consecutiveFailures = 0;
+        endpoint.consecutiveEjections = 0;
+        if (latency >= 0) {
+            if (endpoint.latency <= 0 || latency > endpoint.latency) {
+                // 首个样本或端点变慢时直接取新样本
+                endpoint.latency = std::max(latency, 0.001);
+            } else {
+                double elapsed = std::chrono::duration<double, std::milli>(now - endpoint.sampled).count();
+                double weight = std::exp(-elapsed / static_cast<double>(group.config.decayTime));
+                endpoint.latency = endpoint.latency * weight + latency * (1 - weight);
+            }
+            endpoint.sampled = now;
+        }
+        return;
+    }
+    endpoint.failures++;
+    endpoint.consecutiveFailures++;
+    if (endpoint.consecutiveFailures >= group.config.failureThreshold) {
+        int64_t duration = group.config.ejectionTime << std::min(endpoint.consecutiveEjections, kMaxEjectionDoublings);
+        endpoint.ejectedUntil = now + std::chrono::milliseconds(duration);
+        endpoint.consecutiveEjections++;
+        // 到期后再失败一次即重新摘除
+        endpoint.consecutiveFailures = group.config.failureThreshold - 1;
+        group.ejections++;
+    }
+}
+
+std::vector<UpstreamStats> UpstreamBalancer::Stats() {
+    std::vector<UpstreamStats> result;
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    for (const auto &item : groups) {
+        UpstreamStats stats;
+        stats.name = item.first;
+        stats.ejections = item.second->ejections;
+        stats.warmups = item.second->warmups;
+        for (const auto &endpoint : item.second->endpoints) {
+            UpstreamEndpointStats endpointStats;
+            endpointStats.url = endpoint->url;
+            endpointStats.latency = endpoint->latency;
+            endpointStats.inFlight = endpoint->inFlight;
+            endpointStats.requests = endpoint->requests;
+            endpointStats.failures = endpoint->failures;
+            endpointStats.ejected = !Available(*endpoint, now);
+            stats.endpoints.push_back(endpointStats);
+        }
+        result.push_back(stats);
+    }
+    return result;
+}
+
+void UpstreamBalancer::Loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        // 每个组按代价取最好的若干个可用端点
+        std::vector<WarmTask> tasks;
+        Clock::time_point now = Clock::now();
+        for (const auto &item : groups) {
+            const std::shared_ptr<UpstreamGroup> &group = item.second;
+            if (group->config.warmConnections <= 0) {
+                continue;
+            }
+            double fallback = AverageLatency(*group);
+            std::vector<std::shared_ptr<UpstreamEndpoint>> ranked;
+            for (const auto &endpoint : group->endpoints) {
+                if (Available(*endpoint, now)) {
+                    ranked.push_back(endpoint);
+                }
+            }
+            std::stable_sort(ranked.begin(), ranked.end(),
+                             [fallback](const std::shared_ptr<UpstreamEndpoint> &a,
+                                        const std::shared_ptr<UpstreamEndpoint> &b) {
+                                 return Cost(*a, fallback) < Cost(*b, fallback);
+                             });
+            size_t count = std::min(ranked.size(), static_cast<size_t>(group->config.warmConnections));
+            for (size_t i = 0; i < count; i++) {
+                WarmTask task;
+                task.group = group;
+                task.endpoint = ranked[i];
+                task.url = JoinUrl(ranked[i]->url, group->config.warmPath);
+                tasks.push_back(task);
+            }
+        }
+        lock.unlock();
+        for (const WarmTask &task : tasks) {
+            Warm(task);
+        }
+        lock.lock();
+        wakeup.wait_for(lock, kWarmInterval);
+    }
+}
+
+void UpstreamBalancer::Warm(const WarmTask &task) {
+    ConnectionPool &connectionPool = ConnectionPool::Instance();
+    std::string poolKey = ConnectionPool::KeyOf(task.url);
+    if (poolKey.empty()) {
+        return;
+    }
+    // 连接池中已有该端点的空闲连接时不再预建
+    for (const HostConnectionStats &host : connectionPool.Stats()) {
+        if (host.host == poolKey && host.idle > 0) {
+            return;
+        }
+    }
+    CURL *curl = connectionPool.Acquire(poolKey);
+    if (curl) {
+        connectionPool.Release(poolKey, curl, true);
+        return;
+    }
+    curl = curl_easy_init();
+    if (!curl) {
+        connectionPool.Release(poolKey, nullptr, false);
+        return;
+    }
+    UpstreamConfig config;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        config = task.group->config;
+    }
+    if (configurator) {
+        configurator(curl, config);
+    }
+    connectionPool.Prepare(curl);
+    curl_easy_setopt(curl, CURLOPT_URL, task.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, static_cast<long>(config.connectTimeout));
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, static_cast<long>(config.connectTimeout) * 2);
+    CURLcode result = curl_easy_perform(curl);
+    connectionPool.Release(poolKey, curl, result == CURLE_OK);
+
+    // 只有连接失败计入端点失败，预建请求的状态码与耗时不作为样本
+    std::lock_guard<std::mutex> lock(mutex);
+    if (result == CURLE_OK) {
+        task.group->warmups++;
+    } else {
+        Record(*task.group, *task.endpoint, false, -1);
+    }
+}
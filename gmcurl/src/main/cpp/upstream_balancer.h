@@ -0,0 +1,187 @@
+#ifndef GMCURL_UPSTREAM_BALANCER_H
+#define GMCURL_UPSTREAM_BALANCER_H
+
+#include "curl.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @file upstream_balancer.h
+ * @brief 进程级客户端负载均衡
+ *
+ * 同一服务部署在多个网关地址/域名时，配置为一个上游组，请求以"upstream://组名/路径"发起，由均衡器为每个请求
+ * 选择一个端点并改写URL：
+ * - 在可用端点中随机取两个（power of two choices），选择 延迟EWMA×(进行中请求数+1) 较小的一个
+ * - 延迟为首字节时间的EWMA，按时间衰减；新样本高于当前值时直接取新样本（peak EWMA），端点变慢时立即避开
+ * - 连续失败（传输错误或5xx）达到阈值的端点暂时摘除，到期后重新参与选择，再次失败时摘除时长翻倍（最长8倍）
+ * - 所有端点都被摘除时选择最早到期的端点，不直接拒绝请求
+ * - 后台线程定期为得分最好的若干端点预建连接（HEAD请求后放入连接池），请求不必等待握手
+ */
+
+/**
+ * @brief 上游组配置
+ */
+typedef struct UpstreamConfig {
+    std::string name;                   ///< 组名
+    std::vector<std::string> endpoints; ///< 端点地址，如"https://10.0.0.1:8443"，可带路径前缀
+    int failureThreshold = 3;           ///< 连续失败多少次后摘除
+    int64_t ejectionTime = 10000;       ///< 首次摘除时长（毫秒）
+    int64_t decayTime = 10000;          ///< 延迟EWMA的衰减时间常数（毫秒）
+    int warmConnections = 2;            ///< 保持预建连接的端点数，0表示不预建
+    std::string warmPath = "/";         ///< 预建连接使用的路径（HEAD请求）
+    std::string caPath;                 ///< 预建连接的CA证书路径（与请求一致时连接才能复用）
+    std::string clientCertPath;         ///< 预建连接的客户端证书目录
+    bool isTLCP = false;                ///< 预建连接是否使用TLCP
+    bool verifyServer = true;           ///< 预建连接是否校验服务端证书
+    int connectTimeout = 15;            ///< 预建连接的连接超时（秒）
+} UpstreamConfig;
+
+/**
+ * @brief 端点状态
+ */
+typedef struct UpstreamEndpointStats {
+    std::string url;      ///< 端点地址
+    double latency = 0;   ///< 首字节时间EWMA（毫秒），0表示还没有样本
+    int inFlight = 0;     ///< 进行中的请求数
+    int64_t requests = 0; ///< 已完成的请求数
+    int64_t failures = 0; ///< 失败的请求数
+    bool ejected = false; ///< 是否处于摘除中
+} UpstreamEndpointStats;
+
+/**
+ * @brief 上游组状态
+ */
+typedef struct UpstreamStats {
+    std::string name;                             ///< 组名
+    std::vector<UpstreamEndpointStats> endpoints; ///< 各端点状态
+    int64_t ejections = 0;                        ///< 摘除次数
+    int64_t warmups = 0;                          ///< 预建的连接数
+} UpstreamStats;
+
+/**
+ * @brief 预建连接的句柄配置回调（传输层配置与共享缓存）
+ */
+typedef std::function<void(CURL *, const UpstreamConfig &)> UpstreamConfigurator;
+
+struct UpstreamGroup;
+struct UpstreamEndpoint;
+class UpstreamBalancer;
+
+/**
+ * @brief 一次请求选中的端点，请求结束时登记结果；未登记就销毁时只减少进行中请求数
+ */
+class UpstreamTicket {
+public:
+    UpstreamTicket() = default;
+    ~UpstreamTicket();
+
+    UpstreamTicket(const UpstreamTicket &) = delete;
+    UpstreamTicket &operator=(const UpstreamTicket &) = delete;
+
+    /**
+     * @brief 是否选中了端点
+     */
+    bool Valid() const { return endpoint != nullptr; }
+
+    /**
+     * @brief 登记请求结果
+     * @param success 是否成功（传输成功且不是5xx）
+     * @param latency 首字节时间（毫秒），小于0表示没有样本
+     */
+    void Finish(bool success, double latency);
+
+    /**
+     * @brief 登记没有结果的请求（发送前失败或已取消），计入已完成请求数，不影响端点健康状态
+     */
+    void Abandon();
+
+private:
+    friend class UpstreamBalancer;
+
+    std::shared_ptr<UpstreamGroup> group;       ///< 所属上游组
+    std::shared_ptr<UpstreamEndpoint> endpoint; ///< 选中的端点
+};
+
+/**
+ * @brief 进程级客户端负载均衡
+ */
+class UpstreamBalancer {
+public:
+    /**
+     * @brief 获取进程级实例
+     */
+    static UpstreamBalancer &Instance();
+
+    UpstreamBalancer(const UpstreamBalancer &) = delete;
+    UpstreamBalancer &operator=(const UpstreamBalancer &) = delete;
+
+    /**
+     * @brief URL是否为upstream://地址
+     */
+    static bool IsUpstreamUrl(const std::string &url);
+
+    /**
+     * @brief 设置预建连接的句柄配置回调并启动预建线程
+     */
+    void Start(UpstreamConfigurator configurator);
+
+    /**
+     * @brief 添加或替换上游组，地址不变的端点保留延迟与失败状态
+     * @return 配置是否有效（组名非空且至少一个端点）
+     */
+    bool Configure(const UpstreamConfig &config);
+
+    /**
+     * @brief 删除上游组（进行中的请求不受影响）
+     * @return 组是否存在
+     */
+    bool Remove(const std::string &name);
+
+    /**
+     * @brief 为upstream://地址选择端点并改写为端点地址
+     * @param url 请求URL，成功时改写
+     * @param ticket 选中的端点
+     * @return 上游组是否存在
+     */
+    bool Resolve(std::string &url, UpstreamTicket &ticket);
+
+    /**
+     * @brief 各上游组状态
+     */
+    std::vector<UpstreamStats> Stats();
+
+private:
+    friend class UpstreamTicket;
+
+    UpstreamBalancer() = default;
+
+    /**
+     * @brief 预建连接任务
+     */
+    typedef struct WarmTask {
+        std::shared_ptr<UpstreamGroup> group;       ///< 所属上游组
+        std::shared_ptr<UpstreamEndpoint> endpoint; ///< 端点
+        std::string url;                            ///< 预建连接请求的URL
+    } WarmTask;
+
+    void Record(UpstreamGroup &group, UpstreamEndpoint &endpoint, bool success, double latency);
+    void Loop();
+    void Warm(const WarmTask &task);
+
+    std::mutex mutex;                                             ///< 互斥锁（所有上游组的状态）
+    std::condition_variable wakeup;                               ///< 配置变化时唤醒预建线程
+    std::map<std::string, std::shared_ptr<UpstreamGroup>> groups; ///< 组名 -> 上游组
+    std::mt19937 random{std::random_device{}()};                  ///< 随机选择端点
+    UpstreamConfigurator configurator;                            ///< 句柄配置回调
+    bool started = false;                                         ///< 预建线程是否已启动
+};
+
+#endif // GMCURL_UPSTREAM_BALANCER_H